@@ -14,1337 +14,41 @@
 #include <assert.h>
 
 
-#define REX_NE          -2      /* Not encodable */
-#define REX_NONE        -1
-#define REX_FALSE       0
-#define REX_TRUE        1
-
 /*     return (1<<6) | (w<<3) | (r<<2) | (x<<1) | b; */
 #define REX             (1<<6)
 #define REX_W           (1<<3)
-#define REX_R           (1<<2)
-#define REX_X           (1<<1)
-#define REX_B           (1)
-
-
-static int
-_encode_rm(const x86_64_opr_t *, const x86_64_opr_t *, x86_64_enop_t *);
-static int
-_encode_mr(const x86_64_opr_t *, const x86_64_opr_t *, x86_64_enop_t *);
-static int
-_encode_oi(const x86_64_opr_t *, const x86_64_opr_t *, size_t,
-           x86_64_enop_t *);
-static int
-_encode_mi(const x86_64_opr_t *, const x86_64_opr_t *, int, size_t,
-           x86_64_enop_t *);
-
-
-/*
- * Is an immediate value? (imm8, imm16, imm32, or imm64)
- */
-static __inline__ int
-_is_imm(x86_64_opr_t *opr, int sz)
-{
-    if ( X86_64_OPR_IMM == opr->type ) {
-        switch ( opr->u.imm.type ) {
-        case X86_64_IMM_FIXED:
-            /* Fixed value */
-            if ( 0 == opr->sopsize ) {
-                /* Operand size is not specified */
-                return 1;
-            } else if ( sz == opr->sopsize ) {
-                /* Operand size is specified */
-                return 1;
-            } else {
-                return 0;
-            }
-            break;
-        case X86_64_IMM_EXPR:
-            if ( 0 == opr->sopsize )  {
-                /* Operand size is not specified */
-                return 1;
-            } else if ( sz == opr->sopsize ) {
-                /* Operand size is specified */
-                return 1;
-            } else {
-                return 0;
-            }
-            break;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_imm8(x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_IMM == opr->type ) {
-        switch ( opr->u.imm.type ) {
-        case X86_64_IMM_FIXED:
-            /* Fixed value */
-            if ( 0 == opr->sopsize ) {
-                /* Operand size is not specified */
-                if ( opr->u.imm.u.fixed >= -128
-                     && opr->u.imm.u.fixed <= 127 ) {
-                    /* In the range of imm8 */
-                    return 1;
-                } else {
-                    return 0;
-                }
-            } else if ( SIZE8 == opr->sopsize ) {
-                /* Operand size is specified */
-                return 1;
-            } else {
-                return 0;
-            }
-            break;
-        case X86_64_IMM_EXPR:
-            if ( SIZE8 == opr->sopsize ) {
-                /* Operand size is specified */
-                return 1;
-            } else {
-                return 0;
-            }
-            break;
-        default:
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_imm16(x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_IMM == opr->type ) {
-        switch ( opr->u.imm.type ) {
-        case X86_64_IMM_FIXED:
-            /* Fixed value */
-            if ( 0 == opr->sopsize ) {
-                /* Operand size is not specified */
-                if ( opr->u.imm.u.fixed >= -32768
-                     && opr->u.imm.u.fixed <= 32767 ) {
-                    /* In the range of imm16 */
-                    return 1;
-                } else {
-                    return 0;
-                }
-            } else if ( SIZE16 == opr->sopsize ) {
-                /* Operand size is specified */
-                return 1;
-            } else {
-                return 0;
-            }
-            break;
-        case X86_64_IMM_EXPR:
-            if ( SIZE16 == opr->sopsize ) {
-                /* Operand size is specified */
-                return 1;
-            } else {
-                return 0;
-            }
-            break;
-        default:
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_imm32(x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_IMM == opr->type ) {
-        switch ( opr->u.imm.type ) {
-        case X86_64_IMM_FIXED:
-            /* Fixed value */
-            if ( 0 == opr->sopsize ) {
-                /* Operand size is not specified */
-                if ( opr->u.imm.u.fixed >= -2147483648
-                     && opr->u.imm.u.fixed <= 2147483647 ) {
-                    /* In the range of imm32 */
-                    return 1;
-                } else {
-                    return 0;
-                }
-            } else if ( SIZE32 == opr->sopsize ) {
-                /* Operand size is specified */
-                return 1;
-            } else {
-                return 0;
-            }
-            break;
-        case X86_64_IMM_EXPR:
-            if ( SIZE32 == opr->sopsize ) {
-                /* Operand size is specified */
-                return 1;
-            } else if ( 0 == opr->sopsize ) {
-                return 1;
-            } else {
-                return 0;
-            }
-            break;
-        default:
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_imm64(x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_IMM == opr->type ) {
-        switch ( opr->u.imm.type ) {
-        case X86_64_IMM_FIXED:
-            /* Fixed value */
-            if ( 0 == opr->sopsize ) {
-                /* Operand size is not specified */
-                return 1;
-            } else if ( SIZE64 == opr->sopsize ) {
-                /* Operand size is specified */
-                return 1;
-            } else {
-                return 0;
-            }
-            break;
-        case X86_64_IMM_EXPR:
-            if ( SIZE64 == opr->sopsize ) {
-                /* Operand size is specified */
-                return 1;
-            } else {
-                return 0;
-            }
-            break;
-        default:
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_3(x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_IMM == opr->type ) {
-        switch ( opr->u.imm.type ) {
-        case X86_64_IMM_FIXED:
-            if ( 3 == opr->u.imm.u.fixed ) {
-                return 1;
-            }
-            break;
-        default:
-            ;
-        }
-    }
-    return 0;
-}
-
-
-/*
- * Is the estimated value an X-bit relative address?
- */
-#if 0
-static __inline__ int
-_is_rel8(x86_64_opr_t *opr, off_t pos)
-{
-    int64_t imin;
-    int64_t imax;
-
-    if ( X86_64_OPR_IMM == opr->type ) {
-        /* Fixed value */
-        if ( 0 == opr->sopsize ) {
-            //imin = opr->u.imm.u.est.min - pos * X86_64_INSTR_SIZE_MAX;
-            //imax = opr->u.imm.u.est.max - pos * X86_64_INSTR_SIZE_MIN;
-            /* Operand size is not specified */
-            if ( imin >= -128 && imax <= 127 ) {
-                /* In the range of imm16 */
-                return 1;
-            } else {
-                return 0;
-            }
-        } else if ( SIZE8 == opr->sopsize ) {
-            /* Operand size is specified */
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_imm16(x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_IMM == opr->type
-         && X86_64_IMM_FIXED == opr->u.imm.type ) {
-        /* Fixed value */
-        if ( 0 == opr->sopsize ) {
-            /* Operand size is not specified */
-            if ( opr->u.imm.u.fixed >= -32768
-                 && opr->u.imm.u.fixed <= 32767 ) {
-                /* In the range of imm16 */
-                return 1;
-            } else {
-                return 0;
-            }
-        } else if ( SIZE16 == opr->sopsize ) {
-            /* Operand size is specified */
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_imm32(x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_IMM == opr->type
-         && X86_64_IMM_FIXED == opr->u.imm.type ) {
-        /* Fixed value */
-        if ( 0 == opr->sopsize ) {
-            /* Operand size is not specified */
-            if ( opr->u.imm.u.fixed >= -2147483648
-                 && opr->u.imm.u.fixed <= 2147483647 ) {
-                /* In the range of imm16 */
-                return 1;
-            } else {
-                return 0;
-            }
-        } else if ( SIZE32 == opr->sopsize ) {
-            /* Operand size is specified */
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_imm64(x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_IMM == opr->type ) {
-        if ( 0 == opr->sopsize ) {
-            return 1;
-        } else if ( SIZE64 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-#endif
-
-
-/*
- * Does the estimated value equal the specified register?
- */
-static __inline__ int
-_eq_reg(const x86_64_opr_t *opr, x86_64_reg_t reg)
-{
-    if ( X86_64_OPR_REG == opr->type && reg == opr->u.reg ) {
-        return 1;
-    } else {
-        return 0;
-    }
-}
-
-/*
- * Is the register with the specified size?
- */
-static __inline__ int
-_is_r16(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_REG == opr->type ) {
-        if ( SIZE16 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_r32(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_REG == opr->type ) {
-        if ( SIZE32 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_r64(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_REG == opr->type ) {
-        if ( SIZE64 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-
-/*
- * Is the value type memory with the specified size?
- */
-static __inline__ int
-_is_m_unspec(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_ADDR == opr->type ) {
-        if ( 0 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_m8(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_ADDR == opr->type ) {
-        if ( SIZE8 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_m16(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_ADDR == opr->type ) {
-        if ( SIZE16 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_m32(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_ADDR == opr->type ) {
-        if ( SIZE32 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_m64(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_ADDR == opr->type ) {
-        if ( SIZE64 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-
-/*
- * Is the estimated value register or memory operand with the specified size?
- */
-static __inline__ int
-_is_rm8(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_REG == opr->type || X86_64_OPR_ADDR == opr->type ) {
-        if ( SIZE8 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_rm16(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_REG == opr->type || X86_64_OPR_ADDR == opr->type ) {
-        if ( SIZE16 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_rm32(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_REG == opr->type || X86_64_OPR_ADDR == opr->type ) {
-        if ( SIZE32 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_rm64(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_REG == opr->type || X86_64_OPR_ADDR == opr->type ) {
-        if ( SIZE64 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-
-
-
-
-
-static __inline__ int
-_is_reg(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_REG == opr->type ) {
-        return 1;
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_reg8(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_REG == opr->type ) {
-        if ( SIZE8 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_reg16(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_REG == opr->type ) {
-        if ( SIZE16 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_reg32(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_REG == opr->type ) {
-        if ( SIZE32 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_reg64(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_REG == opr->type ) {
-        if ( SIZE64 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-static __inline__ int
-_is_addr8(const x86_64_opr_t *opr)
-{
-    if ( X86_64_OPR_ADDR == opr->type ) {
-        if ( SIZE8 == opr->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    } else {
-        return 0;
-    }
-}
-
-
-
-static __inline__ int
-_is_rm8_r8(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( X86_64_OPR_REG == opr2->type && SIZE8 == opr2->sopsize
-         && (X86_64_OPR_REG == opr1->type || X86_64_OPR_ADDR == opr1->type)
-         && (0 == opr1->sopsize || SIZE8 == opr1->sopsize) ) {
-        return 1;
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_rm8_r32(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( X86_64_OPR_REG == opr2->type && SIZE32 == opr2->sopsize
-         && (X86_64_OPR_REG == opr1->type || X86_64_OPR_ADDR == opr1->type)
-         && (0 == opr1->sopsize || SIZE8 == opr1->sopsize) ) {
-        return 1;
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_rm8_r64(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( X86_64_OPR_REG == opr2->type && SIZE64 == opr2->sopsize
-         && (X86_64_OPR_REG == opr1->type || X86_64_OPR_ADDR == opr1->type)
-         && (0 == opr1->sopsize || SIZE8 == opr1->sopsize) ) {
-        return 1;
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_rm16_r16(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( X86_64_OPR_REG == opr2->type && SIZE16 == opr2->sopsize
-         && (X86_64_OPR_REG == opr1->type || X86_64_OPR_ADDR == opr1->type)
-         && (0 == opr1->sopsize || SIZE16 == opr1->sopsize) ) {
-        return 1;
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_rm16_r32(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( X86_64_OPR_REG == opr2->type && SIZE32 == opr2->sopsize
-         && (X86_64_OPR_REG == opr1->type || X86_64_OPR_ADDR == opr1->type)
-         && (0 == opr1->sopsize || SIZE16 == opr1->sopsize) ) {
-        return 1;
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_rm32_r32(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( X86_64_OPR_REG == opr2->type && SIZE32 == opr2->sopsize
-         && (X86_64_OPR_REG == opr1->type || X86_64_OPR_ADDR == opr1->type)
-         && (0 == opr1->sopsize || SIZE32 == opr1->sopsize) ) {
-        return 1;
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_rm64_r64(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( X86_64_OPR_REG == opr2->type && SIZE64 == opr2->sopsize
-         && (X86_64_OPR_REG == opr1->type || X86_64_OPR_ADDR == opr1->type)
-         && (0 == opr1->sopsize || SIZE64 == opr1->sopsize) ) {
-        return 1;
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r8_rm8(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    return _is_rm8_r8(opr2, opr1);
-}
-static __inline__ int
-_is_r16_rm16(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    return _is_rm16_r16(opr2, opr1);
-}
-static __inline__ int
-_is_r32_rm8(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    return _is_rm8_r32(opr2, opr1);
-}
-static __inline__ int
-_is_r32_rm16(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    return _is_rm16_r32(opr2, opr1);
-}
-static __inline__ int
-_is_r32_rm32(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    return _is_rm32_r32(opr2, opr1);
-}
-static __inline__ int
-_is_r64_rm8(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    return _is_rm8_r64(opr2, opr1);
-}
-static __inline__ int
-_is_r64_rm64(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    return _is_rm64_r64(opr2, opr1);
-}
-static __inline__ int
-_is_r8_imm8(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( X86_64_OPR_REG == opr1->type && SIZE8 == opr1->sopsize
-         && X86_64_OPR_IMM == opr2->type
-         && X86_64_IMM_FIXED == opr2->u.imm.type ) {
-        if ( 0 == opr2->sopsize ) {
-            if ( opr2->u.imm.u.fixed >= -128 && opr2->u.imm.u.fixed <= 127 ) {
-                return 1;
-            }
-        } else if ( SIZE8 == opr2->sopsize ) {
-            return 1;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r16_imm16(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( X86_64_OPR_REG == opr1->type && SIZE16 == opr1->sopsize
-         && X86_64_OPR_IMM == opr2->type
-         && X86_64_IMM_FIXED == opr2->u.imm.type ) {
-        if ( 0 == opr2->sopsize ) {
-            if ( opr2->u.imm.u.fixed >= -32768
-                 && opr2->u.imm.u.fixed <= 32767 ) {
-                return 1;
-            }
-        } else if ( SIZE16 == opr2->sopsize ) {
-            return 1;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r32_imm32(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( X86_64_OPR_REG == opr1->type && SIZE32 == opr1->sopsize
-         && X86_64_OPR_IMM == opr2->type
-         && X86_64_IMM_FIXED == opr2->u.imm.type ) {
-        if ( 0 == opr2->sopsize ) {
-            if ( opr2->u.imm.u.fixed >= -2147483648
-                 && opr2->u.imm.u.fixed <= 2147483647 ) {
-                return 1;
-            }
-        } else if ( SIZE32 == opr2->sopsize ) {
-            return 1;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r64_imm64(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( X86_64_OPR_REG == opr1->type && SIZE64 == opr1->sopsize
-         && X86_64_OPR_IMM == opr2->type
-         && X86_64_IMM_FIXED == opr2->u.imm.type ) {
-        if ( 0 == opr2->sopsize ) {
-            return 1;
-        } else if ( SIZE64 == opr2->sopsize ) {
-            return 1;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r8_rela8(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( X86_64_OPR_REG == opr1->type && SIZE8 == opr1->sopsize
-         && X86_64_OPR_IMM == opr2->type
-         && X86_64_IMM_EXPR == opr2->u.imm.type ) {
-        if ( 0 == opr2->sopsize || SIZE8 == opr2->sopsize ) {
-            return 1;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r16_rela16(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( X86_64_OPR_REG == opr1->type && SIZE16 == opr1->sopsize
-         && X86_64_OPR_IMM == opr2->type
-         && X86_64_IMM_EXPR == opr2->u.imm.type ) {
-        if ( 0 == opr2->sopsize || SIZE16 == opr2->sopsize ) {
-            return 1;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r32_rela32(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( X86_64_OPR_REG == opr1->type && SIZE32 == opr1->sopsize
-         && X86_64_OPR_IMM == opr2->type
-         && X86_64_IMM_EXPR == opr2->u.imm.type ) {
-        if ( 0 == opr2->sopsize || SIZE32 == opr2->sopsize ) {
-            return 1;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r64_rela64(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( X86_64_OPR_REG == opr1->type && SIZE64 == opr1->sopsize
-         && X86_64_OPR_IMM == opr2->type
-         && X86_64_IMM_EXPR == opr2->u.imm.type ) {
-        if ( 0 == opr2->sopsize || SIZE64 == opr2->sopsize ) {
-            return 1;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_rm8_imm8(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( (X86_64_OPR_REG == opr1->type || X86_64_OPR_ADDR == opr1->type)
-         && X86_64_OPR_IMM == opr2->type
-         && X86_64_IMM_FIXED == opr2->u.imm.type ) {
-        if ( SIZE8 == opr1->sopsize ) {
-            if ( 0 == opr2->sopsize ) {
-                if ( opr2->u.imm.u.fixed >= -128
-                     && opr2->u.imm.u.fixed <= 127 ) {
-                    return 1;
-                }
-            } else if ( SIZE8 == opr2->sopsize ) {
-                return 1;
-            }
-        } else if ( 0 == opr1->sopsize ) {
-            if ( SIZE8 == opr2->sopsize ) {
-                return 1;
-            }
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_rm16_imm16(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( (X86_64_OPR_REG == opr1->type || X86_64_OPR_ADDR == opr1->type)
-         && X86_64_OPR_IMM == opr2->type
-         && X86_64_IMM_FIXED == opr2->u.imm.type ) {
-        if ( SIZE16 == opr1->sopsize ) {
-            if ( 0 == opr2->sopsize ) {
-                if ( opr2->u.imm.u.fixed >= -32768
-                     && opr2->u.imm.u.fixed <= 32767 ) {
-                    return 1;
-                }
-            } else if ( SIZE16 == opr2->sopsize ) {
-                return 1;
-            }
-        } else if ( 0 == opr1->sopsize ) {
-            if ( SIZE16 == opr2->sopsize ) {
-                return 1;
-            }
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_rm32_imm32(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( (X86_64_OPR_REG == opr1->type || X86_64_OPR_ADDR == opr1->type)
-         && X86_64_OPR_IMM == opr2->type
-         && X86_64_IMM_FIXED == opr2->u.imm.type ) {
-        if ( SIZE32 == opr1->sopsize ) {
-            if ( 0 == opr2->sopsize ) {
-                if ( opr2->u.imm.u.fixed >= -2147483648
-                     && opr2->u.imm.u.fixed <= 2147483647 ) {
-                    return 1;
-                }
-            } else if ( SIZE32 == opr2->sopsize ) {
-                return 1;
-            }
-        } else if ( 0 == opr1->sopsize ) {
-            if ( SIZE32 == opr2->sopsize ) {
-                return 1;
-            }
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_rm64_imm64(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2)
-{
-    /* Check the first and second operands */
-    if ( (X86_64_OPR_REG == opr1->type || X86_64_OPR_ADDR == opr1->type)
-         && X86_64_OPR_IMM == opr2->type
-         && X86_64_IMM_FIXED == opr2->u.imm.type ) {
-        if ( SIZE64 == opr1->sopsize ) {
-            if ( 0 == opr2->sopsize ) {
-                return 1;
-            } else if ( SIZE64 == opr2->sopsize ) {
-                return 1;
-            }
-        } else if ( 0 == opr1->sopsize ) {
-            if ( SIZE64 == opr2->sopsize ) {
-                return 1;
-            }
-        }
-    }
-
-    return 0;
-}
-/* RMI */
-static __inline__ int
-_is_r16_rm16_imm8(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2,
-                  const x86_64_opr_t *opr3)
-{
-    /* Check the type of all operands */
-    if ( X86_64_OPR_REG == opr1->type
-         && (X86_64_OPR_REG == opr2->type || X86_64_OPR_ADDR == opr2->type)
-         && X86_64_OPR_IMM == opr3->type
-         && X86_64_IMM_FIXED == opr3->u.imm.type ) {
-        if ( SIZE16 != opr1->sopsize ) {
-            return 0;
-        }
-        if ( 0 != opr2->sopsize && SIZE16 != opr2->sopsize ) {
-            return 0;
-        }
-        if ( 0 == opr3->sopsize ) {
-            if ( opr3->u.imm.u.fixed >= -128 && opr3->u.imm.u.fixed <= 127 ) {
-                return 1;
-            }
-        } else if ( SIZE8 == opr3->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r32_rm32_imm8(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2,
-                  const x86_64_opr_t *opr3)
-{
-    /* Check the type of all operands */
-    if ( X86_64_OPR_REG == opr1->type
-         && (X86_64_OPR_REG == opr2->type || X86_64_OPR_ADDR == opr2->type)
-         && X86_64_OPR_IMM == opr3->type
-         && X86_64_IMM_FIXED == opr3->u.imm.type ) {
-        if ( SIZE32 != opr1->sopsize ) {
-            return 0;
-        }
-        if ( 0 != opr2->sopsize && SIZE32 != opr2->sopsize ) {
-            return 0;
-        }
-        if ( 0 == opr3->sopsize ) {
-            if ( opr3->u.imm.u.fixed >= -128 && opr3->u.imm.u.fixed <= 127 ) {
-                return 1;
-            }
-        } else if ( SIZE8 == opr3->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r64_rm64_imm8(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2,
-                  const x86_64_opr_t *opr3)
-{
-    /* Check the type of all operands */
-    if ( X86_64_OPR_REG == opr1->type
-         && (X86_64_OPR_REG == opr2->type || X86_64_OPR_ADDR == opr2->type)
-         && X86_64_OPR_IMM == opr3->type
-         && X86_64_IMM_FIXED == opr3->u.imm.type ) {
-        if ( SIZE64 != opr1->sopsize ) {
-            return 0;
-        }
-        if ( 0 != opr2->sopsize && SIZE64 != opr2->sopsize ) {
-            return 0;
-        }
-        if ( 0 == opr3->sopsize ) {
-            if ( opr3->u.imm.u.fixed >= -128 && opr3->u.imm.u.fixed <= 127 ) {
-                return 1;
-            }
-        } else if ( SIZE8 == opr3->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r16_rm16_imm16(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2,
-                   const x86_64_opr_t *opr3)
-{
-    /* Check the type of all operands */
-    if ( X86_64_OPR_REG == opr1->type
-         && (X86_64_OPR_REG == opr2->type || X86_64_OPR_ADDR == opr2->type)
-         && X86_64_OPR_IMM == opr3->type
-         && X86_64_IMM_FIXED == opr3->u.imm.type ) {
-        if ( SIZE16 != opr1->sopsize ) {
-            return 0;
-        }
-        if ( 0 != opr2->sopsize && SIZE16 != opr2->sopsize ) {
-            return 0;
-        }
-        if ( 0 == opr3->sopsize ) {
-            if ( opr3->u.imm.u.fixed >= -32768
-                 && opr3->u.imm.u.fixed <= 32767 ) {
-                return 1;
-            }
-        } else if ( SIZE16 == opr3->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r16_rm16_rela16(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2,
-                   const x86_64_opr_t *opr3)
-{
-    /* Check the type of all operands */
-    if ( X86_64_OPR_REG == opr1->type
-         && (X86_64_OPR_REG == opr2->type || X86_64_OPR_ADDR == opr2->type)
-         && X86_64_OPR_IMM == opr3->type
-         && X86_64_IMM_EXPR == opr3->u.imm.type ) {
-        if ( SIZE16 != opr1->sopsize ) {
-            return 0;
-        }
-        if ( 0 != opr2->sopsize && SIZE16 != opr2->sopsize ) {
-            return 0;
-        }
-        if ( 0 == opr3->sopsize || SIZE16 == opr3->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r32_rm32_imm32(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2,
-                   const x86_64_opr_t *opr3)
-{
-    /* Check the type of all operands */
-    if ( X86_64_OPR_REG == opr1->type
-         && (X86_64_OPR_REG == opr2->type || X86_64_OPR_ADDR == opr2->type)
-         && X86_64_OPR_IMM == opr3->type
-         && X86_64_IMM_FIXED == opr3->u.imm.type ) {
-        if ( SIZE32 != opr1->sopsize ) {
-            return 0;
-        }
-        if ( 0 != opr2->sopsize && SIZE32 != opr2->sopsize ) {
-            return 0;
-        }
-        if ( 0 == opr3->sopsize ) {
-            if ( opr3->u.imm.u.fixed >= -2147483648
-                 && opr3->u.imm.u.fixed <= 2147483647 ) {
-                return 1;
-            }
-        } else if ( SIZE32 == opr3->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r32_rm32_rela32(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2,
-                   const x86_64_opr_t *opr3)
-{
-    /* Check the type of all operands */
-    if ( X86_64_OPR_REG == opr1->type
-         && (X86_64_OPR_REG == opr2->type || X86_64_OPR_ADDR == opr2->type)
-         && X86_64_OPR_IMM == opr3->type
-         && X86_64_IMM_EXPR == opr3->u.imm.type ) {
-        if ( SIZE32 != opr1->sopsize ) {
-            return 0;
-        }
-        if ( 0 != opr2->sopsize && SIZE32 != opr2->sopsize ) {
-            return 0;
-        }
-        if ( 0 == opr3->sopsize || SIZE32 == opr3->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r64_rm64_imm32(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2,
-                   const x86_64_opr_t *opr3)
-{
-    /* Check the type of all operands */
-    if ( X86_64_OPR_REG == opr1->type
-         && (X86_64_OPR_REG == opr2->type || X86_64_OPR_ADDR == opr2->type)
-         && X86_64_OPR_IMM == opr3->type
-         && X86_64_IMM_FIXED == opr3->u.imm.type ) {
-        if ( SIZE64 != opr1->sopsize ) {
-            return 0;
-        }
-        if ( 0 != opr2->sopsize && SIZE64 != opr2->sopsize ) {
-            return 0;
-        }
-        if ( 0 == opr3->sopsize ) {
-            if ( opr3->u.imm.u.fixed >= -2147483648
-                 && opr3->u.imm.u.fixed <= 2147483647 ) {
-                return 1;
-            }
-        } else if ( SIZE32 == opr3->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    }
-
-    return 0;
-}
-static __inline__ int
-_is_r64_rm64_rela32(const x86_64_opr_t *opr1, const x86_64_opr_t *opr2,
-                    const x86_64_opr_t *opr3)
-{
-    /* Check the type of all operands */
-    if ( X86_64_OPR_REG == opr1->type
-         && (X86_64_OPR_REG == opr2->type || X86_64_OPR_ADDR == opr2->type)
-         && X86_64_OPR_IMM == opr3->type
-         && X86_64_IMM_EXPR == opr3->u.imm.type ) {
-        if ( SIZE64 != opr1->sopsize ) {
-            return 0;
-        }
-        if ( 0 != opr2->sopsize && SIZE64 != opr2->sopsize ) {
-            return 0;
-        }
-        if ( 0 == opr3->sopsize || SIZE32 == opr3->sopsize ) {
-            return 1;
-        } else {
-            return 0;
-        }
-    }
-
-    return 0;
-}
-
-
-
-/*
- * Resolve register code (and REX.B)
- * Vol. 2A 3-2
- */
-static int
-_reg_code(x86_64_reg_t reg, int *code, int *rex)
-{
-    switch ( reg ) {
-    case REG_AL:
-    case REG_AX:
-    case REG_EAX:
-    case REG_RAX:
-        *code = 0;
-        *rex = REX_NONE;
-        break;
-    case REG_CL:
-    case REG_CX:
-    case REG_ECX:
-    case REG_RCX:
-        *code = 1;
-        *rex = REX_NONE;
-        break;
-    case REG_DL:
-    case REG_DX:
-    case REG_EDX:
-    case REG_RDX:
-        *code = 2;
-        *rex = REX_NONE;
-        break;
-    case REG_BL:
-    case REG_BX:
-    case REG_EBX:
-    case REG_RBX:
-        *code = 3;
-        *rex = REX_NONE;
-        break;
-    case REG_AH:
-        *code = 4;
-        *rex = REX_NE;
-        break;
-    case REG_SP:
-    case REG_ESP:
-    case REG_RSP:
-        *code = 4;
-        *rex = REX_NONE;
-        break;
-    case REG_SPL:
-        *code = 4;
-        *rex = REX_FALSE;
-        break;
-    case REG_CH:
-        *code = 5;
-        *rex = REX_NE;
-        break;
-    case REG_BP:
-    case REG_EBP:
-    case REG_RBP:
-        *code = 5;
-        *rex = REX_NONE;
-        break;
-    case REG_BPL:
-        *code = 5;
-        *rex = REX_FALSE;
-        break;
-    case REG_DH:
-        *code = 6;
-        *rex = REX_NE;
-        break;
-    case REG_SI:
-    case REG_ESI:
-    case REG_RSI:
-        *code = 6;
-        *rex = REX_NONE;
-        break;
-    case REG_SIL:
-        *code = 6;
-        *rex = REX_FALSE;
-        break;
-    case REG_BH:
-        *code = 7;
-        *rex = REX_NE;
-        break;
-    case REG_DI:
-    case REG_EDI:
-    case REG_RDI:
-        *code = 7;
-        *rex = REX_NONE;
-        break;
-    case REG_DIL:
-        *code = 7;
-        *rex = REX_FALSE;
-        break;
-    case REG_R8L:
-    case REG_R8W:
-    case REG_R8D:
-    case REG_R8:
-        *code = 0;
-        *rex = REX_TRUE;
-        break;
-    case REG_R9L:
-    case REG_R9W:
-    case REG_R9D:
-    case REG_R9:
-        *code = 1;
-        *rex = REX_TRUE;
-        break;
-    case REG_R10L:
-    case REG_R10W:
-    case REG_R10D:
-    case REG_R10:
-        *code = 2;
-        *rex = REX_TRUE;
-        break;
-    case REG_R11L:
-    case REG_R11W:
-    case REG_R11D:
-    case REG_R11:
-        *code = 3;
-        *rex = REX_TRUE;
-        break;
-    case REG_R12L:
-    case REG_R12W:
-    case REG_R12D:
-    case REG_R12:
-        *code = 4;
-        *rex = REX_TRUE;
-        break;
-    case REG_R13L:
-    case REG_R13W:
-    case REG_R13D:
-    case REG_R13:
-        *code = 5;
-        *rex = REX_TRUE;
-        break;
-    case REG_R14L:
-    case REG_R14W:
-    case REG_R14D:
-    case REG_R14:
-        *code = 6;
-        *rex = REX_TRUE;
-        break;
-    case REG_R15L:
-    case REG_R15W:
-    case REG_R15D:
-    case REG_R15:
-        *code = 7;
-        *rex = REX_TRUE;
-        break;
-    default:
+#define REX_R           (1<<2)
+#define REX_X           (1<<1)
+#define REX_B           (1)
+
+
+static int
+_encode_rm(const x86_64_opr_t *, const x86_64_opr_t *, x86_64_enop_t *);
+static int
+_encode_mr(const x86_64_opr_t *, const x86_64_opr_t *, x86_64_enop_t *);
+static int
+_encode_oi(const x86_64_opr_t *, const x86_64_opr_t *, size_t,
+           x86_64_enop_t *);
+static int
+_encode_mi(const x86_64_opr_t *, const x86_64_opr_t *, int, size_t,
+           x86_64_enop_t *);
+
+
+/*
+ * Resolve register code (and REX.B)
+ * Vol. 2A 3-2
+ */
+static int
+_reg_code(x86_64_reg_t reg, int *code, int *rex)
+{
+    const x86_64_reg_info_t *ri;
+
+    ri = x86_64_reg_info(reg);
+    if ( NULL == ri || ri->code < 0 ) {
         return -1;
     }
+    *code = ri->code;
+    *rex = ri->rex;
 
     return 0;
 }
@@ -2618,27 +1322,180 @@ _encode_instr(x86_64_instr_t *instr, const x86_64_enop_t *enop,
 }
 
 
+/*
+ * Obtain the size of the instruction
+ */
+size_t
+x86_64_instr_size(const x86_64_instr_t *instr)
+{
+    size_t sz;
+
+    sz = 0;
+    if ( instr->prefix1 >= 0 ) {
+        sz++;
+    }
+    if ( instr->prefix2 >= 0 ) {
+        sz++;
+    }
+    if ( instr->prefix3 >= 0 ) {
+        sz++;
+    }
+    if ( instr->prefix4 >= 0 ) {
+        sz++;
+    }
+    if ( instr->rex >= 0 ) {
+        sz++;
+    }
+    if ( instr->opcode1 >= 0 ) {
+        sz++;
+    }
+    if ( instr->opcode2 >= 0 ) {
+        sz++;
+    }
+    if ( instr->opcode3 >= 0 ) {
+        sz++;
+    }
+    if ( instr->modrm >= 0 ) {
+        sz++;
+    }
+    if ( instr->sib >= 0 ) {
+        sz++;
+    }
+    sz += instr->disp.sz;
+    sz += instr->imm.sz;
+    sz += instr->rel.sz;
+    sz += instr->ptr0.sz;
+    sz += instr->ptr1.sz;
+
+    return sz;
+}
+
+/*
+ * Write the value to the field of the packed instruction in little endian
+ */
+void
+x86_64_pinstr_patch(x86_64_pinstr_t *pinstr, size_t off, size_t sz,
+                    int64_t val)
+{
+    size_t i;
+
+    for ( i = 0; i < sz; i++ ) {
+        pinstr->buf[off + i] = (uint8_t)(val & 0xff);
+        val >>= 8;
+    }
+}
+
+/*
+ * Pack the instruction into the encoded bytes
+ */
+int
+x86_64_instr_pack(const x86_64_instr_t *instr, x86_64_pinstr_t *pinstr)
+{
+    size_t len;
+
+    if ( x86_64_instr_size(instr) > X86_64_INSTR_MAX_LEN ) {
+        return -1;
+    }
+
+    len = 0;
+    if ( instr->prefix1 >= 0 ) {
+        pinstr->buf[len++] = instr->prefix1;
+    }
+    if ( instr->prefix2 >= 0 ) {
+        pinstr->buf[len++] = instr->prefix2;
+    }
+    if ( instr->prefix3 >= 0 ) {
+        pinstr->buf[len++] = instr->prefix3;
+    }
+    if ( instr->prefix4 >= 0 ) {
+        pinstr->buf[len++] = instr->prefix4;
+    }
+    if ( instr->rex >= 0 ) {
+        pinstr->buf[len++] = instr->rex;
+    }
+    if ( instr->opcode1 >= 0 ) {
+        pinstr->buf[len++] = instr->opcode1;
+    }
+    if ( instr->opcode2 >= 0 ) {
+        pinstr->buf[len++] = instr->opcode2;
+    }
+    if ( instr->opcode3 >= 0 ) {
+        pinstr->buf[len++] = instr->opcode3;
+    }
+    if ( instr->modrm >= 0 ) {
+        pinstr->buf[len++] = instr->modrm;
+    }
+    if ( instr->sib >= 0 ) {
+        pinstr->buf[len++] = instr->sib;
+    }
+    pinstr->disp = len;
+    x86_64_pinstr_patch(pinstr, len, instr->disp.sz, instr->disp.val);
+    len += instr->disp.sz;
+    pinstr->imm = len;
+    x86_64_pinstr_patch(pinstr, len, instr->imm.sz, instr->imm.val);
+    len += instr->imm.sz;
+    pinstr->rel = len;
+    x86_64_pinstr_patch(pinstr, len, instr->rel.sz, instr->rel.val);
+    len += instr->rel.sz;
+    pinstr->ptr0 = len;
+    x86_64_pinstr_patch(pinstr, len, instr->ptr0.sz, instr->ptr0.val);
+    len += instr->ptr0.sz;
+    pinstr->ptr1 = len;
+    x86_64_pinstr_patch(pinstr, len, instr->ptr1.sz, instr->ptr1.val);
+    len += instr->ptr1.sz;
+    pinstr->len = len;
+
+    return 0;
+}
+
+/*
+ * Does the value fit in the field of the size?
+ */
+int
+x86_64_check_size(size_t sz, int64_t val)
+{
+    switch ( sz ) {
+    case SIZE8:
+        if ( val >= -128 && val <= 127 ) {
+            return 1;
+        }
+        break;
+    case SIZE16:
+        if ( val >= -32768 && val <= 32767 ) {
+            return 1;
+        }
+        break;
+    case SIZE32:
+        if ( val >= -2147483648 && val <= 2147483647 ) {
+            return 1;
+        }
+        break;
+    case SIZE64:
+        return 1;
+    default:
+        if ( 0 == val ) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
 /*
  * Build instruction for the NP type Op/En
  */
 static int
-_binstr2_np(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize)
+_binstr2_np(const x86_64_stmt_t *xstmt, x86_64_instr_t *instr, int opc1,
+            int opc2, int opc3, ssize_t opsize)
 {
     int ret;
     x86_64_enop_t enop;
-    x86_64_instr_t *instr;
 
     /* Check the size */
     if ( opsize < 0 ) {
         return -EUNKNOWN;
     }
 
-    /* Allocaate for the instruction */
-    instr = malloc(sizeof(x86_64_instr_t));
-    if ( NULL == instr ) {
-        return -EUNKNOWN;
-    }
-
     /* Reset the encoded operands */
     enop.opreg = -1;
     enop.rex.r = REX_NONE;
@@ -2666,7 +1523,6 @@ _binstr2_np(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize)
     ret = _encode_instr(instr, &enop, xstmt->tgt, xstmt->prefix, opsize, 0);
     if ( ret < 0 ) {
         /* Invalid operands */
-        free(instr);
         return -EOPERAND;
     }
 
@@ -2675,12 +1531,6 @@ _binstr2_np(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize)
     instr->opcode2 = opc2;
     instr->opcode3 = opc3;
 
-    /* Set the instruction and the size */
-    if ( NULL == mvector_push_back(xstmt->instrs, instr) ) {
-        free(instr);
-        return -EUNKNOWN;
-    }
-
     /* Success */
     return 1;
 }
@@ -2689,24 +1539,17 @@ _binstr2_np(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize)
  * Build instruction for the NP type Op/En with preg value
  */
 static int
-_binstr2_np_preg(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3,
-                 ssize_t opsize, int preg)
+_binstr2_np_preg(const x86_64_stmt_t *xstmt, x86_64_instr_t *instr, int opc1,
+                 int opc2, int opc3, ssize_t opsize, int preg)
 {
     int ret;
     x86_64_enop_t enop;
-    x86_64_instr_t *instr;
 
     /* Check the size */
     if ( opsize < 0 ) {
         return -EUNKNOWN;
     }
 
-    /* Allocaate for the instruction */
-    instr = malloc(sizeof(x86_64_instr_t));
-    if ( NULL == instr ) {
-        return -EUNKNOWN;
-    }
-
     /* Reset the encoded operands */
     enop.opreg = -1;
     enop.rex.r = REX_NONE;
@@ -2734,7 +1577,6 @@ _binstr2_np_preg(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3,
     ret = _encode_instr(instr, &enop, xstmt->tgt, xstmt->prefix, opsize, 0);
     if ( ret < 0 ) {
         /* Invalid operands */
-        free(instr);
         return -EOPERAND;
     }
 
@@ -2743,12 +1585,6 @@ _binstr2_np_preg(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3,
     instr->opcode2 = opc2;
     instr->opcode3 = opc3;
 
-    /* Set the instruction and the size */
-    if ( NULL == mvector_push_back(xstmt->instrs, instr) ) {
-        free(instr);
-        return -EUNKNOWN;
-    }
-
     /* Success */
     return 1;
 }
@@ -2757,31 +1593,23 @@ _binstr2_np_preg(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3,
  * Build instruction for the I type Op/En
  */
 static int
-_binstr2_i(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
-           const x86_64_opr_t *opr, size_t immsz)
+_binstr2_i(const x86_64_stmt_t *xstmt, x86_64_instr_t *instr, int opc1,
+           int opc2, int opc3, ssize_t opsize, const x86_64_opr_t *opr,
+           size_t immsz)
 {
     int ret;
     x86_64_enop_t enop;
-    x86_64_instr_t *instr;
-
-    /* Allocaate for the instruction */
-    instr = malloc(sizeof(x86_64_instr_t));
-    if ( NULL == instr ) {
-        return -EUNKNOWN;
-    }
 
     /* Encode the operand values */
     ret = _encode_i(opr, immsz, &enop);
     if ( ret < 0 ) {
         /* Invalid operand size */
-        free(instr);
         return -ESIZE;
     }
     /* Encode instruction */
     ret = _encode_instr(instr, &enop, xstmt->tgt, xstmt->prefix, opsize, 0);
     if ( ret < 0 ) {
         /* Invalid operands */
-        free(instr);
         return -EOPERAND;
     }
 
@@ -2790,12 +1618,6 @@ _binstr2_i(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
     instr->opcode2 = opc2;
     instr->opcode3 = opc3;
 
-    /* Set the instruction and the size */
-    if ( NULL == mvector_push_back(xstmt->instrs, instr) ) {
-        free(instr);
-        return -EUNKNOWN;
-    }
-
     /* Success */
     return 1;
 }
@@ -2804,31 +1626,23 @@ _binstr2_i(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
  * Build instruction for the D type Op/En
  */
 static int
-_binstr2_d(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
-           const x86_64_opr_t *opr, size_t immsz)
+_binstr2_d(const x86_64_stmt_t *xstmt, x86_64_instr_t *instr, int opc1,
+           int opc2, int opc3, ssize_t opsize, const x86_64_opr_t *opr,
+           size_t immsz)
 {
     int ret;
     x86_64_enop_t enop;
-    x86_64_instr_t *instr;
-
-    /* Allocaate for the instruction */
-    instr = malloc(sizeof(x86_64_instr_t));
-    if ( NULL == instr ) {
-        return -EUNKNOWN;
-    }
 
     /* Encode the operand values */
     ret = _encode_d(opr, immsz, &enop);
     if ( ret < 0 ) {
         /* Invalid operand size */
-        free(instr);
         return -ESIZE;
     }
     /* Encode instruction */
     ret = _encode_instr(instr, &enop, xstmt->tgt, xstmt->prefix, opsize, 0);
     if ( ret < 0 ) {
         /* Invalid operands */
-        free(instr);
         return -EOPERAND;
     }
 
@@ -2837,12 +1651,6 @@ _binstr2_d(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
     instr->opcode2 = opc2;
     instr->opcode3 = opc3;
 
-    /* Set the instruction and the size */
-    if ( NULL == mvector_push_back(xstmt->instrs, instr) ) {
-        free(instr);
-        return -EUNKNOWN;
-    }
-
     /* Success */
     return 1;
 }
@@ -2851,38 +1659,29 @@ _binstr2_d(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
  * Build instruction for the MI type Op/En
  */
 static int
-_binstr2_mi(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, int preg,
-            ssize_t opsize, const x86_64_opr_t *oprm,
-            const x86_64_opr_t *opri, size_t immsz)
+_binstr2_mi(const x86_64_stmt_t *xstmt, x86_64_instr_t *instr, int opc1,
+            int opc2, int opc3, int preg, ssize_t opsize,
+            const x86_64_opr_t *oprm, const x86_64_opr_t *opri, size_t immsz)
 {
     int ret;
     x86_64_enop_t enop;
     ssize_t addrsize;
-    x86_64_instr_t *instr;
 
     /* Check pseudo register */
     if ( preg < 0 ) {
         return -EUNKNOWN;
     }
 
-    /* Allocaate for the instruction */
-    instr = malloc(sizeof(x86_64_instr_t));
-    if ( NULL == instr ) {
-        return -EUNKNOWN;
-    }
-
     /* Encode and free the values */
     ret = _encode_mi(oprm, opri, preg, immsz, &enop);
     if ( ret < 0 ) {
         /* Invalid operand size */
-        free(instr);
         return -ESIZE;
     }
 
     /* Obtain address size */
     addrsize = _resolve_address_size1(oprm);
     if ( addrsize < 0 ) {
-        free(instr);
         return -ESIZE;
     }
     /* Encode instruction */
@@ -2890,7 +1689,6 @@ _binstr2_mi(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, int preg,
                         addrsize);
     if ( ret < 0 ) {
         /* Invalid operands */
-        free(instr);
         return -EOPERAND;
     }
 
@@ -2899,12 +1697,6 @@ _binstr2_mi(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, int preg,
     instr->opcode2 = opc2;
     instr->opcode3 = opc3;
 
-    /* Set the instruction and the size */
-    if ( NULL == mvector_push_back(xstmt->instrs, instr) ) {
-        free(instr);
-        return -EUNKNOWN;
-    }
-
     /* Success */
     return 1;
 }
@@ -2913,31 +1705,23 @@ _binstr2_mi(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, int preg,
  * Build instruction for the MR type Op/En
  */
 static int
-_binstr2_mr(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
-            const x86_64_opr_t *oprm, const x86_64_opr_t *oprr)
+_binstr2_mr(const x86_64_stmt_t *xstmt, x86_64_instr_t *instr, int opc1,
+            int opc2, int opc3, ssize_t opsize, const x86_64_opr_t *oprm,
+            const x86_64_opr_t *oprr)
 {
     int ret;
     x86_64_enop_t enop;
     ssize_t addrsize;
-    x86_64_instr_t *instr;
-
-    /* Allocaate for the instruction */
-    instr = malloc(sizeof(x86_64_instr_t));
-    if ( NULL == instr ) {
-        return -EUNKNOWN;
-    }
 
     /* Encode and free the values */
     ret = _encode_mr(oprm, oprr, &enop);
     if ( ret < 0 ) {
         /* Invalid operand size */
-        free(instr);
         return -ESIZE;
     }
     /* Obtain address size */
     addrsize = _resolve_address_size1(oprm);
     if ( addrsize < 0 ) {
-        free(instr);
         return -ESIZE;
     }
     /* Encode instruction */
@@ -2945,19 +1729,12 @@ _binstr2_mr(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
                         addrsize);
     if ( ret < 0 ) {
         /* Invalid operands */
-        free(instr);
         return -EOPERAND;
     }
     instr->opcode1 = opc1;
     instr->opcode2 = opc2;
     instr->opcode3 = opc3;
 
-    /* Set the instruction and the size */
-    if ( NULL == mvector_push_back(xstmt->instrs, instr) ) {
-        free(instr);
-        return -EUNKNOWN;
-    }
-
     /* Success */
     return 1;
 }
@@ -2966,31 +1743,22 @@ _binstr2_mr(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
  * Build instruction for the O type Op/En
  */
 static int
-_binstr2_o(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
-           const x86_64_opr_t *oprr)
+_binstr2_o(const x86_64_stmt_t *xstmt, x86_64_instr_t *instr, int opc1,
+           int opc2, int opc3, ssize_t opsize, const x86_64_opr_t *oprr)
 {
     int ret;
     x86_64_enop_t enop;
-    x86_64_instr_t *instr;
-
-    /* Allocaate for the instruction */
-    instr = malloc(sizeof(x86_64_instr_t));
-    if ( NULL == instr ) {
-        return -EUNKNOWN;
-    }
 
     /* Encode and free the values */
     ret = _encode_o(oprr, &enop);
     if ( ret < 0 ) {
         /* Invalid operand size */
-        free(instr);
         return -ESIZE;
     }
     /* Encode instruction */
     ret = _encode_instr(instr, &enop, xstmt->tgt, xstmt->prefix, opsize, 0);
     if ( ret < 0 ) {
         /* Invalid operands */
-        free(instr);
         return -EOPERAND;
     }
     instr->opcode1 = opc1;
@@ -3006,12 +1774,6 @@ _binstr2_o(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
         instr->opcode1 += enop.opreg;
     }
 
-    /* Set the instruction and the size */
-    if ( NULL == mvector_push_back(xstmt->instrs, instr) ) {
-        free(instr);
-        return -EUNKNOWN;
-    }
-
     /* Success */
     return 1;
 }
@@ -3020,31 +1782,23 @@ _binstr2_o(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
  * Build instruction for the RM type Op/En
  */
 static int
-_binstr2_rm(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
-            const x86_64_opr_t *oprr, const x86_64_opr_t *oprm)
+_binstr2_rm(const x86_64_stmt_t *xstmt, x86_64_instr_t *instr, int opc1,
+            int opc2, int opc3, ssize_t opsize, const x86_64_opr_t *oprr,
+            const x86_64_opr_t *oprm)
 {
     int ret;
     x86_64_enop_t enop;
     ssize_t addrsize;
-    x86_64_instr_t *instr;
-
-    /* Allocaate for the instruction */
-    instr = malloc(sizeof(x86_64_instr_t));
-    if ( NULL == instr ) {
-        return -EUNKNOWN;
-    }
 
     /* Encode and free the values */
     ret = _encode_rm(oprr, oprm, &enop);
     if ( ret < 0 ) {
         /* Invalid operand size */
-        free(instr);
         return -ESIZE;
     }
     /* Obtain address size */
     addrsize = _resolve_address_size1(oprm);
     if ( addrsize < 0 ) {
-        free(instr);
         return -ESIZE;
     }
     /* Encode instruction */
@@ -3052,19 +1806,12 @@ _binstr2_rm(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
                         addrsize);
     if ( ret < 0 ) {
         /* Invalid operands */
-        free(instr);
         return -EOPERAND;
     }
     instr->opcode1 = opc1;
     instr->opcode2 = opc2;
     instr->opcode3 = opc3;
 
-    /* Set the instruction and the size */
-    if ( NULL == mvector_push_back(xstmt->instrs, instr) ) {
-        free(instr);
-        return -EUNKNOWN;
-    }
-
     /* Success */
     return 1;
 }
@@ -3073,43 +1820,29 @@ _binstr2_rm(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
  * Build instruction for the M type Op/En
  */
 static int
-_binstr2_m(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, int preg,
-           ssize_t opsize, const x86_64_opr_t *oprm)
+_binstr2_m(const x86_64_stmt_t *xstmt, x86_64_instr_t *instr, int opc1,
+           int opc2, int opc3, int preg, ssize_t opsize,
+           const x86_64_opr_t *oprm)
 {
     int ret;
     x86_64_enop_t enop;
-    x86_64_instr_t *instr;
-
-    /* Allocaate for the instruction */
-    instr = malloc(sizeof(x86_64_instr_t));
-    if ( NULL == instr ) {
-        return -EUNKNOWN;
-    }
 
     /* Encode and free the values */
     ret = _encode_m(oprm, preg, &enop);
     if ( ret < 0 ) {
         /* Invalid operand size */
-        free(instr);
         return -ESIZE;
     }
     /* Encode instruction */
     ret = _encode_instr(instr, &enop, xstmt->tgt, xstmt->prefix, opsize, 0);
     if ( ret < 0 ) {
         /* Invalid operands */
-        free(instr);
         return -EOPERAND;
     }
     instr->opcode1 = opc1;
     instr->opcode2 = opc2;
     instr->opcode3 = opc3;
 
-    /* Set the instruction and the size */
-    if ( NULL == mvector_push_back(xstmt->instrs, instr) ) {
-        free(instr);
-        return -EUNKNOWN;
-    }
-
     /* Success */
     return 1;
 }
@@ -3118,32 +1851,23 @@ _binstr2_m(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, int preg,
  * Build instruction for the RMI type Op/En
  */
 static int
-_binstr2_rmi(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
-             const x86_64_opr_t *oprr, const x86_64_opr_t *oprm,
-             const x86_64_opr_t *opri, size_t immsz)
+_binstr2_rmi(const x86_64_stmt_t *xstmt, x86_64_instr_t *instr, int opc1,
+             int opc2, int opc3, ssize_t opsize, const x86_64_opr_t *oprr,
+             const x86_64_opr_t *oprm, const x86_64_opr_t *opri, size_t immsz)
 {
     int ret;
     x86_64_enop_t enop;
     ssize_t addrsize;
-    x86_64_instr_t *instr;
-
-    /* Allocaate for the instruction */
-    instr = malloc(sizeof(x86_64_instr_t));
-    if ( NULL == instr ) {
-        return -EUNKNOWN;
-    }
 
     /* Encode and free the values */
     ret = _encode_rmi(oprr, oprm, opri, immsz, &enop);
     if ( ret < 0 ) {
         /* Invalid operand size */
-        free(instr);
         return -ESIZE;
     }
     /* Obtain address size */
     addrsize = _resolve_address_size1(oprm);
     if ( addrsize < 0 ) {
-        free(instr);
         return -ESIZE;
     }
     /* Encode instruction */
@@ -3151,19 +1875,12 @@ _binstr2_rmi(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
                         addrsize);
     if ( ret < 0 ) {
         /* Invalid operands */
-        free(instr);
         return -EOPERAND;
     }
     instr->opcode1 = opc1;
     instr->opcode2 = opc2;
     instr->opcode3 = opc3;
 
-    /* Set the instruction and the size */
-    if ( NULL == mvector_push_back(xstmt->instrs, instr) ) {
-        free(instr);
-        return -EUNKNOWN;
-    }
-
     /* Success */
     return 1;
 }
@@ -3172,32 +1889,23 @@ _binstr2_rmi(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
  * Build instruction for the OI type Op/En
  */
 static int
-_binstr2_oi(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
-            const x86_64_opr_t *oprr, const x86_64_opr_t *opri,
-            size_t immsz)
+_binstr2_oi(const x86_64_stmt_t *xstmt, x86_64_instr_t *instr, int opc1,
+            int opc2, int opc3, ssize_t opsize, const x86_64_opr_t *oprr,
+            const x86_64_opr_t *opri, size_t immsz)
 {
     int ret;
     x86_64_enop_t enop;
-    x86_64_instr_t *instr;
-
-    /* Allocaate for the instruction */
-    instr = malloc(sizeof(x86_64_instr_t));
-    if ( NULL == instr ) {
-        return -EUNKNOWN;
-    }
 
     /* Encode and free the values */
     ret = _encode_oi(oprr, opri, immsz, &enop);
     if ( ret < 0 ) {
         /* Invalid operand size */
-        free(instr);
         return -ESIZE;
     }
     /* Encode instruction */
     ret = _encode_instr(instr, &enop, xstmt->tgt, xstmt->prefix, opsize, 0);
     if ( ret < 0 ) {
         /* Invalid operands */
-        free(instr);
         return -EOPERAND;
     }
     instr->opcode1 = opc1;
@@ -3213,847 +1921,546 @@ _binstr2_oi(x86_64_stmt_t *xstmt, int opc1, int opc2, int opc3, ssize_t opsize,
         instr->opcode1 += enop.opreg;
     }
 
-    /* Set the instruction and the size */
-    if ( NULL == mvector_push_back(xstmt->instrs, instr) ) {
-        free(instr);
-        return -EUNKNOWN;
+    /* Success */
+    return 1;
+}
+
+/*
+ * Operand classes required by the encodings
+ */
+typedef struct _x86_64_enc_req {
+    /* Number of operands (-1 if binstr2() does not support the encoding) */
+    int nopr;
+    /* Size of the immediate value or the relative address */
+    size_t sz;
+    /* Classes that each operand must belong to */
+    uint64_t cls[3];
+} x86_64_enc_req_t;
+
+static const x86_64_enc_req_t _enc_reqs[] = {
+    [ENC_NP] = { 0, 0, { 0, 0, 0 } },
+    [ENC_NP_3] = { 1, 0, { X86_64_OPRC_3, 0, 0 } },
+    [ENC_NP_FS] = { 1, 0, { X86_64_OPRC_FS, 0, 0 } },
+    [ENC_NP_GS] = { 1, 0, { X86_64_OPRC_GS, 0, 0 } },
+    [ENC_NP_AL_DX] = { 2, 0, { X86_64_OPRC_AL, X86_64_OPRC_DX, 0 } },
+    [ENC_NP_AX_DX] = { 2, 0, { X86_64_OPRC_AX, X86_64_OPRC_DX, 0 } },
+    [ENC_NP_EAX_DX] = { 2, 0, { X86_64_OPRC_EAX, X86_64_OPRC_DX, 0 } },
+    [ENC_NP_DX_AL] = { 2, 0, { X86_64_OPRC_DX, X86_64_OPRC_AL, 0 } },
+    [ENC_NP_DX_AX] = { 2, 0, { X86_64_OPRC_DX, X86_64_OPRC_AX, 0 } },
+    [ENC_NP_DX_EAX] = { 2, 0, { X86_64_OPRC_DX, X86_64_OPRC_EAX, 0 } },
+    [ENC_NP_PREG] = { 0, 0, { 0, 0, 0 } },
+    [ENC_I_IMM8] = { 1, SIZE8, { X86_64_OPRC_IMM8, 0, 0 } },
+    [ENC_I_IMM16] = { 1, SIZE16, { X86_64_OPRC_IMM16, 0, 0 } },
+    [ENC_I_IMM32] = { 1, SIZE32, { X86_64_OPRC_IMM32, 0, 0 } },
+    [ENC_I_FIMM16] = { -1, 0, { 0, 0, 0 } },
+    [ENC_I_EIMM16] = { -1, 0, { 0, 0, 0 } },
+    [ENC_I_AL_IMM8] = { 2, SIZE8, { X86_64_OPRC_AL, X86_64_OPRC_IMM8, 0 } },
+    [ENC_I_AX_IMM8] = { 2, SIZE8, { X86_64_OPRC_AX, X86_64_OPRC_IMM8, 0 } },
+    [ENC_I_AX_IMM16] = { 2, SIZE16, { X86_64_OPRC_AX, X86_64_OPRC_IMM16, 0 } },
+    [ENC_I_EAX_IMM8] = { 2, SIZE8, { X86_64_OPRC_EAX, X86_64_OPRC_IMM8, 0 } },
+    [ENC_I_EAX_IMM32] = { 2, SIZE32,
+        { X86_64_OPRC_EAX, X86_64_OPRC_IMM32, 0 } },
+    [ENC_I_RAX_IMM32] = { 2, SIZE32,
+        { X86_64_OPRC_RAX, X86_64_OPRC_IMM32, 0 } },
+    [ENC_I_IMM8_AL] = { 2, SIZE8, { X86_64_OPRC_IMM8, X86_64_OPRC_AL, 0 } },
+    [ENC_I_IMM8_AX] = { 2, SIZE8, { X86_64_OPRC_IMM8, X86_64_OPRC_AX, 0 } },
+    [ENC_I_IMM8_EAX] = { 2, SIZE8, { X86_64_OPRC_IMM8, X86_64_OPRC_EAX, 0 } },
+    [ENC_MI_RM8_IMM8] = { 2, SIZE8, { X86_64_OPRC_RM8, X86_64_OPRC_IMM8, 0 } },
+    [ENC_MI_RM16_IMM16] = { 2, SIZE16,
+        { X86_64_OPRC_RM16, X86_64_OPRC_IMM16, 0 } },
+    [ENC_MI_RM32_IMM32] = { 2, SIZE32,
+        { X86_64_OPRC_RM32, X86_64_OPRC_IMM32, 0 } },
+    [ENC_MI_RM64_IMM32] = { 2, SIZE32,
+        { X86_64_OPRC_RM64, X86_64_OPRC_IMM32, 0 } },
+    [ENC_MI_RM16_IMM8] = { 2, SIZE8,
+        { X86_64_OPRC_RM16, X86_64_OPRC_IMM8, 0 } },
+    [ENC_MI_RM32_IMM8] = { 2, SIZE8,
+        { X86_64_OPRC_RM32, X86_64_OPRC_IMM8, 0 } },
+    [ENC_MI_RM64_IMM8] = { 2, SIZE8,
+        { X86_64_OPRC_RM64, X86_64_OPRC_IMM8, 0 } },
+    [ENC_RMI_R16_RM16_IMM8] = { 3, SIZE8,
+        { X86_64_OPRC_R16, X86_64_OPRC_RMU16, X86_64_OPRC_FIX8 } },
+    [ENC_RMI_R16_RM16_IMM16] = { 3, SIZE16,
+        { X86_64_OPRC_R16, X86_64_OPRC_RMU16, X86_64_OPRC_FIX16 } },
+    [ENC_RMI_R32_RM32_IMM8] = { 3, SIZE8,
+        { X86_64_OPRC_R32, X86_64_OPRC_RMU32, X86_64_OPRC_FIX8 } },
+    [ENC_RMI_R32_RM32_IMM32] = { 3, SIZE32,
+        { X86_64_OPRC_R32, X86_64_OPRC_RMU32, X86_64_OPRC_FIX32 } },
+    [ENC_RMI_R64_RM64_IMM8] = { 3, SIZE8,
+        { X86_64_OPRC_R64, X86_64_OPRC_RMU64, X86_64_OPRC_FIX8 } },
+    [ENC_RMI_R64_RM64_IMM32] = { 3, SIZE32,
+        { X86_64_OPRC_R64, X86_64_OPRC_RMU64, X86_64_OPRC_FIX32 } },
+    [ENC_OI_R8_IMM8] = { 2, SIZE8, { X86_64_OPRC_R8, X86_64_OPRC_FIX8, 0 } },
+    [ENC_OI_R16_IMM16] = { 2, SIZE16,
+        { X86_64_OPRC_R16, X86_64_OPRC_FIX16, 0 } },
+    [ENC_OI_R32_IMM32] = { 2, SIZE32,
+        { X86_64_OPRC_R32, X86_64_OPRC_FIX32, 0 } },
+    [ENC_OI_R64_IMM64] = { 2, SIZE64,
+        { X86_64_OPRC_R64, X86_64_OPRC_FIX64, 0 } },
+    [ENC_MR_RM8_R8] = { 2, 0, { X86_64_OPRC_RMU8, X86_64_OPRC_R8, 0 } },
+    [ENC_MR_RM16_R16] = { 2, 0, { X86_64_OPRC_RMU16, X86_64_OPRC_R16, 0 } },
+    [ENC_MR_RM32_R32] = { 2, 0, { X86_64_OPRC_RMU32, X86_64_OPRC_R32, 0 } },
+    [ENC_MR_RM64_R64] = { 2, 0, { X86_64_OPRC_RMU64, X86_64_OPRC_R64, 0 } },
+    [ENC_RM_R8_RM8] = { 2, 0, { X86_64_OPRC_R8, X86_64_OPRC_RMU8, 0 } },
+    [ENC_RM_R16_RM16] = { 2, 0, { X86_64_OPRC_R16, X86_64_OPRC_RMU16, 0 } },
+    [ENC_RM_R32_RM8] = { 2, 0, { X86_64_OPRC_R32, X86_64_OPRC_RMU8, 0 } },
+    [ENC_RM_R32_RM16] = { 2, 0, { X86_64_OPRC_R32, X86_64_OPRC_RMU16, 0 } },
+    [ENC_RM_R32_RM32] = { 2, 0, { X86_64_OPRC_R32, X86_64_OPRC_RMU32, 0 } },
+    [ENC_RM_R64_RM8] = { 2, 0, { X86_64_OPRC_R64, X86_64_OPRC_RMU8, 0 } },
+    [ENC_RM_R64_RM64] = { 2, 0, { X86_64_OPRC_R64, X86_64_OPRC_RMU64, 0 } },
+    [ENC_O_R16] = { 1, 0, { X86_64_OPRC_R16, 0, 0 } },
+    [ENC_O_R32] = { 1, 0, { X86_64_OPRC_R32, 0, 0 } },
+    [ENC_O_R64] = { 1, 0, { X86_64_OPRC_R64, 0, 0 } },
+    [ENC_O_AX_R16] = { 2, 0, { X86_64_OPRC_AX, X86_64_OPRC_R16, 0 } },
+    [ENC_O_EAX_R32] = { 2, 0, { X86_64_OPRC_EAX, X86_64_OPRC_R32, 0 } },
+    [ENC_O_RAX_R64] = { 2, 0, { X86_64_OPRC_RAX, X86_64_OPRC_R64, 0 } },
+    [ENC_O_R16_AX] = { 2, 0, { X86_64_OPRC_R16, X86_64_OPRC_AX, 0 } },
+    [ENC_O_R32_EAX] = { 2, 0, { X86_64_OPRC_R32, X86_64_OPRC_EAX, 0 } },
+    [ENC_O_R64_RAX] = { 2, 0, { X86_64_OPRC_R64, X86_64_OPRC_RAX, 0 } },
+    [ENC_M_MUNSPEC] = { 1, 0, { X86_64_OPRC_M, 0, 0 } },
+    [ENC_M_M8] = { 1, 0, { X86_64_OPRC_M8, 0, 0 } },
+    [ENC_M_M16] = { 1, 0, { X86_64_OPRC_M16, 0, 0 } },
+    [ENC_M_M32] = { 1, 0, { X86_64_OPRC_M32, 0, 0 } },
+    [ENC_M_M64] = { 1, 0, { X86_64_OPRC_M64, 0, 0 } },
+    [ENC_M_R64] = { 1, 0, { X86_64_OPRC_R64, 0, 0 } },
+    [ENC_M_RM8] = { 1, 0, { X86_64_OPRC_RM8, 0, 0 } },
+    [ENC_M_RM16] = { 1, 0, { X86_64_OPRC_RM16, 0, 0 } },
+    [ENC_M_RM32] = { 1, 0, { X86_64_OPRC_RM32, 0, 0 } },
+    [ENC_M_RM64] = { 1, 0, { X86_64_OPRC_RM64, 0, 0 } },
+    [ENC_D_REL8] = { 1, SIZE8, { X86_64_OPRC_REL | X86_64_OPRC_IMM8, 0, 0 } },
+    [ENC_D_REL16] = { 1, SIZE16,
+        { X86_64_OPRC_REL | X86_64_OPRC_IMM16, 0, 0 } },
+    [ENC_D_REL32] = { 1, SIZE32,
+        { X86_64_OPRC_REL | X86_64_OPRC_IMM32, 0, 0 } },
+    [ENC_D_PTR16_16] = { -1, 0, { 0, 0, 0 } },
+    [ENC_D_PTR16_32] = { -1, 0, { 0, 0, 0 } },
+};
+
+/*
+ * Do the operands match the encoding?
+ */
+static __inline__ int
+_match_enc(const x86_64_opr_t *oprs, size_t nopr,
+           const x86_64_enc_req_t *req)
+{
+    size_t i;
+
+    if ( req->nopr != (int)nopr ) {
+        return 0;
+    }
+    for ( i = 0; i < nopr; i++ ) {
+        if ( (oprs[i].cls & req->cls[i]) != req->cls[i] ) {
+            return 0;
+        }
     }
 
-    /* Success */
     return 1;
 }
 
 /*
- * Build instruction and return a success/error code
+ * Get the number of operands of the encoding (-1 if binstr2() does not
+ * support it)
  */
 int
-binstr2(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt, ssize_t opsize,
-        int opc1, int opc2, int opc3, x86_64_enc_t enc, int preg)
+binstr2_nopr(x86_64_enc_t enc)
 {
-    int stat;
+    if ( (size_t)enc >= sizeof(_enc_reqs) / sizeof(_enc_reqs[0]) ) {
+        return -1;
+    }
 
-    assert( STMT_INSTR == xstmt->stmt->type );
+    return _enc_reqs[enc].nopr;
+}
+
+/*
+ * Build instruction into instr and return a success (1), unmatched (0) or
+ * error code
+ */
+static int
+_binstr2_build(const x86_64_stmt_t *xstmt, x86_64_instr_t *instr,
+               ssize_t opsize, int opc1, int opc2, int opc3,
+               x86_64_enc_t enc, int preg)
+{
+    const x86_64_enc_req_t *req;
+    const x86_64_opr_t *opr;
+
+    /* Check the number of operands and the format */
+    if ( (size_t)enc >= sizeof(_enc_reqs) / sizeof(_enc_reqs[0]) ) {
+        return 0;
+    }
+    req = &_enc_reqs[enc];
+    if ( !_match_enc(xstmt->oprs, xstmt->nopr, req) ) {
+        return 0;
+    }
+    opr = xstmt->oprs;
 
-    stat = 0;
+    /* Build the instruction */
     switch ( enc ) {
     case ENC_NP:
-        /* Check the number of operands and the format */
-        if ( 0 == mvector_size(xstmt->oprs) ) {
-            /* Build the instruction */
-            stat = _binstr2_np(xstmt, opc1, opc2, opc3, opsize);
-        }
-        break;
     case ENC_NP_3:
-        /* Check the number of operands and the format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_3(mvector_at(xstmt->oprs, 0)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_np(xstmt, opc1, opc2, opc3, opsize);
-        }
-        break;
     case ENC_NP_FS:
-        /* Check the number of operands and the format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_FS) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_np(xstmt, opc1, opc2, opc3, opsize);
-        }
-        break;
     case ENC_NP_GS:
-        /* Check the number of operands and the format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_GS) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_np(xstmt, opc1, opc2, opc3, opsize);
-        }
-        break;
     case ENC_NP_AL_DX:
-        /* Check the number of operands and the format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_AL)
-             && _eq_reg(mvector_at(xstmt->oprs, 1), REG_DX) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_np(xstmt, opc1, opc2, opc3, opsize);
-        }
-        break;
     case ENC_NP_DX_AL:
-        /* Check the number of operands and the format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_DX)
-             && _eq_reg(mvector_at(xstmt->oprs, 1), REG_AL) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_np(xstmt, opc1, opc2, opc3, opsize);
-        }
-        break;
     case ENC_NP_AX_DX:
-        /* Check the number of operands and the format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_AX)
-             && _eq_reg(mvector_at(xstmt->oprs, 1), REG_DX) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_np(xstmt, opc1, opc2, opc3, opsize);
-        }
-        break;
     case ENC_NP_DX_AX:
-        /* Check the number of operands and the format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_DX)
-             && _eq_reg(mvector_at(xstmt->oprs, 1), REG_AX) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_np(xstmt, opc1, opc2, opc3, opsize);
-        }
-        break;
     case ENC_NP_EAX_DX:
-        /* Check the number of operands and the format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_EAX)
-             && _eq_reg(mvector_at(xstmt->oprs, 1), REG_DX) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_np(xstmt, opc1, opc2, opc3, opsize);
-        }
-        break;
     case ENC_NP_DX_EAX:
-        /* Check the number of operands and the format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_DX)
-             && _eq_reg(mvector_at(xstmt->oprs, 1), REG_EAX) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_np(xstmt, opc1, opc2, opc3, opsize);
-        }
-        break;
+        return _binstr2_np(xstmt, instr, opc1, opc2, opc3, opsize);
     case ENC_NP_PREG:
-        /* Check the number of operands and the format */
-        if ( 0 == mvector_size(xstmt->oprs) ) {
-            /* Build the instruction */
-            stat = _binstr2_np_preg(xstmt, opc1, opc2, opc3, opsize, preg);
-        }
-        break;
+        return _binstr2_np_preg(xstmt, instr, opc1, opc2, opc3, opsize, preg);
 
     case ENC_I_IMM8:
-        /* Check the number of operands and the format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_imm(mvector_at(xstmt->oprs, 0), SIZE8) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_i(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 0), SIZE8);
-        }
-        break;
     case ENC_I_IMM16:
-        /* Check the number of operands and the format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_imm(mvector_at(xstmt->oprs, 0), SIZE16) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_i(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 0), SIZE16);
-        }
-        break;
     case ENC_I_IMM32:
-        /* Check the number of operands and the format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_imm(mvector_at(xstmt->oprs, 0), SIZE32) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_i(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 0), SIZE32);
-        }
-        break;
-    case ENC_I_AL_IMM8:
-        /* Check the number of operands and the format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_AL)
-             && _is_imm(mvector_at(xstmt->oprs, 1), SIZE8) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_i(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 1), SIZE8);
-        }
-        break;
-    case ENC_I_AX_IMM8:
-        /* Check the number of operands and the format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_AX)
-             && _is_imm(mvector_at(xstmt->oprs, 1), SIZE8) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_i(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 1), SIZE8);
-        }
-        break;
-    case ENC_I_AX_IMM16:
-        /* Check the number of operands and the format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_AX)
-             && _is_imm(mvector_at(xstmt->oprs, 1), SIZE16) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_i(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 1), SIZE16);
-        }
-        break;
-    case ENC_I_EAX_IMM8:
-        /* Check the number of operands and the format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_EAX)
-             && _is_imm(mvector_at(xstmt->oprs, 1), SIZE8) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_i(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 1), SIZE8);
-        }
-        break;
-    case ENC_I_EAX_IMM32:
-        /* Check the number of operands and the format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_EAX)
-             && _is_imm(mvector_at(xstmt->oprs, 1), SIZE32) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_i(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 1), SIZE32);
-        }
-        break;
-    case ENC_I_RAX_IMM32:
-        /* Check the number of operands and the format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_RAX)
-             && _is_imm(mvector_at(xstmt->oprs, 1), SIZE32) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_i(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 1), SIZE32);
-        }
-        break;
     case ENC_I_IMM8_AL:
-        /* Check the number of operands and the format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_imm(mvector_at(xstmt->oprs, 0), SIZE8)
-             && _eq_reg(mvector_at(xstmt->oprs, 1), REG_AL) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_i(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 0), SIZE8);
-        }
-        break;
     case ENC_I_IMM8_AX:
-        /* Check the number of operands and the format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_imm(mvector_at(xstmt->oprs, 0), SIZE8)
-             && _eq_reg(mvector_at(xstmt->oprs, 1), REG_AX) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_i(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 0), SIZE8);
-        }
-        break;
-    case ENC_I_IMM8_EAX:
-        /* Check the number of operands and the format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_imm(mvector_at(xstmt->oprs, 0), SIZE8)
-             && _eq_reg(mvector_at(xstmt->oprs, 1), REG_EAX) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_i(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 0), SIZE8);
-        }
-        break;
+    case ENC_I_IMM8_EAX:
+        return _binstr2_i(xstmt, instr, opc1, opc2, opc3, opsize, &opr[0],
+                          req->sz);
+    case ENC_I_AL_IMM8:
+    case ENC_I_AX_IMM8:
+    case ENC_I_AX_IMM16:
+    case ENC_I_EAX_IMM8:
+    case ENC_I_EAX_IMM32:
+    case ENC_I_RAX_IMM32:
+        return _binstr2_i(xstmt, instr, opc1, opc2, opc3, opsize, &opr[1],
+                          req->sz);
 
     case ENC_MI_RM8_IMM8:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_rm8(mvector_at(xstmt->oprs, 0))
-             && _is_imm(mvector_at(xstmt->oprs, 1), SIZE8) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_mi(xstmt, opc1, opc2, opc3, preg, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1), SIZE8);
-        }
-        break;
     case ENC_MI_RM16_IMM16:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_rm16(mvector_at(xstmt->oprs, 0))
-             && _is_imm(mvector_at(xstmt->oprs, 1), SIZE16) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_mi(xstmt, opc1, opc2, opc3, preg, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1), SIZE16);
-        }
-        break;
     case ENC_MI_RM32_IMM32:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_rm32(mvector_at(xstmt->oprs, 0))
-             && _is_imm(mvector_at(xstmt->oprs, 1), SIZE32) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_mi(xstmt, opc1, opc2, opc3, preg, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1), SIZE32);
-        }
-        break;
     case ENC_MI_RM64_IMM32:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_rm64(mvector_at(xstmt->oprs, 0))
-             && _is_imm(mvector_at(xstmt->oprs, 1), SIZE32) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_mi(xstmt, opc1, opc2, opc3, preg, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1), SIZE32);
-        }
-        break;
     case ENC_MI_RM16_IMM8:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_rm16(mvector_at(xstmt->oprs, 0))
-             && _is_imm(mvector_at(xstmt->oprs, 1), SIZE8) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_mi(xstmt, opc1, opc2, opc3, preg, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1), SIZE8);
-        }
-        break;
     case ENC_MI_RM32_IMM8:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_rm32(mvector_at(xstmt->oprs, 0))
-             && _is_imm(mvector_at(xstmt->oprs, 1), SIZE8) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_mi(xstmt, opc1, opc2, opc3, preg, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1), SIZE8);
-        }
-        break;
     case ENC_MI_RM64_IMM8:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_rm64(mvector_at(xstmt->oprs, 0))
-             && _is_imm(mvector_at(xstmt->oprs, 1), SIZE8) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_mi(xstmt, opc1, opc2, opc3, preg, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1), SIZE8);
-        }
-        break;
+        return _binstr2_mi(xstmt, instr, opc1, opc2, opc3, preg, opsize,
+                           &opr[0], &opr[1], req->sz);
 
     case ENC_MR_RM8_R8:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_rm8_r8(mvector_at(xstmt->oprs, 0),
-                           mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_mr(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1));
-        }
-        break;
     case ENC_MR_RM16_R16:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_rm16_r16(mvector_at(xstmt->oprs, 0),
-                             mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_mr(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1));
-        }
     case ENC_MR_RM32_R32:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_rm32_r32(mvector_at(xstmt->oprs, 0),
-                             mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_mr(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1));
-        }
-        break;
     case ENC_MR_RM64_R64:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_rm64_r64(mvector_at(xstmt->oprs, 0),
-                             mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_mr(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1));
-        }
-        break;
+        return _binstr2_mr(xstmt, instr, opc1, opc2, opc3, opsize, &opr[0],
+                           &opr[1]);
 
     case ENC_RM_R8_RM8:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_r8_rm8(mvector_at(xstmt->oprs, 0),
-                           mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_rm(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1));
-        }
-        break;
     case ENC_RM_R16_RM16:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_r16_rm16(mvector_at(xstmt->oprs, 0),
-                             mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_rm(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1));
-        }
-        break;
     case ENC_RM_R32_RM8:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_r32_rm8(mvector_at(xstmt->oprs, 0),
-                            mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_rm(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1));
-        }
-        break;
     case ENC_RM_R32_RM16:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_r32_rm16(mvector_at(xstmt->oprs, 0),
-                             mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_rm(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1));
-        }
-        break;
     case ENC_RM_R32_RM32:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_r32_rm32(mvector_at(xstmt->oprs, 0),
-                             mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_rm(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1));
-        }
-        break;
     case ENC_RM_R64_RM8:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_r64_rm8(mvector_at(xstmt->oprs, 0),
-                            mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_rm(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1));
-        }
-        break;
     case ENC_RM_R64_RM64:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_r64_rm64(mvector_at(xstmt->oprs, 0),
-                             mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_rm(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1));
-        }
-        break;
+        return _binstr2_rm(xstmt, instr, opc1, opc2, opc3, opsize, &opr[0],
+                           &opr[1]);
 
     case ENC_O_R16:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_r16(mvector_at(xstmt->oprs, 0)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_o(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0));
-        }
-        break;
     case ENC_O_R32:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_r32(mvector_at(xstmt->oprs, 0)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_o(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0));
-        }
-        break;
     case ENC_O_R64:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_r64(mvector_at(xstmt->oprs, 0)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_o(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0));
-        }
-        break;
-    case ENC_O_AX_R16:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_AX)
-             && _is_r16(mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_o(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 1));
-        }
-        break;
-    case ENC_O_EAX_R32:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_EAX)
-             && _is_r32(mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_o(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 1));
-        }
-        break;
-    case ENC_O_RAX_R64:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _eq_reg(mvector_at(xstmt->oprs, 0), REG_RAX)
-             && _is_r64(mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_o(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 1));
-        }
-        break;
     case ENC_O_R16_AX:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_r16(mvector_at(xstmt->oprs, 0))
-             && _eq_reg(mvector_at(xstmt->oprs, 1), REG_AX) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_o(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 0));
-        }
-        break;
     case ENC_O_R32_EAX:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_r32(mvector_at(xstmt->oprs, 0))
-             && _eq_reg(mvector_at(xstmt->oprs, 1), REG_EAX) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_o(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 0));
-        }
-        break;
     case ENC_O_R64_RAX:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_r64(mvector_at(xstmt->oprs, 0))
-             && _eq_reg(mvector_at(xstmt->oprs, 1), REG_RAX)) {
-
-            /* Build the instruction */
-            stat = _binstr2_o(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 0));
-        }
-        break;
+        return _binstr2_o(xstmt, instr, opc1, opc2, opc3, opsize, &opr[0]);
+    case ENC_O_AX_R16:
+    case ENC_O_EAX_R32:
+    case ENC_O_RAX_R64:
+        return _binstr2_o(xstmt, instr, opc1, opc2, opc3, opsize, &opr[1]);
 
     case ENC_M_MUNSPEC:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_m_unspec(mvector_at(xstmt->oprs, 0)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_m(xstmt, opc1, opc2, opc3, preg, opsize,
-                              mvector_at(xstmt->oprs, 0));
-        }
-        break;
     case ENC_M_M8:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_m8(mvector_at(xstmt->oprs, 0)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_m(xstmt, opc1, opc2, opc3, preg, opsize,
-                              mvector_at(xstmt->oprs, 0));
-        }
-        break;
     case ENC_M_M16:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_m16(mvector_at(xstmt->oprs, 0)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_m(xstmt, opc1, opc2, opc3, preg, opsize,
-                              mvector_at(xstmt->oprs, 0));
-        }
-        break;
     case ENC_M_M32:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_m32(mvector_at(xstmt->oprs, 0)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_m(xstmt, opc1, opc2, opc3, preg, opsize,
-                              mvector_at(xstmt->oprs, 0));
-        }
-        break;
     case ENC_M_M64:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_m64(mvector_at(xstmt->oprs, 0)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_m(xstmt, opc1, opc2, opc3, preg, opsize,
-                              mvector_at(xstmt->oprs, 0));
-        }
-        break;
     case ENC_M_R64:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_r64(mvector_at(xstmt->oprs, 0)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_m(xstmt, opc1, opc2, opc3, preg, opsize,
-                              mvector_at(xstmt->oprs, 0));
-        }
-        break;
     case ENC_M_RM8:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_rm8(mvector_at(xstmt->oprs, 0)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_m(xstmt, opc1, opc2, opc3, preg, opsize,
-                              mvector_at(xstmt->oprs, 0));
-        }
-        break;
     case ENC_M_RM16:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_rm16(mvector_at(xstmt->oprs, 0)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_m(xstmt, opc1, opc2, opc3, preg, opsize,
-                              mvector_at(xstmt->oprs, 0));
-        }
-        break;
     case ENC_M_RM32:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_rm32(mvector_at(xstmt->oprs, 0)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_m(xstmt, opc1, opc2, opc3, preg, opsize,
-                              mvector_at(xstmt->oprs, 0));
-        }
-        break;
     case ENC_M_RM64:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_rm64(mvector_at(xstmt->oprs, 0)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_m(xstmt, opc1, opc2, opc3, preg, opsize,
-                              mvector_at(xstmt->oprs, 0));
-        }
-        break;
+        return _binstr2_m(xstmt, instr, opc1, opc2, opc3, preg, opsize,
+                          &opr[0]);
 
     case ENC_RMI_R16_RM16_IMM8:
-        /* Check the number of operands and format */
-        if ( 3 == mvector_size(xstmt->oprs)
-             && _is_r16_rm16_imm8(mvector_at(xstmt->oprs, 0),
-                                  mvector_at(xstmt->oprs, 1),
-                                  mvector_at(xstmt->oprs, 2)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_rmi(xstmt, opc1, opc2, opc3, opsize,
-                                mvector_at(xstmt->oprs, 0),
-                                mvector_at(xstmt->oprs, 1),
-                                mvector_at(xstmt->oprs, 2), SIZE8);
-        }
-        break;
     case ENC_RMI_R16_RM16_IMM16:
-        /* Check the number of operands and format */
-        if ( 3 == mvector_size(xstmt->oprs)
-             && _is_r16_rm16_imm16(mvector_at(xstmt->oprs, 0),
-                                   mvector_at(xstmt->oprs, 1),
-                                   mvector_at(xstmt->oprs, 2)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_rmi(xstmt, opc1, opc2, opc3, opsize,
-                                mvector_at(xstmt->oprs, 0),
-                                mvector_at(xstmt->oprs, 1),
-                                mvector_at(xstmt->oprs, 2), SIZE16);
-        }
-        break;
     case ENC_RMI_R32_RM32_IMM8:
-        /* Check the number of operands and format */
-        if ( 3 == mvector_size(xstmt->oprs)
-             && _is_r32_rm32_imm8(mvector_at(xstmt->oprs, 0),
-                                  mvector_at(xstmt->oprs, 1),
-                                  mvector_at(xstmt->oprs, 2)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_rmi(xstmt, opc1, opc2, opc3, opsize,
-                                mvector_at(xstmt->oprs, 0),
-                                mvector_at(xstmt->oprs, 1),
-                                mvector_at(xstmt->oprs, 2), SIZE8);
-        }
-        break;
     case ENC_RMI_R32_RM32_IMM32:
-        /* Check the number of operands and format */
-        if ( 3 == mvector_size(xstmt->oprs)
-             && _is_r32_rm32_imm32(mvector_at(xstmt->oprs, 0),
-                                   mvector_at(xstmt->oprs, 1),
-                                   mvector_at(xstmt->oprs, 2)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_rmi(xstmt, opc1, opc2, opc3, opsize,
-                                mvector_at(xstmt->oprs, 0),
-                                mvector_at(xstmt->oprs, 1),
-                                mvector_at(xstmt->oprs, 2), SIZE32);
-        }
-        break;
     case ENC_RMI_R64_RM64_IMM8:
-        /* Check the number of operands and format */
-        if ( 3 == mvector_size(xstmt->oprs)
-             && _is_r64_rm64_imm8(mvector_at(xstmt->oprs, 0),
-                                  mvector_at(xstmt->oprs, 1),
-                                  mvector_at(xstmt->oprs, 2)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_rmi(xstmt, opc1, opc2, opc3, opsize,
-                                mvector_at(xstmt->oprs, 0),
-                                mvector_at(xstmt->oprs, 1),
-                                mvector_at(xstmt->oprs, 2), SIZE8);
-        }
-        break;
     case ENC_RMI_R64_RM64_IMM32:
-        /* Check the number of operands and format */
-        if ( 3 == mvector_size(xstmt->oprs)
-             && _is_r64_rm64_imm32(mvector_at(xstmt->oprs, 0),
-                                   mvector_at(xstmt->oprs, 1),
-                                   mvector_at(xstmt->oprs, 2)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_rmi(xstmt, opc1, opc2, opc3, opsize,
-                                mvector_at(xstmt->oprs, 0),
-                                mvector_at(xstmt->oprs, 1),
-                                mvector_at(xstmt->oprs, 2), SIZE32);
-        }
-        break;
+        return _binstr2_rmi(xstmt, instr, opc1, opc2, opc3, opsize, &opr[0],
+                            &opr[1], &opr[2], req->sz);
 
     case ENC_OI_R8_IMM8:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_r8_imm8(mvector_at(xstmt->oprs, 0),
-                            mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_oi(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1), SIZE8);
-        }
-        break;
     case ENC_OI_R16_IMM16:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_r16_imm16(mvector_at(xstmt->oprs, 0),
-                              mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_oi(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1), SIZE16);
-        }
-        break;
     case ENC_OI_R32_IMM32:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_r32_imm32(mvector_at(xstmt->oprs, 0),
-                              mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_oi(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1), SIZE32);
-        }
-        break;
     case ENC_OI_R64_IMM64:
-        /* Check the number of operands and format */
-        if ( 2 == mvector_size(xstmt->oprs)
-             && _is_r64_imm64(mvector_at(xstmt->oprs, 0),
-                              mvector_at(xstmt->oprs, 1)) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_oi(xstmt, opc1, opc2, opc3, opsize,
-                               mvector_at(xstmt->oprs, 0),
-                               mvector_at(xstmt->oprs, 1), SIZE64);
-        }
-        break;
+        return _binstr2_oi(xstmt, instr, opc1, opc2, opc3, opsize, &opr[0],
+                           &opr[1], req->sz);
 
     case ENC_D_REL8:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_imm(mvector_at(xstmt->oprs, 0), SIZE8) ) {
-
-            /* Build the instruction */
-            stat = _binstr2_d(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 0), SIZE8);
-        }
-        break;
     case ENC_D_REL16:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_imm(mvector_at(xstmt->oprs, 0), SIZE16) ) {
+    case ENC_D_REL32:
+        return _binstr2_d(xstmt, instr, opc1, opc2, opc3, opsize, &opr[0],
+                          req->sz);
+
+    default:
+        return 0;
+    }
+}
 
-            /* Build the instruction */
-            stat = _binstr2_d(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 0), SIZE16);
+/*
+ * Build instruction and record it as a candidate of the statement; return a
+ * success/error code
+ */
+int
+binstr2(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt, ssize_t opsize,
+        int opc1, int opc2, int opc3, x86_64_enc_t enc, int preg)
+{
+    int ret;
+    x86_64_instr_t instr;
+    x86_64_cand_t cand;
+
+    assert( STMT_INSTR == xstmt->stmt->type );
+
+    /* Build the instruction only to size it */
+    ret = _binstr2_build(xstmt, &instr, opsize, opc1, opc2, opc3, enc, preg);
+    if ( ret <= 0 ) {
+        return ret;
+    }
+
+    /* Record the arguments to materialize it later */
+    cand.opc1 = opc1;
+    cand.opc2 = opc2;
+    cand.opc3 = opc3;
+    cand.opsize = opsize;
+    cand.preg = preg;
+    cand.enc = enc;
+    cand.sz = x86_64_instr_size(&instr);
+    cand.fit = x86_64_check_size(instr.disp.sz, instr.disp.val)
+        && x86_64_check_size(instr.imm.sz, instr.imm.val)
+        && x86_64_check_size(instr.rel.sz, instr.rel.val);
+    cand.disp.sz = instr.disp.sz;
+    cand.disp.expr = instr.disp.expr;
+    cand.imm.sz = instr.imm.sz;
+    cand.imm.expr = instr.imm.expr;
+    cand.rel.sz = instr.rel.sz;
+    cand.rel.expr = instr.rel.expr;
+    if ( NULL == x86_64_cand_vector_push_back(xstmt->cands, cand) ) {
+        return -EUNKNOWN;
+    }
+
+    /* Success */
+    return 1;
+}
+
+/*
+ * Build the instruction of the candidate
+ */
+int
+binstr2_materialize(const x86_64_stmt_t *xstmt, const x86_64_cand_t *cand,
+                    x86_64_instr_t *instr)
+{
+    int ret;
+
+    ret = _binstr2_build(xstmt, instr, cand->opsize, cand->opc1, cand->opc2,
+                         cand->opc3, (x86_64_enc_t)cand->enc, cand->preg);
+    if ( 1 != ret ) {
+        /* Must be built as it was when sized */
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Build the final instruction of the register-register or register-immediate
+ * form in 64-bit mode without prefixes directly from the operands classified
+ * by x86_64_convert_operand_simple(); return a success (1), unmatched or
+ * invalid operands (0, which binstr2() skips too), or -1 if the encoding is
+ * not supported by this fast path or binstr2() returns an error for it
+ */
+int
+binstr2_fast(const x86_64_opr_t *oprs, size_t nopr, ssize_t opsize, int opc1,
+             int opc2, int opc3, x86_64_enc_t enc, int preg,
+             x86_64_instr_t *instr)
+{
+    const x86_64_enc_req_t *req;
+    const x86_64_opr_t *oprr;
+    const x86_64_opr_t *oprm;
+    const x86_64_opr_t *opri;
+    int reg;
+    int rm;
+    int rexr;
+    int rexb;
+    int rex;
+
+    /* Check the number of operands and the format */
+    if ( (size_t)enc >= sizeof(_enc_reqs) / sizeof(_enc_reqs[0]) ) {
+        return 0;
+    }
+    req = &_enc_reqs[enc];
+    if ( !_match_enc(oprs, nopr, req) ) {
+        return 0;
+    }
+
+    /* Register in the reg field (or the opcode), the r/m field, and the
+       immediate value */
+    oprr = NULL;
+    oprm = NULL;
+    opri = NULL;
+    switch ( enc ) {
+    case ENC_MR_RM8_R8:
+    case ENC_MR_RM16_R16:
+    case ENC_MR_RM32_R32:
+    case ENC_MR_RM64_R64:
+        oprm = &oprs[0];
+        oprr = &oprs[1];
+        break;
+    case ENC_RM_R8_RM8:
+    case ENC_RM_R16_RM16:
+    case ENC_RM_R32_RM8:
+    case ENC_RM_R32_RM16:
+    case ENC_RM_R32_RM32:
+    case ENC_RM_R64_RM8:
+    case ENC_RM_R64_RM64:
+        oprr = &oprs[0];
+        oprm = &oprs[1];
+        break;
+    case ENC_MI_RM8_IMM8:
+    case ENC_MI_RM16_IMM16:
+    case ENC_MI_RM32_IMM32:
+    case ENC_MI_RM64_IMM32:
+    case ENC_MI_RM16_IMM8:
+    case ENC_MI_RM32_IMM8:
+    case ENC_MI_RM64_IMM8:
+        if ( preg < 0 ) {
+            return -1;
         }
+        oprm = &oprs[0];
+        opri = &oprs[1];
         break;
-    case ENC_D_REL32:
-        /* Check the number of operands and format */
-        if ( 1 == mvector_size(xstmt->oprs)
-             && _is_imm(mvector_at(xstmt->oprs, 0), SIZE32) ) {
+    case ENC_OI_R8_IMM8:
+    case ENC_OI_R16_IMM16:
+    case ENC_OI_R32_IMM32:
+    case ENC_OI_R64_IMM64:
+        oprr = &oprs[0];
+        opri = &oprs[1];
+        break;
+    case ENC_O_R16:
+    case ENC_O_R32:
+    case ENC_O_R64:
+    case ENC_O_R16_AX:
+    case ENC_O_R32_EAX:
+    case ENC_O_R64_RAX:
+        oprr = &oprs[0];
+        break;
+    case ENC_O_AX_R16:
+    case ENC_O_EAX_R32:
+    case ENC_O_RAX_R64:
+        oprr = &oprs[1];
+        break;
+    case ENC_I_IMM8:
+    case ENC_I_IMM16:
+    case ENC_I_IMM32:
+    case ENC_I_IMM8_AL:
+    case ENC_I_IMM8_AX:
+    case ENC_I_IMM8_EAX:
+        opri = &oprs[0];
+        break;
+    case ENC_I_AL_IMM8:
+    case ENC_I_AX_IMM8:
+    case ENC_I_AX_IMM16:
+    case ENC_I_EAX_IMM8:
+    case ENC_I_EAX_IMM32:
+    case ENC_I_RAX_IMM32:
+        opri = &oprs[1];
+        break;
+    default:
+        /* Not supported */
+        return -1;
+    }
 
-            /* Build the instruction */
-            stat = _binstr2_d(xstmt, opc1, opc2, opc3, opsize,
-                              mvector_at(xstmt->oprs, 0), SIZE32);
+    /* Resolve the register codes */
+    reg = preg;
+    rexr = REX_NONE;
+    rm = -1;
+    rexb = REX_NONE;
+    if ( NULL != oprr ) {
+        if ( X86_64_OPR_REG != oprr->type
+             || _reg_code(oprr->u.reg, &reg, &rexr) < 0 ) {
+            return 0;
         }
-        break;
+    }
+    if ( NULL != oprm ) {
+        if ( X86_64_OPR_REG != oprm->type
+             || _reg_code(oprm->u.reg, &rm, &rexb) < 0 ) {
+            return 0;
+        }
+    } else if ( NULL != oprr ) {
+        /* The register is encoded in the opcode */
+        rm = reg;
+        rexb = rexr;
+        rexr = REX_NONE;
+    }
+    if ( NULL != opri ) {
+        if ( X86_64_OPR_IMM != opri->type
+             || X86_64_IMM_FIXED != opri->u.imm.type ) {
+            return 0;
+        }
+    }
 
-    default:
-        stat = 0;
+    /* REX prefix */
+    rex = _rex(SIZE64 == opsize ? REX_TRUE : REX_NONE, rexr, REX_NONE, rexb);
+    if ( rex < 0 ) {
+        return -1;
+    }
+
+    instr->prefix1 = -1;
+    instr->prefix2 = -1;
+    instr->prefix3 = SIZE16 == opsize ? 0x66 : -1;
+    instr->prefix4 = -1;
+    instr->rex = 0 == rex ? -1 : rex;
+    instr->opcode1 = opc1;
+    instr->opcode2 = opc2;
+    instr->opcode3 = opc3;
+    if ( NULL != oprm ) {
+        instr->modrm = _encode_modrm(reg, 3, rm);
+    } else {
+        instr->modrm = -1;
+        if ( NULL != oprr ) {
+            /* +rb/+rw/+rd/+ro */
+            if ( opc3 >= 0 ) {
+                instr->opcode3 += rm;
+            } else if ( opc2 >= 0 ) {
+                instr->opcode2 += rm;
+            } else {
+                instr->opcode1 += rm;
+            }
+        }
     }
+    instr->sib = -1;
+    instr->disp.sz = 0;
+    instr->disp.val = 0;
+    instr->disp.eval = NULL;
+    instr->disp.expr = NULL;
+    if ( NULL != opri ) {
+        instr->imm.sz = req->sz;
+        instr->imm.val = opri->u.imm.u.fixed;
+    } else {
+        instr->imm.sz = 0;
+        instr->imm.val = 0;
+    }
+    instr->imm.eval = NULL;
+    instr->imm.expr = NULL;
+    instr->rel.sz = 0;
+    instr->rel.val = 0;
+    instr->rel.expr = NULL;
+    instr->ptr0.sz = 0;
+    instr->ptr0.val = 0;
+    instr->ptr0.expr = NULL;
+    instr->ptr1.sz = 0;
+    instr->ptr1.val = 0;
+    instr->ptr1.expr = NULL;
 
-    return stat;
+    /* Success */
+    return 1;
 }
 
 /*
@@ -124,6 +124,15 @@ extern "C" {
     int
     binstr2(x86_64_assembler_t *, x86_64_stmt_t *, ssize_t, int, int, int,
             x86_64_enc_t, int);
+    int binstr2_materialize(const x86_64_stmt_t *, const x86_64_cand_t *,
+                            x86_64_instr_t *);
+    int binstr2_nopr(x86_64_enc_t);
+    int binstr2_fast(const x86_64_opr_t *, size_t, ssize_t, int, int, int,
+                     x86_64_enc_t, int, x86_64_instr_t *);
+    size_t x86_64_instr_size(const x86_64_instr_t *);
+    void x86_64_pinstr_patch(x86_64_pinstr_t *, size_t, size_t, int64_t);
+    int x86_64_instr_pack(const x86_64_instr_t *, x86_64_pinstr_t *);
+    int x86_64_check_size(size_t, int64_t);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,278 @@
+/*_
+ * Copyright 2013 Scyphus Solutions Co. Ltd.  All rights reserved.
+ *
+ * Authors:
+ *      Hirochika Asai  <asai@scyphus.co.jp>
+ */
+
+#include "../../las.h"
+#include "ecache.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ECACHE_INIT_SLOTS       64
+#define ECACHE_INIT_SIZE        32
+
+/*
+ * Hash function of a key (FNV-1a over the words)
+ */
+static __inline__ uint64_t
+_ecache_hash(const uint64_t *w, size_t n)
+{
+    uint64_t h;
+    size_t i;
+
+    h = 14695981039346656037ULL;
+    for ( i = 0; i < n; i++ ) {
+        h ^= w[i];
+        h *= 1099511628211ULL;
+        h ^= h >> 32;
+    }
+
+    return h;
+}
+
+/*
+ * Double the hash index
+ */
+static int
+_ecache_rehash(x86_64_ecache_t *ec)
+{
+    uint32_t *nslots;
+    size_t n;
+    size_t i;
+    size_t j;
+
+    n = ec->nslots ? ec->nslots * 2 : ECACHE_INIT_SLOTS;
+    nslots = calloc(n, sizeof(uint32_t));
+    if ( NULL == nslots ) {
+        return -1;
+    }
+    for ( i = 0; i < ec->size; i++ ) {
+        j = ec->entries[i].key.hash & (n - 1);
+        while ( 0 != nslots[j] ) {
+            j = (j + 1) & (n - 1);
+        }
+        nslots[j] = i + 1;
+    }
+    free(ec->slots);
+    ec->slots = nslots;
+    ec->nslots = n;
+
+    return 0;
+}
+
+/*
+ * Initialize the encoding cache of at most max_size entries (0 to disable);
+ * the entries are allocated as they are added
+ */
+int
+x86_64_ecache_init(x86_64_ecache_t *ec, size_t max_size)
+{
+    ec->entries = NULL;
+    ec->size = 0;
+    ec->alloc_size = 0;
+    ec->max_size = 0;
+    ec->slots = NULL;
+    ec->nslots = 0;
+    ec->adds = 0;
+    ec->lookups = 0;
+    ec->hits = 0;
+
+    if ( 0 == max_size ) {
+        /* Disabled */
+        return 0;
+    }
+    if ( max_size > UINT32_MAX / 2 ) {
+        /* The slots cannot index all the entries */
+        return -1;
+    }
+    ec->max_size = max_size;
+
+    return 0;
+}
+
+/*
+ * Clear the encoding cache
+ * Note that this does not free the cache structure
+ */
+void
+x86_64_ecache_clear(x86_64_ecache_t *ec)
+{
+    free(ec->entries);
+    free(ec->slots);
+    (void)x86_64_ecache_init(ec, 0);
+}
+
+/*
+ * Build the key of the statement from its mnemonic, *fixes, target and
+ * operands; return -1 if the statement is not cacheable, i.e., an operand
+ * refers to an expression or is a pointer
+ */
+int
+x86_64_ecache_key(const x86_64_stmt_t *xstmt, x86_64_ecache_key_t *key)
+{
+    size_t i;
+    size_t n;
+    const x86_64_opr_t *opr;
+    const x86_64_addr_t *addr;
+    uint64_t w0;
+    uint64_t w1;
+    uint64_t w2;
+
+    if ( xstmt->nopr > INSTR_MAX_OPERANDS ) {
+        return -1;
+    }
+
+    n = 0;
+    key->w[n++] = (uint32_t)xstmt->mnemonic | ((uint64_t)xstmt->tgt << 32);
+    key->w[n++] = (uint32_t)xstmt->prefix
+        | ((uint64_t)(uint32_t)xstmt->suffix << 32);
+    key->w[n++] = xstmt->nopr;
+    for ( i = 0; i < xstmt->nopr; i++ ) {
+        opr = &xstmt->oprs[i];
+        w0 = opr->type | ((uint64_t)opr->sopsize << 8);
+        w1 = 0;
+        w2 = 0;
+        switch ( opr->type ) {
+        case X86_64_OPR_REG:
+            w1 = opr->u.reg;
+            break;
+        case X86_64_OPR_IMM:
+            if ( X86_64_IMM_FIXED != opr->u.imm.type ) {
+                return -1;
+            }
+            w2 = opr->u.imm.u.fixed;
+            break;
+        case X86_64_OPR_ADDR:
+            addr = &opr->u.addr;
+            w0 |= ((uint64_t)(addr->flags & 0xff) << 16)
+                | ((uint64_t)addr->saddrsize << 24);
+            if ( X86_64_ADDR_BASE & addr->flags ) {
+                w1 |= (uint32_t)addr->base;
+            }
+            if ( X86_64_ADDR_OFFSET & addr->flags ) {
+                w1 |= (uint64_t)(uint32_t)addr->offset << 32;
+            }
+            if ( X86_64_ADDR_SCALE & addr->flags ) {
+                w0 |= (uint64_t)(uint32_t)addr->scale << 32;
+            }
+            if ( X86_64_ADDR_DISP & addr->flags ) {
+                if ( X86_64_IMM_FIXED != addr->disp.type ) {
+                    return -1;
+                }
+                w2 = addr->disp.u.fixed;
+            }
+            break;
+        default:
+            return -1;
+        }
+        key->w[n++] = w0;
+        key->w[n++] = w1;
+        key->w[n++] = w2;
+    }
+    key->n = n;
+    key->hash = _ecache_hash(key->w, n);
+
+    return 0;
+}
+
+/*
+ * Search the encoding of the key and set it to the statement as the selected
+ * instruction; return 1 if found
+ */
+int
+x86_64_ecache_lookup(x86_64_ecache_t *ec, const x86_64_ecache_key_t *key,
+                     x86_64_stmt_t *xstmt)
+{
+    size_t i;
+    uint32_t n;
+    const x86_64_ecache_entry_t *e;
+
+    if ( 0 == ec->max_size ) {
+        return 0;
+    }
+    ec->lookups++;
+    if ( 0 == ec->nslots ) {
+        /* Empty */
+        return 0;
+    }
+
+    i = key->hash & (ec->nslots - 1);
+    while ( 0 != (n = ec->slots[i]) ) {
+        e = &ec->entries[n - 1];
+        if ( e->key.hash == key->hash && e->key.n == key->n
+             && 0 == memcmp(e->key.w, key->w, sizeof(uint64_t) * key->n) ) {
+            /* Found */
+            ec->hits++;
+            xstmt->sinstr = e->sinstr;
+            xstmt->state = X86_64_STMT_FIXED;
+            xstmt->esize.min = e->sinstr.pinstr.len;
+            xstmt->esize.max = e->sinstr.pinstr.len;
+            return 1;
+        }
+        i = (i + 1) & (ec->nslots - 1);
+    }
+
+    return 0;
+}
+
+/*
+ * Add the selected instruction of the statement to the encoding cache unless
+ * the cache is full; return 1 if added, or -1 if the cache cannot grow
+ */
+int
+x86_64_ecache_add(x86_64_ecache_t *ec, const x86_64_ecache_key_t *key,
+                  const x86_64_stmt_t *xstmt)
+{
+    size_t i;
+    size_t nsize;
+    x86_64_ecache_entry_t *nentries;
+    x86_64_ecache_entry_t *e;
+
+    if ( ec->size >= ec->max_size || X86_64_STMT_FIXED != xstmt->state ) {
+        return 0;
+    }
+
+    /* Keep the load factor of the hash index at most 1/2 */
+    if ( (ec->size + 1) * 2 > ec->nslots ) {
+        if ( 0 != _ecache_rehash(ec) ) {
+            return -1;
+        }
+    }
+    if ( ec->size == ec->alloc_size ) {
+        nsize = ec->alloc_size ? ec->alloc_size * 2 : ECACHE_INIT_SIZE;
+        if ( nsize > ec->max_size ) {
+            nsize = ec->max_size;
+        }
+        nentries = realloc(ec->entries, sizeof(x86_64_ecache_entry_t) * nsize);
+        if ( NULL == nentries ) {
+            return -1;
+        }
+        ec->entries = nentries;
+        ec->alloc_size = nsize;
+    }
+
+    e = &ec->entries[ec->size];
+    e->key = *key;
+    e->sinstr = xstmt->sinstr;
+
+    i = key->hash & (ec->nslots - 1);
+    while ( 0 != ec->slots[i] ) {
+        i = (i + 1) & (ec->nslots - 1);
+    }
+    ec->slots[i] = ++ec->size;
+    ec->adds++;
+
+    return 1;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,39 @@
+/*_
+ * Copyright 2013 Scyphus Solutions Co. Ltd.  All rights reserved.
+ *
+ * Authors:
+ *      Hirochika Asai  <asai@scyphus.co.jp>
+ */
+
+#ifndef _ARCH_X86_64_ECACHE_H
+#define _ARCH_X86_64_ECACHE_H
+
+#include "../../las.h"
+#include "main.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    int x86_64_ecache_init(x86_64_ecache_t *, size_t);
+    void x86_64_ecache_clear(x86_64_ecache_t *);
+    int x86_64_ecache_key(const x86_64_stmt_t *, x86_64_ecache_key_t *);
+    int x86_64_ecache_lookup(x86_64_ecache_t *, const x86_64_ecache_key_t *,
+                             x86_64_stmt_t *);
+    int x86_64_ecache_add(x86_64_ecache_t *, const x86_64_ecache_key_t *,
+                          const x86_64_stmt_t *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ARCH_X86_64_ECACHE_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -7,289 +7,168 @@
 
 #include "eval.h"
 #include "reg.h"
+#include "label.h"
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
 
+#define EVAL_STACK_SIZE 16
+
 /*
- * Prototype declarations
+ * Range of a (sub)expression
  */
-static x86_64_rval_t *
-_expr_fix_var(const x86_64_label_table_t *, const expr_t *);
-static x86_64_rval_t *
-_expr_fix_int(const x86_64_label_table_t *, const expr_t *);
-static x86_64_rval_t *
-_expr_fix_op(const x86_64_label_table_t *, const expr_t *);
-static x86_64_rval_t * _expr_fix(const x86_64_label_table_t *, const expr_t *);
-
-
-static int
-_expr_range_var(const x86_64_label_table_t *, const expr_t *, int64_t *,
-                int64_t *);
-static int
-_expr_range_int(const x86_64_label_table_t *, const expr_t *, int64_t *,
-                int64_t *);
-static int
-_expr_range_op(const x86_64_label_table_t *, const expr_t *, int64_t *,
-               int64_t *);
-static int
-_expr_range(const x86_64_label_table_t *, const expr_t *, int64_t *, int64_t *);
-
-
-
+typedef struct _x86_64_range {
+    /* -1: error, 0: unresolved, 1: resolved */
+    int ret;
+    int64_t min;
+    int64_t max;
+} x86_64_range_t;
 
 /*
- * Search a label from the table
+ * Evaluate var expression
  */
-static x86_64_label_t *
-_search_label(const x86_64_label_table_t *tbl, const char *var)
+static int
+_expr_fix_var(const x86_64_label_table_t *ltbl, const expr_t *expr,
+              x86_64_rval_t *rval)
 {
-    x86_64_label_ent_t *ent;
-
-    ent = tbl->root;
-    while ( NULL != ent ) {
-        if ( 0 == strcmp(ent->c->label, var) ) {
-            /* Set the scope as global */
-            return ent->c;
-        }
-        ent = ent->next;
-    }
-
-    return NULL;
-}
-
-
+    x86_64_reg_t reg;
+    x86_64_label_t *lb;
 
+    rval->nsym = 1;
+    rval->addend = 0;
+    rval->symname = NULL;
 
+    /* Check whether it is a register */
+    reg = x86_64_sym_reg(expr->u.var);
+    if ( REG_UNKNOWN != reg ) {
+        /* Must not be a register */
+        return -1;
+    }
 
+    /* Search the corresponding label */
+    lb = x86_64_label_search(ltbl, expr->u.var);
+    if ( NULL == lb ) {
+        /* Not found: to be linked */
+        rval->symname = intern_str(expr->u.var);
+    } else {
+        /* Found */
+        /* FIXME: Replace "min" with the fixed position  */
+        rval->addend = lb->min;
+    }
 
+    return 0;
+}
 
 /*
- * Evaluate var expression
+ * Evaluate symbol-plus-addend expression
  */
-static x86_64_rval_t *
-_expr_fix_var(const x86_64_label_table_t *ltbl, const expr_t *expr)
+static int
+_expr_fix_symadd(const x86_64_label_table_t *ltbl, const expr_t *expr,
+                 x86_64_rval_t *rval)
 {
-    x86_64_rval_t *rval;
     x86_64_reg_t reg;
     x86_64_label_t *lb;
 
-    /* Allocate a relocatable value */
-    rval = malloc(sizeof(x86_64_rval_t));
-    if ( NULL == rval ) {
-        return NULL;
-    }
     rval->nsym = 1;
-    rval->addend = 0;
+    rval->addend = expr->u.symadd.addend;
     rval->symname = NULL;
 
     /* Check whether it is a register */
-    reg = strtoreg(expr->u.var);
+    reg = x86_64_sym_reg(expr->u.symadd.var);
     if ( REG_UNKNOWN != reg ) {
         /* Must not be a register */
-        free(rval);
-        return NULL;
+        return -1;
     }
 
     /* Search the corresponding label */
-    lb = _search_label(ltbl, expr->u.var);
+    lb = x86_64_label_search(ltbl, expr->u.symadd.var);
     if ( NULL == lb ) {
         /* Not found: to be linked */
-        rval->symname = strdup(expr->u.var);
-        if ( NULL == rval->symname ) {
-            free(rval);
-            return NULL;
-        }
-
-        return rval;
+        rval->symname = intern_str(expr->u.symadd.var);
     } else {
         /* Found */
-        /* FIXME: Replace "min" with the fixed position  */
-        rval->addend = lb->min;
-
-        return rval;
+        rval->addend += lb->min;
     }
+
+    return 0;
 }
 
 /*
  * Evaluate int expression
  */
-static x86_64_rval_t *
-_expr_fix_int(const x86_64_label_table_t *ltbl, const expr_t *expr)
+static int
+_expr_fix_int(const expr_t *expr, x86_64_rval_t *rval)
 {
-    x86_64_rval_t *rval;
-
-    /* Allocate a relocatable value */
-    rval = malloc(sizeof(x86_64_rval_t));
-    if ( NULL == rval ) {
-        return NULL;
-    }
     rval->nsym = 0;
     rval->addend = expr->u.i;
     rval->symname = NULL;
 
-    return rval;
+    return 0;
 }
 
 /*
- * Evaluate op expression
+ * Evaluate prefix op expression
  */
-static x86_64_rval_t *
-_expr_fix_op(const x86_64_label_table_t *ltbl, const expr_t *expr)
+static int
+_expr_fix_prefix(const expr_t *expr, const x86_64_rval_t *lrval,
+                 x86_64_rval_t *rval)
 {
-    x86_64_rval_t *rval;
-    x86_64_rval_t *lrval;
-    x86_64_rval_t *rrval;
-    expr_t *expr0;
-    expr_t *expr1;
-
-    rval = NULL;
-    if ( FIX_PREFIX == expr->u.op.fix_type ) {
-        expr0 = vector_at(expr->u.op.args, 0);
-        lrval = _expr_fix(ltbl, expr0);
-        if ( NULL == lrval ) {
-            return NULL;
-        }
-        switch ( expr->u.op.type ) {
-        case OP_PLUS:
-            /* Do nothing */
-            rval = lrval;
-            break;
-        case OP_MINUS:
-            /* Minus */
-            if ( NULL == lrval->symname ) {
-                /* Jist copy it */
-                rval = lrval;
-            } else {
-                /* Invalid operation */
-                free(lrval->symname);
-                free(lrval);
-                return NULL;
-            }
-            break;
-        default:
-            return NULL;
-        }
-    } else if ( FIX_INFIX == expr->u.op.fix_type ) {
-        expr0 = vector_at(expr->u.op.args, 0);
-        expr1 = vector_at(expr->u.op.args, 1);
-
-        lrval = _expr_fix(ltbl, expr0);
-        if ( NULL == lrval ) {
-            return NULL;
-        }
-        rrval = _expr_fix(ltbl, expr1);
-        if ( NULL == rrval ) {
-            if ( NULL != rrval->symname ) {
-                free(rrval->symname);
-            }
-            free(rrval);
-            return NULL;
-        }
-        switch ( expr->u.op.type ) {
-        case OP_PLUS:
-            if ( lrval->symname && rrval->symname ) {
-                /* Cannot have two symbols */
-                rval = NULL;
-            } else if ( lrval->symname ) {
-                rval = malloc(sizeof(x86_64_rval_t));
-                if ( NULL != rval ) {
-                    rval->symname = strdup(lrval->symname);
-                    if ( NULL == rval->symname ) {
-                        free(rval);
-                        rval = NULL;
-                    } else {
-                        rval->nsym = lrval->nsym + rrval->nsym;
-                        rval->addend = lrval->addend + rrval->addend;
-                    }
-                }
-            } else if ( rrval->symname ) {
-                rval = malloc(sizeof(x86_64_rval_t));
-                if ( NULL != rval ) {
-                    rval->symname = strdup(rrval->symname);
-                    if ( NULL == rval->symname ) {
-                        free(rval);
-                        rval = NULL;
-                    } else {
-                        rval->nsym = lrval->nsym + rrval->nsym;
-                        rval->addend = lrval->addend + rrval->addend;
-                    }
-                }
-            } else {
-                rval = malloc(sizeof(x86_64_rval_t));
-                if ( NULL != rval ) {
-                    rval->symname = NULL;
-                    rval->nsym = lrval->nsym + rrval->nsym;
-                    rval->addend = lrval->addend + rrval->addend;
-                }
-            }
-            break;
-        case OP_MINUS:
-            if ( rrval->symname ) {
-                /* Cannot have a minus symbol value */
-                rval = NULL;
-            } else if ( lrval->symname ) {
-                rval = malloc(sizeof(x86_64_rval_t));
-                if ( NULL != rval ) {
-                    rval->symname = strdup(lrval->symname);
-                    if ( NULL == rval->symname ) {
-                        free(rval);
-                        rval = NULL;
-                    } else {
-                        rval->nsym = lrval->nsym - rrval->nsym;
-                        rval->addend = lrval->addend - rrval->addend;
-                    }
-                }
-            } else {
-                rval = malloc(sizeof(x86_64_rval_t));
-                if ( NULL != rval ) {
-                    rval->symname = NULL;
-                    rval->nsym = lrval->nsym - rrval->nsym;
-                    rval->addend = lrval->addend - rrval->addend;
-                }
-            }
-            break;
-        default:
-            rval = NULL;
-        }
-
-        /* Free */
+    switch ( expr->u.op.type ) {
+    case OP_PLUS:
+        /* Do nothing */
+        *rval = *lrval;
+        break;
+    case OP_MINUS:
+        /* Minus */
         if ( NULL == lrval->symname ) {
-            free(lrval->symname);
-        }
-        free(lrval);
-        if ( NULL == rrval->symname ) {
-            free(rrval->symname);
+            /* Jist copy it */
+            *rval = *lrval;
+        } else {
+            /* Invalid operation */
+            return -1;
         }
-        free(rrval);
+        break;
+    default:
+        return -1;
     }
 
-    return rval;
+    return 0;
 }
 
 /*
- * Evaluate the expression (static function)
+ * Evaluate infix op expression
  */
-static x86_64_rval_t *
-_expr_fix(const x86_64_label_table_t *ltbl, const expr_t *expr)
+static int
+_expr_fix_infix(const expr_t *expr, const x86_64_rval_t *lrval,
+                const x86_64_rval_t *rrval, x86_64_rval_t *rval)
 {
-    x86_64_rval_t *rval;
-
-    switch ( expr->type ) {
-    case EXPR_VAR:
-        rval = _expr_fix_var(ltbl, expr);
-        break;
-    case EXPR_INT:
-        rval = _expr_fix_int(ltbl, expr);
+    switch ( expr->u.op.type ) {
+    case OP_PLUS:
+        if ( lrval->symname && rrval->symname ) {
+            /* Cannot have two symbols */
+            return -1;
+        } else if ( lrval->symname ) {
+            rval->symname = lrval->symname;
+        } else {
+            rval->symname = rrval->symname;
+        }
+        rval->nsym = lrval->nsym + rrval->nsym;
+        rval->addend = lrval->addend + rrval->addend;
         break;
-    case EXPR_OP:
-        rval = _expr_fix_op(ltbl, expr);
+    case OP_MINUS:
+        if ( rrval->symname ) {
+            /* Cannot have a minus symbol value */
+            return -1;
+        }
+        rval->symname = lrval->symname;
+        rval->nsym = lrval->nsym - rrval->nsym;
+        rval->addend = lrval->addend - rrval->addend;
         break;
     default:
-        rval = NULL;
+        return -1;
     }
 
-    return rval;
+    return 0;
 }
 
 /*
@@ -298,185 +177,306 @@ _expr_fix(const x86_64_label_table_t *ltbl, const expr_t *expr)
 x86_64_rval_t *
 x86_64_expr_fix(const x86_64_label_table_t *ltbl, const expr_t *expr)
 {
-    return _expr_fix(ltbl, expr);
-}
+    x86_64_rval_t lstk[EVAL_STACK_SIZE];
+    x86_64_rval_t *stk;
+    x86_64_rval_t *rval;
+    const expr_t *e;
+    size_t sp;
+    int ret;
 
+    /* Allocate a relocatable value */
+    rval = malloc(sizeof(x86_64_rval_t));
+    if ( NULL == rval ) {
+        return NULL;
+    }
+    /* The depth of the stack does not exceed the number of the nodes */
+    if ( expr->size <= EVAL_STACK_SIZE ) {
+        stk = lstk;
+    } else {
+        stk = malloc(sizeof(x86_64_rval_t) * expr->size);
+        if ( NULL == stk ) {
+            free(rval);
+            return NULL;
+        }
+    }
+
+    /* Evaluate the nodes in post-order */
+    sp = 0;
+    ret = 0;
+    for ( e = EXPR_FIRST(expr); e <= expr && 0 == ret; e++ ) {
+        switch ( e->type ) {
+        case EXPR_VAR:
+            ret = _expr_fix_var(ltbl, e, &stk[sp++]);
+            break;
+        case EXPR_INT:
+            ret = _expr_fix_int(e, &stk[sp++]);
+            break;
+        case EXPR_SYMADD:
+            ret = _expr_fix_symadd(ltbl, e, &stk[sp++]);
+            break;
+        case EXPR_OP:
+            if ( FIX_PREFIX == e->u.op.fix_type ) {
+                ret = _expr_fix_prefix(e, &stk[sp - 1], &stk[sp - 1]);
+            } else if ( FIX_INFIX == e->u.op.fix_type ) {
+                ret = _expr_fix_infix(e, &stk[sp - 2], &stk[sp - 1],
+                                      &stk[sp - 2]);
+                sp--;
+            } else {
+                ret = -1;
+            }
+            break;
+        default:
+            ret = -1;
+        }
+    }
+    if ( 0 == ret && 1 == sp ) {
+        *rval = stk[0];
+    } else {
+        free(rval);
+        rval = NULL;
+    }
+    if ( stk != lstk ) {
+        free(stk);
+    }
 
+    return rval;
+}
 
 /*
  * Evaluate var expression
  */
-static int
+static void
 _expr_range_var(const x86_64_label_table_t *ltbl, const expr_t *expr,
-                int64_t *min, int64_t *max)
+                x86_64_range_t *r)
 {
     x86_64_reg_t reg;
     x86_64_label_t *lb;
 
     /* Check whether it is a register */
-    reg = strtoreg(expr->u.var);
+    reg = x86_64_sym_reg(expr->u.var);
     if ( REG_UNKNOWN != reg ) {
         /* Must not be a register */
-        return -1;
+        r->ret = -1;
+        return;
     }
 
     /* Search the corresponding label */
-    lb = _search_label(ltbl, expr->u.var);
+    lb = x86_64_label_search(ltbl, expr->u.var);
     if ( NULL == lb ) {
         /* Not found: to be linked */
-        *min = X86_64_VAR_MIN;
-        *max = X86_64_VAR_MAX;
-
-        return 0;
+        r->min = X86_64_VAR_MIN;
+        r->max = X86_64_VAR_MAX;
+        r->ret = 0;
     } else {
         /* Found */
-        *min = lb->min;
-        *max = lb->max;
+        r->min = lb->min;
+        r->max = lb->max;
+        r->ret = 1;
+    }
+}
 
-        return 1;
+/*
+ * Evaluate symbol-plus-addend expression; an unresolved symbol takes the
+ * whole range as a var expression does
+ */
+static void
+_expr_range_symadd(const x86_64_label_table_t *ltbl, const expr_t *expr,
+                   x86_64_range_t *r)
+{
+    x86_64_reg_t reg;
+    x86_64_label_t *lb;
+
+    /* Check whether it is a register */
+    reg = x86_64_sym_reg(expr->u.symadd.var);
+    if ( REG_UNKNOWN != reg ) {
+        /* Must not be a register */
+        r->ret = -1;
+        return;
+    }
+
+    /* Search the corresponding label */
+    lb = x86_64_label_search(ltbl, expr->u.symadd.var);
+    if ( NULL == lb ) {
+        /* Not found: to be linked */
+        r->min = X86_64_VAR_MIN;
+        r->max = X86_64_VAR_MAX;
+        r->ret = 0;
+    } else {
+        /* Found */
+        r->min = lb->min + expr->u.symadd.addend;
+        r->max = lb->max + expr->u.symadd.addend;
+        r->ret = 1;
     }
 }
 
 /*
- * Evaluate var expression
+ * Evaluate int expression
  */
-static int
-_expr_range_int(const x86_64_label_table_t *ltbl, const expr_t *expr,
-                int64_t *min, int64_t *max)
+static void
+_expr_range_int(const expr_t *expr, x86_64_range_t *r)
 {
     /* Found */
-    *min = expr->u.i;
-    *max = expr->u.i;
-
-    return 1;
+    r->min = expr->u.i;
+    r->max = expr->u.i;
+    r->ret = 1;
 }
 
 /*
- * Evaluate op expression
+ * Evaluate prefix op expression; an unresolved operand is just copied
  */
-static int
-_expr_range_op(const x86_64_label_table_t *ltbl, const expr_t *expr,
-                int64_t *min, int64_t *max)
+static void
+_expr_range_prefix(const expr_t *expr, x86_64_range_t *r)
 {
-    int ret;
     int64_t lmin;
-    int64_t lmax;
-    int64_t rmin;
-    int64_t rmax;
-    expr_t *expr0;
-    expr_t *expr1;
-
-    if ( FIX_PREFIX == expr->u.op.fix_type ) {
-        expr0 = vector_at(expr->u.op.args, 0);
-        ret = _expr_range(ltbl, expr0, &lmin, &lmax);
-        if ( ret < 0 ) {
-            return -1;
-        } else if ( 0 == ret ) {
-            /* Just copy */
-            *min = lmin;
-            *max = lmax;
-            return 0;
-        }
-        switch ( expr->u.op.type ) {
-        case OP_PLUS:
-            /* Do nothing */
-            *min = lmin;
-            *max = lmax;
-            break;
-        case OP_MINUS:
-            /* Minus */
-            *min = -lmax;
-            *max = -lmin;
-            break;
-        default:
-            return -1;
-        }
-    } else if ( FIX_INFIX == expr->u.op.fix_type ) {
-        expr0 = vector_at(expr->u.op.args, 0);
-        expr1 = vector_at(expr->u.op.args, 1);
 
-        ret = _expr_range(ltbl, expr0, &lmin, &lmax);
-        if ( ret < 0 ) {
-            return -1;
-        } else if ( 0 == ret ) {
-            /* Just copy */
-            *min = lmin;
-            *max = lmax;
-            return 0;
-        }
-        ret = _expr_range(ltbl, expr1, &rmin, &rmax);
-        if ( ret < 0 ) {
-            return -1;
-        } else if ( 0 == ret ) {
-            /* Just copy */
-            *min = lmin;
-            *max = lmax;
-            return 0;
-        }
-        switch ( expr->u.op.type ) {
-        case OP_PLUS:
-            *min = lmin + rmin;
-            *max = lmax + rmax;
-            break;
-        case OP_MINUS:
-            *min = lmin - rmax;
-            *max = lmax - rmin;
-            break;
-        default:
-            return -1;
-        }
-    } else {
-        return -1;
+    if ( r->ret <= 0 ) {
+        /* Error or unresolved */
+        return;
+    }
+    switch ( expr->u.op.type ) {
+    case OP_PLUS:
+        /* Do nothing */
+        break;
+    case OP_MINUS:
+        /* Minus */
+        lmin = r->min;
+        r->min = -r->max;
+        r->max = -lmin;
+        break;
+    default:
+        r->ret = -1;
     }
-
-    return 1;
 }
 
 /*
- * Evaluate the expression (static function)
+ * Evaluate infix op expression; the left operand is taken if either operand
+ * is unresolved
  */
-static int
-_expr_range(const x86_64_label_table_t *ltbl, const expr_t *expr, int64_t *min,
-            int64_t *max)
+static void
+_expr_range_infix(const expr_t *expr, x86_64_range_t *l,
+                  const x86_64_range_t *r)
 {
-    int ret;
-
-    switch ( expr->type ) {
-    case EXPR_VAR:
-        ret = _expr_range_var(ltbl, expr, min, max);
-        break;
-    case EXPR_INT:
-        ret = _expr_range_int(ltbl, expr, min, max);
+    if ( l->ret <= 0 ) {
+        /* Error or unresolved */
+        return;
+    }
+    if ( r->ret <= 0 ) {
+        /* Error or unresolved */
+        l->ret = r->ret;
+        return;
+    }
+    switch ( expr->u.op.type ) {
+    case OP_PLUS:
+        l->min = l->min + r->min;
+        l->max = l->max + r->max;
         break;
-    case EXPR_OP:
-        ret = _expr_range_op(ltbl, expr, min, max);
+    case OP_MINUS:
+        l->min = l->min - r->max;
+        l->max = l->max - r->min;
         break;
     default:
-        ret = -1;
+        l->ret = -1;
     }
-
-    return ret;
 }
 
 /*
- * Evaluate the expression
+ * Evaluate the range of the expression
  */
 int
 x86_64_expr_range(const x86_64_label_table_t *ltbl, const expr_t *expr,
                   int64_t *min, int64_t *max)
 {
-    return _expr_range(ltbl, expr, min, max);
-}
-
-
-
+    x86_64_range_t lstk[EVAL_STACK_SIZE];
+    x86_64_range_t *stk;
+    const expr_t *e;
+    size_t sp;
+    int ret;
 
+    /* The depth of the stack does not exceed the number of the nodes */
+    if ( expr->size <= EVAL_STACK_SIZE ) {
+        stk = lstk;
+    } else {
+        stk = malloc(sizeof(x86_64_range_t) * expr->size);
+        if ( NULL == stk ) {
+            return -1;
+        }
+    }
 
+    /* Evaluate the nodes in post-order */
+    sp = 0;
+    for ( e = EXPR_FIRST(expr); e <= expr; e++ ) {
+        switch ( e->type ) {
+        case EXPR_VAR:
+            _expr_range_var(ltbl, e, &stk[sp++]);
+            break;
+        case EXPR_INT:
+            _expr_range_int(e, &stk[sp++]);
+            break;
+        case EXPR_SYMADD:
+            _expr_range_symadd(ltbl, e, &stk[sp++]);
+            break;
+        case EXPR_OP:
+            if ( FIX_PREFIX == e->u.op.fix_type ) {
+                _expr_range_prefix(e, &stk[sp - 1]);
+            } else if ( FIX_INFIX == e->u.op.fix_type ) {
+                _expr_range_infix(e, &stk[sp - 2], &stk[sp - 1]);
+                sp--;
+            } else {
+                stk[sp - 1].ret = -1;
+            }
+            break;
+        default:
+            stk[sp++].ret = -1;
+        }
+    }
 
+    ret = stk[0].ret;
+    if ( ret >= 0 ) {
+        *min = stk[0].min;
+        *max = stk[0].max;
+    }
+    if ( stk != lstk ) {
+        free(stk);
+    }
 
+    return ret;
+}
 
+/*
+ * Collect the indices in the label table of the labels that the expression
+ * refers to; return the number of the references, the first max of which are
+ * stored to idx
+ */
+size_t
+x86_64_expr_labels(const x86_64_label_table_t *ltbl, const expr_t *expr,
+                   size_t *idx, size_t max)
+{
+    const expr_t *e;
+    x86_64_label_t *lb;
+    size_t n;
 
+    n = 0;
+    for ( e = EXPR_FIRST(expr); e <= expr; e++ ) {
+        switch ( e->type ) {
+        case EXPR_VAR:
+            lb = x86_64_label_search(ltbl, e->u.var);
+            break;
+        case EXPR_SYMADD:
+            lb = x86_64_label_search(ltbl, e->u.symadd.var);
+            break;
+        default:
+            lb = NULL;
+        }
+        if ( NULL != lb ) {
+            if ( n < max ) {
+                idx[n] = lb - ltbl->labels;
+            }
+            n++;
+        }
+    }
 
+    return n;
+}
 
 /*
  * Local variables:
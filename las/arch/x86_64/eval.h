@@ -26,6 +26,9 @@ extern "C" {
     int
     x86_64_expr_range(const x86_64_label_table_t *, const expr_t *, int64_t *,
                       int64_t *);
+    size_t
+    x86_64_expr_labels(const x86_64_label_table_t *, const expr_t *, size_t *,
+                       size_t);
 
 
 #ifdef __cplusplus
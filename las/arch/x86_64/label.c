@@ -0,0 +1,165 @@
+/*_
+ * Copyright 2013 Scyphus Solutions Co. Ltd.  All rights reserved.
+ *
+ * Authors:
+ *      Hirochika Asai  <asai@scyphus.co.jp>
+ */
+
+#include "../../las.h"
+#include "label.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+#define LABEL_INIT_SLOTS        64
+#define LABEL_INIT_SIZE         32
+
+/*
+ * Hash function of a symbol ID (Fibonacci hashing)
+ */
+static __inline__ size_t
+_label_hash(sym_id_t id, size_t nslots)
+{
+    return ((uint32_t)id * 2654435769U) & (nslots - 1);
+}
+
+/*
+ * Place the label of the index into the slot array
+ */
+static void
+_label_place(uint32_t *slots, size_t nslots, const x86_64_label_t *labels,
+             uint32_t idx)
+{
+    size_t i;
+
+    i = _label_hash(labels[idx].label, nslots);
+    while ( 0 != slots[i] ) {
+        i = (i + 1) & (nslots - 1);
+    }
+    slots[i] = idx + 1;
+}
+
+/*
+ * Double the hash index
+ */
+static int
+_label_rehash(x86_64_label_table_t *tbl)
+{
+    uint32_t *nslots;
+    size_t n;
+    size_t i;
+
+    n = tbl->nslots ? tbl->nslots * 2 : LABEL_INIT_SLOTS;
+    nslots = calloc(n, sizeof(uint32_t));
+    if ( NULL == nslots ) {
+        return -1;
+    }
+    for ( i = 0; i < tbl->size; i++ ) {
+        _label_place(nslots, n, tbl->labels, i);
+    }
+    free(tbl->slots);
+    tbl->slots = nslots;
+    tbl->nslots = n;
+
+    return 0;
+}
+
+/*
+ * Initialize the label table
+ */
+void
+x86_64_label_table_init(x86_64_label_table_t *tbl)
+{
+    tbl->labels = NULL;
+    tbl->size = 0;
+    tbl->max_size = 0;
+    tbl->slots = NULL;
+    tbl->nslots = 0;
+}
+
+/*
+ * Clear the label table
+ * Note that this does not free the label table structure
+ */
+void
+x86_64_label_table_clear(x86_64_label_table_t *tbl)
+{
+    free(tbl->labels);
+    free(tbl->slots);
+    x86_64_label_table_init(tbl);
+}
+
+/*
+ * Add a label to the table; labels are kept in the order of insertion
+ */
+int
+x86_64_label_add(x86_64_label_table_t *tbl, sym_id_t lsym, off_t imin,
+                 off_t imax)
+{
+    x86_64_label_t *nlabels;
+    x86_64_label_t *lb;
+    size_t nsize;
+
+    if ( NULL != x86_64_label_search(tbl, lsym) ) {
+        /* Duplicated */
+        return -EDUP;
+    }
+
+    /* Keep the load factor of the hash index at most 1/2 */
+    if ( (tbl->size + 1) * 2 > tbl->nslots ) {
+        if ( 0 != _label_rehash(tbl) ) {
+            return -EGENERIC;
+        }
+    }
+    if ( tbl->size == tbl->max_size ) {
+        nsize = tbl->max_size ? tbl->max_size * 2 : LABEL_INIT_SIZE;
+        nlabels = realloc(tbl->labels, sizeof(x86_64_label_t) * nsize);
+        if ( NULL == nlabels ) {
+            return -EGENERIC;
+        }
+        tbl->labels = nlabels;
+        tbl->max_size = nsize;
+    }
+
+    lb = &tbl->labels[tbl->size];
+    lb->label = lsym;
+    /* Set the expected positions of this instruction */
+    lb->min = imin;
+    lb->max = imax;
+    lb->scope = 0;
+    _label_place(tbl->slots, tbl->nslots, tbl->labels, tbl->size);
+    tbl->size++;
+
+    return 0;
+}
+
+/*
+ * Search a label from the table
+ */
+x86_64_label_t *
+x86_64_label_search(const x86_64_label_table_t *tbl, sym_id_t lsym)
+{
+    size_t i;
+    uint32_t n;
+
+    if ( 0 == tbl->nslots ) {
+        return NULL;
+    }
+    i = _label_hash(lsym, tbl->nslots);
+    while ( 0 != (n = tbl->slots[i]) ) {
+        if ( tbl->labels[n - 1].label == lsym ) {
+            return &tbl->labels[n - 1];
+        }
+        i = (i + 1) & (tbl->nslots - 1);
+    }
+
+    return NULL;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
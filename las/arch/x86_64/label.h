@@ -0,0 +1,37 @@
+/*_
+ * Copyright 2013 Scyphus Solutions Co. Ltd.  All rights reserved.
+ *
+ * Authors:
+ *      Hirochika Asai  <asai@scyphus.co.jp>
+ */
+
+#ifndef _ARCH_X86_64_LABEL_H
+#define _ARCH_X86_64_LABEL_H
+
+#include "../../las.h"
+#include "main.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    void x86_64_label_table_init(x86_64_label_table_t *);
+    void x86_64_label_table_clear(x86_64_label_table_t *);
+    int x86_64_label_add(x86_64_label_table_t *, sym_id_t, off_t, off_t);
+    x86_64_label_t *
+    x86_64_label_search(const x86_64_label_table_t *, sym_id_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ARCH_X86_64_LABEL_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -10,13 +10,20 @@
 #include "../../las.h"
 #include "../../token.h"
 #include "../../parser.h"
+#include "../../instr.h"
 #include "binstr.h"
 #include "reg.h"
 #include "eval.h"
+#include "label.h"
+#include "ecache.h"
+#include "relax.h"
 #include "main.h"
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <assert.h>
+#include <pthread.h>
 
 #define INSTR_OFFSET_DISP       1
 #define INSTR_OFFSET_IMM        2
@@ -34,53 +41,8 @@
 
 
 /*
- * Obtain the size of the instruction
+ * Obtain the offset of the field in the selected instruction
  */
-static size_t
-_instr_size(const x86_64_instr_t *instr)
-{
-    size_t sz;
-
-    sz = 0;
-    if ( instr->prefix1 >= 0 ) {
-        sz++;
-    }
-    if ( instr->prefix2 >= 0 ) {
-        sz++;
-    }
-    if ( instr->prefix3 >= 0 ) {
-        sz++;
-    }
-    if ( instr->prefix4 >= 0 ) {
-        sz++;
-    }
-    if ( instr->rex >= 0 ) {
-        sz++;
-    }
-    if ( instr->opcode1 >= 0 ) {
-        sz++;
-    }
-    if ( instr->opcode2 >= 0 ) {
-        sz++;
-    }
-    if ( instr->opcode3 >= 0 ) {
-        sz++;
-    }
-    if ( instr->modrm >= 0 ) {
-        sz++;
-    }
-    if ( instr->sib >= 0 ) {
-        sz++;
-    }
-    sz += instr->disp.sz;
-    sz += instr->imm.sz;
-    sz += instr->rel.sz;
-    sz += instr->ptr0.sz;
-    sz += instr->ptr1.sz;
-
-    return sz;
-}
-
 static off_t
 _instr_offset(const x86_64_stmt_t *xstmt, int type)
 {
@@ -89,48 +51,24 @@ _instr_offset(const x86_64_stmt_t *xstmt, int type)
     /* FIXME: Replace with the fixed position */
     off = xstmt->epos.min;
 
-    if ( xstmt->sinstr->prefix1 >= 0 ) {
-        off++;
-    }
-    if ( xstmt->sinstr->prefix2 >= 0 ) {
-        off++;
-    }
-    if ( xstmt->sinstr->prefix3 >= 0 ) {
-        off++;
-    }
-    if ( xstmt->sinstr->prefix4 >= 0 ) {
-        off++;
-    }
-    if ( xstmt->sinstr->rex >= 0 ) {
-        off++;
-    }
-    if ( xstmt->sinstr->opcode1 >= 0 ) {
-        off++;
-    }
-    if ( xstmt->sinstr->opcode2 >= 0 ) {
-        off++;
-    }
-    if ( xstmt->sinstr->opcode3 >= 0 ) {
-        off++;
-    }
-    if ( xstmt->sinstr->modrm >= 0 ) {
-        off++;
-    }
-    if ( xstmt->sinstr->sib >= 0 ) {
-        off++;
-    }
     switch ( type ) {
     case INSTR_OFFSET_EOI:
-        off += xstmt->sinstr->ptr1.sz;
+        off += xstmt->sinstr.pinstr.len;
+        break;
     case INSTR_OFFSET_PTR1:
-        off += xstmt->sinstr->ptr0.sz;
+        off += xstmt->sinstr.pinstr.ptr1;
+        break;
     case INSTR_OFFSET_PTR0:
-        off += xstmt->sinstr->rel.sz;
+        off += xstmt->sinstr.pinstr.ptr0;
+        break;
     case INSTR_OFFSET_REL:
-        off += xstmt->sinstr->imm.sz;
+        off += xstmt->sinstr.pinstr.rel;
+        break;
     case INSTR_OFFSET_IMM:
-        off += xstmt->sinstr->disp.sz;
+        off += xstmt->sinstr.pinstr.imm;
+        break;
     case INSTR_OFFSET_DISP:
+        off += xstmt->sinstr.pinstr.disp;
         break;
     default:
         ;
@@ -138,240 +76,80 @@ _instr_offset(const x86_64_stmt_t *xstmt, int type)
     return off;
 }
 
-
 /*
- * Print assembled code
+ * Set the instruction as the selected one of the statement
  */
-int
-_print_instruction(const x86_64_instr_t *instr)
-{
-    int i;
-    int64_t val;
-
-    if ( instr->prefix1 >= 0 ) {
-        printf("%.2X", instr->prefix1);
-    }
-    if ( instr->prefix2 >= 0 ) {
-        printf("%.2X", instr->prefix2);
-    }
-    if ( instr->prefix3 >= 0 ) {
-        printf("%.2X", instr->prefix3);
-    }
-    if ( instr->prefix4 >= 0 ) {
-        printf("%.2X", instr->prefix4);
-    }
-    if ( instr->rex >= 0 ) {
-        printf("%.2X", instr->rex);
-    }
-    if ( instr->opcode1 >= 0 ) {
-        printf("%.2X", instr->opcode1);
-    }
-    if ( instr->opcode2 >= 0 ) {
-        printf("%.2X", instr->opcode2);
-    }
-    if ( instr->opcode3 >= 0 ) {
-        printf("%.2X", instr->opcode3);
-    }
-    if ( instr->modrm >= 0 ) {
-        printf("%.2X", instr->modrm);
-    }
-    if ( instr->sib >= 0 ) {
-        printf("%.2X", instr->sib);
-    }
-    /* Little endian */
-    val = instr->disp.val;
-    for ( i = 0; i < instr->disp.sz; i++ ) {
-        printf("%.2llX", val & 0xff);
-        val >>= 8;
-    }
-    val = instr->imm.val;
-    for ( i = 0; i < instr->imm.sz; i++ ) {
-        printf("%.2llX", val & 0xff);
-        val >>= 8;
-    }
-    val = instr->rel.val;
-    for ( i = 0; i < instr->rel.sz; i++ ) {
-        printf("%.2llX", val & 0xff);
-        val >>= 8;
-    }
-    val = instr->ptr0.val;
-    for ( i = 0; i < instr->ptr0.sz; i++ ) {
-        printf("%.2llX", val & 0xff);
-        val >>= 8;
-    }
-    val = instr->ptr1.val;
-    for ( i = 0; i < instr->ptr1.sz; i++ ) {
-        printf("%.2llX", val & 0xff);
-        val >>= 8;
-    }
-
-    return 0;
-}
-int
-_print_instruction_bin(const x86_64_instr_t *instr)
+static int
+_set_sinstr(x86_64_stmt_t *xstmt, const x86_64_instr_t *instr)
 {
-    int i;
-    int64_t val;
-
-    if ( instr->prefix1 >= 0 ) {
-        printf("%c", instr->prefix1);
-    }
-    if ( instr->prefix2 >= 0 ) {
-        printf("%c", instr->prefix2);
-    }
-    if ( instr->prefix3 >= 0 ) {
-        printf("%c", instr->prefix3);
-    }
-    if ( instr->prefix4 >= 0 ) {
-        printf("%c", instr->prefix4);
-    }
-    if ( instr->rex >= 0 ) {
-        printf("%c", instr->rex);
-    }
-    if ( instr->opcode1 >= 0 ) {
-        printf("%c", instr->opcode1);
-    }
-    if ( instr->opcode2 >= 0 ) {
-        printf("%c", instr->opcode2);
-    }
-    if ( instr->opcode3 >= 0 ) {
-        printf("%c", instr->opcode3);
-    }
-    if ( instr->modrm >= 0 ) {
-        printf("%c", instr->modrm);
-    }
-    if ( instr->sib >= 0 ) {
-        printf("%c", instr->sib);
-    }
-    /* Little endian */
-    val = instr->disp.val;
-    for ( i = 0; i < instr->disp.sz; i++ ) {
-        printf("%c", (unsigned char)val & 0xff);
-        val >>= 8;
-    }
-    val = instr->imm.val;
-    for ( i = 0; i < instr->imm.sz; i++ ) {
-        printf("%c", (unsigned char)val & 0xff);
-        val >>= 8;
-    }
-    val = instr->rel.val;
-    for ( i = 0; i < instr->rel.sz; i++ ) {
-        printf("%c", (unsigned char)val & 0xff);
-        val >>= 8;
-    }
-    val = instr->ptr0.val;
-    for ( i = 0; i < instr->ptr0.sz; i++ ) {
-        printf("%c", (unsigned char)val & 0xff);
-        val >>= 8;
-    }
-    val = instr->ptr1.val;
-    for ( i = 0; i < instr->ptr1.sz; i++ ) {
-        printf("%c", (unsigned char)val & 0xff);
-        val >>= 8;
+    if ( 0 != x86_64_instr_pack(instr, &xstmt->sinstr.pinstr) ) {
+        /* Too long */
+        return -1;
     }
+    xstmt->sinstr.disp = instr->disp.expr;
+    xstmt->sinstr.imm = instr->imm.expr;
+    xstmt->sinstr.rel = instr->rel.expr;
+    xstmt->sinstr.relval = instr->rel.val;
+    xstmt->state = X86_64_STMT_FIXED;
 
     return 0;
 }
 
 
-
 /*
- * ADD (Vol. 2A 3-27)
+ * CALL (Vol. 2A 3-87)
  *
  *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      04 ib           ADD AL,imm8             I       Valid   Valid
- *      05 iw           ADD AX,imm16            I       Valid   Valid
- *      05 ib           ADD EAX,imm32           I       Valid   Valid
- *      REX.W + 05 id   ADD RAX,imm32           I       Valid   N.E.
- *      80 /0 ib        ADD r/m8,imm8           MI      Valid   Valid
- *      REX + 80 /0 ib  ADD r/m8*,imm8          MI      Valid   N.E.
- *      81 /0 iw        ADD r/m16,imm16         MI      Valid   Valid
- *      81 /0 id        ADD r/m32,imm32         MI      Valid   Valid
- *      REX.W + 81 /0 id
- *                      ADD r/m64,imm32         MI      Valid   N.E.
- *      83 /0 ib        ADD r/m16,imm8          MI      Valid   Valid
- *      83 /0 ib        ADD r/m32,imm8          MI      Valid   Valid
- *      REX.W + 83 /0 ib
- *                      ADD r/m64,imm8          MI      Valid   N.E.
- *      00 /r           ADD r/m8,r8             MR      Valid   Valid
- *      REX + 00 /r     ADD r/m8*,r8*           NR      Valid   N.E.
- *      01 /r           ADD r/m16,r16           MR      Valid   Valid
- *      01 /r           ADD r/m32,r32           MR      Valid   Valid
- *      REX.W + 01 /r   ADD r/m64,r64           MR      Valid   N.E.
- *      02 /r           ADD r8,r/m8             RM      Valid   Valid
- *      REX + 02 /r     ADD r8*,r/m8*           RM      Valid   Valid
- *      03 /r           ADD r16,r/m16           RM      Valid   Valid
- *      03 /r           ADD r32,r/m32           RM      Valid   Valid
- *      REX.W + 03 /r   ADD r64,r/m64           RM      Valid   N.E.
- *
- *      * In 64-bit mode, AH, BH, CH, DH cannot be accessed if a REX prefix is
- *        used
+ *      E8 cw           CALL rel16              D       N.S.    Valid
+ *      E8 cd           CALL rel32              D       Valid   Valid
+ *      FF /2           CALL r/m16              M       N.S.    Valid
+ *      FF /2           CALL r/m32              M       N.S.    Valid
+ *      FF /2           CALL r/m64              M       Valid   N.E.
+ *      9A cd           CALL ptr16:16           D       Inv.    Valid
+ *      9A cp           CALL ptr16:32           D       Inv.    Valid
+ *      FF /3           CALL m16:16             D       Valid   Valid
+ *      FF /3           CALL m16:32             D       Valid   Valid
+ *      REX.W + FF /3   CALL m16:64             D       Valid   N.E.
  *
  *
  *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      RM      ModRM:reg(r,w)  ModRM:r/m(r)    NA              NA
- *      MR      ModRM:r/m(r,w)  ModRM:reg(r)    NA              NA
- *      MI      ModRM:r/m(r,w)  imm8/16/32      NA              NA
- *      I       AL/AX/EAX/RAX   imm8/16/32      NA              NA
+ *      D       Offset          NA              NA              NA
+ *      M       ModR/M(r)       NA              NA              NA
  */
 static int
-_add(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_call(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 {
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x04, -1, -1, ENC_I_AL_IMM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x05, -1, -1, ENC_I_AX_IMM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x05, -1, -1, ENC_I_EAX_IMM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x05, -1, -1, ENC_I_RAX_IMM32, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x80, -1, -1, ENC_MI_RM8_IMM8, 0));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x81, -1, -1, ENC_MI_RM16_IMM16, 0));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x81, -1, -1, ENC_MI_RM32_IMM32, 0));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x81, -1, -1, ENC_MI_RM64_IMM32, 0));
-
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x83, -1, -1, ENC_MI_RM16_IMM8, 0));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x83, -1, -1, ENC_MI_RM32_IMM8, 0));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x83, -1, -1, ENC_MI_RM64_IMM8, 0));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x00, -1, -1, ENC_MR_RM8_R8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x01, -1, -1, ENC_MR_RM16_R16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x01, -1, -1, ENC_MR_RM32_R32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x01, -1, -1, ENC_MR_RM64_R64, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x02, -1, -1, ENC_RM_R8_RM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x03, -1, -1, ENC_RM_R16_RM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x03, -1, -1, ENC_RM_R32_RM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x03, -1, -1, ENC_RM_R64_RM64, -1));
+    if ( OPCODE_SUFFIX_FAR & xstmt->suffix ) {
+        /* w/ far */
 
-    return 0;
+        /* To be implemented */
+        return -EUNKNOWN;
+    } else {
+        /* w/o far */
+        EC(binstr2(asmblr, xstmt, 0, 0xe8, -1, -1, ENC_D_REL32, -1));
+        EC(binstr2(asmblr, xstmt, 0, 0xff, -1, -1, ENC_M_RM64, 2));
+        /* Invalid for 64-bit mode */
+        /*EC(binstr2(asmblr, xstmt, SIZE16, 0xe8, -1, -1, ENC_D_REL16, -1));*/
+        /*EC(binstr2(asmblr, xstmt, SIZE16, 0xff, -1, -1, ENC_M_RM16, 2));*/
+        /*EC(binstr2(asmblr, xstmt, SIZE32, 0xff, -1, -1, ENC_M_RM32, 2));*/
+
+        return 0;
+    }
 }
 
 /*
- * AND (Vol. 2A 3-51)
+ * CRC32 (Vol. 2A 3-176)
  *
  *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      24 ib           AND AL,imm8             I       Valid   Valid
- *      25 iw           AND AX,imm16            I       Valid   Valid
- *      25 id           AND EAX,imm32           I       Valid   Valid
- *      REX.W + 25 id   AND RAX,imm32           I       Valid   N.E.
- *      80 /4 ib        AND r/m8,imm8           MI      Valid   Valid
- *      REX + 80 /4 ib  AND r/m8*,imm8          MI      Valid   N.E.
- *      81 /4 iw        AND r/m16,imm16         MI      Valid   Valid
- *      81 /4 id        AND r/m32,imm32         MI      Valid   Valid
- *      REX.W + 81 /4 id
- *                      AND r/m64,imm32         MI      Valid   N.E.
- *      83 /4 ib        AND r/m16,imm8          MI      Valid   Valid
- *      83 /4 ib        AND r/m32,imm8          MI      Valid   Valid
- *      REX.W + 83 /4 ib
- *                      AND r/m64,imm8          MI      Valid   Valid
- *      20 /r           AND r/m8,r8             MR      Valid   Valid
- *      REX + 20 /r     AND r/m8*,r8*           MR      Valid   N.E.
- *      21 /r           AND r/m16,r16           MR      Valid   Valid
- *      21 /r           AND r/m32,r32           MR      Valid   Valid
- *      REX.W + 21 /r   AND r/m64,r64           MR      Valid   N.E.
- *      22 /r           AND r8,r/m8             RM      Valid   Valid
- *      REX + 22 /r     AND r8*,r/m8*           RM      Valid   N.E.
- *      23 /r           AND r16,r/m16           RM      Valid   Valid
- *      23 /r           AND r32,r/m32           RM      Valid   Valid
- *      REX.W + 23 /r   AND r64,r/m64           RM      Valid   N.E.
+ *      F2 0F 38 F0 /r  CRC32 r32,r/m8          RM      Valid   Valid
+ *      F2 REX 0F 38 F0 /r
+ *                      CRC32 r32,r/m8*         RM      Valid   Valid
+ *      F2 0F 38 F1 /r  CRC32 r32,r/m16         RM      Valid   Valid
+ *      F2 0F 38 F1 /r  CRC32 r32,r/m32         RM      Valid   Valid
+ *      F2 REX.W 0F 38 F0 /r
+ *                      CRC32 r64,r/m8          RM      Valid   Valid
+ *      F2 REX.W 0F 38 F1 /r
+ *                      CRC32 r64,r/m64         RM      Valid   Valid
  *
  *      * In 64-bit mode, AH, BH, CH, DH cannot be accessed if a REX prefix is
  *        used
@@ -379,1952 +157,191 @@ _add(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
  *
  *      Op/En   Operand1        Operand2        Operand3        Operand4
  *      RM      ModRM:reg(r,w)  ModRM:r/m(r)    NA              NA
- *      MR      ModRM:r/m(r,w)  ModRM:reg(r)    NA              NA
- *      MI      ModRM:r/m(r,w)  imm8/16/32      NA              NA
- *      I       AL/AX/EAX/RAX   imm8/16/32      NA              NA
  */
 static int
-_and(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_crc32(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 {
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x24, -1, -1, ENC_I_AL_IMM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x25, -1, -1, ENC_I_AX_IMM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x25, -1, -1, ENC_I_EAX_IMM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x25, -1, -1, ENC_I_RAX_IMM32, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x80, -1, -1, ENC_MI_RM8_IMM8, 4));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x81, -1, -1, ENC_MI_RM16_IMM16, 4));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x81, -1, -1, ENC_MI_RM32_IMM32, 4));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x81, -1, -1, ENC_MI_RM64_IMM32, 4));
-
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x83, -1, -1, ENC_MI_RM16_IMM8, 4));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x83, -1, -1, ENC_MI_RM32_IMM8, 4));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x83, -1, -1, ENC_MI_RM64_IMM8, 4));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x20, -1, -1, ENC_MR_RM8_R8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x21, -1, -1, ENC_MR_RM16_R16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x21, -1, -1, ENC_MR_RM32_R32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x21, -1, -1, ENC_MR_RM64_R64, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x22, -1, -1, ENC_RM_R8_RM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x23, -1, -1, ENC_RM_R16_RM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x23, -1, -1, ENC_RM_R32_RM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x23, -1, -1, ENC_RM_R64_RM64, -1));
+    /* FIXME */
+    xstmt->prefix |= OPCODE_PREFIX_CRC32;
+
+    EC(binstr2(asmblr, xstmt, SIZE8, 0x0f, 0x38, 0xf0, ENC_RM_R32_RM8, -1));
+    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0x38, 0xf1, ENC_RM_R32_RM16, -1));
+    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0x38, 0xf1, ENC_RM_R32_RM32, -1));
+
+    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0x38, 0xf0, ENC_RM_R64_RM8, -1));
+    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0x38, 0xf1, ENC_RM_R64_RM64, -1));
 
     return 0;
+
 }
 
-/*
- * BSF (Vol. 2A 3-74)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F BC /r        BSF r16,r/m16           RM      Valid   Valid
- *      0F BC /r        BSF r32,r/m32           RM      Valid   Valid
- *      REX.W + 0F BC /r
- *                      BSF r64,r/m64           RM      Valid   N.E.
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      RM      ModRM:reg(w)    ModRM:r/m(r)    NA              NA
- */
 static int
-_bsf(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_into(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 {
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0xbc, -1, ENC_RM_R16_RM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0xbc, -1, ENC_RM_R32_RM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0xbc, -1, ENC_RM_R64_RM64, -1));
+    /* Invalid for 64-bit mode */
+    /*EC(binstr2(asmblr, xstmt, 0, 0xce, -1, -1, ENC_NP, -1));*/
 
     return 0;
 }
 
-/*
- * BSR (Vol. 2A 3-76)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F BD /r        BSR r16,r/m16           RM      Valid   Valid
- *      0F BD /r        BSR r32,r/m32           RM      Valid   Valid
- *      REX.W + 0F BD /r
- *                      BSR r64,r/m64           RM      Valid   N.E.
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      RM      ModRM:reg(w)    ModRM:r/m(r)    NA              NA
- */
 static int
-_bsr(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_jcxz(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 {
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0xbd, -1, ENC_RM_R16_RM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0xbd, -1, ENC_RM_R32_RM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0xbd, -1, ENC_RM_R64_RM64, -1));
+    /* Invalid for 64-bit mode */
+    /*EC(binstr2(asmblr, xstmt, 0, 0xe3, -1, -1, ENC_D_REL8, -1));*/
 
     return 0;
 }
-
-/*
- * BSWAP (Vol. 2A 3-78)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F C8+rd        BSWAP r32               O       Valid   Valid
- *      REX.W + 0F C8+rd
- *                      BSWAP r64               O       Valid   N.E.
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      O       opcode+rd(r,w)  NA              NA              NA
- */
 static int
-_bswap(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_jecxz(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 {
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0xc8, -1, ENC_O_R32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0xc8, -1, ENC_O_R64, -1));
+    /* FIXME: Specify address operand size 67H */
+    /*EC(binstr2(asmblr, xstmt, 0, 0xe3, -1, -1, ENC_D_REL8, -1));*/
 
     return 0;
 }
-
 /*
- * BT (Vol. 2A 3-79)
+ * JMP (Vol. 2A 3-424)
  *
  *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F A3 /r        BT r/m16,r16            MR      Valid   Valid
- *      0F A3 /r        BT r/m32,r32            MR      Valid   Valid
- *      REX.W + 0F A3 /r
- *                      BT r/m64,r64            MR      Valid   N.E.
- *      0F BA /4 ib     BT r/m16,imm8           MI      Valid   Valid
- *      0F BA /4 ib     BT r/m32,imm8           MI      Valid   Valid
- *      REX.W + 0F BA /4 ib
- *                      BT r/m64,imm8           MI      Valid   N.E.
+ *      EB cb           JMP rel8                D       Valid   Valid
+ *      E9 cw           JMP rel16               D       N.S.    Valid
+ *      E9 cd           JMP rel32               D       Valid   Valid
+ *      FF /4           JMP r/m16               M       N.S.    Valid
+ *      FF /4           JMP r/m32               M       N.S.    Valid
+ *      FF /4           JMP r/m64               M       Valid   N.E.
+ *      EA cd           JMP ptr16:16            D       Inv.    Valid
+ *      EA cp           JMP ptr16:32            D       Inv.    Valid
+ *      FF /5           JMP m16:16              M       Valid   Valid
+ *      FF /5           JMP m16:32              M       Valid   Valid
+ *      REX.W + FF /5   JMP m16:64              M       Valid   N.E.
  *
  *
  *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      MR      ModRM:r/m(r)    ModRM:reg(r)    NA              NA
- *      MI      ModRM:r/m(r)    imm8            NA              NA
+ *      D       Offset          NA              NA              NA
+ *      M       ModR/M(r)       NA              NA              NA
  */
 static int
-_bt(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_jmp(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 {
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0xa3, -1, ENC_MR_RM16_R16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0xa3, -1, ENC_MR_RM32_R32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0xa3, -1, ENC_MR_RM64_R64, -1));
+    if ( OPCODE_SUFFIX_FAR & xstmt->suffix ) {
+        /* w/ far */
+        //EC(binstr2(asmblr, xstmt, SIZE16, 0xff, -1, -1, ENC_D_PTR16_16, -1));
 
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0xba, -1, ENC_MI_RM16_IMM8, 4));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0xba, -1, ENC_MI_RM32_IMM8, 4));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0xba, -1, ENC_MI_RM64_IMM8, 4));
+        /* To be implemented */
+        return -EUNKNOWN;
+    } else {
+        /* w/o far */
+        EC(binstr2(asmblr, xstmt, 0, 0xeb, -1, -1, ENC_D_REL8, -1));
+        EC(binstr2(asmblr, xstmt, 0, 0xe9, -1, -1, ENC_D_REL32, -1));
+        EC(binstr2(asmblr, xstmt, 0, 0xff, -1, -1, ENC_M_RM64, 4));
+        /* Invalid for 64-bit mode */
+        /*EC(binstr2(asmblr, xstmt, SIZE16, 0xe9, -1, -1, ENC_D_REL16, -1));*/
+        /*EC(binstr2(asmblr, xstmt, SIZE16, 0xff, -1, -1, ENC_M_RM16, 4));*/
+        /*EC(binstr2(asmblr, xstmt, SIZE32, 0xff, -1, -1, ENC_M_RM32, 4));*/
 
-    return 0;
+        return 0;
+    }
 }
 
-
 /*
- * BTC (Vol. 2A 3-81)
+ * POPA/POPAD (Vol. 2B 4-268)
  *
  *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F BB /r        BTC r/m16,r16           MR      Valid   Valid
- *      0F BB /r        BTC r/m32,r32           MR      Valid   Valid
- *      REX.W + 0F BB /r
- *                      BTC r/m64,r64           MR      Valid   N.E.
- *      0F BA /7 ib     BTC r/m16,imm8          MI      Valid   Valid
- *      0F BA /7 ib     BTC r/m32,imm8          MI      Valid   Valid
- *      REX.W + 0F BA /7 ib
- *                      BTC r/m64,imm8          MI      Valid   N.E.
+ *      61              POPA                    NP      Inv.    Valid
+ *      61              POPAD                   NP      Inv.    Valid
  *
  *
  *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      MR      ModRM:r/m(r)    ModRM:reg(r)    NA              NA
- *      MI      ModRM:r/m(r)    imm8            NA              NA
+ *      NP      NA              NA              NA              NA
  */
 static int
-_btc(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_popa(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 {
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0xbb, -1, ENC_MR_RM16_R16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0xbb, -1, ENC_MR_RM32_R32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0xbb, -1, ENC_MR_RM64_R64, -1));
+    /* Invalid for 64-bit mode */
+    /*EC(binstr2(asmblr, xstmt, SIZE16, 0x61, -1, -1, ENC_NP, -1));*/
 
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0xba, -1, ENC_MI_RM16_IMM8, 7));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0xba, -1, ENC_MI_RM32_IMM8, 7));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0xba, -1, ENC_MI_RM64_IMM8, 7));
+    return 0;
+}
+static int
+_popad(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+{
+    /* Invalid for 64-bit mode */
+    /*EC(binstr2(asmblr, xstmt, SIZE32, 0x61, -1, -1, ENC_NP, -1));*/
 
     return 0;
 }
 
 /*
- * BTR (Vol. 2A 3-83)
+ * POPCNT (Vol. 2B 4-270)
  *
  *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F B3 /r        BTR r/m16,r16           MR      Valid   Valid
- *      0F B3 /r        BTR r/m32,r32           MR      Valid   Valid
- *      REX.W + 0F B3 /r
- *                      BTR r/m64,r64           MR      Valid   N.E.
- *      0F BA /6 ib     BTR r/m16,imm8          MI      Valid   Valid
- *      0F BA /6 ib     BTR r/m32,imm8          MI      Valid   Valid
- *      REX.W + 0F BA /6 ib
- *                      BTR r/m64,imm8          MI      Valid   N.E.
+ *      F3 0F B8 /r     POPCNT r16,r/m16        RM      Valid   Valid
+ *      F3 0F B8 /r     POPCNT r32,r/m32        RM      Valid   Valid
+ *      F3 REX.W 0F B8 /r
+ *                      POPCNT r64,r/m64        RM      Valid   N.E.
  *
  *
  *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      MR      ModRM:r/m(r)    ModRM:reg(r)    NA              NA
- *      MI      ModRM:r/m(r)    imm8            NA              NA
+ *      RM      ModRM:reg(w)    ModRM:r/m(r)
  */
 static int
-_btr(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_popcnt(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 {
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0xb3, -1, ENC_MR_RM16_R16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0xb3, -1, ENC_MR_RM32_R32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0xb3, -1, ENC_MR_RM64_R64, -1));
+    /* FIXME */
+    xstmt->prefix |= OPCODE_PREFIX_POPCNT;
 
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0xba, -1, ENC_MI_RM16_IMM8, 6));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0xba, -1, ENC_MI_RM32_IMM8, 6));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0xba, -1, ENC_MI_RM64_IMM8, 6));
+    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0xb8, -1, ENC_RM_R16_RM16, -1));
+    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0xb8, -1, ENC_RM_R32_RM32, -1));
+    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0xb8, -1, ENC_RM_R64_RM64, -1));
 
     return 0;
 }
 
 /*
- * BTS (Vol. 2A 3-85)
+ * PUSHA/PUSHAD (Vol. 2B 4-337)
  *
  *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F AB /r        BTS r/m16,r16           MR      Valid   Valid
- *      0F AB /r        BTS r/m32,r32           MR      Valid   Valid
- *      REX.W + 0F AB /r
- *                      BTS r/m64,r64           MR      Valid   N.E.
- *      0F BA /5 ib     BTS r/m16,imm8          MI      Valid   Valid
- *      0F BA /5 ib     BTS r/m32,imm8          MI      Valid   Valid
- *      REX.W + 0F BA /5 ib
- *                      BTS r/m64,imm8          MI      Valid   N.E.
+ *      60              PUSHA                   NP      Inv.    Valid
+ *      60              PUSHAD                  NP      Inv.    Valid
  *
  *
  *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      MR      ModRM:r/m(r)    ModRM:reg(r)    NA              NA
- *      MI      ModRM:r/m(r)    imm8            NA              NA
+ *      NP      NA              NA              NA              NA
  */
 static int
-_bts(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_pusha(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 {
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0xab, -1, ENC_MR_RM16_R16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0xab, -1, ENC_MR_RM32_R32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0xab, -1, ENC_MR_RM64_R64, -1));
+    /* Invalid for 64-bit mode */
+    /*EC(binstr2(asmblr, xstmt, SIZE16, 0x60, -1, -1, ENC_NP, -1));*/
 
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0xba, -1, ENC_MI_RM16_IMM8, 5));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0xba, -1, ENC_MI_RM32_IMM8, 5));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0xba, -1, ENC_MI_RM64_IMM8, 5));
+    return 0;
+}
+static int
+_pushad(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+{
+    /* Invalid for 64-bit mode */
+    /*EC(binstr2(asmblr, xstmt, SIZE32, 0x60, -1, -1, ENC_NP, -1));*/
 
     return 0;
 }
 
 /*
- * CALL (Vol. 2A 3-87)
+ * RET (Vol. 2B 4-369)
  *
  *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      E8 cw           CALL rel16              D       N.S.    Valid
- *      E8 cd           CALL rel32              D       Valid   Valid
- *      FF /2           CALL r/m16              M       N.S.    Valid
- *      FF /2           CALL r/m32              M       N.S.    Valid
- *      FF /2           CALL r/m64              M       Valid   N.E.
- *      9A cd           CALL ptr16:16           D       Inv.    Valid
- *      9A cp           CALL ptr16:32           D       Inv.    Valid
- *      FF /3           CALL m16:16             D       Valid   Valid
- *      FF /3           CALL m16:32             D       Valid   Valid
- *      REX.W + FF /3   CALL m16:64             D       Valid   N.E.
+ *      C3              RET                     NP      Valid   Valid
+ *      CB              RET                     NP      Valid   Valid
+ *      C2 iw           RET imm16               I       Valid   Valid
+ *      CA iw           RET imm16               I       Valid   Valid
  *
  *
  *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      D       Offset          NA              NA              NA
- *      M       ModR/M(r)       NA              NA              NA
+ *      NP      NA              NA              NA              NA
+ *      I       imm16           NA              NA              NA
  */
 static int
-_call(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    if ( OPCODE_SUFFIX_FAR & xstmt->suffix ) {
-        /* w/ far */
-
-        /* To be implemented */
-        return -EUNKNOWN;
-    } else {
-        /* w/o far */
-        EC(binstr2(asmblr, xstmt, 0, 0xe8, -1, -1, ENC_D_REL32, -1));
-        EC(binstr2(asmblr, xstmt, 0, 0xff, -1, -1, ENC_M_RM64, 2));
-        /* Invalid for 64-bit mode */
-        /*EC(binstr2(asmblr, xstmt, SIZE16, 0xe8, -1, -1, ENC_D_REL16, -1));*/
-        /*EC(binstr2(asmblr, xstmt, SIZE16, 0xff, -1, -1, ENC_M_RM16, 2));*/
-        /*EC(binstr2(asmblr, xstmt, SIZE32, 0xff, -1, -1, ENC_M_RM32, 2));*/
-
-        return 0;
-    }
-}
-
-/*
- * CBW/CWDE/CDQE (Vol. 2A 3-100)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      98              CBW                     NP      Valid   Valid
- *      98              CWDE                    NP      Valid   Valid
- *      REX.W + 98      CDQE                    NP      Valid   N.E.
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_cbw(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x98, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-static int
-_cwde(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x98, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-static int
-_cdqe(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x98, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-
-/*
- * CLC (Vol. 2A 3-101)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      F8              CLC                     NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_clc(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0xf8, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-
-/*
- * CLD (Vol. 2A 3-102)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      FC              CLD                     NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_cld(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0xfc, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-
-/*
- * CLFLUSH (Vol. 2A 3-103)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F AE /7        CLFLUSH m8              M       Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      M       ModR/M(w)       NA              NA              NA
- */
-static int
-_clflush(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x0f, 0xae, -1, ENC_M_M8, 7));
-
-    return 0;
-}
-
-/*
- * CLI (Vol. 2A 3-105)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      FA              CLI                     NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_cli(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0xfa, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-
-/*
- * CMP (Vol. 2A 3-113)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      3C ib           CMP AL,imm8             I       Valid   Valid
- *      3D iw           CMP AX,imm16            I       Valid   Valid
- *      3D id           CMP EAX,imm32           I       Valid   Valid
- *      REX.W + 3D id   CMP RAX,imm32           I       Valid   N.E.
- *      80 /7 ib        CMP r/m8,imm8           MI      Valid   Valid
- *      REX + 80 /7 ib  CMP r/m8*,imm8          MI      Valid   N.E.
- *      81 /7 iw        CMP r/m16,imm16         MI      Valid   Valid
- *      81 /7 id        CMP r/m32,imm32         MI      Valid   Valid
- *      REX.W + 81 /7 id
- *                      CMP r/m64,imm32         MI      Valid   N.E.
- *      83 /7 ib        CMP r/m16,imm8          MI      Valid   Valid
- *      83 /7 ib        CMP r/m32,imm8          MI      Valid   Valid
- *      REX.W + 83 /7 ib
- *                      CMP r/m64,imm8          MI      Valid   Valid
- *      38 /r           CMP r/m8,r8             MR      Valid   Valid
- *      REX + 38 /r     CMP r/m8*,r8*           MR      Valid   N.E.
- *      39 /r           CMP r/m16,r16           MR      Valid   Valid
- *      39 /r           CMP r/m32,r32           MR      Valid   Valid
- *      REX.W + 39 /r   CMP r/m64,r64           MR      Valid   N.E.
- *      3A /r           CMP r8,r/m8             RM      Valid   Valid
- *      REX + 3A /r     CMP r8*,r/m8*           RM      Valid   N.E.
- *      3B /r           CMP r16,r/m16           RM      Valid   Valid
- *      3B /r           CMP r32,r/m32           RM      Valid   Valid
- *      REX.W + 3B /r   CMP r64,r/m64           RM      Valid   N.E.
- *
- *      * In 64-bit mode, AH, BH, CH, DH cannot be accessed if a REX prefix is
- *        used
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      RM      ModRM:reg(r,w)  ModRM:r/m(r)    NA              NA
- *      MR      ModRM:r/m(r,w)  ModRM:reg(r)    NA              NA
- *      MI      ModRM:r/m(r,w)  imm8/16/32      NA              NA
- *      I       AL/AX/EAX/RAX   imm8/16/32      NA              NA
- */
-static int
-_cmp(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x3c, -1, -1, ENC_I_AL_IMM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x3d, -1, -1, ENC_I_AX_IMM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x3d, -1, -1, ENC_I_EAX_IMM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x3d, -1, -1, ENC_I_RAX_IMM32, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x80, -1, -1, ENC_MI_RM8_IMM8, 7));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x81, -1, -1, ENC_MI_RM16_IMM16, 7));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x81, -1, -1, ENC_MI_RM32_IMM32, 7));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x81, -1, -1, ENC_MI_RM64_IMM32, 7));
-
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x83, -1, -1, ENC_MI_RM16_IMM8, 7));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x83, -1, -1, ENC_MI_RM32_IMM8, 7));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x83, -1, -1, ENC_MI_RM64_IMM8, 7));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x38, -1, -1, ENC_MR_RM8_R8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x39, -1, -1, ENC_MR_RM16_R16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x39, -1, -1, ENC_MR_RM32_R32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x39, -1, -1, ENC_MR_RM64_R64, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x3a, -1, -1, ENC_RM_R8_RM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x3b, -1, -1, ENC_RM_R16_RM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x3b, -1, -1, ENC_RM_R32_RM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x3b, -1, -1, ENC_RM_R64_RM64, -1));
-
-    return 0;
-}
-
-/*
- * CMPXCHG (Vol. 2A 3-140)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F B0 /r        CMPXCHG r/m8,r8         MR      Valid   Valid*
- *      REX + 0F B0 /r  CMPXCHG r/m8**,r8       MR      Valid   N.E.
- *      0F B1 /r        CMPXCHG r/m16,r16       MR      Valid   Valid*
- *      0F B1 /r        CMPXCHG r/m32,r32       MR      Valid   Valid*
- *      REX.W + 0F B1 /r
- *                      CMPXCHG r/m64,r64       MR      Valid   N.E.
- *
- *      *  See IA-32 Architecture Compatibility section in the manual
- *      ** In 64-bit mode, AH, BH, CH, DH cannot be accessed if a REX prefix is
- *         used
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      MR      ModRM:r/m(r,w)  ModRM:reg(r)    NA              NA
- */
-static int
-_cmpxchg(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x0f, 0xb0, -1, ENC_MR_RM8_R8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0xb1, -1, ENC_MR_RM16_R16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0xb1, -1, ENC_MR_RM32_R32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0xb1, -1, ENC_MR_RM64_R64, -1));
-
-    return 0;
-}
-
-/*
- * CPUID (Vol. 2A 3-148)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F A2           CPUID                   NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_cpuid(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0xa2, -1, ENC_NP, -1));
-
-    return 0;
-}
-
-/*
- * CRC32 (Vol. 2A 3-176)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      F2 0F 38 F0 /r  CRC32 r32,r/m8          RM      Valid   Valid
- *      F2 REX 0F 38 F0 /r
- *                      CRC32 r32,r/m8*         RM      Valid   Valid
- *      F2 0F 38 F1 /r  CRC32 r32,r/m16         RM      Valid   Valid
- *      F2 0F 38 F1 /r  CRC32 r32,r/m32         RM      Valid   Valid
- *      F2 REX.W 0F 38 F0 /r
- *                      CRC32 r64,r/m8          RM      Valid   Valid
- *      F2 REX.W 0F 38 F1 /r
- *                      CRC32 r64,r/m64         RM      Valid   Valid
- *
- *      * In 64-bit mode, AH, BH, CH, DH cannot be accessed if a REX prefix is
- *        used
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      RM      ModRM:reg(r,w)  ModRM:r/m(r)    NA              NA
- */
-static int
-_crc32(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    /* FIXME */
-    xstmt->prefix |= OPCODE_PREFIX_CRC32;
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x0f, 0x38, 0xf0, ENC_RM_R32_RM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0x38, 0xf1, ENC_RM_R32_RM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0x38, 0xf1, ENC_RM_R32_RM32, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0x38, 0xf0, ENC_RM_R64_RM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0x38, 0xf1, ENC_RM_R64_RM64, -1));
-
-    return 0;
-
-}
-
-/*
- * CWD/CDQ/CQO (Vol. 2A 3-216)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      99              CWD                     NP      Valid   Valid
- *      99              CDQ                     NP      Valid   Valid
- *      REX.W + 99      CQO                     NP      Valid   N.E.
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_cwd(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x99, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-static int
-_cdq(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x99, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-static int
-_cqo(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x99, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-
-/*
- * DAA (Vol. 2A 3-217)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      27              DAA                     NP      Invalid Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_daa(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    /* FIXME: Invalidate in 64-bit mode */
-    EC(binstr2(asmblr, xstmt, 0, 0x27, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-
-/*
- * DAS (Vol. 2A 3-219)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      2F              DAS                     NP      Invalid Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_das(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    /* FIXME: Invalidate in 64-bit mode */
-    EC(binstr2(asmblr, xstmt, 0, 0x2f, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-
-/*
- * DEC (Vol. 2A 3-221)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      FE /1           DEC r/m8                M       Valid   Valid
- *      REX + FE /1     DEC r/m8*               M       Valid   N.E.
- *      FF /1           DEC r/m16               M       Valid   Valid
- *      FF /1           DEC r/m32               M       Valid   Valid
- *      REX.W + FF /1   DEC r/m64               M       Valid   N.E.
- *      48 +rw          DEC r16                 O       N.E.    Valid
- *      48 +rd          DEC r32                 O       N.E.    Valid
- *
- *      * In 64-bit mode, AH, BH, CH, DH cannot be accessed if a REX prefix is
- *        used
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      M       ModR/M:r/m(r,w) NA              NA              NA
- *      O       opcode+rd(r,w)  NA              NA              NA
- */
-static int
-_dec(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xfe, -1, -1, ENC_M_RM8, 1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xff, -1, -1, ENC_M_RM16, 1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xff, -1, -1, ENC_M_RM32, 1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0xff, -1, -1, ENC_M_RM64, 1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, SIZE16, 0x48, -1, -1, ENC_O_R16, -1));*/
-    /*EC(binstr2(asmblr, xstmt, SIZE32, 0x48, -1, -1, ENC_O_R32, -1));*/
-
-    return 0;
-}
-
-/*
- * DIV (Vol. 2A 3-223)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      F6 /6           DIV r/m8                M       Valid   Valid
- *      REX + F6 /6     DIV r/m8*               M       Valid   N.E.
- *      F7 /6           DIV r/m16               M       Valid   Valid
- *      F7 /6           DIV r/m32               M       Valid   Valid
- *      REX.W + F7 /6   DIV r/m64               M       Valid   N.E.
- *
- *      * In 64-bit mode, AH, BH, CH, DH cannot be accessed if a REX prefix is
- *        used
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      M       ModR/M:r/m(r,w) NA              NA              NA
- */
-static int
-_div(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xf6, -1, -1, ENC_M_RM8, 6));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xf7, -1, -1, ENC_M_RM16, 6));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xf7, -1, -1, ENC_M_RM32, 6));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0xf7, -1, -1, ENC_M_RM64, 6));
-
-    return 0;
-}
-
-/*
- * HLT (Vol. 2A 3-368)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      F4              HLT                     NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_hlt(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0xf4, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-
-/*
- * IDIV (Vol. 2A 3-375)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      F6 /7           IDIV r/m8               M       Valid   Valid
- *      REX + F6 /7     IDIV r/m8*              M       Valid   N.E.
- *      F7 /7           IDIV r/m16              M       Valid   Valid
- *      F7 /7           IDIV r/m32              M       Valid   Valid
- *      REX.W + F7 /7   IDIV r/m64              M       Valid   N.E.
- *
- *      * In 64-bit mode, AH, BH, CH, DH cannot be accessed if a REX prefix is
- *        used
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      M       ModR/M:r/m(r,w) NA              NA              NA
- */
-static int
-_idiv(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xf6, -1, -1, ENC_M_RM8, 7));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xf7, -1, -1, ENC_M_RM16, 7));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xf7, -1, -1, ENC_M_RM32, 7));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0xf7, -1, -1, ENC_M_RM64, 7));
-
-    return 0;
-}
-
-/*
- * IMUL (Vol. 2A 3-378)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      F6 /5           IMUL r/m8*              M       Valid   Valid
- *      F7 /5           IMUL r/m16              M       Valid   Valid
- *      F7 /5           IMUL r/m32              M       Valid   Valid
- *      REX.W + F7 /5   IMUL r/m64              M       Valid   N.E.
- *      0F AF /r        IMUL r16,r/m16          RM      Valid   Valid
- *      0F AF /r        IMUL r32,r/m32          RM      Valid   Valid
- *      REX.W + 0F AF /r
- *                      IMUL r64,r/m64          RM      Valid   N.E.
- *      6B /r ib        IMUL r16,r/m16,imm8     RMI     Valid   Valid
- *      6B /r ib        IMUL r32,r/m32,imm8     RMI     Valid   Valid
- *      REX.W + 6B /r ib
- *                      IMUL r64,r/m64,imm8     RMI     Valid   N.E.
- *      69 /r iw        IMUL r16,r/m16,imm16    RMI     Valid   Valid
- *      69 /r id        IMUL r32,r/m32,imm32    RMI     Valid   Valid
- *      REX.W + 69 /r id
- *                      IMUL r64,r/m64,imm32    RMI     Valid   N.E.
- *
- *      * In 64-bit mode, AH, BH, CH, DH cannot be accessed if a REX prefix is
- *        used
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      M       ModR/M:r/m(r,w) NA              NA              NA
- *      RM      ModRM:reg(r,w)  ModRM:r/m(r)    NA              NA
- *      RMI     ModRM:reg(r,w)  ModRM:r/m(r)    imm8/16/32      NA
- */
-static int
-_imul(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xf6, -1, -1, ENC_M_RM8, 5));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xf7, -1, -1, ENC_M_RM16, 5));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xf7, -1, -1, ENC_M_RM32, 5));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0xf7, -1, -1, ENC_M_RM64, 5));
-
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0xaf, -1, ENC_RM_R16_RM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0xaf, -1, ENC_RM_R32_RM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0xaf, -1, ENC_RM_R64_RM64, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x6b, -1, -1, ENC_RMI_R16_RM16_IMM8,
-               -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x6b, -1, -1, ENC_RMI_R32_RM32_IMM8,
-               -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x6b, -1, -1, ENC_RMI_R64_RM64_IMM8,
-               -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x69, -1, -1, ENC_RMI_R16_RM16_IMM16,
-               -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x69, -1, -1, ENC_RMI_R32_RM32_IMM32,
-               -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x69, -1, -1, ENC_RMI_R64_RM64_IMM32,
-               -1));
-
-    return 0;
-}
-
-/*
- * IN (Vol. 2A 3-382)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      E4 ib           IN AL,imm8              I       Valid   Valid
- *      E5 ib           IN AX,imm8              I       Valid   Valid
- *      E5 ib           IN EAX,imm8             I       Valid   Valid
- *      EC              IN AL,DX                NP      Valid   Valid
- *      ED              IN AX,DX                NP      Valid   Valid
- *      ED              IN EAX,DX               NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      I       imm8            NA              NA              NA
- *      NP      NA              NA              NA              NA
- */
-static int
-_in(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xe4, -1, -1, ENC_I_AL_IMM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xe5, -1, -1, ENC_I_AX_IMM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xe5, -1, -1, ENC_I_EAX_IMM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xec, -1, -1, ENC_NP_AL_DX, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xed, -1, -1, ENC_NP_AX_DX, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xed, -1, -1, ENC_NP_EAX_DX, -1));
-
-    return 0;
-}
-
-/*
- * INC (Vol. 2A 3-384)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      FE /0           INC r/m8                M       Valid   Valid
- *      REX + FE /0     INC r/m8*               M       Valid   N.E.
- *      FF /0           INC r/m16               M       Valid   Valid
- *      FF /0           INC r/m32               M       Valid   Valid
- *      REX.W + FF /0   INC r/m64               M       Valid   N.E.
- *      40 +rw          INC r16                 O       N.E.    Valid
- *      40 +rd          INC r32                 O       N.E.    Valid
- *
- *      * In 64-bit mode, AH, BH, CH, DH cannot be accessed if a REX prefix is
- *        used
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      M       ModR/M:r/m(r,w) NA              NA              NA
- *      O       opcode+rd(r,w)  NA              NA              NA
- */
-static int
-_inc(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xfe, -1, -1, ENC_M_RM8, 0));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xff, -1, -1, ENC_M_RM16, 0));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xff, -1, -1, ENC_M_RM32, 0));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0xff, -1, -1, ENC_M_RM64, 0));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, SIZE16, 0x40, -1, -1, ENC_O_R16, -1));*/
-    /*EC(binstr2(asmblr, xstmt, SIZE32, 0x40, -1, -1, ENC_O_R32, -1));*/
-
-    return 0;
-}
-
-/*
- * INT (Vol. 2A 3-392)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      CC              INT 3                   NP      Valid   Valid
- *      CD              INT imm8                I       Valid   Valid
- *      CE              INTO                    NP      Inv.    Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- *      I       imm8            NA              NA              NA
- */
-static int
-_int(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0xcc, -1, -1, ENC_NP_3, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0xcd, -1, -1, ENC_I_IMM8, -1));
-
-    return 0;
-}
-static int
-_into(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0xce, -1, -1, ENC_NP, -1));*/
-
-    return 0;
-}
-
-/*
- * IRET (Vol. 2A 3-411)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      CF              IRET                    NP      Valid   Valid
- *      CF              IRETD                   NP      Valid   Valid
- *      REX.W + CF      IRETQ                   NP      Valid   N.E.
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_iret(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xcf, -1, -1, ENC_NP, 0));
-
-    return 0;
-}
-static int
-_iretd(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xcf, -1, -1, ENC_NP, 0));
-
-    return 0;
-}
-static int
-_iretq(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE64, 0xcf, -1, -1, ENC_NP, 0));
-
-    return 0;
-}
-
-/*
- * JCC (Vol. 2A 3-419)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      77 cb           JA rel8                 D       Valid   Valid
- *      73 cb           JAE rel8                D       Valid   Valid
- *      72 cb           JB rel8                 D       Valid   Valid
- *      76 cb           JBE rel8                D       Valid   Valid
- *      72 cb           JC rel8                 D       Valid   Valid
- *      E3 cb           JCXZ rel8               D       N.E.    Valid
- *      E3 cb           JECXZ rel8              D       Valid   Valid
- *      E3 cb           JRCXZ rel8              D       Valid   N.E.
- *      74 cb           JE rel8                 D       Valid   Valid
- *      7F cb           JG rel8                 D       Valid   Valid
- *      7D cb           JGE rel8                D       Valid   Valid
- *      7C cb           JL rel8                 D       Valid   Valid
- *      7E cb           JLE rel8                D       Valid   Valid
- *      76 cb           JNA rel8                D       Valid   Valid
- *      72 cb           JNAE rel8               D       Valid   Valid
- *      73 cb           JNB rel8                D       Valid   Valid
- *      77 cb           JNBE rel8               D       Valid   Valid
- *      73 cb           JNC rel8                D       Valid   Valid
- *      75 cb           JNE rel8                D       Valid   Valid
- *      7E cb           JNG rel8                D       Valid   Valid
- *      7C cb           JNGE rel8               D       Valid   Valid
- *      7D cb           JNL rel8                D       Valid   Valid
- *      7F cb           JNLE rel8               D       Valid   Valid
- *      71 cb           JNO rel8                D       Valid   Valid
- *      7B cb           JNP rel8                D       Valid   Valid
- *      79 cb           JNS rel8                D       Valid   Valid
- *      75 cb           JNZ rel8                D       Valid   Valid
- *      70 cb           JO rel8                 D       Valid   Valid
- *      7A cb           JP rel8                 D       Valid   Valid
- *      7A cb           JPE rel8                D       Valid   Valid
- *      7B cb           JPO rel8                D       Valid   Valid
- *      78 cb           JS rel8                 D       Valid   Valid
- *      74 cb           JZ rel8                 D       Valid   Valid
- *
- *      0F 87 cw        JA rel16                D       N.S.    Valid
- *      0F 87 cd        JA rel32                D       Valid   Valid
- *      0F 83 cw        JAE rel16               D       N.S.    Valid
- *      0F 83 cd        JAE rel32               D       Valid   Valid
- *      0F 82 cw        JB rel16                D       N.S.    Valid
- *      0F 82 cd        JB rel32                D       Valid   Valid
- *      0F 86 cw        JBE rel16               D       N.S.    Valid
- *      0F 86 cd        JBE rel32               D       Valid   Valid
- *      0F 82 cw        JC rel16                D       N.S.    Valid
- *      0F 82 cd        JC rel32                D       Valid   Valid
- *      0F 84 cw        JE rel16                D       N.S.    Valid
- *      0F 84 cd        JE rel32                D       Valid   Valid
- *      0F 84 cw        JZ rel16                D       N.S.    Valid
- *      0F 84 cd        JZ rel32                D       Valid   Valid
- *      0F 8F cw        JG rel16                D       N.S.    Valid
- *      0F 8F cd        JG rel32                D       Valid   Valid
- *      0F 8D cw        JGE rel16               D       N.S.    Valid
- *      0F 8D cd        JGE rel32               D       Valid   Valid
- *      0F 8C cw        JL rel16                D       N.S.    Valid
- *      0F 8C cd        JL rel32                D       Valid   Valid
- *      0F 8E cw        JLE rel16               D       N.S.    Valid
- *      0F 8E cd        JLE rel32               D       Valid   Valid
- *      0F 86 cw        JNA rel16               D       N.S.    Valid
- *      0F 86 cd        JNA rel32               D       Valid   Valid
- *      0F 82 cw        JNAE rel16              D       N.S.    Valid
- *      0F 82 cd        JNAE rel32              D       Valid   Valid
- *      0F 83 cw        JNB rel16               D       N.S.    Valid
- *      0F 83 cd        JNB rel32               D       Valid   Valid
- *      0F 87 cw        JNBE rel16              D       N.S.    Valid
- *      0F 87 cd        JNBE rel32              D       Valid   Valid
- *      0F 83 cw        JNC rel16               D       N.S.    Valid
- *      0F 83 cd        JNC rel32               D       Valid   Valid
- *      0F 85 cw        JNE rel16               D       N.S.    Valid
- *      0F 85 cd        JNE rel32               D       Valid   Valid
- *      0F 8E cw        JNG rel16               D       N.S.    Valid
- *      0F 8E cd        JNG rel32               D       Valid   Valid
- *      0F 8C cw        JNGE rel16              D       N.S.    Valid
- *      0F 8C cd        JNGE rel32              D       Valid   Valid
- *      0F 8D cw        JNL rel16               D       N.S.    Valid
- *      0F 8D cd        JNL rel32               D       Valid   Valid
- *      0F 8F cw        JNLE rel16              D       N.S.    Valid
- *      0F 8F cd        JNLE rel32              D       Valid   Valid
- *      0F 81 cw        JNO rel16               D       N.S.    Valid
- *      0F 81 cd        JNO rel32               D       Valid   Valid
- *      0F 8B cw        JNP rel16               D       N.S.    Valid
- *      0F 8B cd        JNP rel32               D       Valid   Valid
- *      0F 89 cw        JNS rel16               D       N.S.    Valid
- *      0F 89 cd        JNS rel32               D       Valid   Valid
- *      0F 85 cw        JNZ rel16               D       N.S.    Valid
- *      0F 85 cd        JNZ rel32               D       Valid   Valid
- *      0F 80 cw        JO rel16                D       N.S.    Valid
- *      0F 80 cd        JO rel32                D       Valid   Valid
- *      0F 8A cw        JP rel16                D       N.S.    Valid
- *      0F 8A cd        JP rel32                D       Valid   Valid
- *      0F 8A cw        JPE rel16               D       N.S.    Valid
- *      0F 8A cd        JPE rel32               D       Valid   Valid
- *      0F 8B cw        JPO rel16               D       N.S.    Valid
- *      0F 8B cd        JPO rel32               D       Valid   Valid
- *      0F 88 cw        JS rel16                D       N.S.    Valid
- *      0F 88 cd        JS rel32                D       Valid   Valid
- *      0F 84 cw        JZ rel16                D       N.S.    Valid
- *      0F 84 cd        JZ rel32                D       Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      D       Offset          NA              NA              NA
- */
-static int
-_ja(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x77, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x87, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x87, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jae(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x73, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x83, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x83, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jb(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x72, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x82, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x82, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jbe(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x76, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x86, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x86, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jc(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x72, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x82, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x82, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jcxz(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0xe3, -1, -1, ENC_D_REL8, -1));*/
-
-    return 0;
-}
-static int
-_jecxz(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    /* FIXME: Specify address operand size 67H */
-    /*EC(binstr2(asmblr, xstmt, 0, 0xe3, -1, -1, ENC_D_REL8, -1));*/
-
-    return 0;
-}
-static int
-_jrcxz(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0xe3, -1, -1, ENC_D_REL8, -1));
-
-    return 0;
-}
-static int
-_je(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x74, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x84, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x84, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jg(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x7f, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8f, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8f, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jge(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x7d, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8d, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8d, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jl(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x7c, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8c, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8c, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jle(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x7e, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8e, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8e, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jna(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x76, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x86, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x86, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jnae(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x72, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x82, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x82, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jnb(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x73, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x83, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x83, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jnbe(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x77, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x87, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x87, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jnc(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x73, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x83, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x83, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jne(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x75, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x85, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x85, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jng(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x7e, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8e, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8e, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jnge(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x7c, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8c, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8c, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jnl(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x7d, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8d, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8d, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jnle(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x7f, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8f, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8f, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jno(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x71, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x81, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x81, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jnp(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x7b, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8b, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8b, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jns(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x79, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x89, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x89, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jnz(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x75, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x85, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x85, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jo(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x70, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x80, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x80, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jp(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x7a, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8a, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8a, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jpe(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x7a, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8a, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8a, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jpo(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x7b, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8b, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x8b, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_js(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x78, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x88, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x88, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-static int
-_jz(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x74, -1, -1, ENC_D_REL8, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x84, -1, ENC_D_REL32, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x84, -1, ENC_D_REL16, -1));*/
-
-    return 0;
-}
-
-/*
- * JMP (Vol. 2A 3-424)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      EB cb           JMP rel8                D       Valid   Valid
- *      E9 cw           JMP rel16               D       N.S.    Valid
- *      E9 cd           JMP rel32               D       Valid   Valid
- *      FF /4           JMP r/m16               M       N.S.    Valid
- *      FF /4           JMP r/m32               M       N.S.    Valid
- *      FF /4           JMP r/m64               M       Valid   N.E.
- *      EA cd           JMP ptr16:16            D       Inv.    Valid
- *      EA cp           JMP ptr16:32            D       Inv.    Valid
- *      FF /5           JMP m16:16              M       Valid   Valid
- *      FF /5           JMP m16:32              M       Valid   Valid
- *      REX.W + FF /5   JMP m16:64              M       Valid   N.E.
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      D       Offset          NA              NA              NA
- *      M       ModR/M(r)       NA              NA              NA
- */
-static int
-_jmp(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    if ( OPCODE_SUFFIX_FAR & xstmt->suffix ) {
-        /* w/ far */
-        //EC(binstr2(asmblr, xstmt, SIZE16, 0xff, -1, -1, ENC_D_PTR16_16, -1));
-
-        /* To be implemented */
-        return -EUNKNOWN;
-    } else {
-        /* w/o far */
-        EC(binstr2(asmblr, xstmt, 0, 0xeb, -1, -1, ENC_D_REL8, -1));
-        EC(binstr2(asmblr, xstmt, 0, 0xe9, -1, -1, ENC_D_REL32, -1));
-        EC(binstr2(asmblr, xstmt, 0, 0xff, -1, -1, ENC_M_RM64, 4));
-        /* Invalid for 64-bit mode */
-        /*EC(binstr2(asmblr, xstmt, SIZE16, 0xe9, -1, -1, ENC_D_REL16, -1));*/
-        /*EC(binstr2(asmblr, xstmt, SIZE16, 0xff, -1, -1, ENC_M_RM16, 4));*/
-        /*EC(binstr2(asmblr, xstmt, SIZE32, 0xff, -1, -1, ENC_M_RM32, 4));*/
-
-        return 0;
-    }
-}
-
-/*
- * LEA (Vol. 2A 3-443)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      8D /r           LEA r16,m               RM      Valid   Valid
- *      8D /r           LEA r32,m               RM      Valid   Valid
- *      REX.W + 8D /r   LEA r64,m               RM      Valid   N.E.
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      RM      ModR/M:reg(w)   ModR/M:r/m(r)   NA              NA
- */
-static int
-_lea(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x8d, -1, -1, ENC_RM_R16_RM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x8d, -1, -1, ENC_RM_R32_RM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x8d, -1, -1, ENC_RM_R64_RM64, -1));
-
-    return 0;
-}
-
-/*
- * LEAVE (Vol. 2A 3-443)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      C9              LEAVE                   NP      Valid   Valid
- *      C9              LEAVE                   NP      N.E.    Valid
- *      C9              LEAVE                   NP      Valid   N.E.
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_leave(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0xc9, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-
-/*
- * LFENCE (Vol. 2A 3-448)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F AE /5        LFENCE                  NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_lfence(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0xae, -1, ENC_NP_PREG, 5));
-
-    return 0;
-}
-
-/*
- * LGDT/LIDT (Vol. 2A 3-449)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F 01 /2        LGDT m16&32             M       N.E.    Valid
- *      0F 01 /3        LIDT m16&32             M       N.E.    Valid
- *      0F 01 /2        LGDT m16&64             M       Valid   N.E.
- *      0F 01 /3        LIDT m16&64             M       Valid   N.E.
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      M       ModRM:r/m(r)    NA              NA              NA
- */
-static int
-_lgdt(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x01, -1, ENC_M_MUNSPEC, 2));
-
-    return 0;
-}
-static int
-_lidt(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x01, -1, ENC_M_MUNSPEC, 3));
-
-    return 0;
-}
-
-/*
- * LLDT (Vol. 2A 3-452)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F 00 /2        LLDT r/m16              M       Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      M       ModRM:r/m(r)    NA              NA              NA
- */
-static int
-_lldt(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x00, -1, ENC_M_RM16, 2));
-
-    return 0;
-}
-
-/*
- * LODS/LODSB/LODSW/LODSD/LODSQ (Vol. 2A 3-458)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      AC              LODS m8                 NP      Valid   Valid
- *      AD              LODS m16                NP      Valid   Valid
- *      AD              LODS m32                NP      Valid   Valid
- *      REX.W + AD      LODS m64                NP      Valid   N.E.
- *      AC              LODSB                   NP      Valid   Valid
- *      AD              LODSW                   NP      Valid   Valid
- *      AD              LODSD                   NP      Valid   Valid
- *      REX.W + AD      LODSQ                   NP      Valid   N.E.
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_lodsb(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xac, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-static int
-_lodsw(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xad, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-static int
-_lodsd(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xad, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-static int
-_lodsq(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE64, 0xad, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-
-/*
- * MFENCE (Vol. 2B 4-18)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F AE /6        MFENCE                  NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_mfence(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0xae, -1, ENC_NP_PREG, 6));
-
-    return 0;
-}
-
-/*
- * MONITOR (Vol. 2B 4-27)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F 01 C8        MONITOR                 NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_monitor(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x01, 0xc8, ENC_NP, -1));
-
-    return 0;
-}
-
-
-/*
- * MOV (Vol. 2B 4-29)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      88 /r           MOV r/m8,r8             MR      Valid   Valid
- *      REX + 88 /r     MOV r/m8***,r8***       MR      Valid   N.E.
- *      89 /r           MOV r/m16,r16           MR      Valid   Valid
- *      89 /r           MOV r/m32,r32           MR      Valid   Valid
- *      REX.W + 89 /r   MOV r/m64,r64           MR      Valid   N.E.
- *      8A /r           MOV r8,r/m8             RM      Valid   Valid
- *      REX + 8A /r     MOV r8***,r/m8***       RM      Valid   N.E.
- *      8B /r           MOV r16,r/m16           RM      Valid   Valid
- *      8B /r           MOV r32,r/m32           RM      Valid   Valid
- *      REX.W + 8B /r   MOV r64,r/m64           RM      Valid   N.E.
- *      8C /r           MOV r/m16,Sreg**        MR      Valid   Valid
- *      REX.W 8C /r     MOV r/m64,Sreg**        MR      Valid   Valid
- *      8E /r           MOV Sreg,r/m16**        RM      Valid   Valid
- *      REX.W 8E /r     MOV Sreg,r/m16**        RM      Valid   Valid
- *      A0              MOV AL,moffs8*          FD      Valid   Valid
- *      REX.W + A0      MOV AL,moffs8*          FD      Valid   N.E.
- *      A1              MOV AX,moffs16*         FD      Valid   Valid
- *      A1              MOV EAX,moffs32*        FD      Valid   Valid
- *      REX.W + A1      MOV RAX,moffs64*        FD      Valid   N.E.
- *      A2              MOV moffs8,AL           TD      Valid   Valid
- *      REX.W + A2      MOV moffs8***,AL        TD      Valid   N.E.
- *      A3              MOV moffs16*,AX         TD      Valid   Valid
- *      A3              MOV moffs32*,EAX        TD      Valid   Valid
- *      REX.W + A3      MOV moffs64*,RAX        TD      Valid   N.E.
- *      B0+ rb ib       MOV r8,imm8             OI      Valid   Valid
- *      REX + B0+ rb ib MOV r8***,imm8          OI      Valid   N.E.
- *      B8+ rw iw       MOV r16,imm16           OI      Valid   Valid
- *      B8+ rd id       MOV r32,imm32           OI      Valid   Valid
- *      REX.W + B8+ rd io
- *                      MOV r64,imm64           OI      Valid   N.E.
- *      C6 /0 ib        MOV r/m8,imm8           MI      Valid   Valid
- *      REX + C6 /0 ib  MOV r/m8***,imm8        MI      Valid   N.E.
- *      C7 /0 iw        MOV r/m16,imm16         MI      Valid   Valid
- *      C7 /0 id        MOV r/m32,imm32         MI      Valid   Valid
- *      REX.W + C7 /0 io
- *                      MOV r/m64,imm32         MI      Valid   N.E.
- *
- *      *   The moffs8, moffs16, moffs32 and moffs64 operands specify a simple
- *          offset relative to the segment base, where 8, 16, 32 and 64 refer to
- *          the size of the data.  The address-size attribute of the instruction
- *          determines the size of the offset, either 16, 32 or 64 bits.
- *      **  In 32-bit mode, the assembler may insert the 16-bit operand-size
- *          prefix with this instruction
- *      *** In 64-bit mode, AH, BH, CH, DH cannot be accessed
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      MR      ModRM:r/m(w)    ModRM:reg(r)    NA              NA
- *      RM      ModRM:reg(w)    ModRM:r/m(r)    NA              NA
- *      FD      AL/AX/EAX/RAX   Moffs           NA              NA
- *      TD      Moffs(w)        AL/AX/EAX/RAX   NA              NA
- *      OI      opcode + rd(w)  imm8/16/32/64   NA              NA
- *      MI      ModRM:r/m(w)    imm8/16/32/64   NA              NA
- */
-static int
-_mov(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x88, -1, -1, ENC_MR_RM8_R8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x89, -1, -1, ENC_MR_RM16_R16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x89, -1, -1, ENC_MR_RM32_R32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x89, -1, -1, ENC_MR_RM64_R64, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x8a, -1, -1, ENC_RM_R8_RM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x8b, -1, -1, ENC_RM_R16_RM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x8b, -1, -1, ENC_RM_R32_RM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x8b, -1, -1, ENC_RM_R64_RM64, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xb0, -1, -1, ENC_OI_R8_IMM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xb8, -1, -1, ENC_OI_R16_IMM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xb8, -1, -1, ENC_OI_R32_IMM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0xb8, -1, -1, ENC_OI_R64_IMM64, -1));
-
-    /* FIXME: Support moffs */
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xc6, -1, -1, ENC_MI_RM8_IMM8, 0));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xc7, -1, -1, ENC_MI_RM16_IMM16, 0));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xc7, -1, -1, ENC_MI_RM32_IMM32, 0));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0xc7, -1, -1, ENC_MI_RM64_IMM32, 0));
-
-    return 0;
-}
-
-/*
- * MOVS/MOVSB/MOVSW/MOVSD/MOVSQ (Vol. 2B 4-85)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      A4              MOVS m8,m8              NP      Valid   Valid
- *      A5              MOVS m16,m16            NP      Valid   Valid
- *      A5              MOVS m32,m32            NP      Valid   Valid
- *      REX.W + A5      MOVS m64,m64            NP      Valid   N.E.
- *      A4              MOVSB                   NP      Valid   Valid
- *      A5              MOVSW                   NP      Valid   Valid
- *      A5              MOVSD                   NP      Valid   Valid
- *      REX.W + A5      MOVSQ                   NP      Valid   N.E.
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_movsb(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xa4, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-static int
-_movsw(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xa5, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-static int
-_movsd(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xa5, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-static int
-_movsq(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE64, 0xa5, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-
-/*
- * OUT (Vol. 2B 4-131)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      E6 ib           OUT imm8,AL             I       Valid   Valid
- *      E7 ib           OUT imm8,AX             I       Valid   Valid
- *      E7 ib           OUT imm8,EAX            I       Valid   Valid
- *      EE              OUT DX,AL               NP      Valid   Valid
- *      EF              OUT DX,AX               NP      Valid   Valid
- *      EF              OUT DX,EAX              NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      I       imm8            NA              NA              NA
- *      NP      NA              NA              NA              NA
- */
-static int
-_out(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xe6, -1, -1, ENC_I_IMM8_AL, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xe7, -1, -1, ENC_I_IMM8_AX, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xe7, -1, -1, ENC_I_IMM8_EAX, -1));
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xee, -1, -1, ENC_NP_DX_AL, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xef, -1, -1, ENC_NP_DX_AX, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xef, -1, -1, ENC_NP_DX_EAX, -1));
-
-    return 0;
-}
-
-/*
- * POP (Vol. 2B 4-263)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      8F /0           POP r/m16               M       Valid   Valid
- *      8F /0           POP r/m32               M       N.E.    Valid
- *      8F /0           POP r/m64               M       Valid   N.E.
- *      58+ rw          POP r16                 O       Valid   Valid
- *      58+ rd          POP r32                 O       N.E.    Valid
- *      58+ rd          POP r64                 O       Valid   N.E.
- *      1F              POP DS                  NP      Inv.    Valid
- *      07              POP ES                  NP      Inv.    Valid
- *      17              POP SS                  NP      Inv.    Valid
- *      0F A1           POP FS                  NP      Valid   Valid
- *      0F A1           POP FS                  NP      Inv.    Valid
- *      0F A1           POP FS                  NP      N.E.    Valid
- *      0F A9           POP GS                  NP      Valid   Valid
- *      0F A9           POP GS                  NP      Inv.    Valid
- *      0F A9           POP GS                  NP      N.E.    Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      M       ModR/M(r)       NA              NA              NA
- *      O       opcode+rd(r,w)  NA              NA              NA
- *      NP      NA              NA              NA              NA
- */
-static int
-_pop(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x8f, -1, -1, ENC_M_RM16, 0));
-    EC(binstr2(asmblr, xstmt, 0, 0x8f, -1, -1, ENC_M_RM64, 0));
-
-    //EC(binstr2(asmblr, xstmt, SIZE16, 0x58, -1, -1, ENC_O_R16, -1));
-    //EC(binstr2(asmblr, xstmt, 0, 0x58, -1, -1, ENC_O_R64, -1));
-
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0xa1, -1, ENC_NP_FS, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0xa9, -1, ENC_NP_GS, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0x8f, -1, -1, ENC_M_RM32, 0));*/
-    /*EC(binstr2(asmblr, xstmt, 0, 0x58, -1, -1, ENC_O_R32, -1));*/
-
-    return 0;
-}
-
-/*
- * POPA/POPAD (Vol. 2B 4-268)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      61              POPA                    NP      Inv.    Valid
- *      61              POPAD                   NP      Inv.    Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_popa(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, SIZE16, 0x61, -1, -1, ENC_NP, -1));*/
-
-    return 0;
-}
-static int
-_popad(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, SIZE32, 0x61, -1, -1, ENC_NP, -1));*/
-
-    return 0;
-}
-
-/*
- * POPCNT (Vol. 2B 4-270)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      F3 0F B8 /r     POPCNT r16,r/m16        RM      Valid   Valid
- *      F3 0F B8 /r     POPCNT r32,r/m32        RM      Valid   Valid
- *      F3 REX.W 0F B8 /r
- *                      POPCNT r64,r/m64        RM      Valid   N.E.
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      RM      ModRM:reg(w)    ModRM:r/m(r)
- */
-static int
-_popcnt(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    /* FIXME */
-    xstmt->prefix |= OPCODE_PREFIX_POPCNT;
-
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0xb8, -1, ENC_RM_R16_RM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x0f, 0xb8, -1, ENC_RM_R32_RM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0xb8, -1, ENC_RM_R64_RM64, -1));
-
-    return 0;
-}
-
-/*
- * PUSH (Vol. 2B 4-333)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      FF /6           PUSH r/m16              M       Valid   Valid
- *      FF /6           PUSH r/m32              M       N.E.    Valid
- *      FF /6           PUSH r/m64              M       Valid   N.E.
- *      50+ rw          PUSH r16                O       Valid   Valid
- *      50+ rd          PUSH r32                O       N.E.    Valid
- *      50+ rd          PUSH r64                O       Valid   N.E.
- *      6A ib           PUSH imm8               I       Valid   Valid
- *      6B iw           PUSH imm16              I       Valid   Valid
- *      6B id           PUSH imm32              I       Valid   Valid
- *      0E              PUSH CS                 NP      Inv.    Valid
- *      16              PUSH SS                 NP      Inv.    Valid
- *      1E              PUSH DS                 NP      Inv.    Valid
- *      06              PUSH ES                 NP      Inv.    Valid
- *      0F A0           PUSH FS                 NP      Valid   Valid
- *      0F A8           PUSH GS                 NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      M       ModR/M(r)       NA              NA              NA
- *      O       opcode+rd(r,w)  NA              NA              NA
- *      I       imm8/16/32      NA              NA              NA
- *      NP      NA              NA              NA              NA
- */
-static int
-_push(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xff, -1, -1, ENC_M_RM16, 6));
-    EC(binstr2(asmblr, xstmt, 0, 0xff, -1, -1, ENC_M_RM64, 6));
-
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x50, -1, -1, ENC_O_R16, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x50, -1, -1, ENC_O_R64, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x6a, -1, -1, ENC_I_IMM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x6b, -1, -1, ENC_I_IMM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x6b, -1, -1, ENC_I_IMM32, -1));
-
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0xa0, -1, ENC_NP_FS, -1));
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0xa8, -1, ENC_NP_GS, -1));
-
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, 0, 0xff, -1, -1, ENC_M_RM32, 6));*/
-    /*EC(binstr2(asmblr, xstmt, 0, 0x50, -1, -1, ENC_O_R32, -1));*/
-
-    return 0;
-}
-
-/*
- * PUSHA/PUSHAD (Vol. 2B 4-337)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      60              PUSHA                   NP      Inv.    Valid
- *      60              PUSHAD                  NP      Inv.    Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_pusha(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, SIZE16, 0x60, -1, -1, ENC_NP, -1));*/
-
-    return 0;
-}
-static int
-_pushad(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    /* Invalid for 64-bit mode */
-    /*EC(binstr2(asmblr, xstmt, SIZE32, 0x60, -1, -1, ENC_NP, -1));*/
-
-    return 0;
-}
-
-/*
- * RET (Vol. 2B 4-369)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      C3              RET                     NP      Valid   Valid
- *      CB              RET                     NP      Valid   Valid
- *      C2 iw           RET imm16               I       Valid   Valid
- *      CA iw           RET imm16               I       Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- *      I       imm16           NA              NA              NA
- */
-static int
-_ret(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_ret(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 {
     if ( OPCODE_SUFFIX_FAR & xstmt->suffix ) {
         /* w/ far */
@@ -2340,859 +357,799 @@ _ret(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 }
 
 /*
- * SFENCE (Vol. 2B 4-412)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F AE /7        MFENCE                  NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
- */
-static int
-_sfence(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0xae, -1, ENC_NP_PREG, 7));
-
-    return 0;
-}
-
-/*
- * SGDT (Vol. 2B 4-413)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F 01 /0        SGDT m                  M       Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      M       ModRM:r/m(r)    NA              NA              NA
- */
-static int
-_sgdt(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x01, -1, ENC_M_MUNSPEC, 0));
-
-    return 0;
-}
-
-/*
- * SIDT (Vol. 2B 4-427)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F 01 /1        SIDT m                  M       Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      M       ModRM:r/m(r)    NA              NA              NA
- */
-static int
-_sidt(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x01, -1, ENC_M_MUNSPEC, 1));
-
-    return 0;
-}
-
-/*
- * SLDT (Vol. 2B 4-429)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F 00 /0        SIDT r/m16              M       Valid   Valid
- *      REX.W + 0F 00 /0
- *                      SIDT r64/m16            M       Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      M       ModRM:r/m(r)    NA              NA              NA
- */
-static int
-_sldt(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x0f, 0x00, -1, ENC_M_RM16, 0));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x0f, 0x00, -1, ENC_M_R64, 0));
-
-    return 0;
-}
-
-/*
- * STI (Vol. 2B 4-441)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      FB              STI                     NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
+ * Row of the instruction specification (spec.def)
  */
-static int
-_sti(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0xfb, -1, -1, ENC_NP, -1));
+typedef struct _x86_64_spec {
+    const char *mnemonic;
+    ssize_t opsize;
+    int opc1;
+    int opc2;
+    int opc3;
+    x86_64_enc_t enc;
+    int preg;
+} x86_64_spec_t;
 
-    return 0;
-}
+static const x86_64_spec_t _specs[] = {
+#define X86_64_SPEC(m, sz, o1, o2, o3, enc, preg)                       \
+    { #m, (sz), (o1), (o2), (o3), ENC_##enc, (preg) },
+#include "spec.def"
+#undef X86_64_SPEC
+};
+#define X86_64_SPEC_NUM         (sizeof(_specs) / sizeof(x86_64_spec_t))
+
+/* Maximum number of the mnemonics (an ID is stored in an unsigned char) */
+#define X86_64_MNEMONIC_MAX     255
+/* Number of the operand counts that the rows are grouped by */
+#define X86_64_SPEC_NOPR        (INSTR_MAX_OPERANDS + 1)
 
 /*
- * STOS/STOSB/STOSW/STOSD/STOSQ (Vol. 2A 3-458)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      AA              STOS m8                 NP      Valid   Valid
- *      AB              STOS m16                NP      Valid   Valid
- *      AB              STOS m32                NP      Valid   Valid
- *      REX.W + AB      STOS m64                NP      Valid   N.E.
- *      AA              STOSB                   NP      Valid   Valid
- *      AB              STOSW                   NP      Valid   Valid
- *      AB              STOSD                   NP      Valid   Valid
- *      REX.W + AB      STOSQ                   NP      Valid   N.E.
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
+ * Indices of the rows sorted by the mnemonic ID and the number of operands
+ * (stable, i.e., in the order of spec.def within a group), and the start of
+ * each group in _spec_index; the rows of the mnemonic m with n operands are
+ * _spec_index[_spec_start[b]] to _spec_index[_spec_start[b + 1] - 1] where
+ * b = m * X86_64_SPEC_NOPR + n.  Built by _spec_init().
  */
-static int
-_stosb(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xaa, -1, -1, ENC_NP, -1));
-
-    return 0;
-}
-static int
-_stosw(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xab, -1, -1, ENC_NP, -1));
+static uint16_t _spec_index[X86_64_SPEC_NUM];
+static uint16_t _spec_start[X86_64_MNEMONIC_MAX * X86_64_SPEC_NOPR + 1];
 
-    return 0;
-}
+/*
+ * Assembler function of the mnemonics in the instruction specification; try
+ * only the rows of the mnemonic with the same number of operands
+ */
 static int
-_stosd(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_encode_spec(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 {
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xab, -1, -1, ENC_NP, -1));
+    const x86_64_spec_t *spec;
+    size_t nopr;
+    size_t b;
+    size_t i;
 
-    return 0;
-}
-static int
-_stosq(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, SIZE64, 0xab, -1, -1, ENC_NP, -1));
+    nopr = xstmt->nopr;
+    if ( nopr >= X86_64_SPEC_NOPR ) {
+        return 0;
+    }
+    b = (size_t)xstmt->mnemonic * X86_64_SPEC_NOPR + nopr;
+    for ( i = _spec_start[b]; i < _spec_start[b + 1]; i++ ) {
+        spec = &_specs[_spec_index[i]];
+        EC(binstr2(asmblr, xstmt, spec->opsize, spec->opc1, spec->opc2,
+                   spec->opc3, spec->enc, spec->preg));
+    }
 
     return 0;
 }
 
 /*
- * SUB (Vol. 2B 4-450)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      2C ib           SUB AL,imm8             I       Valid   Valid
- *      2D iw           SUB AX,imm16            I       Valid   Valid
- *      2D ib           SUB EAX,imm32           I       Valid   Valid
- *      REX.W + 2D id   SUB RAX,imm32           I       Valid   N.E.
- *      80 /5 ib        SUB r/m8,imm8           MI      Valid   Valid
- *      REX + 80 /5 ib  SUB r/m8*,imm8          MI      Valid   N.E.
- *      81 /5 iw        SUB r/m16,imm16         MI      Valid   Valid
- *      81 /5 id        SUB r/m32,imm32         MI      Valid   Valid
- *      REX.W + 81 /5 id
- *                      SUB r/m64,imm32         MI      Valid   N.E.
- *      83 /5 ib        SUB r/m16,imm8          MI      Valid   Valid
- *      83 /5 ib        SUB r/m32,imm8          MI      Valid   Valid
- *      REX.W + 83 /5 ib
- *                      SUB r/m64,imm8          MI      Valid   N.E.
- *      28 /r           SUB r/m8,r8             MR      Valid   Valid
- *      REX + 28 /r     SUB r/m8*,r8*           NR      Valid   N.E.
- *      29 /r           SUB r/m16,r16           MR      Valid   Valid
- *      29 /r           SUB r/m32,r32           MR      Valid   Valid
- *      REX.W + 29 /r   SUB r/m64,r64           MR      Valid   N.E.
- *      2A /r           SUB r8,r/m8             RM      Valid   Valid
- *      REX + 2A /r     SUB r8*,r/m8*           RM      Valid   Valid
- *      2B /r           SUB r16,r/m16           RM      Valid   Valid
- *      2B /r           SUB r32,r/m32           RM      Valid   Valid
- *      REX.W + 2B /r   SUB r64,r/m64           RM      Valid   N.E.
- *
- *      * In 64-bit mode, AH, BH, CH, DH cannot be accessed if a REX prefix is
- *        used
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      I       AL/AX/EAX/RAX   imm8/16/32      NA              NA
- *      MI      ModRM:r/m(r,w)  imm8/16/32      NA              NA
- *      MR      ModRM:r/m(r,w)  ModRM:reg(r)    NA              NA
- *      RM      ModRM:reg(r,w)  ModRM:r/m(r)    NA              NA
+ * Encode the instruction in the specification whose operands are all
+ * registers or fixed immediate values directly into the final instruction
+ * without candidates; return 1 if encoded, or 0 to fall back to the generic
+ * path.  The shortest fitting row (the first one among the same size) is
+ * selected as _fix_instr() does.
  */
 static int
-_sub(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_encode_fast(x86_64_stmt_t *xstmt)
 {
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x2c, -1, -1, ENC_I_AL_IMM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x2d, -1, -1, ENC_I_AX_IMM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x2d, -1, -1, ENC_I_EAX_IMM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x2d, -1, -1, ENC_I_RAX_IMM32, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x80, -1, -1, ENC_MI_RM8_IMM8, 5));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x81, -1, -1, ENC_MI_RM16_IMM16, 5));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x81, -1, -1, ENC_MI_RM32_IMM32, 5));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x81, -1, -1, ENC_MI_RM64_IMM32, 5));
-
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x83, -1, -1, ENC_MI_RM16_IMM8, 5));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x83, -1, -1, ENC_MI_RM32_IMM8, 5));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x83, -1, -1, ENC_MI_RM64_IMM8, 5));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x28, -1, -1, ENC_MR_RM8_R8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x29, -1, -1, ENC_MR_RM16_R16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x29, -1, -1, ENC_MR_RM32_R32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x29, -1, -1, ENC_MR_RM64_R64, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x2a, -1, -1, ENC_RM_R8_RM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x2b, -1, -1, ENC_RM_R16_RM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x2b, -1, -1, ENC_RM_R32_RM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x2b, -1, -1, ENC_RM_R64_RM64, -1));
+    const instr_t *instr;
+    const x86_64_spec_t *spec;
+    x86_64_instr_t tmp;
+    x86_64_instr_t sel;
+    size_t imin;
+    size_t sz;
+    size_t b;
+    size_t i;
+    int ret;
 
-    return 0;
+    instr = &xstmt->stmt->u.instr;
+    if ( _encode_spec != xstmt->ifunc || X86_64_O64 != xstmt->tgt
+         || 0 != xstmt->prefix || instr->nopr >= X86_64_SPEC_NOPR ) {
+        return 0;
+    }
+
+    /* Convert the operands */
+    for ( i = 0; i < instr->nopr; i++ ) {
+        if ( 0 != x86_64_convert_operand_simple(&instr->opr[i],
+                                                &xstmt->oprs[i]) ) {
+            return 0;
+        }
+    }
+    xstmt->nopr = instr->nopr;
+
+    /* Find the shortest encoding */
+    imin = 0;
+    b = (size_t)xstmt->mnemonic * X86_64_SPEC_NOPR + instr->nopr;
+    for ( i = _spec_start[b]; i < _spec_start[b + 1]; i++ ) {
+        spec = &_specs[_spec_index[i]];
+        ret = binstr2_fast(xstmt->oprs, xstmt->nopr, spec->opsize, spec->opc1,
+                           spec->opc2, spec->opc3, spec->enc, spec->preg,
+                           &tmp);
+        if ( ret < 0 ) {
+            /* Unusual; let the generic path handle it */
+            return 0;
+        } else if ( 0 == ret ) {
+            continue;
+        }
+        if ( !x86_64_check_size(tmp.imm.sz, tmp.imm.val) ) {
+            continue;
+        }
+        sz = x86_64_instr_size(&tmp);
+        if ( 0 == imin || sz < imin ) {
+            imin = sz;
+            sel = tmp;
+        }
+    }
+    if ( 0 == imin ) {
+        /* No encoding; the generic path reports the error */
+        return 0;
+    }
+
+    /* Fixed */
+    if ( 0 != _set_sinstr(xstmt, &sel) ) {
+        return 0;
+    }
+    xstmt->esize.min = imin;
+    xstmt->esize.max = imin;
+
+    return 1;
 }
 
+#define X86_64_MNEMONIC_NSLOTS          1024
+#define X86_64_MNEMONIC_SEED_TRIALS     4096
+
 /*
- * SYSCALL (Vol. 2B 4-460)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F 05           SYSCALL                 NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
+ * Kind of the mnemonic table entry
  */
-static int
-_syscall(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
-{
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x05, -1, ENC_NP, -1));
+typedef enum _x86_64_mnemonic_kind {
+    X86_64_MNEMONIC_INSTR,
+    X86_64_MNEMONIC_PREFIX,
+    X86_64_MNEMONIC_SUFFIX,
+} x86_64_mnemonic_kind_t;
 
-    return 0;
+/*
+ * Mnemonic table entry; the index in the table is the mnemonic ID
+ */
+typedef struct _x86_64_mnemonic {
+    const char *name;
+    size_t len;
+    x86_64_mnemonic_kind_t kind;
+    x86_64_instr_f ifunc;
+    int flag;
+} x86_64_mnemonic_t;
+
+/*
+ * Macros to register an assembler function, a mnemonic of the instruction
+ * specification, a prefix or a suffix into the mnemonic table
+ */
+#define X86_64_MNEMONIC(x)                                              \
+    { #x, sizeof(#x) - 1, X86_64_MNEMONIC_INSTR, _##x, 0 }
+#define X86_64_MNEMONIC_SPEC(x)                                         \
+    { #x, sizeof(#x) - 1, X86_64_MNEMONIC_INSTR, _encode_spec, 0 }
+#define X86_64_MNEMONIC_PREFIX(x, f)                                    \
+    { #x, sizeof(#x) - 1, X86_64_MNEMONIC_PREFIX, NULL, (f) }
+#define X86_64_MNEMONIC_SUFFIX(x, f)                                    \
+    { #x, sizeof(#x) - 1, X86_64_MNEMONIC_SUFFIX, NULL, (f) }
+
+static const x86_64_mnemonic_t _mnemonics[] = {
+    /* Prefixes */
+    X86_64_MNEMONIC_PREFIX(lock, OPCODE_PREFIX_LOCK),
+    X86_64_MNEMONIC_PREFIX(rep, OPCODE_PREFIX_REP),
+    X86_64_MNEMONIC_PREFIX(repe, OPCODE_PREFIX_REPE),
+    X86_64_MNEMONIC_PREFIX(repz, OPCODE_PREFIX_REPZ),
+    X86_64_MNEMONIC_PREFIX(repne, OPCODE_PREFIX_REPNE),
+    X86_64_MNEMONIC_PREFIX(repnz, OPCODE_PREFIX_REPNZ),
+    X86_64_MNEMONIC_PREFIX(brt, OPCODE_PREFIX_BRANCH_TAKEN),
+    X86_64_MNEMONIC_PREFIX(brn, OPCODE_PREFIX_BRANCH_NOT_TAKEN),
+    /* Suffixes */
+    X86_64_MNEMONIC_SUFFIX(far, OPCODE_SUFFIX_FAR),
+    /* Instructions */
+    X86_64_MNEMONIC_SPEC(add),
+    X86_64_MNEMONIC_SPEC(and),
+    X86_64_MNEMONIC_SPEC(bsf),
+    X86_64_MNEMONIC_SPEC(bsr),
+    X86_64_MNEMONIC_SPEC(bswap),
+    X86_64_MNEMONIC_SPEC(bt),
+    X86_64_MNEMONIC_SPEC(btc),
+    X86_64_MNEMONIC_SPEC(btr),
+    X86_64_MNEMONIC_SPEC(bts),
+    X86_64_MNEMONIC(call),
+    X86_64_MNEMONIC_SPEC(cbw),
+    X86_64_MNEMONIC_SPEC(cwde),
+    X86_64_MNEMONIC_SPEC(cdqe),
+    X86_64_MNEMONIC_SPEC(clc),
+    X86_64_MNEMONIC_SPEC(cld),
+    X86_64_MNEMONIC_SPEC(clflush),
+    X86_64_MNEMONIC_SPEC(cli),
+    X86_64_MNEMONIC_SPEC(cmp),
+    X86_64_MNEMONIC_SPEC(cmpxchg),
+    X86_64_MNEMONIC_SPEC(cpuid),
+    X86_64_MNEMONIC(crc32),
+    X86_64_MNEMONIC_SPEC(cwd),
+    X86_64_MNEMONIC_SPEC(cdq),
+    X86_64_MNEMONIC_SPEC(cqo),
+    X86_64_MNEMONIC_SPEC(daa),
+    X86_64_MNEMONIC_SPEC(das),
+    X86_64_MNEMONIC_SPEC(dec),
+    X86_64_MNEMONIC_SPEC(div),
+    X86_64_MNEMONIC_SPEC(hlt),
+    X86_64_MNEMONIC_SPEC(idiv),
+    X86_64_MNEMONIC_SPEC(imul),
+    X86_64_MNEMONIC_SPEC(in),
+    X86_64_MNEMONIC_SPEC(inc),
+    X86_64_MNEMONIC_SPEC(int),
+    X86_64_MNEMONIC(into),
+    X86_64_MNEMONIC_SPEC(iret),
+    X86_64_MNEMONIC_SPEC(iretd),
+    X86_64_MNEMONIC_SPEC(iretq),
+    X86_64_MNEMONIC_SPEC(ja),
+    X86_64_MNEMONIC_SPEC(jae),
+    X86_64_MNEMONIC_SPEC(jb),
+    X86_64_MNEMONIC_SPEC(jbe),
+    X86_64_MNEMONIC_SPEC(jc),
+    X86_64_MNEMONIC(jcxz),
+    X86_64_MNEMONIC(jecxz),
+    X86_64_MNEMONIC_SPEC(jrcxz),
+    X86_64_MNEMONIC_SPEC(je),
+    X86_64_MNEMONIC_SPEC(jg),
+    X86_64_MNEMONIC_SPEC(jge),
+    X86_64_MNEMONIC_SPEC(jl),
+    X86_64_MNEMONIC_SPEC(jle),
+    X86_64_MNEMONIC_SPEC(jna),
+    X86_64_MNEMONIC_SPEC(jnae),
+    X86_64_MNEMONIC_SPEC(jnb),
+    X86_64_MNEMONIC_SPEC(jnbe),
+    X86_64_MNEMONIC_SPEC(jnc),
+    X86_64_MNEMONIC_SPEC(jne),
+    X86_64_MNEMONIC_SPEC(jng),
+    X86_64_MNEMONIC_SPEC(jnge),
+    X86_64_MNEMONIC_SPEC(jnl),
+    X86_64_MNEMONIC_SPEC(jnle),
+    X86_64_MNEMONIC_SPEC(jno),
+    X86_64_MNEMONIC_SPEC(jnp),
+    X86_64_MNEMONIC_SPEC(jns),
+    X86_64_MNEMONIC_SPEC(jnz),
+    X86_64_MNEMONIC_SPEC(jo),
+    X86_64_MNEMONIC_SPEC(jp),
+    X86_64_MNEMONIC_SPEC(jpe),
+    X86_64_MNEMONIC_SPEC(jpo),
+    X86_64_MNEMONIC_SPEC(js),
+    X86_64_MNEMONIC_SPEC(jz),
+    X86_64_MNEMONIC(jmp),
+    X86_64_MNEMONIC_SPEC(lea),
+    X86_64_MNEMONIC_SPEC(leave),
+    X86_64_MNEMONIC_SPEC(lfence),
+    X86_64_MNEMONIC_SPEC(lgdt),
+    X86_64_MNEMONIC_SPEC(lidt),
+    X86_64_MNEMONIC_SPEC(lldt),
+    X86_64_MNEMONIC_SPEC(lodsb),
+    X86_64_MNEMONIC_SPEC(lodsw),
+    X86_64_MNEMONIC_SPEC(lodsd),
+    X86_64_MNEMONIC_SPEC(lodsq),
+    X86_64_MNEMONIC_SPEC(mfence),
+    X86_64_MNEMONIC_SPEC(monitor),
+    X86_64_MNEMONIC_SPEC(mov),
+    X86_64_MNEMONIC_SPEC(movsb),
+    X86_64_MNEMONIC_SPEC(movsw),
+    X86_64_MNEMONIC_SPEC(movsd),
+    X86_64_MNEMONIC_SPEC(movsq),
+    X86_64_MNEMONIC_SPEC(out),
+    X86_64_MNEMONIC_SPEC(pop),
+    X86_64_MNEMONIC(popa),
+    X86_64_MNEMONIC(popad),
+    X86_64_MNEMONIC(popcnt),
+    X86_64_MNEMONIC_SPEC(push),
+    X86_64_MNEMONIC(pusha),
+    X86_64_MNEMONIC(pushad),
+    X86_64_MNEMONIC(ret),
+    X86_64_MNEMONIC_SPEC(sfence),
+    X86_64_MNEMONIC_SPEC(sgdt),
+    X86_64_MNEMONIC_SPEC(sidt),
+    X86_64_MNEMONIC_SPEC(sldt),
+    X86_64_MNEMONIC_SPEC(sti),
+    X86_64_MNEMONIC_SPEC(stosb),
+    X86_64_MNEMONIC_SPEC(stosw),
+    X86_64_MNEMONIC_SPEC(stosd),
+    X86_64_MNEMONIC_SPEC(stosq),
+    X86_64_MNEMONIC_SPEC(sub),
+    X86_64_MNEMONIC_SPEC(syscall),
+    X86_64_MNEMONIC_SPEC(sysenter),
+    X86_64_MNEMONIC_SPEC(sysexit),
+    X86_64_MNEMONIC_SPEC(sysret),
+    X86_64_MNEMONIC_SPEC(test),
+    X86_64_MNEMONIC_SPEC(xchg),
+    X86_64_MNEMONIC_SPEC(xor),
+};
+#define X86_64_MNEMONIC_NUM     (sizeof(_mnemonics) / sizeof(x86_64_mnemonic_t))
+
+/* Perfect hash index of the mnemonic table (mnemonic ID + 1; 0 for empty) */
+static unsigned char _mnemonic_slots[X86_64_MNEMONIC_NSLOTS];
+static uint32_t _mnemonic_seed;
+static int _mnemonic_initialized = 0;
+
+/*
+ * Case-insensitive hash function of mnemonics
+ */
+static __inline__ size_t
+_mnemonic_hash(uint32_t seed, const char *s, size_t len)
+{
+    uint32_t h;
+    size_t i;
+
+    h = seed;
+    for ( i = 0; i < len; i++ ) {
+        h = (h ^ ((unsigned char)s[i] | 0x20)) * 16777619U;
+    }
+
+    return (h ^ (h >> 16)) & (X86_64_MNEMONIC_NSLOTS - 1);
 }
 
 /*
- * SYSENTER (Vol. 2B 4-462)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F 34           SYSENTER                NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
+ * Build the perfect hash index of the mnemonics and mark the interned
+ * (lowercase) mnemonics so that the mnemonic of a symbol is resolved by its ID
  */
 static int
-_sysenter(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_mnemonic_init(void)
 {
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x34, -1, ENC_NP, -1));
+    uint32_t seed;
+    size_t i;
+    size_t j;
+    sym_id_t id;
+
+    if ( _mnemonic_initialized ) {
+        return 0;
+    }
+
+    /* Search a seed without collision */
+    for ( seed = 2166136261U;
+          seed < 2166136261U + X86_64_MNEMONIC_SEED_TRIALS; seed++ ) {
+        (void)memset(_mnemonic_slots, 0, sizeof(_mnemonic_slots));
+        for ( i = 0; i < X86_64_MNEMONIC_NUM; i++ ) {
+            j = _mnemonic_hash(seed, _mnemonics[i].name, _mnemonics[i].len);
+            if ( 0 != _mnemonic_slots[j] ) {
+                /* Collision */
+                break;
+            }
+            _mnemonic_slots[j] = i + 1;
+        }
+        if ( i == X86_64_MNEMONIC_NUM ) {
+            /* Found */
+            break;
+        }
+    }
+    if ( i != X86_64_MNEMONIC_NUM ) {
+        return -1;
+    }
+    _mnemonic_seed = seed;
+
+    /* Intern the mnemonics */
+    for ( i = 0; i < X86_64_MNEMONIC_NUM; i++ ) {
+        id = intern_sym(_mnemonics[i].name, _mnemonics[i].len);
+        if ( SYM_ID_NONE == id ) {
+            return -1;
+        }
+        (void)intern_set_attr(id, X86_64_SYMATTR_MNEMONIC | i);
+    }
+
+    _mnemonic_initialized = 1;
 
     return 0;
 }
 
 /*
- * SYSEXIT (Vol. 2B 4-464)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F 35           SYSEXIT                 NP      Valid   Valid
- *      REX.W + 0F 35   SYSEXIT                 NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
+ * Search the mnemonic by its name (case-insensitive)
  */
-static int
-_sysexit(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+static const x86_64_mnemonic_t *
+_mnemonic_lookup(const char *s, size_t len)
 {
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x35, -1, ENC_NP, -1));
+    const x86_64_mnemonic_t *m;
+    int n;
 
-    return 0;
+    n = _mnemonic_slots[_mnemonic_hash(_mnemonic_seed, s, len)];
+    if ( 0 == n ) {
+        return NULL;
+    }
+    m = &_mnemonics[n - 1];
+    if ( m->len != len || 0 != strncasecmp(m->name, s, len) ) {
+        return NULL;
+    }
+
+    return m;
 }
 
 /*
- * SYSRET (Vol. 2B 4-467)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      0F 07           SYSRET                  NP      Valid   Valid
- *      REX.W + 0F 07   SYSRET                  NP      Valid   Valid
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      NP      NA              NA              NA              NA
+ * Get the mnemonic that the interned symbol names
  */
-static int
-_sysret(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+static const x86_64_mnemonic_t *
+_mnemonic_sym(sym_id_t id)
 {
-    EC(binstr2(asmblr, xstmt, 0, 0x0f, 0x07, -1, ENC_NP, -1));
+    int attr;
 
-    return 0;
+    attr = intern_attr(id);
+    if ( X86_64_SYMATTR_MNEMONIC == (attr & X86_64_SYMATTR_MASK) ) {
+        return &_mnemonics[attr & ~X86_64_SYMATTR_MASK];
+    } else if ( 0 != attr ) {
+        /* Register etc. */
+        return NULL;
+    }
+
+    /* Not in lowercase */
+    return _mnemonic_lookup(intern_str(id), intern_len(id));
 }
 
 /*
- * TEST (Vol. 2B 4-471)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      A8 ib           TEST AL,imm8            I       Valid   Valid
- *      A9 iw           TEST AX,imm16           I       Valid   Valid
- *      A9 id           TEST EAX,imm32          I       Valid   Valid
- *      REX.W + A9 id   TEST RAX,imm32          I       Valid   N.E.
- *      F6 /0 ib        TEST r/m8,imm8          MI      Valid   Valid
- *      REX + F6 /0 ib  TEST r/m8*,imm8         MI      Valid   N.E.
- *      F7 /0 iw        TEST r/m16,imm16        MI      Valid   Valid
- *      F7 /0 id        TEST r/m32,imm32        MI      Valid   Valid
- *      REX.W + F7 /0 id
- *                      TEST r/m64,imm32        MI      Valid   N.E.
- *      84 /r           TEST r/m8,r8            MR      Valid   Valid
- *      REX + 84 /r     TEST r/m8*,r8*          MR      Valid   N.E.
- *      85 /r           TEST r/m16,r16          MR      Valid   Valid
- *      85 /r           TEST r/m32,r32          MR      Valid   Valid
- *      REX.W + 85 /r   TEST r/m64,r64          MR      Valid   N.E.
- *
- *      * In 64-bit mode, AH, BH, CH, DH cannot be accessed if a REX prefix is
- *        used
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      I       AL/AX/EAX/RAX   imm8/16/32      NA              NA
- *      MI      ModRM:r/m(r)    imm8/16/32      NA              NA
- *      MR      ModRM:r/m(r)    ModRM:reg(r)    NA              NA
+ * Group the rows of the instruction specification by the mnemonic ID and the
+ * number of operands (counting sort)
  */
 static int
-_test(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_spec_init(void)
 {
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xa8, -1, -1, ENC_I_AL_IMM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xa9, -1, -1, ENC_I_AX_IMM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xa9, -1, -1, ENC_I_EAX_IMM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0xa9, -1, -1, ENC_I_RAX_IMM32, -1));
+    const x86_64_mnemonic_t *m;
+    int nopr;
+    size_t b;
+    size_t i;
+    size_t bkt[X86_64_SPEC_NUM];
+
+    if ( X86_64_MNEMONIC_NUM > X86_64_MNEMONIC_MAX ) {
+        return -1;
+    }
+
+    /* Count the rows of each group */
+    (void)memset(_spec_start, 0, sizeof(_spec_start));
+    for ( i = 0; i < X86_64_SPEC_NUM; i++ ) {
+        m = _mnemonic_sym(intern_find(_specs[i].mnemonic,
+                                      strlen(_specs[i].mnemonic)));
+        if ( NULL == m || _encode_spec != m->ifunc ) {
+            /* Not registered with X86_64_MNEMONIC_SPEC() */
+            return -1;
+        }
+        nopr = binstr2_nopr(_specs[i].enc);
+        if ( nopr < 0 ) {
+            /* Not supported by binstr2(); never matches */
+            bkt[i] = X86_64_MNEMONIC_MAX * X86_64_SPEC_NOPR;
+            continue;
+        }
+        bkt[i] = (size_t)(m - _mnemonics) * X86_64_SPEC_NOPR + nopr;
+        _spec_start[bkt[i] + 1]++;
+    }
 
-    EC(binstr2(asmblr, xstmt, SIZE8, 0xf6, -1, -1, ENC_MI_RM8_IMM8, 0));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0xf7, -1, -1, ENC_MI_RM16_IMM16, 0));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0xf7, -1, -1, ENC_MI_RM32_IMM32, 0));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0xf7, -1, -1, ENC_MI_RM64_IMM32, 0));
+    /* Start of each group */
+    for ( b = 0; b < X86_64_MNEMONIC_MAX * X86_64_SPEC_NOPR; b++ ) {
+        _spec_start[b + 1] += _spec_start[b];
+    }
 
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x84, -1, -1, ENC_MR_RM8_R8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x85, -1, -1, ENC_MR_RM16_R16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x85, -1, -1, ENC_MR_RM32_R32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x85, -1, -1, ENC_MR_RM64_R64, -1));
+    /* Place the rows in the order of spec.def */
+    for ( i = 0; i < X86_64_SPEC_NUM; i++ ) {
+        if ( bkt[i] < X86_64_MNEMONIC_MAX * X86_64_SPEC_NOPR ) {
+            _spec_index[_spec_start[bkt[i]]++] = i;
+        }
+    }
+    /* Restore the start of each group shifted by the placement */
+    for ( b = X86_64_MNEMONIC_MAX * X86_64_SPEC_NOPR; b > 0; b-- ) {
+        _spec_start[b] = _spec_start[b - 1];
+    }
+    _spec_start[0] = 0;
 
     return 0;
 }
 
 /*
- * XCHG (Vol. 2B 4-525)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      90+rw           XCHG AX,r16             O       Valid   Valid
- *      90+rw           XCHG r16,AX             O       Valid   Valid
- *      90+rd           XCHG EAX,r32            O       Valid   Valid
- *      REX.W + 90+rd   XCHG RAX,r64            O       Valid   N.E.
- *      90+rd           XCHG r32,EAX            O       Valid   Valid
- *      REX.W + 90+rd   XCHG r64,RAX            O       Valid   N.E.
- *      86 /r           XCHG r/m8,r8            MR      Valid   Valid
- *      REX + 86 /r     XCHG r/m8*,r8*          MR      Valid   N.E.
- *      86 /r           XCHG r8,r/m8            RM      Valid   Valid
- *      REX + 86 /r     XCHG r8*,r/m8*          RM      Valid   N.E.
- *      87 /r           XCHG r/m16,r16          MR      Valid   Valid
- *      87 /r           XCHG r16,r/m16          RM      Valid   Valid
- *      87 /r           XCHG r/m32,r32          MR      Valid   Valid
- *      REX.W + 87 /r   XCHG r/m64,r64          MR      Valid   N.E.
- *      87 /r           XCHG r32,r/m32          RM      Valid   Valid
- *      REX.W + 87 /r   XCHG r64,r/m64          RM      Valid   N.E.
- *
- *      * In 64-bit mode, AH, BH, CH, DH cannot be accessed
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      I       AL/AX/EAX/RAX   imm8/16/32      NA              NA
- *      MI      ModRM:r/m(w)    imm8/16/32      NA              NA
- *      MR      ModRM:r/m(r,w)  ModRM:reg(r)    NA              NA
- *      RM      ModRM:reg(r,w)  ModRM:r/m(r)    NA              NA
+ * Print the opcode, i.e., the mnemonic with its prefixes and suffixes
  */
-static int
-_xchg(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+static void
+_print_opcode(const x86_64_assembler_t *asmblr, const instr_t *instr)
 {
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x90, -1, -1, ENC_O_AX_R16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x90, -1, -1, ENC_O_R16_AX, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x90, -1, -1, ENC_O_EAX_R32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x90, -1, -1, ENC_O_RAX_R64, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x90, -1, -1, ENC_O_R32_EAX, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x90, -1, -1, ENC_O_R64_RAX, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x86, -1, -1, ENC_MR_RM8_R8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x86, -1, -1, ENC_RM_R8_RM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x87, -1, -1, ENC_MR_RM16_R16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x87, -1, -1, ENC_RM_R16_RM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x87, -1, -1, ENC_MR_RM32_R32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x87, -1, -1, ENC_MR_RM64_R64, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x87, -1, -1, ENC_RM_R32_RM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x87, -1, -1, ENC_RM_R64_RM64, -1));
+    size_t i;
 
-    return 0;
+    for ( i = 0; i < asmblr->icode->nfix; i++ ) {
+        if ( instr->prefix & ((uint32_t)1 << i) ) {
+            fprintf(asmblr->err, " %s", intern_str(asmblr->icode->fix[i]));
+        }
+    }
+    fprintf(asmblr->err, " %s", intern_str(instr->mnemonic));
+    for ( i = 0; i < asmblr->icode->nfix; i++ ) {
+        if ( instr->suffix & ((uint32_t)1 << i) ) {
+            fprintf(asmblr->err, " %s", intern_str(asmblr->icode->fix[i]));
+        }
+    }
 }
 
 /*
- * XOR (Vol. 2B 4-531)
- *
- *      Opcode          Instruction             Op/En   64-bit  Compat/Leg
- *      34 ib           XOR AL,imm8             I       Valid   Valid
- *      35 iw           XOR AX,imm16            I       Valid   Valid
- *      35 id           XOR EAX,imm32           I       Valid   Valid
- *      REX.W + 35 id   XOR RAX,imm32           I       Valid   N.E.
- *      80 /6 ib        XOR r/m8,imm8           MI      Valid   Valid
- *      REX + 80 /6 ib  XOR r/m8*,imm8          MI      Valid   N.E.
- *      81 /6 iw        XOR r/m16,imm16         MI      Valid   Valid
- *      81 /6 id        XOR r/m32,imm32         MI      Valid   Valid
- *      REX.W + 81 /6 id
- *                      XOR r/m64,imm32         MI      Valid   N.E.
- *      83 /6 ib        XOR r/m16,imm8          MI      Valid   Valid
- *      83 /6 ib        XOR r/m32,imm8          MI      Valid   Valid
- *      REX.W + 83 /6 ib
- *                      XOR r/m64,imm8          MI      Valid   N.E.
- *      30 /r           XOR r/m8,r8             MR      Valid   Valid
- *      REX + 30 /r     XOR r/m8*,r8*           MR      Valid   N.E.
- *      31 /r           XOR r/m16,r16           MR      Valid   Valid
- *      31 /r           XOR r/m32,r32           MR      Valid   Valid
- *      REX.W + 31 /r   XOR r/m64,r64           MR      Valid   N.E.
- *      32 /r           XOR r8,r/m8             RM      Valid   Valid
- *      REX + 32 /r     XOR r8*,r/m8*           RM      Valid   N.E.
- *      33 /r           XOR r16,r/m16           RM      Valid   Valid
- *      33 /r           XOR r32,r/m32           RM      Valid   Valid
- *      REX.W + 33 /r   XOR r64,r/m64           RM      Valid   N.E.
- *
- *      * In 64-bit mode, AH, BH, CH, DH cannot be accessed
- *
- *
- *      Op/En   Operand1        Operand2        Operand3        Operand4
- *      I       AL/AX/EAX/RAX   imm8/16/32      NA              NA
- *      MI      ModRM:r/m(w)    imm8/16/32      NA              NA
- *      MR      ModRM:r/m(r,w)  ModRM:reg(r)    NA              NA
- *      RM      ModRM:reg(r,w)  ModRM:r/m(r)    NA              NA
+ * Resolve the flags of the *fixes in the mask, which all must be of the kind
  */
 static int
-_xor(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_resolv_fixes(const x86_64_assembler_t *asmblr, uint32_t mask,
+              x86_64_mnemonic_kind_t kind, int *flags)
 {
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x34, -1, -1, ENC_I_AL_IMM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x35, -1, -1, ENC_I_AX_IMM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x35, -1, -1, ENC_I_EAX_IMM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x35, -1, -1, ENC_I_RAX_IMM32, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x80, -1, -1, ENC_MI_RM8_IMM8, 6));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x81, -1, -1, ENC_MI_RM16_IMM16, 6));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x81, -1, -1, ENC_MI_RM32_IMM32, 6));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x81, -1, -1, ENC_MI_RM64_IMM32, 6));
-
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x83, -1, -1, ENC_MI_RM16_IMM8, 6));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x83, -1, -1, ENC_MI_RM32_IMM8, 6));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x83, -1, -1, ENC_MI_RM64_IMM8, 6));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x30, -1, -1, ENC_MR_RM8_R8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x31, -1, -1, ENC_MR_RM16_R16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x31, -1, -1, ENC_MR_RM32_R32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x31, -1, -1, ENC_MR_RM64_R64, -1));
-
-    EC(binstr2(asmblr, xstmt, SIZE8, 0x32, -1, -1, ENC_RM_R8_RM8, -1));
-    EC(binstr2(asmblr, xstmt, SIZE16, 0x33, -1, -1, ENC_RM_R16_RM16, -1));
-    EC(binstr2(asmblr, xstmt, SIZE32, 0x33, -1, -1, ENC_RM_R32_RM32, -1));
-    EC(binstr2(asmblr, xstmt, SIZE64, 0x33, -1, -1, ENC_RM_R64_RM64, -1));
+    const x86_64_mnemonic_t *m;
+    size_t i;
+
+    *flags = 0;
+    for ( i = 0; i < asmblr->icode->nfix; i++ ) {
+        if ( mask & ((uint32_t)1 << i) ) {
+            m = _mnemonic_sym(asmblr->icode->fix[i]);
+            if ( NULL == m || kind != m->kind ) {
+                return -1;
+            }
+            *flags |= m->flag;
+        }
+    }
 
     return 0;
 }
 
-
-/*
- * A macro to register an assembler function into this file
- */
-#define REGISTER_INSTR(f, str, x) do {          \
-        if ( 0 == strcasecmp(#x, (str)) ) {     \
-            (f) = _##x;                         \
-        }                                       \
-    } while ( 0 )
-
 /*
  * Get the function pointer w/ instruction prefixes corresponding to the opcode
  */
 static int
-_resolv_instr(x86_64_stmt_t *xstmt)
+_resolv_instr(const x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 {
-    x86_64_instr_f ifunc;
-    char *str;
-    int i;
+    const instr_t *instr;
+    const x86_64_mnemonic_t *m;
     int tmpprefix;
     int tmpsuffix;
 
-    ifunc = NULL;
+    instr = &xstmt->stmt->u.instr;
 
-    if ( mvector_size(xstmt->stmt->u.instr->opcode) < 1 ) {
-        /* No opcode found */
+    /* Parse prefixes */
+    if ( 0 != _resolv_fixes(asmblr, instr->prefix, X86_64_MNEMONIC_PREFIX,
+                            &tmpprefix) ) {
         return -1;
     }
 
-    /* Parse prefixes */
-    tmpprefix = 0;
-    for ( i = 0; i < mvector_size(xstmt->stmt->u.instr->opcode); i++ ) {
-        str = mvector_at(xstmt->stmt->u.instr->opcode, i);
-        if ( 0 == strcasecmp(str, "lock") ) {
-            tmpprefix |= OPCODE_PREFIX_LOCK;
-        } else if ( 0 == strcasecmp(str, "rep") ) {
-            tmpprefix |= OPCODE_PREFIX_REP;
-        } else if ( 0 == strcasecmp(str, "repe") ) {
-            tmpprefix |= OPCODE_PREFIX_REPE;
-        } else if ( 0 == strcasecmp(str, "repz") ) {
-            tmpprefix |= OPCODE_PREFIX_REPZ;
-        } else if ( 0 == strcasecmp(str, "repne") ) {
-            tmpprefix |= OPCODE_PREFIX_REPNE;
-        } else if ( 0 == strcasecmp(str, "repnz") ) {
-            tmpprefix |= OPCODE_PREFIX_REPNZ;
-        } else if ( 0 == strcasecmp(str, "brt") ) {
-            tmpprefix |= OPCODE_PREFIX_BRANCH_TAKEN;
-        } else if ( 0 == strcasecmp(str, "brn") ) {
-            tmpprefix |= OPCODE_PREFIX_BRANCH_NOT_TAKEN;
-        } else {
-            break;
-        }
+    /* Opcode */
+    m = _mnemonic_sym(instr->mnemonic);
+    if ( NULL == m || X86_64_MNEMONIC_INSTR != m->kind ) {
+        /* Not found */
+        return -1;
     }
 
-   /* Opcode */
-   if ( i < mvector_size(xstmt->stmt->u.instr->opcode) ) {
-       str = mvector_at(xstmt->stmt->u.instr->opcode, i);
-       REGISTER_INSTR(ifunc, str, add);
-       REGISTER_INSTR(ifunc, str, and);
-       REGISTER_INSTR(ifunc, str, bsf);
-       REGISTER_INSTR(ifunc, str, bsr);
-       REGISTER_INSTR(ifunc, str, bswap);
-       REGISTER_INSTR(ifunc, str, bt);
-       REGISTER_INSTR(ifunc, str, btc);
-       REGISTER_INSTR(ifunc, str, btr);
-       REGISTER_INSTR(ifunc, str, bts);
-       REGISTER_INSTR(ifunc, str, call);
-       REGISTER_INSTR(ifunc, str, cbw);
-       REGISTER_INSTR(ifunc, str, cwde);
-       REGISTER_INSTR(ifunc, str, cdqe);
-       REGISTER_INSTR(ifunc, str, clc);
-       REGISTER_INSTR(ifunc, str, cld);
-       REGISTER_INSTR(ifunc, str, clflush);
-       REGISTER_INSTR(ifunc, str, cli);
-       REGISTER_INSTR(ifunc, str, cmp);
-       REGISTER_INSTR(ifunc, str, cmpxchg);
-       REGISTER_INSTR(ifunc, str, cpuid);
-       REGISTER_INSTR(ifunc, str, crc32);
-       REGISTER_INSTR(ifunc, str, cwd);
-       REGISTER_INSTR(ifunc, str, cdq);
-       REGISTER_INSTR(ifunc, str, cqo);
-       REGISTER_INSTR(ifunc, str, daa);
-       REGISTER_INSTR(ifunc, str, das);
-       REGISTER_INSTR(ifunc, str, dec);
-       REGISTER_INSTR(ifunc, str, div);
-       REGISTER_INSTR(ifunc, str, hlt);
-       REGISTER_INSTR(ifunc, str, idiv);
-       REGISTER_INSTR(ifunc, str, imul);
-       REGISTER_INSTR(ifunc, str, in);
-       REGISTER_INSTR(ifunc, str, inc);
-       REGISTER_INSTR(ifunc, str, int);
-       REGISTER_INSTR(ifunc, str, into);
-       REGISTER_INSTR(ifunc, str, iret);
-       REGISTER_INSTR(ifunc, str, iretd);
-       REGISTER_INSTR(ifunc, str, iretq);
-       REGISTER_INSTR(ifunc, str, ja);
-       REGISTER_INSTR(ifunc, str, jae);
-       REGISTER_INSTR(ifunc, str, jb);
-       REGISTER_INSTR(ifunc, str, jbe);
-       REGISTER_INSTR(ifunc, str, jc);
-       REGISTER_INSTR(ifunc, str, jcxz);
-       REGISTER_INSTR(ifunc, str, jecxz);
-       REGISTER_INSTR(ifunc, str, jrcxz);
-       REGISTER_INSTR(ifunc, str, je);
-       REGISTER_INSTR(ifunc, str, jg);
-       REGISTER_INSTR(ifunc, str, jge);
-       REGISTER_INSTR(ifunc, str, jl);
-       REGISTER_INSTR(ifunc, str, jle);
-       REGISTER_INSTR(ifunc, str, jna);
-       REGISTER_INSTR(ifunc, str, jnae);
-       REGISTER_INSTR(ifunc, str, jnb);
-       REGISTER_INSTR(ifunc, str, jnbe);
-       REGISTER_INSTR(ifunc, str, jnc);
-       REGISTER_INSTR(ifunc, str, jne);
-       REGISTER_INSTR(ifunc, str, jng);
-       REGISTER_INSTR(ifunc, str, jnge);
-       REGISTER_INSTR(ifunc, str, jnl);
-       REGISTER_INSTR(ifunc, str, jnle);
-       REGISTER_INSTR(ifunc, str, jno);
-       REGISTER_INSTR(ifunc, str, jnp);
-       REGISTER_INSTR(ifunc, str, jns);
-       REGISTER_INSTR(ifunc, str, jnz);
-       REGISTER_INSTR(ifunc, str, jo);
-       REGISTER_INSTR(ifunc, str, jp);
-       REGISTER_INSTR(ifunc, str, jpe);
-       REGISTER_INSTR(ifunc, str, jpo);
-       REGISTER_INSTR(ifunc, str, js);
-       REGISTER_INSTR(ifunc, str, jz);
-       REGISTER_INSTR(ifunc, str, jmp);
-       REGISTER_INSTR(ifunc, str, lea);
-       REGISTER_INSTR(ifunc, str, leave);
-       REGISTER_INSTR(ifunc, str, lfence);
-       REGISTER_INSTR(ifunc, str, lgdt);
-       REGISTER_INSTR(ifunc, str, lidt);
-       REGISTER_INSTR(ifunc, str, lldt);
-       REGISTER_INSTR(ifunc, str, lodsb);
-       REGISTER_INSTR(ifunc, str, lodsw);
-       REGISTER_INSTR(ifunc, str, lodsd);
-       REGISTER_INSTR(ifunc, str, lodsq);
-       REGISTER_INSTR(ifunc, str, mfence);
-       REGISTER_INSTR(ifunc, str, monitor);
-       REGISTER_INSTR(ifunc, str, mov);
-       REGISTER_INSTR(ifunc, str, movsb);
-       REGISTER_INSTR(ifunc, str, movsw);
-       REGISTER_INSTR(ifunc, str, movsd);
-       REGISTER_INSTR(ifunc, str, movsq);
-       REGISTER_INSTR(ifunc, str, out);
-       REGISTER_INSTR(ifunc, str, pop);
-       REGISTER_INSTR(ifunc, str, popa);
-       REGISTER_INSTR(ifunc, str, popad);
-       REGISTER_INSTR(ifunc, str, popcnt);
-       REGISTER_INSTR(ifunc, str, push);
-       REGISTER_INSTR(ifunc, str, pusha);
-       REGISTER_INSTR(ifunc, str, pushad);
-       REGISTER_INSTR(ifunc, str, ret);
-       REGISTER_INSTR(ifunc, str, sfence);
-       REGISTER_INSTR(ifunc, str, sgdt);
-       REGISTER_INSTR(ifunc, str, sidt);
-       REGISTER_INSTR(ifunc, str, sldt);
-       REGISTER_INSTR(ifunc, str, sti);
-       REGISTER_INSTR(ifunc, str, stosb);
-       REGISTER_INSTR(ifunc, str, stosw);
-       REGISTER_INSTR(ifunc, str, stosd);
-       REGISTER_INSTR(ifunc, str, stosq);
-       REGISTER_INSTR(ifunc, str, sub);
-       REGISTER_INSTR(ifunc, str, syscall);
-       REGISTER_INSTR(ifunc, str, sysenter);
-       REGISTER_INSTR(ifunc, str, sysexit);
-       REGISTER_INSTR(ifunc, str, sysret);
-       REGISTER_INSTR(ifunc, str, test);
-       REGISTER_INSTR(ifunc, str, xchg);
-       REGISTER_INSTR(ifunc, str, xor);
-   } else {
-       return -1;
-   }
-   i++;
-
-   /* Check if the function is found */
-   if ( NULL == ifunc ) {
-       return -1;
-   }
-
     /* Parse suffixes */
-    tmpsuffix = 0;
-    for ( ; i < mvector_size(xstmt->stmt->u.instr->opcode); i++ ) {
-        str = mvector_at(xstmt->stmt->u.instr->opcode, i);
-        if ( 0 == strcasecmp(str, "far") ) {
-            tmpsuffix |= OPCODE_SUFFIX_FAR;
-        } else {
-            break;
-        }
-    }
-
-    if ( i != mvector_size(xstmt->stmt->u.instr->opcode) ) {
+    if ( 0 != _resolv_fixes(asmblr, instr->suffix, X86_64_MNEMONIC_SUFFIX,
+                            &tmpsuffix) ) {
         return -1;
     }
 
     /* Set the values */
+    xstmt->mnemonic = m - _mnemonics;
+    xstmt->ifunc = m->ifunc;
     xstmt->prefix = tmpprefix;
     xstmt->suffix = tmpsuffix;
-    xstmt->ifunc = ifunc;
 
     return 0;
 }
 
+/*
+ * Build the selected candidate, set it to the statement and release the
+ * candidates
+ */
 static int
-_check_size(size_t sz, int64_t val)
+_select_cand(x86_64_stmt_t *xstmt, const x86_64_cand_t *cand)
 {
-    switch ( sz ) {
-    case SIZE8:
-        if ( val >= -128 && val <= 127 ) {
-            return 1;
-        }
-        break;
-    case SIZE16:
-        if ( val >= -32768 && val <= 32767 ) {
-            return 1;
-        }
-        break;
-    case SIZE32:
-        if ( val >= -2147483648 && val <= 2147483647 ) {
-            return 1;
-        }
-        break;
-    case SIZE64:
-        return 1;
-    default:
-        if ( 0 == val ) {
-            return 1;
-        }
+    x86_64_instr_t instr;
+
+    if ( 0 != binstr2_materialize(xstmt, cand, &instr) ) {
+        return -1;
+    }
+    if ( 0 != _set_sinstr(xstmt, &instr) ) {
+        return -1;
     }
+    x86_64_cand_vector_delete(xstmt->cands);
+    xstmt->cands = NULL;
 
     return 0;
 }
 
 /*
- * Fix instructions
+ * Fix instructions, or start the relaxation of the instruction at its
+ * shortest candidate (among all the candidates if no constant value fits,
+ * which is left to stage 3 as is)
  */
 static int
 _fix_instr(x86_64_stmt_t *xstmt)
 {
-    int i;
+    size_t i;
+    int mi;
+    int ai;
     size_t imin;
-    size_t imax;
+    size_t amin;
     size_t sz;
-    x86_64_instr_t *instr;
-    x86_64_instr_t *minstr;
+    const x86_64_cand_t *cand;
+    const x86_64_cand_t *mcand;
     int fixed;
 
     /* Fix the optimal instruction if possible */
     imin = 0;
-    imax = 0;
-    instr = NULL;
-    minstr = NULL;
+    amin = 0;
+    cand = NULL;
+    mcand = NULL;
+    mi = -1;
+    ai = -1;
     fixed = 1;
-    for ( i = 0; i < mvector_size(xstmt->instrs); i++ ) {
-        instr = mvector_at(xstmt->instrs, i);
-        if ( NULL != instr->disp.expr || NULL != instr->imm.expr
-             || 0 != instr->rel.sz ) {
+    for ( i = 0; i < x86_64_cand_vector_size(xstmt->cands); i++ ) {
+        cand = x86_64_cand_vector_ref(xstmt->cands, i);
+        if ( NULL != cand->disp.expr || NULL != cand->imm.expr
+             || 0 != cand->rel.sz ) {
             /* Not fixed */
             fixed = 0;
         }
 
+        sz = cand->sz;
+        if ( 0 == amin || sz < amin ) {
+            amin = sz;
+            ai = i;
+        }
+
         /* Check the operands whether they are acceptable values */
-        if ( !_check_size(instr->disp.sz, instr->disp.val)
-             || !_check_size(instr->imm.sz, instr->imm.val)
-             || !_check_size(instr->rel.sz, instr->rel.val) ) {
+        if ( !cand->fit ) {
             continue;
         }
 
-        sz = _instr_size(instr);
         if ( 0 == imin || sz < imin ) {
             /* Update minimum */
             imin = sz;
-            minstr = instr;
-        }
-        if ( sz > imax ) {
-            imax = sz;
+            mcand = cand;
+            mi = i;
         }
     }
+    if ( 0 == amin ) {
+        return -EOPERAND;
+    }
     if ( 0 == imin ) {
+        /* No constant value fits */
+        xstmt->rcand = ai;
+        xstmt->esize.min = amin;
+        xstmt->esize.max = amin;
         return -EOPERAND;
     }
 
     if ( fixed ) {
         /* Fixed */
-        xstmt->sinstr = minstr;
-        xstmt->esize.min = imin;
-        xstmt->esize.max = imin;
+        if ( 0 != _select_cand(xstmt, mcand) ) {
+            return -EUNKNOWN;
+        }
     } else {
-        /* Not fixed yet */
-        xstmt->esize.min = imin;
-        xstmt->esize.max = imax;
+        /* Not fixed yet; start from the shortest one */
+        xstmt->rcand = mi;
     }
+    xstmt->esize.min = imin;
+    xstmt->esize.max = imin;
 
     return 0;
 }
 
 /*
- * Fix instructions
+ * Does the candidate fit at the current position of the statement?  Return 1
+ * if it fits, 0 if not, or -1 on error
  */
 static int
-_fix_instr2(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_cand_fit(x86_64_assembler_t *asmblr, const x86_64_stmt_t *xstmt,
+          const x86_64_cand_t *cand)
 {
-    int i;
-    size_t imin;
-    size_t imax;
     int64_t loff;
     int64_t roff;
     size_t sz;
-    x86_64_instr_t *instr;
-    x86_64_instr_t *minstr;
     int ret;
 
-    /* Fix the optimal instruction if possible */
-    imin = 0;
-    imax = 0;
-    instr = NULL;
-    minstr = NULL;
-    for ( i = 0; i < mvector_size(xstmt->instrs); i++ ) {
-        /* Check if the optimal instruction is fixed */
-        if ( NULL != xstmt->sinstr ) {
-            /* Already fixed */
-            continue;
-        }
-
-        /* Obtain a candidate instruction */
-        instr = mvector_at(xstmt->instrs, i);
-
-        /* Obtain the size of the instruction */
-        sz = _instr_size(instr);
+    /* Obtain the size of the instruction */
+    sz = cand->sz;
 
-        /* Check whether they are capable values */
-        if ( NULL != instr->disp.expr ) {
-            /* Displacement is relocatable */
-            ret = x86_64_expr_range(&asmblr->lbtbl, instr->disp.expr, &loff,
-                                    &roff);
-            if ( ret < 0 ) {
-                return -1;
-            }
-            if ( !_check_size(instr->disp.sz, loff)
-                 || !_check_size(instr->disp.sz, roff) ) {
-                continue;
-            }
+    /* Check whether they are capable values */
+    if ( NULL != cand->disp.expr ) {
+        /* Displacement is relocatable */
+        ret = x86_64_expr_range(&asmblr->lbtbl, cand->disp.expr, &loff,
+                                &roff);
+        if ( ret < 0 ) {
+            return -1;
+        }
+        if ( !x86_64_check_size(cand->disp.sz, loff)
+             || !x86_64_check_size(cand->disp.sz, roff) ) {
+            return 0;
+        }
+    }
+    if ( NULL != cand->imm.expr ) {
+        /* Immediate value is relocatable */
+        ret = x86_64_expr_range(&asmblr->lbtbl, cand->imm.expr, &loff,
+                                &roff);
+        if ( ret < 0 ) {
+            return -1;
+        }
+        if ( !x86_64_check_size(cand->imm.sz, loff)
+             || !x86_64_check_size(cand->imm.sz, roff) ) {
+            return 0;
         }
-        if ( NULL != instr->imm.expr ) {
-            /* Immediate value is relocatable */
-            ret = x86_64_expr_range(&asmblr->lbtbl, instr->imm.expr, &loff,
+    }
+    if ( 0 != cand->rel.sz ) {
+        /* Relative value */
+        if ( NULL == cand->rel.expr ) {
+            //loff = cand->rel.val - xstmt->epos.max - sz;
+            //roff = cand->rel.val - xstmt->epos.min - sz;
+            loff = X86_64_VAR_MIN;
+            roff = X86_64_VAR_MAX;
+            if ( !x86_64_check_size(cand->rel.sz, loff)
+                 || !x86_64_check_size(cand->rel.sz, roff) ) {
+                return 0;
+            }
+        } else {
+            ret = x86_64_expr_range(&asmblr->lbtbl, cand->rel.expr, &loff,
                                     &roff);
             if ( ret < 0 ) {
                 return -1;
             }
-            if ( !_check_size(instr->imm.sz, loff)
-                 || !_check_size(instr->imm.sz, roff) ) {
-                continue;
-            }
-        }
-        if ( 0 != instr->rel.sz ) {
-            /* Relative value */
-            if ( NULL == instr->rel.expr ) {
-                //loff = instr->rel.val - xstmt->epos.max - sz;
-                //roff = instr->rel.val - xstmt->epos.min - sz;
-                loff = X86_64_VAR_MIN;
-                roff = X86_64_VAR_MAX;
-                if ( !_check_size(instr->rel.sz, loff)
-                     || !_check_size(instr->rel.sz, roff) ) {
-                    continue;
-                }
-            } else {
-                ret = x86_64_expr_range(&asmblr->lbtbl, instr->rel.expr, &loff,
-                                        &roff);
-                if ( ret < 0 ) {
-                    return -1;
-                }
-                loff = loff - xstmt->epos.max - sz;
-                roff = roff - xstmt->epos.min - sz;
-                if ( !_check_size(instr->rel.sz, loff)
-                     || !_check_size(instr->rel.sz, roff) ) {
-                    continue;
-                }
+            loff = loff - xstmt->epos.max - sz;
+            roff = roff - xstmt->epos.min - sz;
+            if ( !x86_64_check_size(cand->rel.sz, loff)
+                 || !x86_64_check_size(cand->rel.sz, roff) ) {
+                return 0;
             }
         }
+    }
 
-        if ( 0 == imin || sz < imin ) {
-            /* Update minimum */
-            imin = sz;
-            minstr = instr;
+    return 1;
+}
+
+/*
+ * Relax instructions: unless the current candidate fits at the current
+ * position, grow it to the shortest one that fits among the candidates
+ * following it in the order of the size (and of the index for the same size);
+ * return 1 if grown, 0 if unchanged, or a negative error code.  The sizes
+ * only grow, so that the distances only grow and a candidate that does not
+ * fit never fits again.
+ */
+static int
+_fix_instr2(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+{
+    size_t i;
+    int mi;
+    const x86_64_cand_t *cur;
+    const x86_64_cand_t *cand;
+    const x86_64_cand_t *mcand;
+    int ret;
+
+    /* Check if the optimal instruction is fixed */
+    if ( X86_64_STMT_FIXED == xstmt->state ) {
+        /* Already fixed */
+        return 0;
+    }
+    if ( NULL == xstmt->cands || xstmt->rcand < 0 ) {
+        /* No candidate */
+        return -EOPERAND;
+    }
+
+    /* Check the current candidate */
+    cur = x86_64_cand_vector_ref(xstmt->cands, xstmt->rcand);
+    ret = _cand_fit(asmblr, xstmt, cur);
+    if ( ret < 0 ) {
+        return -1;
+    } else if ( ret > 0 ) {
+        return 0;
+    }
+
+    /* Find the next one */
+    mcand = NULL;
+    mi = -1;
+    for ( i = 0; i < x86_64_cand_vector_size(xstmt->cands); i++ ) {
+        cand = x86_64_cand_vector_ref(xstmt->cands, i);
+        if ( cand->sz < cur->sz
+             || (cand->sz == cur->sz && i <= (size_t)xstmt->rcand)
+             || (NULL != mcand && cand->sz >= mcand->sz) ) {
+            continue;
         }
-        if ( sz > imax ) {
-            imax = sz;
+        ret = _cand_fit(asmblr, xstmt, cand);
+        if ( ret < 0 ) {
+            return -1;
+        } else if ( ret > 0 ) {
+            mcand = cand;
+            mi = i;
         }
     }
-    if ( 0 == imin ) {
+    if ( NULL == mcand ) {
+        /* Nothing fits */
         return -EOPERAND;
     }
 
-    /* Fix */
-    xstmt->sinstr = minstr;
-    xstmt->esize.min = imin;
-    xstmt->esize.max = imin;
+    /* Grow */
+    xstmt->rcand = mi;
+    xstmt->esize.min = mcand->sz;
+    xstmt->esize.max = mcand->sz;
 
-    return 0;
+    return 1;
 }
 
 /*
@@ -3201,55 +1158,48 @@ _fix_instr2(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 static int
 _fix_instr3(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 {
-    x86_64_instr_t *instr;
+    x86_64_sinstr_t *sinstr;
     x86_64_rval_t *rval;
     x86_64_rela_t *rela;
-    size_t sz;
+    size_t relsz;
 
     /* Selected instruction */
-    instr = xstmt->sinstr;
-    if ( NULL == instr ) {
+    if ( X86_64_STMT_FIXED != xstmt->state ) {
         return -1;
     }
+    sinstr = &xstmt->sinstr;
 
-
-    /* Obtain the size of the instruction */
-    sz = _instr_size(instr);
+    /* Obtain the size of the relative value */
+    relsz = sinstr->pinstr.ptr0 - sinstr->pinstr.rel;
 
     /* Check whether they are capable values */
-    if ( NULL != instr->disp.expr ) {
+    if ( NULL != sinstr->disp ) {
         /* Displacement is relocatable */
-        rval = x86_64_expr_fix(&asmblr->lbtbl, instr->disp.expr);
+        rval = x86_64_expr_fix(&asmblr->lbtbl, sinstr->disp);
         if ( NULL == rval ) {
             return -1;
         }
-        fprintf(stderr, "DEBUG: %d %s %lld\n", rval->nsym,
+        fprintf(asmblr->err, "DEBUG: %d %s %lld\n", rval->nsym,
                 rval->symname ? rval->symname : "-",
                 rval->addend);
         /* Free */
-        if ( NULL != rval->symname ) {
-            free(rval->symname);
-        }
         free(rval);
     }
-    if ( NULL != instr->imm.expr ) {
+    if ( NULL != sinstr->imm ) {
         /* Immediate value is relocatable */
-        rval = x86_64_expr_fix(&asmblr->lbtbl, instr->imm.expr);
+        rval = x86_64_expr_fix(&asmblr->lbtbl, sinstr->imm);
         if ( NULL == rval ) {
             return -1;
         }
-        fprintf(stderr, "DEBUG: %d %s %lld\n", rval->nsym,
+        fprintf(asmblr->err, "DEBUG: %d %s %lld\n", rval->nsym,
                 rval->symname ? rval->symname : "-",
                 rval->addend);
         /* Free */
-        if ( NULL != rval->symname ) {
-            free(rval->symname);
-        }
         free(rval);
     }
-    if ( 0 != instr->rel.sz ) {
+    if ( 0 != relsz ) {
         /* Relative value */
-        if ( NULL == instr->rel.expr ) {
+        if ( NULL == sinstr->rel ) {
             rela = malloc(sizeof(x86_64_rela_t));
             if ( NULL == rela ) {
                 return -1;
@@ -3257,27 +1207,24 @@ _fix_instr3(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
             /* FIXME: Replace with the fixed position */
             rela->offset = _instr_offset(xstmt, INSTR_OFFSET_REL);
             rela->type = X86_64_RELA_PC32; /* FIXME */
-            rela->addend = instr->rel.val;
+            rela->addend = sinstr->relval;
             /* S = 0 */
             rela->symname = NULL;
 
             /* Reset the value */
-            instr->rel.val = 0;
+            sinstr->relval = 0;
         } else {
-            rval = x86_64_expr_fix(&asmblr->lbtbl, instr->rel.expr);
+            rval = x86_64_expr_fix(&asmblr->lbtbl, sinstr->rel);
             if ( NULL == rval ) {
                 return -1;
             }
-            fprintf(stderr, "DEBUG: %d %s %lld\n", rval->nsym,
+            fprintf(asmblr->err, "DEBUG: %d %s %lld\n", rval->nsym,
                     rval->symname ? rval->symname : "-",
                     rval->addend);
 
             /* To relocatable value */
             rela = malloc(sizeof(x86_64_rela_t));
             if ( NULL == rela ) {
-                if ( NULL != rval->symname ) {
-                    free(rval->symname);
-                }
                 free(rval);
                 return -1;
             }
@@ -3289,36 +1236,29 @@ _fix_instr3(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
                     - _instr_offset(xstmt, INSTR_OFFSET_EOI);
                 /* S = 0 */
                 if ( NULL != rval->symname ) {
-                    rela->symname = strdup(rval->symname);
-                    if ( NULL == rela->symname ) {
-                        free(rval->symname);
-                        free(rval);
-                        return -1;
-                    }
+                    rela->symname = rval->symname;
                     /* Reset the value */
-                    instr->rel.val = 0;
+                    sinstr->relval = 0;
 
                 } else {
                     free(rela);
                     /* Reset the value */
-                    instr->rel.val = rval->addend
+                    sinstr->relval = rval->addend
                         - _instr_offset(xstmt, INSTR_OFFSET_EOI);
                 }
             } else {
                 /* FIXME */
-                if ( NULL != rval->symname ) {
-                    free(rval->symname);
-                }
                 free(rval);
                 return -1;
             }
 
             /* Free */
-            if ( NULL != rval->symname ) {
-                free(rval->symname);
-            }
             free(rval);
         }
+
+        /* Update the packed instruction with the value */
+        x86_64_pinstr_patch(&sinstr->pinstr, sinstr->pinstr.rel, relsz,
+                            sinstr->relval);
     }
 
     return 0;
@@ -3331,436 +1271,896 @@ static int
 _assemble_instr(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
 {
     int ret;
-    int j;
+    int cacheable;
+    x86_64_ecache_key_t key;
 
     assert( STMT_INSTR == xstmt->stmt->type );
 
+    /* Search the encoding cache */
+    cacheable = asmblr->ecache.max_size > 0
+        && 0 == x86_64_ecache_key(xstmt, &key);
+    if ( cacheable && x86_64_ecache_lookup(&asmblr->ecache, &key, xstmt) ) {
+        /* Hit */
+        return 0;
+    }
+
     /* Execute an assembling function */
+    xstmt->cands = x86_64_cand_vector_new();
+    if ( NULL == xstmt->cands ) {
+        return -1;
+    }
     ret = xstmt->ifunc(asmblr, xstmt);
     if ( ret >= 0 ) {
-        if ( 0 == mvector_size(xstmt->instrs) ) {
+        if ( 0 == x86_64_cand_vector_size(xstmt->cands) ) {
             /* Error */
-            fprintf(stderr, "Error:");
-            for ( j = 0; j < mvector_size(xstmt->stmt->u.instr->opcode); j++ ) {
-                fprintf(stderr, " %s",
-                        mvector_at(xstmt->stmt->u.instr->opcode, j));
-            }
-            fprintf(stderr, "\n");
+            fprintf(asmblr->err, "Error:");
+            _print_opcode(asmblr, &xstmt->stmt->u.instr);
+            fprintf(asmblr->err, "\n");
             /* FIXME */
             return 0;
         } else {
             if ( 0 != _fix_instr(xstmt) ) {
                 /* FIXME: Error */
+            } else if ( cacheable ) {
+                /* Cache it if fixed */
+                (void)x86_64_ecache_add(&asmblr->ecache, &key, xstmt);
             }
             return 0;
         }
     } else {
         /* Error */
-        fprintf(stderr, "Error:");
-        for ( j = 0; j < mvector_size(xstmt->stmt->u.instr->opcode); j++ ) {
-            fprintf(stderr, " %s",
-                    mvector_at(xstmt->stmt->u.instr->opcode, j));
-        }
-        fprintf(stderr, "\n");
-        /* FIXME */
-        return 0;
+        fprintf(asmblr->err, "Error:");
+        _print_opcode(asmblr, &xstmt->stmt->u.instr);
+        fprintf(asmblr->err, "\n");
+        /* FIXME */
+        return 0;
+    }
+
+    return 0;
+}
+
+
+/*
+ * Set a label as global scope
+ */
+static int
+_set_label_global(x86_64_label_table_t *tbl, sym_id_t lsym)
+{
+    x86_64_label_t *lb;
+
+    lb = x86_64_label_search(tbl, lsym);
+    if ( NULL == lb ) {
+        return -1;
+    }
+    /* Set the scope as global */
+    lb->scope |= 1;
+
+    return 0;
+}
+
+/*
+ * Fixed the label position
+ */
+static int
+_fix_label_position(x86_64_label_table_t *tbl, sym_id_t lsym, off_t pos)
+{
+    x86_64_label_t *lb;
+
+    lb = x86_64_label_search(tbl, lsym);
+    if ( NULL == lb ) {
+        return -1;
+    }
+    lb->min = pos;
+    lb->max = pos;
+
+    return 0;
+}
+
+
+/*
+ * Delete the statements
+ */
+static void
+_stmts_delete(x86_64_stmt_t *xstmts, size_t n)
+{
+    size_t i;
+
+    for ( i = 0; i < n; i++ ) {
+        x86_64_cand_vector_delete(xstmts[i].cands);
+    }
+    free(xstmts);
+}
+
+/*
+ * Evaluate operands
+ */
+static int
+_convert_operands(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+{
+    const instr_t *instr;
+    size_t i;
+
+    /* Evaluate operands */
+    instr = &xstmt->stmt->u.instr;
+    if ( instr->nopr > INSTR_MAX_OPERANDS ) {
+        return -EOPERAND;
+    }
+    for ( i = 0; i < instr->nopr; i++ ) {
+        if ( 0 != x86_64_convert_operand(&instr->opr[i], &xstmt->oprs[i]) ) {
+            /* Error */
+            return -EOPERAND;
+        }
+    }
+    xstmt->nopr = instr->nopr;
+
+    return 1;
+}
+
+
+/*
+ * Stage 1: Assemble all the candidates
+ * Stage 2: Lay out the statements and relax the instructions
+ * Stage 3: Complete the assembling procedure
+ */
+/*
+ * Create the workers of a pass over the statements split into contiguous
+ * chunks, sharing out ecache_size entries of the encoding caches among them;
+ * *nw is set to the number of the workers
+ */
+static x86_64_worker_t *
+_workers_new(x86_64_assembler_t *asmblr, size_t ecache_size, size_t *nw)
+{
+    x86_64_worker_t *workers;
+    x86_64_worker_t *w;
+    size_t n;
+    size_t i;
+
+    n = asmblr->nxstmts;
+    *nw = (n + X86_64_MIN_CHUNK - 1) / X86_64_MIN_CHUNK;
+    if ( *nw > asmblr->jobs ) {
+        *nw = asmblr->jobs;
+    }
+    if ( *nw < 1 ) {
+        *nw = 1;
+    }
+    workers = calloc(*nw, sizeof(x86_64_worker_t));
+    if ( NULL == workers ) {
+        return NULL;
+    }
+    if ( 1 == *nw ) {
+        /* Alone */
+        workers[0].asmblr = asmblr;
+        workers[0].start = 0;
+        workers[0].end = n;
+        return workers;
+    }
+
+    for ( i = 0; i < *nw; i++ ) {
+        w = &workers[i];
+        w->local = *asmblr;
+        w->asmblr = &w->local;
+        w->start = n * i / *nw;
+        w->end = n * (i + 1) / *nw;
+        w->local.err = open_memstream(&w->errbuf, &w->errlen);
+        if ( NULL == w->local.err
+             || 0 != x86_64_ecache_init(&w->local.ecache,
+                                        ecache_size * (i + 1) / *nw
+                                        - ecache_size * i / *nw) ) {
+            if ( NULL != w->local.err ) {
+                (void)fclose(w->local.err);
+                free(w->errbuf);
+            }
+            while ( i-- > 0 ) {
+                (void)fclose(workers[i].local.err);
+                free(workers[i].errbuf);
+                x86_64_ecache_clear(&workers[i].local.ecache);
+            }
+            free(workers);
+            return NULL;
+        }
+    }
+
+    return workers;
+}
+
+/*
+ * Entry point of a worker thread
+ */
+static void *
+_worker_main(void *arg)
+{
+    x86_64_worker_t *w;
+
+    w = (x86_64_worker_t *)arg;
+    w->ret = w->fn(w);
+
+    return NULL;
+}
+
+/*
+ * Run fn on the workers in parallel and wait for all of them; a worker that
+ * fails to start runs on this thread
+ */
+static int
+_workers_run(x86_64_worker_t *workers, size_t nw, int (*fn)(x86_64_worker_t *))
+{
+    pthread_t *threads;
+    int *started;
+    size_t i;
+
+    for ( i = 0; i < nw; i++ ) {
+        workers[i].fn = fn;
+    }
+    if ( 1 == nw ) {
+        (void)_worker_main(&workers[0]);
+        return workers[0].ret;
+    }
+
+    threads = malloc(sizeof(pthread_t) * nw);
+    started = malloc(sizeof(int) * nw);
+    if ( NULL == threads || NULL == started ) {
+        free(threads);
+        free(started);
+        return -1;
+    }
+    for ( i = 0; i < nw; i++ ) {
+        started[i] = (0 == pthread_create(&threads[i], NULL, _worker_main,
+                                          &workers[i]));
+        if ( !started[i] ) {
+            (void)_worker_main(&workers[i]);
+        }
+    }
+    for ( i = 0; i < nw; i++ ) {
+        if ( started[i] ) {
+            (void)pthread_join(threads[i], NULL);
+        }
+    }
+    free(threads);
+    free(started);
+
+    /* The first error in the order of the statements */
+    for ( i = 0; i < nw; i++ ) {
+        if ( workers[i].ret < 0 ) {
+            return workers[i].ret;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Delete the workers; their diagnostics are printed in the order of the
+ * chunks up to the first chunk that has failed, so that they are the same as
+ * those of a worker alone
+ */
+static void
+_workers_delete(x86_64_assembler_t *asmblr, x86_64_worker_t *workers,
+                size_t nw)
+{
+    x86_64_worker_t *w;
+    size_t i;
+    int failed;
+
+    if ( 1 == nw ) {
+        free(workers);
+        return;
+    }
+
+    failed = 0;
+    for ( i = 0; i < nw; i++ ) {
+        w = &workers[i];
+        (void)fclose(w->local.err);
+        if ( !failed ) {
+            (void)fwrite(w->errbuf, 1, w->errlen, asmblr->err);
+            failed = w->ret < 0;
+        }
+        free(w->errbuf);
+        asmblr->ecache.adds += w->local.ecache.adds;
+        asmblr->ecache.lookups += w->local.ecache.lookups;
+        asmblr->ecache.hits += w->local.ecache.hits;
+        x86_64_ecache_clear(&w->local.ecache);
+    }
+    free(workers);
+}
+
+/*
+ * Resolve, convert and encode the statements of the worker
+ */
+static int
+_stage1_chunk(x86_64_worker_t *w)
+{
+    x86_64_assembler_t *asmblr;
+    size_t i;
+    const stmt_t *stmt;
+    int ret;
+    x86_64_stmt_t *xstmt;
+    x86_64_target_t tgt;
+
+    asmblr = w->asmblr;
+
+    /* Set the default target */
+    tgt = X86_64_O64;
+
+    for ( i = w->start; i < w->end; i++ ) {
+        stmt = stmt_vector_ref(asmblr->icode->stmts, i);
+
+        xstmt = &asmblr->xstmts[i];
+        xstmt->stmt = stmt;
+        xstmt->state = X86_64_STMT_INIT;
+        xstmt->tgt = tgt;
+        xstmt->mnemonic = -1;
+        xstmt->ifunc = NULL;
+        xstmt->cands = NULL;
+        xstmt->rcand = -1;
+        xstmt->nopr = 0;
+        xstmt->esize.min = 0;
+        xstmt->esize.max = 0;
+
+        switch ( stmt->type ) {
+        case STMT_INSTR:
+            /* Resolve the corresponding function pointer to the assembling
+               this instruction */
+            ret = _resolv_instr(asmblr, xstmt);
+            if ( 0 != ret ) {
+                /* Unknown */
+                fprintf(asmblr->err, "Unknown instruction:");
+                _print_opcode(asmblr, &stmt->u.instr);
+                fprintf(asmblr->err, "\n");
+                /* Error */
+                return -1;
+            }
+
+            /* Encode the register-register and register-immediate forms
+               directly */
+            if ( _encode_fast(xstmt) ) {
+                break;
+            }
+
+            /* Evaluate operands first */
+            ret = _convert_operands(asmblr, xstmt);
+            if ( ret < 0 ) {
+                /* Error */
+                return -1;
+            }
+
+            /* Assemble the instruction */
+            ret = _assemble_instr(asmblr, xstmt);
+            if ( 0 != ret ) {
+                /* Error on assembling the instruction */
+                return -1;
+            }
+            break;
+        default:
+            /* Do nothing */
+            ;
+        }
+    }
+
+    return 0;
+}
+
+static int
+_stage1(x86_64_assembler_t *asmblr)
+{
+    size_t n;
+    size_t nw;
+    x86_64_stmt_t *xstmts;
+    x86_64_worker_t *workers;
+    int ret;
+
+    assert( 0 == asmblr->stage );
+
+    /* Allocate the statements indexed by the statement number */
+    n = stmt_vector_size(asmblr->icode->stmts);
+    xstmts = calloc(n > 0 ? n : 1, sizeof(x86_64_stmt_t));
+    if ( NULL == xstmts ) {
+        return -1;
+    }
+
+    asmblr->xstmts = xstmts;
+    asmblr->nxstmts = n;
+
+    /* Assemble the chunks of the statements in parallel */
+    workers = _workers_new(asmblr, asmblr->ecache.max_size, &nw);
+    if ( NULL == workers ) {
+        ret = -1;
+    } else {
+        ret = _workers_run(workers, nw, _stage1_chunk);
+        _workers_delete(asmblr, workers, nw);
+    }
+    if ( ret < 0 ) {
+        /* Error */
+        _stmts_delete(xstmts, n);
+        asmblr->xstmts = NULL;
+        asmblr->nxstmts = 0;
+        return -1;
     }
 
+    asmblr->stage = 1;
+
     return 0;
 }
-
-
 /*
- * Add label to the table
+ * Sum the sizes of the statements of the worker
  */
 static int
-_add_label(x86_64_label_table_t *tbl, const char *lstr, off_t imin, off_t imax)
+_layout_sum(x86_64_worker_t *w)
 {
-    x86_64_label_t *lb;
-    x86_64_label_ent_t **ent;
+    size_t i;
+    x86_64_stmt_t *xstmt;
 
-    ent = &(tbl->root);
-    while ( NULL != *ent ) {
-        if ( 0 == strcmp((*ent)->c->label, lstr) ) {
-            /* Duplicated */
-            return -EDUP;
+    w->size = 0;
+    for ( i = w->start; i < w->end; i++ ) {
+        xstmt = &w->asmblr->xstmts[i];
+        if ( STMT_INSTR == xstmt->stmt->type ) {
+            w->size += xstmt->esize.min;
         }
-        ent = &((*ent)->next);
-    }
-    *ent = malloc(sizeof(x86_64_label_ent_t));
-    if ( NULL == *ent ) {
-        return -EGENERIC;
-    }
-
-    /* Allocate memory for a label structure */
-    lb = malloc(sizeof(x86_64_label_t));
-    if ( NULL == lb ) {
-        free(*ent);
-        return -EGENERIC;
-    }
-    lb->label = strdup(lstr);
-    if ( NULL == lb->label ) {
-        free(*ent);
-        free(lb);
-        return -EGENERIC;
     }
-    /* Set the expected positions of this instruction */
-    lb->min = imin;
-    lb->max = imax;
-    lb->scope = 0;
-
-    /* Set */
-    (*ent)->c = lb;
-    (*ent)->next = NULL;
 
     return 0;
 }
 
 /*
- * Clear the label table
- * Note that this does not free the label table structure
- */
-static void
-_label_table_clear(x86_64_label_table_t *tbl)
-{
-    x86_64_label_ent_t *ent;
-    x86_64_label_ent_t *tmpent;
-
-    ent = tbl->root;
-    while ( NULL != ent ) {
-        tmpent = ent->next;
-        free(ent->c->label);
-        free(ent->c);
-        free(ent);
-        ent = tmpent;
-    }
-    tbl->root = NULL;
-}
-
-/*
- * Set a label as global scope
+ * Lay out the statements of the worker from its start position and update
+ * the label positions
  */
 static int
-_set_label_global(x86_64_label_table_t *tbl, const char *lstr)
+_layout_chunk(x86_64_worker_t *w)
 {
-    x86_64_label_ent_t *ent;
+    size_t i;
+    x86_64_stmt_t *xstmt;
+    off_t pos;
 
-    ent = tbl->root;
-    while ( NULL != ent ) {
-        if ( 0 == strcmp(ent->c->label, lstr) ) {
-            /* Set the scope as global */
-            ent->c->scope |= 1;
-            return 0;
+    pos = w->pos;
+    for ( i = w->start; i < w->end; i++ ) {
+        xstmt = &w->asmblr->xstmts[i];
+        xstmt->epos.min = pos;
+        xstmt->epos.max = pos;
+
+        switch ( xstmt->stmt->type ) {
+        case STMT_INSTR:
+            pos += xstmt->esize.min;
+            break;
+        case STMT_LABEL:
+            /* Update the position */
+            _fix_label_position(&w->asmblr->lbtbl, xstmt->stmt->u.label, pos);
+            break;
+        default:
+            /* Do nothing */
+            ;
         }
-        ent = ent->next;
     }
 
-    return -1;
+    return 0;
 }
 
 /*
- * Fixed the label position
+ * Lay out the statements with the current sizes of the instructions and
+ * update the label positions; the positions are the prefix sums computed in
+ * two levels: the sums of the chunks in parallel, the start positions of the
+ * chunks serially, and the positions in the chunks in parallel
  */
 static int
-_fix_label_position(x86_64_label_table_t *tbl, const char *lstr, off_t pos)
+_layout(x86_64_assembler_t *asmblr)
 {
-    x86_64_label_ent_t *ent;
+    x86_64_worker_t *workers;
+    size_t nw;
+    size_t i;
+    off_t pos;
 
-    ent = tbl->root;
-    while ( NULL != ent ) {
-        if ( 0 == strcmp(ent->c->label, lstr) ) {
-            ent->c->min = pos;
-            ent->c->max = pos;
-            return 0;
-        }
-        ent = ent->next;
+    workers = _workers_new(asmblr, 0, &nw);
+    if ( NULL == workers ) {
+        return -1;
+    }
+    if ( nw > 1 ) {
+        (void)_workers_run(workers, nw, _layout_sum);
+    }
+    pos = 0;
+    for ( i = 0; i < nw; i++ ) {
+        workers[i].pos = pos;
+        pos += workers[i].size;
     }
+    (void)_workers_run(workers, nw, _layout_chunk);
+    _workers_delete(asmblr, workers, nw);
 
-    return -1;
+    return 0;
 }
 
+/*
+ * Is the statement to be relaxed?
+ */
+static __inline__ int
+_relaxable(const x86_64_stmt_t *xstmt)
+{
+    return STMT_INSTR == xstmt->stmt->type
+        && X86_64_STMT_FIXED != xstmt->state
+        && NULL != xstmt->cands && xstmt->rcand >= 0;
+}
 
 /*
- * Delete the opcode vector
+ * Append the labels that the expression refers to to the dependencies of the
+ * k-th instruction under the relaxation (without duplicates) and return the
+ * number of the references; *last is updated to the last statement number of
+ * the labels
  */
-static void
-_opr_vector_delete(x86_64_opr_vector_t *vec)
+static size_t
+_relax_add_deps(x86_64_assembler_t *asmblr, x86_64_relax_t *rx,
+                const expr_t *expr, size_t k, size_t *cur, size_t *last)
 {
+    size_t n;
     size_t i;
-
-    for ( i = 0; i < mvector_size(vec); i++ ) {
-        free((x86_64_opr_t *)mvector_at(vec, i));
+    size_t j;
+    size_t l;
+
+    n = x86_64_expr_labels(&asmblr->lbtbl, expr, rx->deps + *cur,
+                           SIZE_MAX);
+    for ( i = 0; i < n; i++ ) {
+        l = rx->deps[*cur];
+        if ( rx->lstmts[l] > *last ) {
+            *last = rx->lstmts[l];
+        }
+        for ( j = rx->dstart[k]; j < *cur; j++ ) {
+            if ( rx->deps[j] == l ) {
+                break;
+            }
+        }
+        if ( j == *cur ) {
+            (*cur)++;
+        } else {
+            /* Duplicate: drop it */
+            (void)memmove(rx->deps + *cur, rx->deps + *cur + 1,
+                          sizeof(size_t) * (n - i - 1));
+        }
     }
-    mvector_delete(vec);
+
+    return n;
 }
 
 /*
- * Delete the opcode vector
+ * Release the state of the relaxation
  */
 static void
-_stmt_vector_delete(x86_64_stmt_vector_t *vec)
+_relax_clear(x86_64_relax_t *rx)
 {
-    size_t i;
-
-    for ( i = 0; i < mvector_size(vec); i++ ) {
-        free((x86_64_stmt_t *)mvector_at(vec, i));
-    }
-    mvector_delete(vec);
+    free(rx->stmts);
+    free(rx->dstart);
+    free(rx->deps);
+    free(rx->lstmts);
+    x86_64_fenwick_clear(&rx->pos);
+    x86_64_span_index_clear(&rx->spans);
 }
 
 /*
- * Evaluate operands
+ * Set up the relaxation: collect the instructions to be relaxed and their
+ * label dependencies, and build the positions and the spans.  A change in the
+ * size of a statement affects a relative field only if the statement lies
+ * between the instruction and the single label it refers to, and the other
+ * fields depending on labels if it precedes the last of them.
  */
 static int
-_convert_operands(x86_64_assembler_t *asmblr, x86_64_stmt_t *xstmt)
+_relax_init(x86_64_assembler_t *asmblr, x86_64_relax_t *rx)
 {
-    x86_64_opr_t *opr;
-    operand_t *op;
-    size_t nr;
+    x86_64_stmt_t *xstmt;
+    const x86_64_cand_t *cand;
+    off_t *sizes;
+    size_t *lo;
+    size_t *hi;
+    size_t ndeps;
+    size_t nl;
+    size_t cur;
+    size_t last;
+    size_t s;
+    size_t k;
     size_t i;
-    x86_64_opr_vector_t *oprs;
+    int ret;
 
-    /* Allocate a vector for evals */
-    oprs = mvector_new();
-    if ( NULL == oprs ) {
+    (void)memset(rx, 0, sizeof(x86_64_relax_t));
+    sizes = malloc(sizeof(off_t) * (asmblr->nxstmts + 1));
+    rx->stmts = malloc(sizeof(size_t) * (asmblr->nxstmts + 1));
+    rx->lstmts = malloc(sizeof(size_t) * (asmblr->lbtbl.size + 1));
+    if ( NULL == sizes || NULL == rx->stmts || NULL == rx->lstmts ) {
+        free(sizes);
+        _relax_clear(rx);
         return -1;
     }
 
-    /* Evaluate operands */
-    nr = mvector_size(xstmt->stmt->u.instr->operands);
-    for ( i = 0; i < nr; i++ ) {
-        /* Obtain operands */
-        op = mvector_at(xstmt->stmt->u.instr->operands, i);
-        /* Evaluate operands */
-        opr = x86_64_convert_operand(op);
-        if ( NULL == opr ) {
-            /* Error */
-            _opr_vector_delete(oprs);
-            return -EOPERAND;
+    /* Collect the instructions and the labels in the order of the table */
+    ndeps = 0;
+    nl = 0;
+    for ( s = 0; s < asmblr->nxstmts; s++ ) {
+        xstmt = &asmblr->xstmts[s];
+        sizes[s] = 0;
+        if ( STMT_LABEL == xstmt->stmt->type ) {
+            rx->lstmts[nl++] = s;
+        } else if ( STMT_INSTR == xstmt->stmt->type ) {
+            sizes[s] = xstmt->esize.min;
+            if ( !_relaxable(xstmt) ) {
+                continue;
+            }
+            rx->stmts[rx->n++] = s;
+            for ( i = 0; i < x86_64_cand_vector_size(xstmt->cands); i++ ) {
+                cand = x86_64_cand_vector_ref(xstmt->cands, i);
+                if ( NULL != cand->disp.expr ) {
+                    ndeps += x86_64_expr_labels(&asmblr->lbtbl,
+                                                cand->disp.expr, NULL, 0);
+                }
+                if ( NULL != cand->imm.expr ) {
+                    ndeps += x86_64_expr_labels(&asmblr->lbtbl,
+                                                cand->imm.expr, NULL, 0);
+                }
+                if ( 0 != cand->rel.sz && NULL != cand->rel.expr ) {
+                    ndeps += x86_64_expr_labels(&asmblr->lbtbl,
+                                                cand->rel.expr, NULL, 0);
+                }
+            }
         }
-        if ( NULL == mvector_push_back(oprs, opr) ) {
-            free(opr);
-            /* Error */
-            _opr_vector_delete(oprs);
-            return -EUNKNOWN;
+    }
+    assert( nl == asmblr->lbtbl.size );
+
+    ret = x86_64_fenwick_init(&rx->pos, sizes, asmblr->nxstmts);
+    free(sizes);
+    if ( ret < 0 ) {
+        _relax_clear(rx);
+        return -1;
+    }
+
+    /* Collect the dependencies and the spans */
+    rx->dstart = malloc(sizeof(size_t) * (rx->n + 1));
+    rx->deps = malloc(sizeof(size_t) * (ndeps + 1));
+    lo = malloc(sizeof(size_t) * (rx->n + 1));
+    hi = malloc(sizeof(size_t) * (rx->n + 1));
+    if ( NULL == rx->dstart || NULL == rx->deps || NULL == lo || NULL == hi ) {
+        free(lo);
+        free(hi);
+        _relax_clear(rx);
+        return -1;
+    }
+    cur = 0;
+    for ( k = 0; k < rx->n; k++ ) {
+        s = rx->stmts[k];
+        xstmt = &asmblr->xstmts[s];
+        rx->dstart[k] = cur;
+        lo[k] = X86_64_SPAN_NONE;
+        hi[k] = s;
+        for ( i = 0; i < x86_64_cand_vector_size(xstmt->cands); i++ ) {
+            cand = x86_64_cand_vector_ref(xstmt->cands, i);
+            last = 0;
+            if ( NULL != cand->disp.expr
+                 && _relax_add_deps(asmblr, rx, cand->disp.expr, k, &cur,
+                                    &last) > 0 ) {
+                lo[k] = 0;
+            }
+            if ( NULL != cand->imm.expr
+                 && _relax_add_deps(asmblr, rx, cand->imm.expr, k, &cur,
+                                    &last) > 0 ) {
+                lo[k] = 0;
+            }
+            if ( last > hi[k] ) {
+                hi[k] = last;
+            }
+            last = 0;
+            if ( 0 != cand->rel.sz && NULL != cand->rel.expr ) {
+                nl = _relax_add_deps(asmblr, rx, cand->rel.expr, k, &cur,
+                                     &last);
+                if ( 1 == nl && last < s ) {
+                    /* Backward */
+                    if ( last < lo[k] ) {
+                        lo[k] = last;
+                    }
+                } else if ( 1 == nl ) {
+                    /* Forward */
+                    if ( s < lo[k] ) {
+                        lo[k] = s;
+                    }
+                    if ( last > hi[k] ) {
+                        hi[k] = last;
+                    }
+                } else if ( nl > 1 ) {
+                    lo[k] = 0;
+                    if ( last > hi[k] ) {
+                        hi[k] = last;
+                    }
+                }
+            }
         }
     }
+    rx->dstart[rx->n] = cur;
 
-    /* Set evals */
-    xstmt->oprs = oprs;
+    ret = x86_64_span_index_init(&rx->spans, asmblr->nxstmts, lo, hi, rx->n);
+    free(lo);
+    free(hi);
+    if ( ret < 0 ) {
+        _relax_clear(rx);
+        return -1;
+    }
 
-    return 1;
+    return 0;
 }
 
-
 /*
- * Stage 1: Assemble all the candidates
- * State 2: Estimate label offsets
- * Stage 3: Complete the assembling procedure
+ * Update the position of the k-th instruction under the relaxation and of the
+ * labels it depends on
  */
-static int
-_stage1(x86_64_assembler_t *asmblr, const stmt_vector_t *vec)
+static void
+_relax_locate(x86_64_assembler_t *asmblr, x86_64_relax_t *rx, size_t k)
 {
-    size_t i;
-    size_t j;
-    stmt_t *stmt;
-    int ret;
-    off_t pos;
     x86_64_stmt_t *xstmt;
-    x86_64_stmt_vector_t *xvec;
-    x86_64_target_t tgt;
-
-    assert( 0 == asmblr->stage );
-
-    /* Allocate a new statement vector */
-    xvec = mvector_new();
-
-    /* Set the default target */
-    tgt = X86_64_O64;
-
-    /* Estimate the position of labels */
-    pos = 0;
-    for ( i = 0; i < mvector_size(vec); i++ ) {
-        stmt = mvector_at(vec, i);
-
-        xstmt = malloc(sizeof(x86_64_stmt_t));
-        if ( NULL == xstmt ) {
-            /* Error */
-            _stmt_vector_delete(xvec);
-            mvector_delete(xvec);
-            return -1;
-        }
-        xstmt->stmt = stmt;
-        xstmt->state = X86_64_STMT_INIT;
-        xstmt->tgt = tgt;
-        xstmt->oprs = NULL;
-        xstmt->sinstr = NULL;
-        xstmt->instrs = mvector_new();
-        xstmt->esize.min = 0;
-        xstmt->esize.max = 0;
+    x86_64_label_t *lb;
+    size_t i;
 
-        /* Append */
-        if ( NULL == mvector_push_back(xvec, xstmt) ) {
-            /* Error */
-            _stmt_vector_delete(xvec);
-            return -1;
-        }
+    xstmt = &asmblr->xstmts[rx->stmts[k]];
+    xstmt->epos.min = x86_64_fenwick_prefix(&rx->pos, rx->stmts[k]);
+    xstmt->epos.max = xstmt->epos.min;
+    for ( i = rx->dstart[k]; i < rx->dstart[k + 1]; i++ ) {
+        lb = &asmblr->lbtbl.labels[rx->deps[i]];
+        lb->min = x86_64_fenwick_prefix(&rx->pos, rx->lstmts[rx->deps[i]]);
+        lb->max = lb->min;
+    }
+}
 
-        switch ( stmt->type ) {
-        case STMT_INSTR:
-            /* Resolve the corresponding function pointer to the assembling
-               this instruction */
-            ret = _resolv_instr(xstmt);
-            if ( 0 != ret ) {
-                /* Unknown */
-                fprintf(stderr, "Unknown instruction:");
-                for ( j = 0; j < mvector_size(xstmt->stmt->u.instr->opcode);
-                      j++ ) {
-                    fprintf(stderr, " %s",
-                            mvector_at(xstmt->stmt->u.instr->opcode, j));
-                }
-                fprintf(stderr, "\n");
-                /* Error */
-                _stmt_vector_delete(xvec);
-                return -1;
-            }
+/*
+ * Relax the instructions until no instruction grows.  All the instructions
+ * are evaluated in the first round, and then only those of which span
+ * contains an instruction grown in the previous round, so that the rounds
+ * after the first take the time proportional to the instructions affected.
+ */
+static int
+_relax(x86_64_assembler_t *asmblr)
+{
+    x86_64_relax_t rx;
+    x86_64_stmt_t *xstmt;
+    size_t *queue;
+    size_t *next;
+    size_t *grown;
+    size_t *tmp;
+    size_t nq;
+    size_t ngrown;
+    size_t round;
+    size_t i;
+    off_t sz;
 
-            /* Evaluate operands first */
-            ret = _convert_operands(asmblr, xstmt);
-            if ( ret < 0 ) {
-                /* Error */
-                return -1;
+    if ( _relax_init(asmblr, &rx) < 0 ) {
+        return -1;
+    }
+    queue = malloc(sizeof(size_t) * (rx.n + 1));
+    next = malloc(sizeof(size_t) * (rx.n + 1));
+    grown = malloc(sizeof(size_t) * (rx.n + 1));
+    if ( NULL == queue || NULL == next || NULL == grown ) {
+        free(queue);
+        free(next);
+        free(grown);
+        _relax_clear(&rx);
+        return -1;
+    }
+    for ( i = 0; i < rx.n; i++ ) {
+        queue[i] = i;
+    }
+    nq = rx.n;
+
+    for ( round = 1; nq > 0; round++ ) {
+        asmblr->relax.passes++;
+        ngrown = 0;
+        for ( i = 0; i < nq; i++ ) {
+            xstmt = &asmblr->xstmts[rx.stmts[queue[i]]];
+            _relax_locate(asmblr, &rx, queue[i]);
+            sz = xstmt->esize.min;
+            asmblr->relax.evals++;
+            if ( _fix_instr2(asmblr, xstmt) > 0 ) {
+                /* Move the following statements */
+                x86_64_fenwick_add(&rx.pos, rx.stmts[queue[i]],
+                                   xstmt->esize.min - sz);
+                grown[ngrown++] = rx.stmts[queue[i]];
             }
+        }
+        asmblr->relax.grown += ngrown;
 
-            /* Assemble the instruction */
-            ret = _assemble_instr(asmblr, xstmt);
-            if ( 0 != ret ) {
-                /* Error on assembling the instruction */
-                _stmt_vector_delete(xvec);
-                return -1;
-            }
-            pos++;
-            break;
-        default:
-            /* Do nothing */
-            ;
+        /* Re-evaluate the instructions of which span has grown */
+        nq = 0;
+        for ( i = 0; i < ngrown; i++ ) {
+            nq = x86_64_span_index_stab(&rx.spans, grown[i], round, next, nq);
         }
+        tmp = queue;
+        queue = next;
+        next = tmp;
     }
 
-    asmblr->xvec = xvec;
-    asmblr->stage = 1;
+    free(queue);
+    free(next);
+    free(grown);
+    _relax_clear(&rx);
 
-    return 0;
+    /* Fix the positions of all the statements and labels */
+    return _layout(asmblr);
 }
+
 static int
 _stage2(x86_64_assembler_t *asmblr)
 {
     size_t i;
     x86_64_stmt_t *xstmt;
     int ret;
-    off_t imin;
-    off_t imax;
 
     assert( 1 == asmblr->stage );
 
-    imin = 0;
-    imax = 0;
-
-    for ( i = 0; i < mvector_size(asmblr->xvec); i++ ) {
+    /* Add the labels to the label table */
+    for ( i = 0; i < asmblr->nxstmts; i++ ) {
         /* Get a statement at i-th position */
-        xstmt = mvector_at(asmblr->xvec, i);
+        xstmt = &asmblr->xstmts[i];
 
-        /* Set the estimated position */
-        xstmt->epos.min = imin;
-        xstmt->epos.max = imax;
-
-        switch ( xstmt->stmt->type ) {
-        case STMT_INSTR:
-            /* Estimate the label position */
-            imin += xstmt->esize.min;
-            imax += xstmt->esize.max;
-            break;
-        case STMT_LABEL:
-            /* Add it to the label table */
-            ret = _add_label(&asmblr->lbtbl, xstmt->stmt->u.label, imin, imax);
+        if ( STMT_LABEL == xstmt->stmt->type ) {
+            ret = x86_64_label_add(&asmblr->lbtbl, xstmt->stmt->u.label, 0,
+                                   0);
             if ( ret < 0 ) {
                 if ( -EDUP == ret ) {
                     fprintf(stderr, "A duplicate label: %s\n",
-                            xstmt->stmt->u.label);
+                            intern_str(xstmt->stmt->u.label));
                 }
-                _label_table_clear(&asmblr->lbtbl);
+                x86_64_label_table_clear(&asmblr->lbtbl);
                 return -1;
             }
-
-            break;
-        default:
-            /* Do nothing */
-            ;
         }
     }
 
+    /* Lay out the instructions with the shortest candidates */
+    if ( _layout(asmblr) < 0 ) {
+        return -1;
+    }
+
+    /* Grow the instructions out of range */
+    if ( _relax(asmblr) < 0 ) {
+        return -1;
+    }
+
     /* Finishing stage 2 */
     asmblr->stage = 2;
 
     return 0;
 }
 
+/*
+ * Select the relaxed candidates of the statements of the worker and fix the
+ * instructions
+ */
 static int
-_stage3(x86_64_assembler_t *asmblr)
+_stage3_chunk(x86_64_worker_t *w)
 {
     size_t i;
     x86_64_stmt_t *xstmt;
-    off_t pos;
+    const x86_64_cand_t *cand;
 
-    assert( 2 == asmblr->stage );
-
-    for ( i = 0; i < mvector_size(asmblr->xvec); i++ ) {
-        xstmt = mvector_at(asmblr->xvec, i);
+    for ( i = w->start; i < w->end; i++ ) {
+        xstmt = &w->asmblr->xstmts[i];
 
-        switch ( xstmt->stmt->type ) {
-        case STMT_INSTR:
-            _fix_instr2(asmblr, xstmt);
-            break;
-        default:
-            /* Do nothing */
-            ;
+        if ( STMT_INSTR != xstmt->stmt->type ) {
+            continue;
+        }
+        if ( _relaxable(xstmt) ) {
+            cand = x86_64_cand_vector_ref(xstmt->cands, xstmt->rcand);
+            if ( _cand_fit(w->asmblr, xstmt, cand) > 0 ) {
+                (void)_select_cand(xstmt, cand);
+            }
         }
+        _fix_instr3(w->asmblr, xstmt);
     }
 
-    /* Fix the position */
-    pos = 0;
-    for ( i = 0; i < mvector_size(asmblr->xvec); i++ ) {
-        xstmt = mvector_at(asmblr->xvec, i);
+    return 0;
+}
 
-        switch ( xstmt->stmt->type ) {
-        case STMT_INSTR:
-            xstmt->epos.min = pos;
-            xstmt->epos.max = pos;
-            pos += xstmt->esize.min;
-            break;
-        case STMT_LABEL:
-            /* Update the position */
-            _fix_label_position(&asmblr->lbtbl, xstmt->stmt->u.label, pos);
-            /*fprintf(stderr, "Label %s: %lld\n", xstmt->stmt->u.label, pos);*/
-            break;
-        default:
-            /* Do nothing */
-            ;
-        }
-    }
+static int
+_stage3(x86_64_assembler_t *asmblr)
+{
+    x86_64_worker_t *workers;
+    size_t nw;
 
-    for ( i = 0; i < mvector_size(asmblr->xvec); i++ ) {
-        xstmt = mvector_at(asmblr->xvec, i);
+    assert( 2 == asmblr->stage );
 
-        switch ( xstmt->stmt->type ) {
-        case STMT_INSTR:
-            _fix_instr3(asmblr, xstmt);
-            break;
-        default:
-            /* Do nothing */
-            ;
-        }
+    /* The statements are independent of each other given the labels */
+    workers = _workers_new(asmblr, 0, &nw);
+    if ( NULL == workers ) {
+        return -1;
     }
+    (void)_workers_run(workers, nw, _stage3_chunk);
+    _workers_delete(asmblr, workers, nw);
 
     /* Completed stage 3 */
     asmblr->stage = 3;
@@ -3776,28 +2176,19 @@ _output(x86_64_assembler_t *asmblr)
 
     assert( 3 == asmblr->stage );
 
-    for ( i = 0; i < mvector_size(asmblr->xvec); i++ ) {
-        xstmt = mvector_at(asmblr->xvec, i);
+    for ( i = 0; i < asmblr->nxstmts; i++ ) {
+        xstmt = &asmblr->xstmts[i];
 
         switch ( xstmt->stmt->type ) {
         case STMT_INSTR:
-            if ( NULL != xstmt->sinstr ) {
-                _print_instruction_bin(xstmt->sinstr);
+            if ( X86_64_STMT_FIXED == xstmt->state ) {
+                (void)fwrite(xstmt->sinstr.pinstr.buf, 1,
+                             xstmt->sinstr.pinstr.len, stdout);
             } else {
                 fprintf(stderr, "Not fixed instruction: # = %zu\n",
-                        mvector_size(xstmt->instrs));
-            }
-
-#if 0
-            fprintf(stderr, "# = %zu\n", mvector_size(xstmt->instrs));
-            if ( 1 == mvector_size(xstmt->instrs) ) {
-                _print_instruction_bin(mvector_at(xstmt->instrs, 0));
-#if 0
-                _print_instruction(instr);
-                printf("\n");
-#endif
+                        NULL != xstmt->cands
+                        ? x86_64_cand_vector_size(xstmt->cands) : 0);
             }
-#endif
             break;
         default:
             /* Do nothing */
@@ -3813,14 +2204,15 @@ _output(x86_64_assembler_t *asmblr)
  * Assemble x86-64 code
  */
 static int
-_assemble(x86_64_assembler_t *asmblr, stmt_vector_t *vec)
+_assemble(x86_64_assembler_t *asmblr)
 {
     int ret;
+    stmt_vector_t *vec;
     stmt_t *stmt;
     size_t i;
 
     /* Stage 1 */
-    ret = _stage1(asmblr, vec);
+    ret = _stage1(asmblr);
     if ( ret < 0 ) {
         return -1;
     }
@@ -3844,15 +2236,17 @@ _assemble(x86_64_assembler_t *asmblr, stmt_vector_t *vec)
     }
 
     /* Linker stage: Check global */
-    for ( i = 0; i < mvector_size(vec); i++ ) {
-        stmt = mvector_at(vec, i);
+    vec = asmblr->icode->stmts;
+    for ( i = 0; i < stmt_vector_size(vec); i++ ) {
+        stmt = stmt_vector_ref(vec, i);
         switch ( stmt->type ) {
         case STMT_GLOBAL:
             ret = _set_label_global(&asmblr->lbtbl, stmt->u.global);
             if ( ret < 0 ) {
-                fprintf(stderr, "Label %s is not defined\n", stmt->u.label);
+                fprintf(stderr, "Label %s is not defined\n",
+                        intern_str(stmt->u.global));
                 /* Free the label table */
-                _label_table_clear(&asmblr->lbtbl);
+                x86_64_label_table_clear(&asmblr->lbtbl);
                 return -1;
             }
             break;
@@ -3869,16 +2263,31 @@ _assemble(x86_64_assembler_t *asmblr, stmt_vector_t *vec)
  * Assembler code
  */
 int
-arch_x86_64_assemble(const char *fname)
+arch_x86_64_assemble(const char *fname, const las_opts_t *opts)
 {
     pcode_t *pcode;
-    stmt_vector_t *vec;
+    icode_t *icode;
     preprocessor_t *pp;
     int ret;
     x86_64_assembler_t asmblr;
 
+    /* Initialize the register table before any symbol is tokenized */
+    if ( 0 != x86_64_reg_init() ) {
+        return -1;
+    }
+    if ( 0 != _mnemonic_init() ) {
+        return -1;
+    }
+    if ( 0 != _spec_init() ) {
+        return -1;
+    }
+
     /* Create a preprocessor instance */
     pp = pp_new();
+    if ( NULL == pp ) {
+        return -1;
+    }
+    pp->jobs = opts->jobs;
 
     /* Register *fixes */
     ret = pp_register_fix(pp, "lock");
@@ -3925,18 +2334,49 @@ arch_x86_64_assemble(const char *fname)
     }
 
     /* Parse the code */
-    vec = parse(pcode);
-    if ( NULL == vec ) {
+    icode = parse(pcode);
+    /* The statements do not refer to the tokens */
+    pcode_delete(pcode);
+    if ( NULL == icode ) {
         return -1;
     }
 
-    /* Initialize the label table */
-    asmblr.lbtbl.root = NULL;
+    /* Initialize the label table and the encoding cache */
+    x86_64_label_table_init(&asmblr.lbtbl);
+    if ( 0 != x86_64_ecache_init(&asmblr.ecache, opts->ecache_size) ) {
+        fprintf(stderr, "Cannot set up the encoding cache of %zu entries\n",
+                opts->ecache_size);
+        icode_delete(icode);
+        return -1;
+    }
     asmblr.stage = 0;
-
-    _assemble(&asmblr, vec);
-
-    return 0;
+    asmblr.icode = icode;
+    asmblr.xstmts = NULL;
+    asmblr.nxstmts = 0;
+    asmblr.jobs = opts->jobs;
+    asmblr.err = stderr;
+    asmblr.relax.passes = 0;
+    asmblr.relax.grown = 0;
+    asmblr.relax.evals = 0;
+
+    ret = _assemble(&asmblr);
+
+    if ( opts->stats ) {
+        fprintf(stderr, "Encoding cache: %zu/%zu entries, %zu hits / %zu "
+                "lookups (%.1f%%)\n", asmblr.ecache.adds,
+                asmblr.ecache.max_size, asmblr.ecache.hits,
+                asmblr.ecache.lookups, asmblr.ecache.lookups
+                ? 100.0 * asmblr.ecache.hits / asmblr.ecache.lookups : 0.0);
+        fprintf(stderr, "Relaxation: %zu passes, %zu instructions grown, "
+                "%zu evaluations\n", asmblr.relax.passes, asmblr.relax.grown,
+                asmblr.relax.evals);
+    }
+    x86_64_ecache_clear(&asmblr.ecache);
+    if ( NULL != asmblr.xstmts ) {
+        _stmts_delete(asmblr.xstmts, asmblr.nxstmts);
+    }
+
+    return ret;
 }
 
 
@@ -0,0 +1,481 @@
+/*_
+ * Copyright 2013 Scyphus Solutions Co. Ltd.  All rights reserved.
+ *
+ * Authors:
+ *      Hirochika Asai  <asai@scyphus.co.jp>
+ */
+
+/* $Id$ */
+
+#ifndef _ARCH_X86_64_MAIN_H
+#define _ARCH_X86_64_MAIN_H
+
+#include "../../las.h"
+#include "reg.h"
+#include <stdint.h>
+#include <sys/types.h>
+
+#define X86_64_ADDR_BASE        1
+#define X86_64_ADDR_DISP        (1<<1)
+#define X86_64_ADDR_OFFSET      (1<<2)
+#define X86_64_ADDR_SCALE       (1<<3)
+
+typedef enum _x86_64_target {
+    X86_64_O16,
+    X86_64_O32,
+    X86_64_O64,
+} x86_64_target_t;
+
+typedef enum _x86_64_opr_type {
+    X86_64_OPR_REG,
+    X86_64_OPR_IMM,
+    X86_64_OPR_ADDR,
+    X86_64_OPR_PTR,
+} x86_64_opr_type_t;
+
+typedef enum _x86_64_imm_type {
+    X86_64_IMM_FIXED,
+    X86_64_IMM_EXPR,
+} x86_64_imm_type_t;
+
+typedef struct _x86_64_imm {
+    x86_64_imm_type_t type;
+    union {
+        int64_t fixed;
+        expr_t *rexpr;
+    } u;
+} x86_64_imm_t;
+
+typedef struct _x86_64_addr {
+    int flags;
+    x86_64_reg_t base;
+    x86_64_reg_t offset;
+    int scale;
+    x86_64_imm_t disp;
+    size_t saddrsize;
+} x86_64_addr_t;
+
+/*
+ * Operand classes
+ *
+ * x86_64_convert_operand() sets the bits of all the classes that an operand
+ * belongs to, and an encoding is matched by the classes it requires for each
+ * operand.  The classes of the same kind are consecutive bits in the order of
+ * 8, 16, 32 and 64 bits.
+ */
+#define X86_64_OPRC_R8          (1ULL << 0)     /* r8 */
+#define X86_64_OPRC_R16         (1ULL << 1)
+#define X86_64_OPRC_R32         (1ULL << 2)
+#define X86_64_OPRC_R64         (1ULL << 3)
+#define X86_64_OPRC_M8          (1ULL << 4)     /* m8 */
+#define X86_64_OPRC_M16         (1ULL << 5)
+#define X86_64_OPRC_M32         (1ULL << 6)
+#define X86_64_OPRC_M64         (1ULL << 7)
+#define X86_64_OPRC_RM8         (1ULL << 8)     /* r8 or m8 */
+#define X86_64_OPRC_RM16        (1ULL << 9)
+#define X86_64_OPRC_RM32        (1ULL << 10)
+#define X86_64_OPRC_RM64        (1ULL << 11)
+#define X86_64_OPRC_RMU8        (1ULL << 12)    /* r8, m8 or unsized m */
+#define X86_64_OPRC_RMU16       (1ULL << 13)
+#define X86_64_OPRC_RMU32       (1ULL << 14)
+#define X86_64_OPRC_RMU64       (1ULL << 15)
+#define X86_64_OPRC_IMM8        (1ULL << 16)    /* Unsized or 8-bit imm */
+#define X86_64_OPRC_IMM16       (1ULL << 17)
+#define X86_64_OPRC_IMM32       (1ULL << 18)
+#define X86_64_OPRC_IMM64       (1ULL << 19)
+#define X86_64_OPRC_FIX8        (1ULL << 20)    /* Fixed imm that fits imm8 */
+#define X86_64_OPRC_FIX16       (1ULL << 21)
+#define X86_64_OPRC_FIX32       (1ULL << 22)
+#define X86_64_OPRC_FIX64       (1ULL << 23)
+#define X86_64_OPRC_M           (1ULL << 24)    /* Unsized m */
+#define X86_64_OPRC_REL         (1ULL << 25)    /* Relative address capable */
+#define X86_64_OPRC_3           (1ULL << 26)    /* Fixed value 3 */
+#define X86_64_OPRC_AL          (1ULL << 27)
+#define X86_64_OPRC_AX          (1ULL << 28)
+#define X86_64_OPRC_EAX         (1ULL << 29)
+#define X86_64_OPRC_RAX         (1ULL << 30)
+#define X86_64_OPRC_DX          (1ULL << 31)
+#define X86_64_OPRC_FS          (1ULL << 32)
+#define X86_64_OPRC_GS          (1ULL << 33)
+
+typedef struct _x86_64_opr {
+    x86_64_opr_type_t type;
+    union {
+        x86_64_reg_t reg;
+        x86_64_imm_t imm;
+        x86_64_addr_t addr;
+    } u;
+    size_t sopsize;
+    /* Classes (X86_64_OPRC_*) */
+    uint64_t cls;
+} x86_64_opr_t;
+
+typedef struct _x86_64_enop {
+    int opreg;
+    struct {
+        int r;
+        int x;
+        int b;
+    } rex;
+    int modrm;
+    int sib;
+    struct {
+        size_t sz;
+        int64_t val;
+        const x86_64_opr_t *eval;
+        expr_t *expr;
+    } disp;
+    struct {
+        size_t sz;
+        int64_t val;
+        const x86_64_opr_t *eval;
+        expr_t *expr;
+    } imm;
+    struct {
+        size_t sz;
+        int64_t val;
+        expr_t *expr;
+    } rel;
+    struct {
+        size_t sz;
+        int64_t val;
+        expr_t *expr;
+    } ptr0;
+    struct {
+        size_t sz;
+        int64_t val;
+        expr_t *expr;
+    } ptr1;
+} x86_64_enop_t;
+
+typedef struct _x86_64_instr {
+    int prefix1;
+    int prefix2;
+    int prefix3;
+    int prefix4;
+    int rex;
+    int opcode1;
+    int opcode2;
+    int opcode3;
+    int modrm;
+    int sib;
+    struct {
+        size_t sz;
+        int64_t val;
+        const x86_64_opr_t *eval;
+        expr_t *expr;
+    } disp;
+    struct {
+        size_t sz;
+        int64_t val;
+        const x86_64_opr_t *eval;
+        expr_t *expr;
+    } imm;
+    struct {
+        size_t sz;
+        int64_t val;
+        expr_t *expr;
+    } rel;
+    struct {
+        size_t sz;
+        int64_t val;
+        expr_t *expr;
+    } ptr0;
+    struct {
+        size_t sz;
+        int64_t val;
+        expr_t *expr;
+    } ptr1;
+} x86_64_instr_t;
+
+/*
+ * Maximum length of an instruction
+ */
+#define X86_64_INSTR_MAX_LEN    15
+
+/*
+ * Packed instruction: the encoded bytes and the offsets of the fields in
+ * them (the end of the preceding one if the field is absent)
+ */
+typedef struct _x86_64_pinstr {
+    uint8_t buf[X86_64_INSTR_MAX_LEN];
+    uint8_t len;
+    uint8_t disp;
+    uint8_t imm;
+    uint8_t rel;
+    uint8_t ptr0;
+    uint8_t ptr1;
+} x86_64_pinstr_t;
+
+typedef struct _x86_64_rval {
+    int nsym;
+    int64_t addend;
+    /* Name of the symbol to be linked (owned by the interning table) */
+    const char *symname;
+} x86_64_rval_t;
+
+typedef enum _x86_64_rela_type {
+    X86_64_RELA_PC32,
+} x86_64_rela_type_t;
+
+typedef struct _x86_64_rela {
+    off_t offset;
+    x86_64_rela_type_t type;
+    int64_t addend;
+    const char *symname;
+} x86_64_rela_t;
+
+typedef struct _x86_64_label {
+    sym_id_t label;
+    off_t min;
+    off_t max;
+    int scope;
+} x86_64_label_t;
+
+/*
+ * Label table; labels are stored in the order of insertion and indexed by an
+ * open-addressing hash keyed by the symbol (slot = label index + 1, 0 for
+ * empty)
+ */
+typedef struct _x86_64_label_table {
+    x86_64_label_t *labels;
+    size_t size;
+    size_t max_size;
+    uint32_t *slots;
+    size_t nslots;
+} x86_64_label_table_t;
+
+/*
+ * Candidate encoding of an instruction: the arguments of binstr2() to
+ * materialize it and what the layout needs to choose among the candidates
+ */
+typedef struct _x86_64_cand {
+    int16_t opc1;
+    int16_t opc2;
+    int16_t opc3;
+    int8_t opsize;
+    int8_t preg;
+    uint8_t enc;                /* x86_64_enc_t */
+    /* Size of the instruction */
+    uint8_t sz;
+    /* Non-zero if the constant values fit in the fields */
+    uint8_t fit;
+    /* Sizes and relocatable expressions (NULL if constant) of the fields */
+    struct {
+        uint8_t sz;
+        expr_t *expr;
+    } disp;
+    struct {
+        uint8_t sz;
+        expr_t *expr;
+    } imm;
+    struct {
+        uint8_t sz;
+        expr_t *expr;
+    } rel;
+} x86_64_cand_t;
+
+TVECTOR_DECLARE(x86_64_cand_vector, x86_64_cand_t, 4)
+
+/*
+ * Selected instruction: the packed instruction and what stage 3 resolves,
+ * i.e., the relocatable expressions of the fields (NULL if constant) and the
+ * constant relative value
+ */
+typedef struct _x86_64_sinstr {
+    x86_64_pinstr_t pinstr;
+    expr_t *disp;
+    expr_t *imm;
+    expr_t *rel;
+    int64_t relval;
+} x86_64_sinstr_t;
+
+typedef enum _x86_64_stmt_state {
+    X86_64_STMT_INIT,
+    /* The instruction is selected */
+    X86_64_STMT_FIXED,
+} x86_64_stmt_state_t;
+
+typedef struct _x86_64_assembler x86_64_assembler_t;
+typedef struct _x86_64_stmt x86_64_stmt_t;
+typedef int (*x86_64_instr_f)(x86_64_assembler_t *, x86_64_stmt_t *);
+
+/*
+ * Back-end statement; the records are stored in an array indexed by the
+ * statement number, and the fields that the layout stages refer to precede
+ * the ones used only to encode the instruction
+ */
+struct _x86_64_stmt {
+    const stmt_t *stmt;
+    x86_64_stmt_state_t state;
+    struct {
+        off_t min;
+        off_t max;
+    } esize;
+    struct {
+        off_t min;
+        off_t max;
+    } epos;
+    /* Selected instruction (valid if the state is X86_64_STMT_FIXED) */
+    x86_64_sinstr_t sinstr;
+    x86_64_target_t tgt;
+    int mnemonic;
+    int prefix;
+    int suffix;
+    x86_64_instr_f ifunc;
+    /* Candidates (NULL unless the generic encoder has run, and after the
+       selection) */
+    x86_64_cand_vector_t *cands;
+    /* Index of the candidate under the relaxation (-1 if none) */
+    int rcand;
+    /* Operands */
+    size_t nopr;
+    x86_64_opr_t oprs[INSTR_MAX_OPERANDS];
+};
+
+/*
+ * Key of the encoding cache: the mnemonic, the *fixes, the target and the
+ * operands of a statement packed into words
+ */
+#define X86_64_ECACHE_KEY_WORDS (3 + 3 * INSTR_MAX_OPERANDS)
+typedef struct _x86_64_ecache_key {
+    uint64_t w[X86_64_ECACHE_KEY_WORDS];
+    size_t n;
+    uint64_t hash;
+} x86_64_ecache_key_t;
+
+/*
+ * Entry of the encoding cache: the selected instruction of the key
+ */
+typedef struct _x86_64_ecache_entry {
+    x86_64_ecache_key_t key;
+    x86_64_sinstr_t sinstr;
+} x86_64_ecache_entry_t;
+
+/*
+ * Encoding cache of the instructions fixed in stage 1; entries are added
+ * until the table is full and indexed by an open-addressing hash (slot =
+ * entry index + 1, 0 for empty).  Both arrays grow as the entries are added,
+ * up to max_size entries.
+ */
+typedef struct _x86_64_ecache {
+    x86_64_ecache_entry_t *entries;
+    size_t size;
+    size_t alloc_size;
+    size_t max_size;
+    uint32_t *slots;
+    size_t nslots;
+    /* Statistics */
+    size_t adds;
+    size_t lookups;
+    size_t hits;
+} x86_64_ecache_t;
+
+/*
+ * Fenwick tree of the sizes of the statements; the position of a statement is
+ * the prefix sum of the sizes of the preceding ones
+ */
+typedef struct _x86_64_fenwick {
+    off_t *tree;
+    size_t n;
+} x86_64_fenwick_t;
+
+/*
+ * Span index: a segment tree over the statement numbers each node of which
+ * lists the spans covering the range of the node, so that the spans
+ * containing a statement are on the path from the leaf to the root; the list
+ * of node i is items[start[i]] to items[start[i + 1] - 1]
+ */
+typedef struct _x86_64_span_index {
+    size_t base;
+    size_t *start;
+    size_t *items;
+    /* Rounds of the last report of the nodes and the spans */
+    size_t *nstamp;
+    size_t *istamp;
+} x86_64_span_index_t;
+
+/*
+ * State of the relaxation: the instructions to be relaxed, the labels each
+ * of them depends on (deps[dstart[i]] to deps[dstart[i + 1] - 1] as the
+ * indices in the label table), the statement numbers of the labels, the
+ * positions, and the spans to be re-evaluated when a statement grows
+ */
+typedef struct _x86_64_relax {
+    size_t *stmts;
+    size_t n;
+    size_t *dstart;
+    size_t *deps;
+    size_t *lstmts;
+    x86_64_fenwick_t pos;
+    x86_64_span_index_t spans;
+} x86_64_relax_t;
+
+struct _x86_64_assembler {
+    int stage;
+    /* Parsed code */
+    icode_t *icode;
+    x86_64_label_table_t lbtbl;
+    x86_64_ecache_t ecache;
+    /* Statements */
+    x86_64_stmt_t *xstmts;
+    size_t nxstmts;
+    /* Number of the worker threads of stage 1 */
+    size_t jobs;
+    /* Stream of the diagnostics of stage 1 */
+    FILE *err;
+    /* Statistics of the relaxation */
+    struct {
+        size_t passes;
+        size_t grown;
+        size_t evals;
+    } relax;
+};
+
+/*
+ * Minimum number of the statements of a worker
+ */
+#define X86_64_MIN_CHUNK        4096
+
+/*
+ * Worker: runs a pass over the statements from start to end - 1.  A worker
+ * alone runs on the assembler itself; otherwise on its own copy (local) of
+ * which encoding cache is its own share of the entries and of which
+ * diagnostics are written to the buffer to be printed in the order of the
+ * statements.  pos and size carry the prefix sum of the layout.
+ */
+typedef struct _x86_64_worker x86_64_worker_t;
+struct _x86_64_worker {
+    x86_64_assembler_t *asmblr;
+    x86_64_assembler_t local;
+    int (*fn)(x86_64_worker_t *);
+    size_t start;
+    size_t end;
+    off_t pos;
+    off_t size;
+    int ret;
+    char *errbuf;
+    size_t errlen;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    int x86_64_convert_operand(const operand_t *, x86_64_opr_t *);
+    int x86_64_convert_operand_simple(const operand_t *, x86_64_opr_t *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ARCH_X86_64_MAIN_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
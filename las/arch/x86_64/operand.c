@@ -11,27 +11,17 @@
 #include <stdint.h>
 #include <string.h>
 
-static x86_64_opr_t * _estimate_expr_var(expr_t *);
-static x86_64_opr_t * _estimate_expr_int(expr_t *);
-static x86_64_opr_t * _estimate_expr_op(expr_t *);
-static x86_64_opr_t * _estimate_expr(expr_t *);
+#define ESTIMATE_STACK_SIZE     16
 
 /*
  * Estimate var expression
  */
-static x86_64_opr_t *
-_estimate_expr_var(expr_t *expr)
+static void
+_estimate_expr_var(expr_t *expr, x86_64_opr_t *opr)
 {
-    x86_64_opr_t *opr;
     x86_64_reg_t reg;
 
-    /* Allocate estimated value */
-    opr = malloc(sizeof(x86_64_opr_t));
-    if ( NULL == opr ) {
-        return NULL;
-    }
-
-    reg = strtoreg(expr->u.var);
+    reg = x86_64_sym_reg(expr->u.var);
     if ( REG_UNKNOWN == reg ) {
         /* Symbol */
         opr->type = X86_64_OPR_IMM;
@@ -44,444 +34,423 @@ _estimate_expr_var(expr_t *expr)
         opr->u.reg = reg;
         opr->sopsize = 0;
     }
-
-    return opr;
 }
 
 /*
  * Estimate integer expression
  */
-static x86_64_opr_t *
-_estimate_expr_int(expr_t *expr)
+static void
+_estimate_expr_int(expr_t *expr, x86_64_opr_t *opr)
 {
-    x86_64_opr_t *opr;
-
-    opr = malloc(sizeof(x86_64_opr_t));
-    if ( NULL == opr ) {
-        return NULL;
-    }
     opr->type = X86_64_OPR_IMM;
     opr->u.imm.type = X86_64_IMM_FIXED;
     opr->u.imm.u.fixed = expr->u.i;
     opr->sopsize = 0;
-
-    return opr;
 }
 
 /*
- * Estimate operand
+ * Estimate symbol-plus-addend expression
  */
-static x86_64_opr_t *
-_estimate_expr_op(expr_t *expr)
+static void
+_estimate_expr_symadd(expr_t *expr, x86_64_opr_t *opr)
 {
-    x86_64_opr_t *opr;
-    x86_64_opr_t *lopr;
-    x86_64_opr_t *ropr;
-    expr_t *expr0;
-    expr_t *expr1;
-
-    /* Allocate the estimated value */
-    opr = malloc(sizeof(x86_64_opr_t));
-    if ( NULL == opr ) {
-        return NULL;
+    x86_64_reg_t reg;
+
+    reg = x86_64_sym_reg(expr->u.symadd.var);
+    if ( REG_UNKNOWN == reg ) {
+        /* Symbol */
+        opr->type = X86_64_OPR_IMM;
+        opr->u.imm.type = X86_64_IMM_EXPR;
+        opr->u.imm.u.rexpr = expr;
+        opr->sopsize = 0;
+    } else {
+        /* Base register + Displacement */
+        opr->type = X86_64_OPR_ADDR;
+        opr->u.addr.flags = X86_64_ADDR_BASE | X86_64_ADDR_DISP;
+        opr->u.addr.base = reg;
+        opr->u.addr.disp.type = X86_64_IMM_FIXED;
+        opr->u.addr.disp.u.fixed = expr->u.symadd.addend;
+        opr->u.addr.saddrsize = 0;
+        opr->sopsize = 0;
     }
-    opr->sopsize = 0;
+}
 
-    /* Refactoring is required... */
-    if ( FIX_PREFIX == expr->u.op.fix_type ) {
-        expr0 = vector_at(expr->u.op.args, 0);
-        lopr = _estimate_expr(expr0);
-        if ( NULL == lopr ) {
-            free(opr);
-            return NULL;
+/*
+ * Estimate prefix operator from the estimated operand
+ */
+static int
+_estimate_expr_prefix(expr_t *expr, const x86_64_opr_t *lopr,
+                      x86_64_opr_t *opr)
+{
+    if ( X86_64_OPR_IMM == lopr->type ) {
+        if ( X86_64_IMM_FIXED == lopr->u.imm.type ) {
+            opr->type = X86_64_OPR_IMM;
+            opr->u.imm.type = X86_64_IMM_FIXED;
+            switch ( expr->u.op.type ) {
+            case OP_PLUS:
+                /* Do nothing: Just copy */
+                opr->u.imm.u.fixed = lopr->u.imm.u.fixed;
+                break;
+            case OP_MINUS:
+                /* Minus */
+                opr->u.imm.u.fixed = -lopr->u.imm.u.fixed;
+                break;
+            case OP_TILDE:
+                /* Bitwise not */
+                opr->u.imm.u.fixed = ~lopr->u.imm.u.fixed;
+                break;
+            default:
+                return -1;
+            }
+        } else {
+            opr->type = X86_64_OPR_IMM;
+            opr->u.imm.type = X86_64_IMM_EXPR;
+            switch ( expr->u.op.type ) {
+            case OP_PLUS:
+            case OP_MINUS:
+                /* Do nothing */
+                opr->u.imm.u.rexpr = expr;
+                break;
+            default:
+                return -1;
+            }
         }
-        if ( X86_64_OPR_IMM == lopr->type ) {
-            if ( X86_64_IMM_FIXED == lopr->u.imm.type ) {
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Estimate infix operator from the estimated operands
+ */
+static int
+_estimate_expr_infix(expr_t *expr, const x86_64_opr_t *lopr,
+                     const x86_64_opr_t *ropr, x86_64_opr_t *opr)
+{
+    switch ( expr->u.op.type ) {
+    case OP_PLUS:
+        if ( X86_64_OPR_IMM == lopr->type
+             && X86_64_OPR_IMM == ropr->type ) {
+            if ( X86_64_IMM_FIXED == lopr->u.imm.type
+                 && X86_64_IMM_FIXED == ropr->u.imm.type ) {
                 opr->type = X86_64_OPR_IMM;
                 opr->u.imm.type = X86_64_IMM_FIXED;
-                switch ( expr->u.op.type ) {
-                case OP_PLUS:
-                    /* Do nothing: Just copy */
-                    opr->u.imm.u.fixed = lopr->u.imm.u.fixed;
-                    break;
-                case OP_MINUS:
-                    /* Minus */
-                    opr->u.imm.u.fixed = -lopr->u.imm.u.fixed;
-                    break;
-                case OP_TILDE:
-                    /* Bitwise not */
-                    opr->u.imm.u.fixed = ~lopr->u.imm.u.fixed;
-                    break;
-                default:
-                    free(opr);
-                    return NULL;
-                }
-            } else {
+                opr->u.imm.u.fixed
+                    = lopr->u.imm.u.fixed + ropr->u.imm.u.fixed;
+                opr->sopsize = 0;
+            } else if ( X86_64_IMM_EXPR == lopr->u.imm.type
+                        || X86_64_IMM_EXPR == ropr->u.imm.type ) {
                 opr->type = X86_64_OPR_IMM;
                 opr->u.imm.type = X86_64_IMM_EXPR;
-                switch ( expr->u.op.type ) {
-                case OP_PLUS:
-                case OP_MINUS:
-                    /* Do nothing */
-                    opr->u.imm.u.rexpr = expr;
-                    break;
-                default:
-                    free(opr);
-                    return NULL;
-                }
+                opr->u.imm.u.rexpr = expr;
+                opr->sopsize = 0;
+            } else {
+                /* Invalid syntax */
+                return -1;
             }
-        } else {
-            free(opr);
-            return NULL;
-        }
-    } else if ( FIX_INFIX == expr->u.op.fix_type ) {
-        expr0 = vector_at(expr->u.op.args, 0);
-        expr1 = vector_at(expr->u.op.args, 1);
-
-        lopr = _estimate_expr(expr0);
-        if ( NULL == lopr ) {
-            free(opr);
-            return NULL;
-        }
-        ropr = _estimate_expr(expr1);
-        if ( NULL == ropr ) {
-            /* Free lval */
-            free(opr);
-            free(lopr);
-            return NULL;
-        }
-        switch ( expr->u.op.type ) {
-        case OP_PLUS:
-            if ( X86_64_OPR_IMM == lopr->type
-                 && X86_64_OPR_IMM == ropr->type ) {
-                if ( X86_64_IMM_FIXED == lopr->u.imm.type
-                     && X86_64_IMM_FIXED == ropr->u.imm.type ) {
-                    opr->type = X86_64_OPR_IMM;
-                    opr->u.imm.type = X86_64_IMM_FIXED;
-                    opr->u.imm.u.fixed
-                        = lopr->u.imm.u.fixed + ropr->u.imm.u.fixed;
-                    opr->sopsize = 0;
-                } else if ( X86_64_IMM_EXPR == lopr->u.imm.type
-                            || X86_64_IMM_EXPR == ropr->u.imm.type ) {
-                    opr->type = X86_64_OPR_IMM;
-                    opr->u.imm.type = X86_64_IMM_EXPR;
-                    opr->u.imm.u.rexpr = expr;
-                    opr->sopsize = 0;
-                } else {
+        } else if ( X86_64_OPR_REG == lopr->type
+                    && X86_64_OPR_IMM == ropr->type ) {
+            /* Base register + Displacement */
+            opr->type = X86_64_OPR_ADDR;
+            opr->u.addr.flags = X86_64_ADDR_BASE | X86_64_ADDR_DISP;
+            opr->u.addr.base = lopr->u.reg;
+            (void)memcpy(&opr->u.addr.disp, &ropr->u.imm,
+                         sizeof(x86_64_imm_t));
+            opr->u.addr.saddrsize = 0;
+            opr->sopsize = 0;
+        } else if ( X86_64_OPR_IMM == lopr->type
+                    && X86_64_OPR_REG == ropr->type ) {
+            /* Base register + Displacement */
+            opr->type = X86_64_OPR_ADDR;
+            opr->u.addr.flags = X86_64_ADDR_BASE | X86_64_ADDR_DISP;
+            opr->u.addr.base = ropr->u.reg;
+            (void)memcpy(&opr->u.addr.disp, &lopr->u.imm,
+                         sizeof(x86_64_imm_t));
+            opr->u.addr.saddrsize = 0;
+            opr->sopsize = 0;
+        } else if ( X86_64_OPR_REG == lopr->type
+                    && X86_64_OPR_REG == ropr->type ) {
+            /* Base register + Offset register */
+            opr->type = X86_64_OPR_ADDR;
+            opr->u.addr.flags = X86_64_ADDR_BASE | X86_64_ADDR_OFFSET
+                | X86_64_ADDR_SCALE;
+            opr->u.addr.base = lopr->u.reg;
+            opr->u.addr.offset = ropr->u.reg;
+            opr->u.addr.scale = 1;
+            opr->u.addr.saddrsize = 0;
+            opr->sopsize = 0;
+        } else if ( X86_64_OPR_ADDR == lopr->type ) {
+            if ( X86_64_OPR_REG == ropr->type ) {
+                /* Base register */
+                if ( X86_64_ADDR_BASE & lopr->u.addr.flags ) {
                     /* Invalid syntax */
-                    free(opr);
-                    free(lopr);
-                    free(ropr);
-                    return NULL;
+                    return -1;
                 }
-            } else if ( X86_64_OPR_REG == lopr->type
-                        && X86_64_OPR_IMM == ropr->type ) {
-                /* Base register + Displacement */
                 opr->type = X86_64_OPR_ADDR;
-                opr->u.addr.flags = X86_64_ADDR_BASE | X86_64_ADDR_DISP;
-                opr->u.addr.base = lopr->u.reg;
-                (void)memcpy(&opr->u.addr.disp, &ropr->u.imm,
+                opr->u.addr.flags = X86_64_ADDR_BASE | lopr->u.addr.flags;
+                opr->u.addr.base = ropr->u.reg;
+                opr->u.addr.offset = lopr->u.addr.offset;
+                opr->u.addr.scale = lopr->u.addr.scale;
+                (void)memcpy(&opr->u.addr.disp, &lopr->u.addr.disp,
                              sizeof(x86_64_imm_t));
                 opr->u.addr.saddrsize = 0;
                 opr->sopsize = 0;
-            } else if ( X86_64_OPR_IMM == lopr->type
-                        && X86_64_OPR_REG == ropr->type ) {
-                /* Base register + Displacement */
+            } else if ( X86_64_OPR_IMM == ropr->type ) {
+                /* Displacement */
+                if ( X86_64_ADDR_DISP & lopr->u.addr.flags ) {
+                    /* Invalid syntax */
+                    return -1;
+                }
                 opr->type = X86_64_OPR_ADDR;
-                opr->u.addr.flags = X86_64_ADDR_BASE | X86_64_ADDR_DISP;
-                opr->u.addr.base = ropr->u.reg;
-                (void)memcpy(&opr->u.addr.disp, &lopr->u.imm,
+                opr->u.addr.flags = X86_64_ADDR_DISP | lopr->u.addr.flags;
+                (void)memcpy(&opr->u.addr.disp, &ropr->u.imm,
                              sizeof(x86_64_imm_t));
+                opr->u.addr.base = lopr->u.addr.base;
+                opr->u.addr.offset = lopr->u.addr.offset;
+                opr->u.addr.scale = lopr->u.addr.scale;
                 opr->u.addr.saddrsize = 0;
                 opr->sopsize = 0;
-            } else if ( X86_64_OPR_REG == lopr->type
-                        && X86_64_OPR_REG == ropr->type ) {
-                /* Base register + Offset register */
+            } else {
+                /* Invalid syntax */
+                return -1;
+            }
+        } else if ( X86_64_OPR_ADDR == ropr->type ) {
+            if ( X86_64_OPR_REG == lopr->type ) {
+                /* Base register */
+                if ( X86_64_ADDR_BASE & ropr->u.addr.flags ) {
+                    /* Invalid syntax */
+                    return -1;
+                }
                 opr->type = X86_64_OPR_ADDR;
-                opr->u.addr.flags = X86_64_ADDR_BASE | X86_64_ADDR_OFFSET
-                    | X86_64_ADDR_SCALE;
+                opr->u.addr.flags = X86_64_ADDR_BASE | ropr->u.addr.flags;
                 opr->u.addr.base = lopr->u.reg;
-                opr->u.addr.offset = ropr->u.reg;
-                opr->u.addr.scale = 1;
+                opr->u.addr.offset = ropr->u.addr.offset;
+                opr->u.addr.scale = ropr->u.addr.scale;
+                (void)memcpy(&opr->u.addr.disp, &ropr->u.addr.disp,
+                             sizeof(x86_64_imm_t));
                 opr->u.addr.saddrsize = 0;
                 opr->sopsize = 0;
-            } else if ( X86_64_OPR_ADDR == lopr->type ) {
-                if ( X86_64_OPR_REG == ropr->type ) {
-                    /* Base register */
-                    if ( X86_64_ADDR_BASE & lopr->u.addr.flags ) {
-                        /* Invalid syntax */
-                        free(opr);
-                        free(lopr);
-                        free(ropr);
-                        return NULL;
-                    }
-                    opr->type = X86_64_OPR_ADDR;
-                    opr->u.addr.flags = X86_64_ADDR_BASE | lopr->u.addr.flags;
-                    opr->u.addr.base = ropr->u.reg;
-                    opr->u.addr.offset = lopr->u.addr.offset;
-                    opr->u.addr.scale = lopr->u.addr.scale;
-                    (void)memcpy(&opr->u.addr.disp, &lopr->u.addr.disp,
-                                 sizeof(x86_64_imm_t));
-                    opr->u.addr.saddrsize = 0;
-                    opr->sopsize = 0;
-                } else if ( X86_64_OPR_IMM == ropr->type ) {
-                    /* Displacement */
-                    if ( X86_64_ADDR_DISP & lopr->u.addr.flags ) {
-                        /* Invalid syntax */
-                        free(opr);
-                        free(lopr);
-                        free(ropr);
-                        return NULL;
-                    }
-                    opr->type = X86_64_OPR_ADDR;
-                    opr->u.addr.flags = X86_64_ADDR_DISP | lopr->u.addr.flags;
-                    (void)memcpy(&opr->u.addr.disp, &ropr->u.imm,
-                                 sizeof(x86_64_imm_t));
-                    opr->u.addr.base = lopr->u.addr.base;
-                    opr->u.addr.offset = lopr->u.addr.offset;
-                    opr->u.addr.scale = lopr->u.addr.scale;
-                    opr->u.addr.saddrsize = 0;
-                    opr->sopsize = 0;
-                } else {
+            } else if ( X86_64_OPR_IMM == lopr->type ) {
+                /* Displacement */
+                if ( X86_64_ADDR_DISP & ropr->u.addr.flags ) {
                     /* Invalid syntax */
-                    free(opr);
-                    free(lopr);
-                    free(ropr);
-                    return NULL;
-                }
-            } else if ( X86_64_OPR_ADDR == ropr->type ) {
-                if ( X86_64_OPR_REG == lopr->type ) {
-                    /* Base register */
-                    if ( X86_64_ADDR_BASE & ropr->u.addr.flags ) {
-                        /* Invalid syntax */
-                        free(opr);
-                        free(lopr);
-                        free(ropr);
-                        return NULL;
-                    }
-                    opr->type = X86_64_OPR_ADDR;
-                    opr->u.addr.flags = X86_64_ADDR_BASE | ropr->u.addr.flags;
-                    opr->u.addr.base = lopr->u.reg;
-                    opr->u.addr.saddrsize = 0;
-                    opr->sopsize = 0;
-                } else if ( X86_64_OPR_IMM == lopr->type ) {
-                    /* Displacement */
-                    if ( X86_64_ADDR_DISP & ropr->u.addr.flags ) {
-                        /* Invalid syntax */
-                        free(opr);
-                        free(lopr);
-                        free(ropr);
-                        return NULL;
-                    }
-                    opr->type = X86_64_OPR_ADDR;
-                    opr->u.addr.flags = X86_64_ADDR_DISP | ropr->u.addr.flags;
-                    (void)memcpy(&opr->u.addr.disp, &lopr->u.imm,
-                                 sizeof(x86_64_imm_t));
-                    opr->u.addr.saddrsize = 0;
-                    opr->sopsize = 0;
-                } else {
-                    /* Invalid syntax */
-                    free(opr);
-                    free(lopr);
-                    free(ropr);
-                    return NULL;
+                    return -1;
                 }
+                opr->type = X86_64_OPR_ADDR;
+                opr->u.addr.flags = X86_64_ADDR_DISP | ropr->u.addr.flags;
+                (void)memcpy(&opr->u.addr.disp, &lopr->u.imm,
+                             sizeof(x86_64_imm_t));
+                opr->u.addr.base = ropr->u.addr.base;
+                opr->u.addr.offset = ropr->u.addr.offset;
+                opr->u.addr.scale = ropr->u.addr.scale;
+                opr->u.addr.saddrsize = 0;
+                opr->sopsize = 0;
+            } else {
+                /* Invalid syntax */
+                return -1;
+            }
+        } else {
+            /* Invalid */
+            return -1;
+        }
+        break;
+    case OP_MINUS:
+        if ( X86_64_OPR_IMM == lopr->type
+             && X86_64_OPR_IMM == ropr->type ) {
+            if ( X86_64_IMM_FIXED == lopr->u.imm.type
+                 && X86_64_IMM_FIXED == ropr->u.imm.type ) {
+                opr->type = X86_64_OPR_IMM;
+                opr->u.imm.type = X86_64_IMM_FIXED;
+                opr->u.imm.u.fixed
+                    = lopr->u.imm.u.fixed - ropr->u.imm.u.fixed;
+                opr->sopsize = 0;
+            } else if ( X86_64_IMM_EXPR == lopr->u.imm.type
+                        || X86_64_IMM_EXPR == ropr->u.imm.type ) {
+                opr->type = X86_64_OPR_IMM;
+                opr->u.imm.type = X86_64_IMM_EXPR;
+                opr->u.imm.u.rexpr = expr;
+                opr->sopsize = 0;
+            } else {
+                /* Invalid syntax */
+                return -1;
+            }
+        } else {
+            /* Invalid */
+            return -1;
+        }
+        break;
+    case OP_MUL:
+        if ( X86_64_OPR_IMM == lopr->type
+             && X86_64_OPR_IMM == ropr->type ) {
+            if ( X86_64_IMM_FIXED == lopr->u.imm.type
+                 && X86_64_IMM_FIXED == ropr->u.imm.type ) {
+                opr->type = X86_64_OPR_IMM;
+                opr->u.imm.type = X86_64_IMM_FIXED;
+                opr->u.imm.u.fixed
+                    = lopr->u.imm.u.fixed * ropr->u.imm.u.fixed;
+                opr->sopsize = 0;
             } else {
                 /* Invalid */
-                free(opr);
-                free(lopr);
-                free(ropr);
-                return NULL;
+                return -1;
             }
-            break;
-        case OP_MINUS:
-            if ( X86_64_OPR_IMM == lopr->type
-                 && X86_64_OPR_IMM == ropr->type ) {
-                if ( X86_64_IMM_FIXED == lopr->u.imm.type
-                     && X86_64_IMM_FIXED == ropr->u.imm.type ) {
-                    opr->type = X86_64_OPR_IMM;
-                    opr->u.imm.type = X86_64_IMM_FIXED;
-                    opr->u.imm.u.fixed
-                        = lopr->u.imm.u.fixed - ropr->u.imm.u.fixed;
-                    opr->sopsize = 0;
-                } else if ( X86_64_IMM_EXPR == lopr->u.imm.type
-                            || X86_64_IMM_EXPR == ropr->u.imm.type ) {
-                    opr->type = X86_64_OPR_IMM;
-                    opr->u.imm.type = X86_64_IMM_EXPR;
-                    opr->u.imm.u.rexpr = expr;
-                    opr->sopsize = 0;
-                } else {
-                    /* Invalid syntax */
-                    free(opr);
-                    free(lopr);
-                    free(ropr);
-                    return NULL;
-                }
+        } else if ( X86_64_OPR_IMM == lopr->type
+                    && X86_64_OPR_REG == ropr->type ) {
+            if ( X86_64_IMM_FIXED == lopr->u.imm.type ) {
+                /* The scale must be a fixed value */
+                opr->type = X86_64_OPR_ADDR;
+                opr->u.addr.flags = X86_64_ADDR_OFFSET | X86_64_ADDR_SCALE;
+                opr->u.addr.offset = ropr->u.reg;
+                opr->u.addr.scale = lopr->u.imm.u.fixed;
+                opr->u.addr.saddrsize = 0;
+                opr->sopsize = 0;
             } else {
                 /* Invalid */
-                free(opr);
-                free(lopr);
-                free(ropr);
-                return NULL;
+                return -1;
             }
-            break;
-        case OP_MUL:
-            if ( X86_64_OPR_IMM == lopr->type
-                 && X86_64_OPR_IMM == ropr->type ) {
-                if ( X86_64_IMM_FIXED == lopr->u.imm.type
-                     && X86_64_IMM_FIXED == ropr->u.imm.type ) {
-                    opr->type = X86_64_OPR_IMM;
-                    opr->u.imm.type = X86_64_IMM_FIXED;
-                    opr->u.imm.u.fixed
-                        = lopr->u.imm.u.fixed * ropr->u.imm.u.fixed;
-                    opr->sopsize = 0;
-                } else {
-                    /* Invalid */
-                    free(opr);
-                    free(lopr);
-                    free(ropr);
-                    return NULL;
-                }
-            } else if ( X86_64_OPR_IMM == lopr->type
-                        && X86_64_OPR_REG == ropr->type ) {
-                if ( X86_64_IMM_FIXED == lopr->u.imm.type ) {
-                    /* The scale must be a fixed value */
-                    opr->type = X86_64_OPR_ADDR;
-                    opr->u.addr.flags = X86_64_ADDR_OFFSET | X86_64_ADDR_SCALE;
-                    opr->u.addr.offset = ropr->u.reg;
-                    opr->u.addr.scale = lopr->u.imm.u.fixed;
-                    opr->u.addr.saddrsize = 0;
-                    opr->sopsize = 0;
-                } else {
-                    /* Invalid */
-                    free(opr);
-                    free(lopr);
-                    free(ropr);
-                    return NULL;
-                }
-            } else if ( X86_64_OPR_REG == lopr->type
-                        && X86_64_OPR_IMM == ropr->type ) {
-                if ( X86_64_IMM_FIXED == ropr->u.imm.type ) {
-                    /* The scale must be a fixed value */
-                    opr->type = X86_64_OPR_ADDR;
-                    opr->u.addr.flags = X86_64_ADDR_OFFSET | X86_64_ADDR_SCALE;
-                    opr->u.addr.offset = lopr->u.reg;
-                    opr->u.addr.scale = ropr->u.imm.u.fixed;
-                    opr->u.addr.saddrsize = 0;
-                    opr->sopsize = 0;
-                } else {
-                    /* Invalid */
-                    free(opr);
-                    free(lopr);
-                    free(ropr);
-                    return NULL;
-                }
+        } else if ( X86_64_OPR_REG == lopr->type
+                    && X86_64_OPR_IMM == ropr->type ) {
+            if ( X86_64_IMM_FIXED == ropr->u.imm.type ) {
+                /* The scale must be a fixed value */
+                opr->type = X86_64_OPR_ADDR;
+                opr->u.addr.flags = X86_64_ADDR_OFFSET | X86_64_ADDR_SCALE;
+                opr->u.addr.offset = lopr->u.reg;
+                opr->u.addr.scale = ropr->u.imm.u.fixed;
+                opr->u.addr.saddrsize = 0;
+                opr->sopsize = 0;
             } else {
                 /* Invalid */
-                free(opr);
-                free(lopr);
-                free(ropr);
-                return NULL;
+                return -1;
             }
-            break;
-        case OP_DIV:
-            if ( X86_64_OPR_IMM == lopr->type
-                 && X86_64_OPR_IMM == ropr->type ) {
-                if ( X86_64_IMM_FIXED == lopr->u.imm.type
-                     && X86_64_IMM_FIXED == ropr->u.imm.type ) {
-                    opr->type = X86_64_OPR_IMM;
-                    opr->u.imm.type = X86_64_IMM_FIXED;
-                    opr->u.imm.u.fixed
-                        = lopr->u.imm.u.fixed / ropr->u.imm.u.fixed;
-                    opr->sopsize = 0;
-                } else {
-                    /* Invalid */
-                    free(opr);
-                    free(lopr);
-                    free(ropr);
-                    return NULL;
-                }
+        } else {
+            /* Invalid */
+            return -1;
+        }
+        break;
+    case OP_DIV:
+        if ( X86_64_OPR_IMM == lopr->type
+             && X86_64_OPR_IMM == ropr->type ) {
+            if ( X86_64_IMM_FIXED == lopr->u.imm.type
+                 && X86_64_IMM_FIXED == ropr->u.imm.type ) {
+                opr->type = X86_64_OPR_IMM;
+                opr->u.imm.type = X86_64_IMM_FIXED;
+                opr->u.imm.u.fixed
+                    = lopr->u.imm.u.fixed / ropr->u.imm.u.fixed;
+                opr->sopsize = 0;
             } else {
                 /* Invalid */
-                free(opr);
-                free(lopr);
-                free(ropr);
-                return NULL;
+                return -1;
             }
-            break;
-        default:
-            /* Unsupported operator */
-            free(opr);
-            free(lopr);
-            free(ropr);
-            return NULL;
+        } else {
+            /* Invalid */
+            return -1;
         }
-
+        break;
+    default:
+        /* Unsupported operator */
+        return -1;
     }
 
-    return opr;
+
+    return 0;
 }
 
 /*
- * Estimate the expression (static function)
+ * Estimate the expression (static function); the nodes are estimated in
+ * post-order with a stack of the estimated operands
  */
-static x86_64_opr_t *
-_estimate_expr(expr_t *expr)
+static int
+_estimate_expr(expr_t *expr, x86_64_opr_t *opr)
 {
-    x86_64_opr_t *opr;
+    x86_64_opr_t lstk[ESTIMATE_STACK_SIZE];
+    x86_64_opr_t *stk;
+    x86_64_opr_t res;
+    expr_t *e;
+    size_t sp;
+    int ret;
+
+    /* The depth of the stack does not exceed the number of the nodes */
+    if ( expr->size <= ESTIMATE_STACK_SIZE ) {
+        stk = lstk;
+    } else {
+        stk = malloc(sizeof(x86_64_opr_t) * expr->size);
+        if ( NULL == stk ) {
+            return -1;
+        }
+    }
 
-    switch ( expr->type ) {
-    case EXPR_VAR:
-        opr = _estimate_expr_var(expr);
-        break;
-    case EXPR_INT:
-        opr = _estimate_expr_int(expr);
-        break;
-    case EXPR_OP:
-        opr = _estimate_expr_op(expr);
-        break;
-    default:
-        opr = NULL;
+    sp = 0;
+    ret = 0;
+    for ( e = EXPR_FIRST(expr); e <= expr && 0 == ret; e++ ) {
+        (void)memset(&res, 0, sizeof(x86_64_opr_t));
+        switch ( e->type ) {
+        case EXPR_VAR:
+            _estimate_expr_var(e, &stk[sp++]);
+            break;
+        case EXPR_INT:
+            _estimate_expr_int(e, &stk[sp++]);
+            break;
+        case EXPR_SYMADD:
+            (void)memset(&stk[sp], 0, sizeof(x86_64_opr_t));
+            _estimate_expr_symadd(e, &stk[sp++]);
+            break;
+        case EXPR_OP:
+            if ( FIX_PREFIX == e->u.op.fix_type ) {
+                ret = _estimate_expr_prefix(e, &stk[sp - 1], &res);
+            } else if ( FIX_INFIX == e->u.op.fix_type ) {
+                ret = _estimate_expr_infix(e, &stk[sp - 2], &stk[sp - 1],
+                                           &res);
+                sp--;
+            } else {
+                ret = -1;
+            }
+            stk[sp - 1] = res;
+            break;
+        default:
+            ret = -1;
+        }
     }
 
-    return opr;
+    if ( 0 == ret ) {
+        *opr = stk[0];
+    }
+    if ( stk != lstk ) {
+        free(stk);
+    }
+
+    return ret;
 }
 
 /*
  * Estimate immediate value or register
  */
-static x86_64_opr_t *
-_estimate_expr_imm_or_reg(expr_t *expr)
+static int
+_estimate_expr_imm_or_reg(expr_t *expr, x86_64_opr_t *opr)
 {
-    x86_64_opr_t *opr;
-
-    opr = _estimate_expr(expr);
+    if ( 0 != _estimate_expr(expr, opr) ) {
+        return -1;
+    }
 
-    /* Verify the returned value */
-    if ( NULL == opr ) {
-        return NULL;
-    } else if ( X86_64_OPR_REG != opr->type
-                && X86_64_OPR_IMM != opr->type ) {
-        free(opr);
-        return NULL;
+    /* Verify the estimated value */
+    if ( X86_64_OPR_REG != opr->type && X86_64_OPR_IMM != opr->type ) {
+        return -1;
     }
 
-    return opr;
+    return 0;
 }
 
 /*
  * Estimate the expression which is address operand type
  */
-static x86_64_opr_t *
-_estimate_expr_addr(pexpr_t *pexpr)
+static int
+_estimate_expr_addr(expr_t *expr, size_prefix_t prefix, x86_64_opr_t *opr)
 {
-    x86_64_opr_t *opr;
     x86_64_reg_t reg;
     x86_64_imm_t imm;
 
-    opr = _estimate_expr(pexpr->expr);
-    if ( NULL == opr ) {
-        return NULL;
+    if ( 0 != _estimate_expr(expr, opr) ) {
+        return -1;
     }
 
     /* Convert the type to address operand */
@@ -502,7 +471,7 @@ _estimate_expr_addr(pexpr_t *pexpr)
     }
 
     /* Check the operand prefix */
-    switch ( pexpr->prefix ) {
+    switch ( prefix ) {
     case SIZE_PREFIX_BYTE:
         opr->sopsize = SIZE8;
         break;
@@ -520,38 +489,132 @@ _estimate_expr_addr(pexpr_t *pexpr)
         ;
     }
 
-    /* Verify the returned value */
+    /* Verify the estimated value */
     if ( X86_64_OPR_ADDR != opr->type ) {
-        free(opr);
-        return NULL;
+        return -1;
     }
 
-    return opr;
+    return 0;
 }
 
 /*
- * Covert the operand
+ * Index of the operand size in the classes of the same kind, or -1 if unsized
  */
-x86_64_opr_t *
-x86_64_convert_operand(operand_t *op)
+static __inline__ int
+_class_size_index(size_t sz)
 {
-    x86_64_opr_t *opr;
-    size_t sz;
-
-    if ( OEXPR_EXPR == op->oexpr0->type ) {
-        /* Immediate value or register */
-        opr = _estimate_expr_imm_or_reg(op->oexpr0->u.expr);
-    } else if ( OEXPR_ADDR == op->oexpr0->type ) {
-        /* Address */
-        opr = _estimate_expr_addr(op->oexpr0->u.pexpr);
-    } else {
-        return NULL;
+    switch ( sz ) {
+    case SIZE8:
+        return 0;
+    case SIZE16:
+        return 1;
+    case SIZE32:
+        return 2;
+    case SIZE64:
+        return 3;
+    default:
+        return -1;
     }
-    /* Check the returned value */
-    if ( NULL == opr ) {
-        return NULL;
+}
+
+/*
+ * Compute the classes of the operand
+ */
+static uint64_t
+_operand_class(const x86_64_opr_t *opr)
+{
+    uint64_t cls;
+    int64_t val;
+    int k;
+
+    cls = 0;
+    k = _class_size_index(opr->sopsize);
+    switch ( opr->type ) {
+    case X86_64_OPR_REG:
+        if ( k >= 0 ) {
+            cls |= (X86_64_OPRC_R8 | X86_64_OPRC_RM8 | X86_64_OPRC_RMU8) << k;
+        }
+        switch ( opr->u.reg ) {
+        case REG_AL:
+            cls |= X86_64_OPRC_AL;
+            break;
+        case REG_AX:
+            cls |= X86_64_OPRC_AX;
+            break;
+        case REG_EAX:
+            cls |= X86_64_OPRC_EAX;
+            break;
+        case REG_RAX:
+            cls |= X86_64_OPRC_RAX;
+            break;
+        case REG_DX:
+            cls |= X86_64_OPRC_DX;
+            break;
+        case REG_FS:
+            cls |= X86_64_OPRC_FS;
+            break;
+        case REG_GS:
+            cls |= X86_64_OPRC_GS;
+            break;
+        default:
+            ;
+        }
+        break;
+    case X86_64_OPR_ADDR:
+        if ( 0 == opr->sopsize ) {
+            cls |= X86_64_OPRC_M | X86_64_OPRC_RMU8 | X86_64_OPRC_RMU16
+                | X86_64_OPRC_RMU32 | X86_64_OPRC_RMU64;
+        } else if ( k >= 0 ) {
+            cls |= (X86_64_OPRC_M8 | X86_64_OPRC_RM8 | X86_64_OPRC_RMU8) << k;
+        }
+        break;
+    case X86_64_OPR_IMM:
+        cls |= X86_64_OPRC_REL;
+        if ( 0 == opr->sopsize ) {
+            cls |= X86_64_OPRC_IMM8 | X86_64_OPRC_IMM16 | X86_64_OPRC_IMM32
+                | X86_64_OPRC_IMM64;
+        } else if ( k >= 0 ) {
+            cls |= X86_64_OPRC_IMM8 << k;
+        }
+        if ( X86_64_IMM_FIXED != opr->u.imm.type ) {
+            break;
+        }
+        val = opr->u.imm.u.fixed;
+        if ( 0 == opr->sopsize ) {
+            /* The operand size is estimated from the value */
+            if ( val >= -128 && val <= 127 ) {
+                cls |= X86_64_OPRC_FIX8;
+            }
+            if ( val >= -32768 && val <= 32767 ) {
+                cls |= X86_64_OPRC_FIX16;
+            }
+            if ( val >= -2147483648LL && val <= 2147483647LL ) {
+                cls |= X86_64_OPRC_FIX32;
+            }
+            cls |= X86_64_OPRC_FIX64;
+        } else if ( k >= 0 ) {
+            cls |= X86_64_OPRC_FIX8 << k;
+        }
+        if ( 3 == val ) {
+            cls |= X86_64_OPRC_3;
+        }
+        break;
+    default:
+        ;
     }
 
+    return cls;
+}
+
+/*
+ * Apply the operand prefix to the estimated operand, and validate and classify
+ * it
+ */
+static int
+_complete_operand(const operand_t *op, x86_64_opr_t *opr)
+{
+    size_t sz;
+
     /* Check the operand prefix */
     switch ( op->prefix ) {
     case SIZE_PREFIX_BYTE:
@@ -581,8 +644,7 @@ x86_64_convert_operand(operand_t *op)
         sz = regsize(opr->u.reg);
         if ( 0 != opr->sopsize && sz != opr->sopsize ) {
             /* Invalid operand size */
-            free(opr);
-            return NULL;
+            return -1;
         }
         opr->sopsize = sz;
         break;
@@ -592,8 +654,7 @@ x86_64_convert_operand(operand_t *op)
             if ( 0 != opr->u.addr.saddrsize
                  && sz != opr->u.addr.saddrsize ) {
                 /* Invalid operand size */
-                free(opr);
-                return NULL;
+                return -1;
             }
             opr->u.addr.saddrsize = sz;
         }
@@ -602,15 +663,78 @@ x86_64_convert_operand(operand_t *op)
             if ( 0 != opr->u.addr.saddrsize
                  && sz != opr->u.addr.saddrsize ) {
                 /* Invalid operand size */
-                free(opr);
-                return NULL;
+                return -1;
             }
             opr->u.addr.saddrsize = sz;
         }
         break;
     }
 
-    return opr;
+    /* Classify the operand for the encodings */
+    opr->cls = _operand_class(opr);
+
+    return 0;
+}
+
+/*
+ * Covert the operand into opr
+ */
+int
+x86_64_convert_operand(const operand_t *op, x86_64_opr_t *opr)
+{
+    int ret;
+
+    if ( OEXPR_EXPR == op->type ) {
+        /* Immediate value or register */
+        ret = _estimate_expr_imm_or_reg(op->expr0, opr);
+    } else if ( OEXPR_ADDR == op->type ) {
+        /* Address */
+        ret = _estimate_expr_addr(op->expr0, op->aprefix, opr);
+    } else {
+        return -1;
+    }
+    /* Check the returned value */
+    if ( 0 != ret ) {
+        return -1;
+    }
+
+    return _complete_operand(op, opr);
+}
+
+/*
+ * Convert the operand of a single register or integer into opr without
+ * allocation; return -1 if the operand is in the other forms
+ */
+int
+x86_64_convert_operand_simple(const operand_t *op, x86_64_opr_t *opr)
+{
+    expr_t *expr;
+
+    if ( OEXPR_EXPR != op->type || NULL != op->expr1 ) {
+        return -1;
+    }
+    expr = op->expr0;
+    if ( 1 != expr->size ) {
+        return -1;
+    }
+
+    (void)memset(opr, 0, sizeof(x86_64_opr_t));
+    switch ( expr->type ) {
+    case EXPR_VAR:
+        _estimate_expr_var(expr, opr);
+        if ( X86_64_OPR_REG != opr->type ) {
+            /* Symbol */
+            return -1;
+        }
+        break;
+    case EXPR_INT:
+        _estimate_expr_int(expr, opr);
+        break;
+    default:
+        return -1;
+    }
+
+    return _complete_operand(op, opr);
 }
 
 /*
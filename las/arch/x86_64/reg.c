@@ -7,209 +7,258 @@
 
 #include "../../las.h"
 #include "reg.h"
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
+#define REG_NSLOTS      2048
+#define REG_SEED_TRIALS 4096
+
+/*
+ * Register table indexed by x86_64_reg_t
+ */
+static const x86_64_reg_info_t _regs[] = {
+    [REG_EIP] = { "eip", 3, REG_EIP, SIZE32, -1, REX_NONE },
+    [REG_RIP] = { "rip", 3, REG_RIP, SIZE64, -1, REX_NONE },
+    [REG_AL] = { "al", 2, REG_AL, SIZE8, 0, REX_NONE },
+    [REG_AH] = { "ah", 2, REG_AH, SIZE8, 4, REX_NE },
+    [REG_AX] = { "ax", 2, REG_AX, SIZE16, 0, REX_NONE },
+    [REG_EAX] = { "eax", 3, REG_EAX, SIZE32, 0, REX_NONE },
+    [REG_RAX] = { "rax", 3, REG_RAX, SIZE64, 0, REX_NONE },
+    [REG_CL] = { "cl", 2, REG_CL, SIZE8, 1, REX_NONE },
+    [REG_CH] = { "ch", 2, REG_CH, SIZE8, 5, REX_NE },
+    [REG_CX] = { "cx", 2, REG_CX, SIZE16, 1, REX_NONE },
+    [REG_ECX] = { "ecx", 3, REG_ECX, SIZE32, 1, REX_NONE },
+    [REG_RCX] = { "rcx", 3, REG_RCX, SIZE64, 1, REX_NONE },
+    [REG_DL] = { "dl", 2, REG_DL, SIZE8, 2, REX_NONE },
+    [REG_DH] = { "dh", 2, REG_DH, SIZE8, 6, REX_NE },
+    [REG_DX] = { "dx", 2, REG_DX, SIZE16, 2, REX_NONE },
+    [REG_EDX] = { "edx", 3, REG_EDX, SIZE32, 2, REX_NONE },
+    [REG_RDX] = { "rdx", 3, REG_RDX, SIZE64, 2, REX_NONE },
+    [REG_BL] = { "bl", 2, REG_BL, SIZE8, 3, REX_NONE },
+    [REG_BH] = { "bh", 2, REG_BH, SIZE8, 7, REX_NE },
+    [REG_BX] = { "bx", 2, REG_BX, SIZE16, 3, REX_NONE },
+    [REG_EBX] = { "ebx", 3, REG_EBX, SIZE32, 3, REX_NONE },
+    [REG_RBX] = { "rbx", 3, REG_RBX, SIZE64, 3, REX_NONE },
+    [REG_SPL] = { "spl", 3, REG_SPL, SIZE8, 4, REX_FALSE },
+    [REG_SP] = { "sp", 2, REG_SP, SIZE16, 4, REX_NONE },
+    [REG_ESP] = { "esp", 3, REG_ESP, SIZE32, 4, REX_NONE },
+    [REG_RSP] = { "rsp", 3, REG_RSP, SIZE64, 4, REX_NONE },
+    [REG_BPL] = { "bpl", 3, REG_BPL, SIZE8, 5, REX_FALSE },
+    [REG_BP] = { "bp", 2, REG_BP, SIZE16, 5, REX_NONE },
+    [REG_EBP] = { "ebp", 3, REG_EBP, SIZE32, 5, REX_NONE },
+    [REG_RBP] = { "rbp", 3, REG_RBP, SIZE64, 5, REX_NONE },
+    [REG_SIL] = { "sil", 3, REG_SIL, SIZE8, 6, REX_FALSE },
+    [REG_SI] = { "si", 2, REG_SI, SIZE16, 6, REX_NONE },
+    [REG_ESI] = { "esi", 3, REG_ESI, SIZE32, 6, REX_NONE },
+    [REG_RSI] = { "rsi", 3, REG_RSI, SIZE64, 6, REX_NONE },
+    [REG_DIL] = { "dil", 3, REG_DIL, SIZE8, 7, REX_FALSE },
+    [REG_DI] = { "di", 2, REG_DI, SIZE16, 7, REX_NONE },
+    [REG_EDI] = { "edi", 3, REG_EDI, SIZE32, 7, REX_NONE },
+    [REG_RDI] = { "rdi", 3, REG_RDI, SIZE64, 7, REX_NONE },
+    [REG_R8L] = { "r8l", 3, REG_R8L, SIZE8, 0, REX_TRUE },
+    [REG_R8W] = { "r8w", 3, REG_R8W, SIZE16, 0, REX_TRUE },
+    [REG_R8D] = { "r8d", 3, REG_R8D, SIZE32, 0, REX_TRUE },
+    [REG_R8] = { "r8", 2, REG_R8, SIZE64, 0, REX_TRUE },
+    [REG_R9L] = { "r9l", 3, REG_R9L, SIZE8, 1, REX_TRUE },
+    [REG_R9W] = { "r9w", 3, REG_R9W, SIZE16, 1, REX_TRUE },
+    [REG_R9D] = { "r9d", 3, REG_R9D, SIZE32, 1, REX_TRUE },
+    [REG_R9] = { "r9", 2, REG_R9, SIZE64, 1, REX_TRUE },
+    [REG_R10L] = { "r10l", 4, REG_R10L, SIZE8, 2, REX_TRUE },
+    [REG_R10W] = { "r10w", 4, REG_R10W, SIZE16, 2, REX_TRUE },
+    [REG_R10D] = { "r10d", 4, REG_R10D, SIZE32, 2, REX_TRUE },
+    [REG_R10] = { "r10", 3, REG_R10, SIZE64, 2, REX_TRUE },
+    [REG_R11L] = { "r11l", 4, REG_R11L, SIZE8, 3, REX_TRUE },
+    [REG_R11W] = { "r11w", 4, REG_R11W, SIZE16, 3, REX_TRUE },
+    [REG_R11D] = { "r11d", 4, REG_R11D, SIZE32, 3, REX_TRUE },
+    [REG_R11] = { "r11", 3, REG_R11, SIZE64, 3, REX_TRUE },
+    [REG_R12L] = { "r12l", 4, REG_R12L, SIZE8, 4, REX_TRUE },
+    [REG_R12W] = { "r12w", 4, REG_R12W, SIZE16, 4, REX_TRUE },
+    [REG_R12D] = { "r12d", 4, REG_R12D, SIZE32, 4, REX_TRUE },
+    [REG_R12] = { "r12", 3, REG_R12, SIZE64, 4, REX_TRUE },
+    [REG_R13L] = { "r13l", 4, REG_R13L, SIZE8, 5, REX_TRUE },
+    [REG_R13W] = { "r13w", 4, REG_R13W, SIZE16, 5, REX_TRUE },
+    [REG_R13D] = { "r13d", 4, REG_R13D, SIZE32, 5, REX_TRUE },
+    [REG_R13] = { "r13", 3, REG_R13, SIZE64, 5, REX_TRUE },
+    [REG_R14L] = { "r14l", 4, REG_R14L, SIZE8, 6, REX_TRUE },
+    [REG_R14W] = { "r14w", 4, REG_R14W, SIZE16, 6, REX_TRUE },
+    [REG_R14D] = { "r14d", 4, REG_R14D, SIZE32, 6, REX_TRUE },
+    [REG_R14] = { "r14", 3, REG_R14, SIZE64, 6, REX_TRUE },
+    [REG_R15L] = { "r15l", 4, REG_R15L, SIZE8, 7, REX_TRUE },
+    [REG_R15W] = { "r15w", 4, REG_R15W, SIZE16, 7, REX_TRUE },
+    [REG_R15D] = { "r15d", 4, REG_R15D, SIZE32, 7, REX_TRUE },
+    [REG_R15] = { "r15", 3, REG_R15, SIZE64, 7, REX_TRUE },
+    [REG_CS] = { "cs", 2, REG_CS, SIZE16, -1, REX_NONE },
+    [REG_DS] = { "ds", 2, REG_DS, SIZE16, -1, REX_NONE },
+    [REG_ES] = { "es", 2, REG_ES, SIZE16, -1, REX_NONE },
+    [REG_FS] = { "fs", 2, REG_FS, SIZE16, -1, REX_NONE },
+    [REG_GS] = { "gs", 2, REG_GS, SIZE16, -1, REX_NONE },
+    [REG_FLAGS] = { "flags", 5, REG_FLAGS, SIZE16, -1, REX_NONE },
+    [REG_EFLAGS] = { "eflags", 6, REG_EFLAGS, SIZE32, -1, REX_NONE },
+    [REG_RFLAGS] = { "rflags", 6, REG_RFLAGS, SIZE64, -1, REX_NONE },
+    [REG_MM0] = { "mm0", 3, REG_MM0, 0, -1, REX_NONE },
+    [REG_MM1] = { "mm1", 3, REG_MM1, 0, -1, REX_NONE },
+    [REG_MM2] = { "mm2", 3, REG_MM2, 0, -1, REX_NONE },
+    [REG_MM3] = { "mm3", 3, REG_MM3, 0, -1, REX_NONE },
+    [REG_MM4] = { "mm4", 3, REG_MM4, 0, -1, REX_NONE },
+    [REG_MM5] = { "mm5", 3, REG_MM5, 0, -1, REX_NONE },
+    [REG_MM6] = { "mm6", 3, REG_MM6, 0, -1, REX_NONE },
+    [REG_MM7] = { "mm7", 3, REG_MM7, 0, -1, REX_NONE },
+    [REG_XMM0] = { "xmm0", 4, REG_XMM0, 0, -1, REX_NONE },
+    [REG_XMM1] = { "xmm1", 4, REG_XMM1, 0, -1, REX_NONE },
+    [REG_XMM2] = { "xmm2", 4, REG_XMM2, 0, -1, REX_NONE },
+    [REG_XMM3] = { "xmm3", 4, REG_XMM3, 0, -1, REX_NONE },
+    [REG_XMM4] = { "xmm4", 4, REG_XMM4, 0, -1, REX_NONE },
+    [REG_XMM5] = { "xmm5", 4, REG_XMM5, 0, -1, REX_NONE },
+    [REG_XMM6] = { "xmm6", 4, REG_XMM6, 0, -1, REX_NONE },
+    [REG_XMM7] = { "xmm7", 4, REG_XMM7, 0, -1, REX_NONE },
+};
+
+#define REG_NUM (sizeof(_regs) / sizeof(_regs[0]))
+
+/*
+ * Perfect hash index of the register names (built by x86_64_reg_init());
+ * each slot holds x86_64_reg_t + 1, or 0 for an empty slot
+ */
+static unsigned char _reg_slots[REG_NSLOTS];
+static uint32_t _reg_seed;
+static int _reg_initialized = 0;
+
+/*
+ * Hash function of the register names
+ */
+static __inline__ uint32_t
+_reg_hash(uint32_t seed, const char *s, size_t len)
+{
+    uint32_t h;
+    size_t i;
+
+    h = seed;
+    for ( i = 0; i < len; i++ ) {
+        h = (h ^ (unsigned char)s[i]) * 16777619U;
+    }
+
+    return (h ^ (h >> 16)) & (REG_NSLOTS - 1);
+}
+
+/*
+ * Build the perfect hash index of the register names and mark the interned
+ * register names so that the register of a symbol is resolved by its ID
+ */
+int
+x86_64_reg_init(void)
+{
+    uint32_t seed;
+    size_t i;
+    size_t j;
+    sym_id_t id;
+
+    if ( _reg_initialized ) {
+        return 0;
+    }
+
+    /* Search a seed without collision */
+    for ( seed = 2166136261U; seed < 2166136261U + REG_SEED_TRIALS; seed++ ) {
+        (void)memset(_reg_slots, 0, sizeof(_reg_slots));
+        for ( i = 0; i < REG_NUM; i++ ) {
+            j = _reg_hash(seed, _regs[i].name, _regs[i].len);
+            if ( 0 != _reg_slots[j] ) {
+                /* Collision */
+                break;
+            }
+            _reg_slots[j] = i + 1;
+        }
+        if ( i == REG_NUM ) {
+            /* Found */
+            break;
+        }
+    }
+    if ( i != REG_NUM ) {
+        return -1;
+    }
+    _reg_seed = seed;
+
+    /* Intern the register names */
+    for ( i = 0; i < REG_NUM; i++ ) {
+        id = intern_sym(_regs[i].name, _regs[i].len);
+        if ( SYM_ID_NONE == id ) {
+            return -1;
+        }
+        (void)intern_set_attr(id, X86_64_SYMATTR_REG | _regs[i].reg);
+    }
+
+    _reg_initialized = 1;
+
+    return 0;
+}
+
+/*
+ * Search the register by its name
+ */
+const x86_64_reg_info_t *
+x86_64_reg_lookup(const char *s, size_t len)
+{
+    const x86_64_reg_info_t *ri;
+    int n;
+
+    if ( !_reg_initialized && 0 != x86_64_reg_init() ) {
+        return NULL;
+    }
+    n = _reg_slots[_reg_hash(_reg_seed, s, len)];
+    if ( 0 == n ) {
+        return NULL;
+    }
+    ri = &_regs[n - 1];
+    if ( ri->len != len || 0 != memcmp(ri->name, s, len) ) {
+        return NULL;
+    }
+
+    return ri;
+}
+
+/*
+ * Get the information of the register
+ */
+const x86_64_reg_info_t *
+x86_64_reg_info(x86_64_reg_t reg)
+{
+    if ( reg < 0 || (size_t)reg >= REG_NUM ) {
+        return NULL;
+    }
+
+    return &_regs[reg];
+}
+
+/*
+ * Get the register that the interned symbol names
+ */
+x86_64_reg_t
+x86_64_sym_reg(sym_id_t id)
+{
+    int attr;
+
+    attr = intern_attr(id);
+    if ( X86_64_SYMATTR_REG != (attr & X86_64_SYMATTR_MASK) ) {
+        return REG_UNKNOWN;
+    }
+
+    return attr & ~X86_64_SYMATTR_MASK;
+}
+
 /*
  * Convert the register string to x86_64_reg_t
  */
 x86_64_reg_t
 strtoreg(const char *s)
 {
-    x86_64_reg_t reg;
+    const x86_64_reg_info_t *ri;
 
-    if ( 0 == strcmp("eip", s) ) {
-        reg = REG_EIP;
-    } else if ( 0 == strcmp("rip", s) ) {
-        reg = REG_RIP;
-    } else if ( 0 == strcmp("al", s) ) {
-        reg = REG_AL;
-    } else if ( 0 == strcmp("ah", s) ) {
-        reg = REG_AH;
-    } else if ( 0 == strcmp("ax", s) ) {
-        reg = REG_AX;
-    } else if ( 0 == strcmp("eax", s) ) {
-        reg = REG_EAX;
-    } else if ( 0 == strcmp("rax", s) ) {
-        reg = REG_RAX;
-    } else if ( 0 == strcmp("cl", s) ) {
-        reg = REG_CL;
-    } else if ( 0 == strcmp("ch", s) ) {
-        reg = REG_CH;
-    } else if ( 0 == strcmp("cx", s) ) {
-        reg = REG_CX;
-    } else if ( 0 == strcmp("ecx", s) ) {
-        reg = REG_ECX;
-    } else if ( 0 == strcmp("rcx", s) ) {
-        reg = REG_RCX;
-    } else if ( 0 == strcmp("dl", s) ) {
-        reg = REG_DL;
-    } else if ( 0 == strcmp("dh", s) ) {
-        reg = REG_DH;
-    } else if ( 0 == strcmp("dx", s) ) {
-        reg = REG_DX;
-    } else if ( 0 == strcmp("edx", s) ) {
-        reg = REG_EDX;
-    } else if ( 0 == strcmp("rdx", s) ) {
-        reg = REG_RDX;
-    } else if ( 0 == strcmp("bl", s) ) {
-        reg = REG_BL;
-    } else if ( 0 == strcmp("bh", s) ) {
-        reg = REG_BH;
-    } else if ( 0 == strcmp("bx", s) ) {
-        reg = REG_BX;
-    } else if ( 0 == strcmp("ebx", s) ) {
-        reg = REG_EBX;
-    } else if ( 0 == strcmp("rbx", s) ) {
-        reg = REG_RBX;
-    } else if ( 0 == strcmp("spl", s) ) {
-        reg = REG_SPL;
-    } else if ( 0 == strcmp("sp", s) ) {
-        reg = REG_SP;
-    } else if ( 0 == strcmp("esp", s) ) {
-        reg = REG_ESP;
-    } else if ( 0 == strcmp("rsp", s) ) {
-        reg = REG_RSP;
-    } else if ( 0 == strcmp("bpl", s) ) {
-        reg = REG_BPL;
-    } else if ( 0 == strcmp("bp", s) ) {
-        reg = REG_BP;
-    } else if ( 0 == strcmp("ebp", s) ) {
-        reg = REG_EBP;
-    } else if ( 0 == strcmp("rbp", s) ) {
-        reg = REG_RBP;
-    } else if ( 0 == strcmp("sil", s) ) {
-        reg = REG_SIL;
-    } else if ( 0 == strcmp("si", s) ) {
-        reg = REG_SI;
-    } else if ( 0 == strcmp("esi", s) ) {
-        reg = REG_ESI;
-    } else if ( 0 == strcmp("rsi", s) ) {
-        reg = REG_RSI;
-    } else if ( 0 == strcmp("dil", s) ) {
-        reg = REG_DIL;
-    } else if ( 0 == strcmp("di", s) ) {
-        reg = REG_DI;
-    } else if ( 0 == strcmp("edi", s) ) {
-        reg = REG_EDI;
-    } else if ( 0 == strcmp("rdi", s) ) {
-        reg = REG_RDI;
-    } else if ( 0 == strcmp("r8l", s) ) {
-        reg = REG_R8L;
-    } else if ( 0 == strcmp("r8w", s) ) {
-        reg = REG_R8W;
-    } else if ( 0 == strcmp("r8d", s) ) {
-        reg = REG_R8D;
-    } else if ( 0 == strcmp("r8", s) ) {
-        reg = REG_R8;
-    } else if ( 0 == strcmp("r9l", s) ) {
-        reg = REG_R9L;
-    } else if ( 0 == strcmp("r9w", s) ) {
-        reg = REG_R9W;
-    } else if ( 0 == strcmp("r9d", s) ) {
-        reg = REG_R9D;
-    } else if ( 0 == strcmp("r9", s) ) {
-        reg = REG_R9;
-    } else if ( 0 == strcmp("r10l", s) ) {
-        reg = REG_R10L;
-    } else if ( 0 == strcmp("r10w", s) ) {
-        reg = REG_R10W;
-    } else if ( 0 == strcmp("r10d", s) ) {
-        reg = REG_R10D;
-    } else if ( 0 == strcmp("r10", s) ) {
-        reg = REG_R10;
-    } else if ( 0 == strcmp("r11l", s) ) {
-        reg = REG_R11L;
-    } else if ( 0 == strcmp("r11w", s) ) {
-        reg = REG_R11W;
-    } else if ( 0 == strcmp("r11d", s) ) {
-        reg = REG_R11D;
-    } else if ( 0 == strcmp("r11", s) ) {
-        reg = REG_R11;
-    } else if ( 0 == strcmp("r12l", s) ) {
-        reg = REG_R12L;
-    } else if ( 0 == strcmp("r12w", s) ) {
-        reg = REG_R12W;
-    } else if ( 0 == strcmp("r12d", s) ) {
-        reg = REG_R12D;
-    } else if ( 0 == strcmp("r12", s) ) {
-        reg = REG_R12;
-    } else if ( 0 == strcmp("r13l", s) ) {
-        reg = REG_R13L;
-    } else if ( 0 == strcmp("r13w", s) ) {
-        reg = REG_R13W;
-    } else if ( 0 == strcmp("r13d", s) ) {
-        reg = REG_R13D;
-    } else if ( 0 == strcmp("r13", s) ) {
-        reg = REG_R13;
-    } else if ( 0 == strcmp("r14l", s) ) {
-        reg = REG_R14L;
-    } else if ( 0 == strcmp("r14w", s) ) {
-        reg = REG_R14W;
-    } else if ( 0 == strcmp("r14d", s) ) {
-        reg = REG_R14D;
-    } else if ( 0 == strcmp("r14", s) ) {
-        reg = REG_R14;
-    } else if ( 0 == strcmp("r15l", s) ) {
-        reg = REG_R15L;
-    } else if ( 0 == strcmp("r15w", s) ) {
-        reg = REG_R15W;
-    } else if ( 0 == strcmp("r15d", s) ) {
-        reg = REG_R15D;
-    } else if ( 0 == strcmp("r15", s) ) {
-        reg = REG_R15;
-    } else if ( 0 == strcmp("cs", s) ) {
-        reg = REG_CS;
-    } else if ( 0 == strcmp("ds", s) ) {
-        reg = REG_DS;
-    } else if ( 0 == strcmp("es", s) ) {
-        reg = REG_ES;
-    } else if ( 0 == strcmp("fs", s) ) {
-        reg = REG_FS;
-    } else if ( 0 == strcmp("gs", s) ) {
-        reg = REG_GS;
-    } else if ( 0 == strcmp("flags", s) ) {
-        reg = REG_FLAGS;
-    } else if ( 0 == strcmp("eflags", s) ) {
-        reg = REG_EFLAGS;
-    } else if ( 0 == strcmp("rflags", s) ) {
-        reg = REG_RFLAGS;
-    } else if ( 0 == strcmp("mm0", s) ) {
-        reg = REG_MM0;
-    } else if ( 0 == strcmp("mm1", s) ) {
-        reg = REG_MM1;
-    } else if ( 0 == strcmp("mm2", s) ) {
-        reg = REG_MM2;
-    } else if ( 0 == strcmp("mm3", s) ) {
-        reg = REG_MM3;
-    } else if ( 0 == strcmp("mm4", s) ) {
-        reg = REG_MM4;
-    } else if ( 0 == strcmp("mm5", s) ) {
-        reg = REG_MM5;
-    } else if ( 0 == strcmp("mm6", s) ) {
-        reg = REG_MM6;
-    } else if ( 0 == strcmp("mm7", s) ) {
-        reg = REG_MM7;
-    } else if ( 0 == strcmp("xmm0", s) ) {
-        reg = REG_XMM0;
-    } else if ( 0 == strcmp("xmm1", s) ) {
-        reg = REG_XMM1;
-    } else if ( 0 == strcmp("xmm2", s) ) {
-        reg = REG_XMM2;
-    } else if ( 0 == strcmp("xmm3", s) ) {
-        reg = REG_XMM3;
-    } else if ( 0 == strcmp("xmm4", s) ) {
-        reg = REG_XMM4;
-    } else if ( 0 == strcmp("xmm5", s) ) {
-        reg = REG_XMM5;
-    } else if ( 0 == strcmp("xmm6", s) ) {
-        reg = REG_XMM6;
-    } else if ( 0 == strcmp("xmm7", s) ) {
-        reg = REG_XMM7;
-    } else {
-        reg = REG_UNKNOWN;
+    ri = x86_64_reg_lookup(s, strlen(s));
+    if ( NULL == ri ) {
+        return REG_UNKNOWN;
     }
 
-    return reg;
+    return ri->reg;
 }
 
 /*
@@ -218,99 +267,11 @@ strtoreg(const char *s)
 int
 regsize(x86_64_reg_t r)
 {
-    int sz;
-    switch ( r ) {
-    case REG_AL:
-    case REG_AH:
-    case REG_CL:
-    case REG_CH:
-    case REG_DL:
-    case REG_DH:
-    case REG_BL:
-    case REG_BH:
-    case REG_SPL:
-    case REG_BPL:
-    case REG_SIL:
-    case REG_DIL:
-    case REG_R8L:
-    case REG_R9L:
-    case REG_R10L:
-    case REG_R11L:
-    case REG_R12L:
-    case REG_R13L:
-    case REG_R14L:
-    case REG_R15L:
-        sz = SIZE8;
-        break;
-    case REG_AX:
-    case REG_CX:
-    case REG_DX:
-    case REG_BX:
-    case REG_SP:
-    case REG_BP:
-    case REG_SI:
-    case REG_DI:
-    case REG_R8W:
-    case REG_R9W:
-    case REG_R10W:
-    case REG_R11W:
-    case REG_R12W:
-    case REG_R13W:
-    case REG_R14W:
-    case REG_R15W:
-    case REG_CS:
-    case REG_DS:
-    case REG_ES:
-    case REG_FS:
-    case REG_GS:
-    case REG_FLAGS:
-        sz = SIZE16;
-        break;
-    case REG_EAX:
-    case REG_ECX:
-    case REG_EDX:
-    case REG_EBX:
-    case REG_ESP:
-    case REG_EBP:
-    case REG_ESI:
-    case REG_EDI:
-    case REG_R8D:
-    case REG_R9D:
-    case REG_R10D:
-    case REG_R11D:
-    case REG_R12D:
-    case REG_R13D:
-    case REG_R14D:
-    case REG_R15D:
-    case REG_EFLAGS:
-    case REG_EIP:
-        sz = SIZE32;
-        break;
-    case REG_RAX:
-    case REG_RCX:
-    case REG_RDX:
-    case REG_RBX:
-    case REG_RSP:
-    case REG_RBP:
-    case REG_RSI:
-    case REG_RDI:
-    case REG_R8:
-    case REG_R9:
-    case REG_R10:
-    case REG_R11:
-    case REG_R12:
-    case REG_R13:
-    case REG_R14:
-    case REG_R15:
-    case REG_RFLAGS:
-    case REG_RIP:
-        sz = SIZE64;
-        break;
-    default:
-        sz = 0;
+    if ( r < 0 || (size_t)r >= REG_NUM ) {
+        return 0;
     }
 
-    return sz;
+    return _regs[r].size;
 }
 
 /*
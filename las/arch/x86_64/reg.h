@@ -8,6 +8,25 @@
 #ifndef _ARCH_X86_64_REG_H
 #define _ARCH_X86_64_REG_H
 
+#include "../../intern.h"
+#include <stddef.h>
+
+/*
+ * REX requirement of registers
+ */
+#define REX_NE          -2      /* Not encodable */
+#define REX_NONE        -1
+#define REX_FALSE       0
+#define REX_TRUE        1
+
+/*
+ * Attribute of the interned symbols naming registers and mnemonics (see
+ * intern_set_attr())
+ */
+#define X86_64_SYMATTR_MASK     0x7fff0000
+#define X86_64_SYMATTR_REG      0x00010000
+#define X86_64_SYMATTR_MNEMONIC 0x00020000
+
 /*
  * x86-64 registers
  */
@@ -130,10 +149,29 @@ typedef enum op_reg {
     REG_XMM7,
 } x86_64_reg_t;
 
+/*
+ * Register information
+ */
+typedef struct _x86_64_reg_info {
+    const char *name;
+    size_t len;
+    x86_64_reg_t reg;
+    /* Size in bytes (zero if not applicable) */
+    int size;
+    /* Register code (-1 for non general-purpose registers) */
+    int code;
+    /* REX requirement (REX_*) */
+    int rex;
+} x86_64_reg_info_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+    int x86_64_reg_init(void);
+    const x86_64_reg_info_t * x86_64_reg_lookup(const char *, size_t);
+    const x86_64_reg_info_t * x86_64_reg_info(x86_64_reg_t);
+    x86_64_reg_t x86_64_sym_reg(sym_id_t);
     x86_64_reg_t strtoreg(const char *);
     int regsize(x86_64_reg_t);
 
@@ -0,0 +1,208 @@
+/*_
+ * Copyright 2013 Scyphus Solutions Co. Ltd.  All rights reserved.
+ *
+ * Authors:
+ *      Hirochika Asai  <asai@scyphus.co.jp>
+ */
+
+#include "../../las.h"
+#include "relax.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Initialize the Fenwick tree with the sizes of n statements
+ */
+int
+x86_64_fenwick_init(x86_64_fenwick_t *fw, const off_t *sizes, size_t n)
+{
+    size_t i;
+    size_t j;
+
+    fw->tree = malloc(sizeof(off_t) * (n + 1));
+    if ( NULL == fw->tree ) {
+        return -1;
+    }
+    fw->n = n;
+
+    /* Build it in linear time; the node i covers (i - lsb(i), i] */
+    fw->tree[0] = 0;
+    (void)memcpy(fw->tree + 1, sizes, sizeof(off_t) * n);
+    for ( i = 1; i <= n; i++ ) {
+        j = i + (i & -i);
+        if ( j <= n ) {
+            fw->tree[j] += fw->tree[i];
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Release the Fenwick tree
+ */
+void
+x86_64_fenwick_clear(x86_64_fenwick_t *fw)
+{
+    free(fw->tree);
+    fw->tree = NULL;
+    fw->n = 0;
+}
+
+/*
+ * Add delta to the size of the i-th statement
+ */
+void
+x86_64_fenwick_add(x86_64_fenwick_t *fw, size_t i, off_t delta)
+{
+    for ( i = i + 1; i <= fw->n; i += i & -i ) {
+        fw->tree[i] += delta;
+    }
+}
+
+/*
+ * Sum of the sizes of the statements preceding the i-th one
+ */
+off_t
+x86_64_fenwick_prefix(const x86_64_fenwick_t *fw, size_t i)
+{
+    off_t sum;
+
+    sum = 0;
+    for ( ; i > 0; i -= i & -i ) {
+        sum += fw->tree[i];
+    }
+
+    return sum;
+}
+
+/*
+ * Call f for each canonical node of the span [lo, hi]
+ */
+#define SPAN_FOREACH_NODE(base, lo, hi, node, f)        \
+    do {                                                \
+        size_t _l = (lo) + (base);                      \
+        size_t _r = (hi) + (base) + 1;                  \
+        while ( _l < _r ) {                             \
+            if ( _l & 1 ) {                             \
+                (node) = _l++;                          \
+                f;                                      \
+            }                                           \
+            if ( _r & 1 ) {                             \
+                (node) = --_r;                          \
+                f;                                      \
+            }                                           \
+            _l >>= 1;                                   \
+            _r >>= 1;                                   \
+        }                                               \
+    } while ( 0 )
+
+/*
+ * Build the span index of m spans [lo[i], hi[i]] over n statements; the spans
+ * of which lo is X86_64_SPAN_NONE are not indexed
+ */
+int
+x86_64_span_index_init(x86_64_span_index_t *si, size_t n, const size_t *lo,
+                       const size_t *hi, size_t m)
+{
+    size_t base;
+    size_t node;
+    size_t i;
+
+    base = 1;
+    while ( base < n ) {
+        base <<= 1;
+    }
+    si->base = base;
+    si->start = calloc(2 * base + 1, sizeof(size_t));
+    si->nstamp = calloc(2 * base, sizeof(size_t));
+    si->istamp = calloc(m ? m : 1, sizeof(size_t));
+    si->items = NULL;
+    if ( NULL == si->start || NULL == si->nstamp || NULL == si->istamp ) {
+        x86_64_span_index_clear(si);
+        return -1;
+    }
+
+    /* Count the spans of each node */
+    for ( i = 0; i < m; i++ ) {
+        if ( X86_64_SPAN_NONE != lo[i] ) {
+            SPAN_FOREACH_NODE(base, lo[i], hi[i], node,
+                              si->start[node + 1]++);
+        }
+    }
+    for ( i = 0; i < 2 * base; i++ ) {
+        si->start[i + 1] += si->start[i];
+    }
+
+    /* Fill the lists, using nstamp as the cursors */
+    si->items = malloc(sizeof(size_t) * (si->start[2 * base] + 1));
+    if ( NULL == si->items ) {
+        x86_64_span_index_clear(si);
+        return -1;
+    }
+    for ( i = 0; i < m; i++ ) {
+        if ( X86_64_SPAN_NONE != lo[i] ) {
+            SPAN_FOREACH_NODE(base, lo[i], hi[i], node,
+                              si->items[si->start[node] + si->nstamp[node]++]
+                              = i);
+        }
+    }
+    (void)memset(si->nstamp, 0, sizeof(size_t) * 2 * base);
+
+    return 0;
+}
+
+/*
+ * Release the span index
+ */
+void
+x86_64_span_index_clear(x86_64_span_index_t *si)
+{
+    free(si->start);
+    free(si->items);
+    free(si->nstamp);
+    free(si->istamp);
+    si->start = NULL;
+    si->items = NULL;
+    si->nstamp = NULL;
+    si->istamp = NULL;
+}
+
+/*
+ * Append the spans containing the statement c to out[nout...] unless they
+ * have been reported in the round (> 0), and return the new number of the
+ * spans in out.  A node reported in the round is not scanned again, nor are
+ * its ancestors since they have been reported together.
+ */
+size_t
+x86_64_span_index_stab(x86_64_span_index_t *si, size_t c, size_t round,
+                       size_t *out, size_t nout)
+{
+    size_t node;
+    size_t i;
+    size_t item;
+
+    for ( node = c + si->base; node > 0 && si->nstamp[node] != round;
+          node >>= 1 ) {
+        si->nstamp[node] = round;
+        for ( i = si->start[node]; i < si->start[node + 1]; i++ ) {
+            item = si->items[i];
+            if ( si->istamp[item] != round ) {
+                si->istamp[item] = round;
+                out[nout++] = item;
+            }
+        }
+    }
+
+    return nout;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
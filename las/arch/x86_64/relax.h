@@ -0,0 +1,44 @@
+/*_
+ * Copyright 2013 Scyphus Solutions Co. Ltd.  All rights reserved.
+ *
+ * Authors:
+ *      Hirochika Asai  <asai@scyphus.co.jp>
+ */
+
+#ifndef _ARCH_X86_64_RELAX_H
+#define _ARCH_X86_64_RELAX_H
+
+#include "../../las.h"
+#include "main.h"
+
+/* Span that no statement changes */
+#define X86_64_SPAN_NONE        ((size_t)-1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    int x86_64_fenwick_init(x86_64_fenwick_t *, const off_t *, size_t);
+    void x86_64_fenwick_clear(x86_64_fenwick_t *);
+    void x86_64_fenwick_add(x86_64_fenwick_t *, size_t, off_t);
+    off_t x86_64_fenwick_prefix(const x86_64_fenwick_t *, size_t);
+    int x86_64_span_index_init(x86_64_span_index_t *, size_t, const size_t *,
+                               const size_t *, size_t);
+    void x86_64_span_index_clear(x86_64_span_index_t *);
+    size_t x86_64_span_index_stab(x86_64_span_index_t *, size_t, size_t,
+                                  size_t *, size_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ARCH_X86_64_RELAX_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
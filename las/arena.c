@@ -0,0 +1,191 @@
+/*_
+ * Copyright 2013 Scyphus Solutions Co. Ltd.  All rights reserved.
+ *
+ * Authors:
+ *      Hirochika Asai  <asai@scyphus.co.jp>
+ */
+
+/* $Id$ */
+
+#include "arena.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Allocate a new block that holds at least sz bytes and link it to the head
+ */
+static struct arena_block *
+_arena_block_new(struct arena *arena, size_t sz)
+{
+    struct arena_block *blk;
+
+    if ( sz < ARENA_DEFAULT_BLOCKSIZE ) {
+        sz = ARENA_DEFAULT_BLOCKSIZE;
+    }
+    if ( sz > SIZE_MAX - sizeof(struct arena_block) ) {
+        return NULL;
+    }
+    blk = malloc(sizeof(struct arena_block) + sz);
+    if ( NULL == blk ) {
+        return NULL;
+    }
+    blk->size = sz;
+    blk->used = 0;
+
+    if ( NULL != arena->head && sz > ARENA_DEFAULT_BLOCKSIZE ) {
+        /* Keep bumping in the current block after a large allocation by
+           putting the dedicated block behind it */
+        blk->next = arena->head->next;
+        arena->head->next = blk;
+    } else {
+        blk->next = arena->head;
+        arena->head = blk;
+    }
+    arena->total += sz;
+
+    return blk;
+}
+
+/*
+ * Allocate sz bytes from the arena with the specified alignment
+ */
+static void *
+_arena_alloc(struct arena *arena, size_t sz, size_t align)
+{
+    struct arena_block *blk;
+    size_t off;
+
+    blk = arena->head;
+    if ( NULL != blk ) {
+        off = (blk->used + align - 1) & ~(align - 1);
+        if ( off <= blk->size && sz <= blk->size - off ) {
+            blk->used = off + sz;
+            return blk->data + off;
+        }
+    }
+
+    /* Not enough space in the current block */
+    blk = _arena_block_new(arena, sz);
+    if ( NULL == blk ) {
+        return NULL;
+    }
+    blk->used = sz;
+
+    return blk->data;
+}
+
+/*
+ * Allocate an arena instance
+ */
+struct arena *
+arena_new(void)
+{
+    struct arena *arena;
+
+    arena = malloc(sizeof(struct arena));
+    if ( NULL == arena ) {
+        return NULL;
+    }
+    arena->head = NULL;
+    arena->total = 0;
+
+    return arena;
+}
+
+/*
+ * Free the arena instance and everything allocated from it
+ */
+void
+arena_delete(struct arena *arena)
+{
+    struct arena_block *blk;
+    struct arena_block *next;
+
+    if ( NULL == arena ) {
+        return;
+    }
+    blk = arena->head;
+    while ( NULL != blk ) {
+        next = blk->next;
+        free(blk);
+        blk = next;
+    }
+    free(arena);
+}
+
+/*
+ * Move all the blocks of src into dst and free src; the memory allocated from
+ * src is then released with dst
+ */
+void
+arena_merge(struct arena *dst, struct arena *src)
+{
+    struct arena_block *blk;
+
+    if ( NULL == src->head ) {
+        free(src);
+        return;
+    }
+    if ( NULL == dst->head ) {
+        dst->head = src->head;
+    } else {
+        /* Keep the current block of dst at the head */
+        blk = src->head;
+        while ( NULL != blk->next ) {
+            blk = blk->next;
+        }
+        blk->next = dst->head->next;
+        dst->head->next = src->head;
+    }
+    dst->total += src->total;
+    free(src);
+}
+
+/*
+ * Allocate memory from the arena (aligned to ARENA_ALIGNMENT_SIZE)
+ */
+void *
+arena_alloc(struct arena *arena, size_t sz)
+{
+    return _arena_alloc(arena, sz, ARENA_ALIGNMENT_SIZE);
+}
+
+/*
+ * Copy n bytes of the string to the arena and terminate it with NUL
+ */
+char *
+arena_strndup(struct arena *arena, const char *s, size_t n)
+{
+    char *str;
+
+    if ( n >= SIZE_MAX ) {
+        return NULL;
+    }
+    str = _arena_alloc(arena, n + 1, 1);
+    if ( NULL == str ) {
+        return NULL;
+    }
+    (void)memcpy(str, s, n);
+    str[n] = '\0';
+
+    return str;
+}
+
+/*
+ * Copy the string to the arena
+ */
+char *
+arena_strdup(struct arena *arena, const char *s)
+{
+    return arena_strndup(arena, s, strlen(s));
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,66 @@
+/*_
+ * Copyright 2013 Scyphus Solutions Co. Ltd.  All rights reserved.
+ *
+ * Authors:
+ *      Hirochika Asai  <asai@scyphus.co.jp>
+ */
+
+/* $Id$ */
+
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_DEFAULT_BLOCKSIZE 65536
+#define ARENA_ALIGNMENT_SIZE    8
+
+/*
+ * A block of the arena
+ */
+struct arena_block {
+    struct arena_block *next;
+    /* Allocated size of data */
+    size_t size;
+    /* Used size of data */
+    size_t used;
+    /* Data follows */
+    unsigned char data[];
+};
+
+/*
+ * Arena (bump) allocator; everything allocated from an arena is released at
+ * once by arena_delete()
+ */
+struct arena {
+    /* The current block (the head of the list of blocks) */
+    struct arena_block *head;
+    /* Total size of the allocated memory */
+    size_t total;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    struct arena * arena_new(void);
+    void arena_delete(struct arena *);
+    void arena_merge(struct arena *, struct arena *);
+    void * arena_alloc(struct arena *, size_t);
+    char * arena_strndup(struct arena *, const char *, size_t);
+    char * arena_strdup(struct arena *, const char *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ARENA_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -5,7 +5,6 @@
  *      Hirochika Asai  <asai@scyphus.co.jp>
  */
 
-#include "vector.h"
 #include "expr.h"
 #include "parser.h"
 #include "las.h"
@@ -14,80 +13,194 @@
 #include <string.h>
 
 /*
- * Prototype declarations
+ * Fold the prefix operator on an integer; the operators are evaluated in the
+ * same way as the back end does for fixed values
  */
+static int
+_expr_fold_prefix(expr_operator_type_t type, expr_t *expr0)
+{
+    if ( EXPR_INT != expr0->type ) {
+        return -1;
+    }
+    switch ( type ) {
+    case OP_PLUS:
+        break;
+    case OP_MINUS:
+        expr0->u.i = -expr0->u.i;
+        break;
+    case OP_TILDE:
+        expr0->u.i = ~expr0->u.i;
+        break;
+    default:
+        return -1;
+    }
 
-
+    return 0;
+}
 
 /*
- * Create new infix operator
+ * Fold the infix operator on integers, and on a symbol and an integer into a
+ * symbol-plus-addend node; the result is stored into expr0
  */
-expr_t *
-expr_infix_operator(expr_operator_type_t type, expr_t *expr0, expr_t *expr1)
+static int
+_expr_fold_infix(expr_operator_type_t type, expr_t *expr0, expr_t *expr1)
 {
-    expr_t *expr;
-    expr_vec_t *args;
+    int64_t l;
+    int64_t r;
+    sym_id_t var;
 
-    /* The number of arguments is 2 for infix operator */
-    args = vector_new(2);
-    if ( NULL == vector_push_back(args, expr0) ) {
-        vector_delete(args);
-        return NULL;
+    if ( 1 != expr0->size || 1 != expr1->size ) {
+        /* Only leaves are folded */
+        return -1;
     }
-    if ( NULL == vector_push_back(args, expr1) ) {
-        vector_delete(args);
-        return NULL;
+
+    if ( EXPR_INT == expr0->type && EXPR_INT == expr1->type ) {
+        /* Signed 64-bit arithmetic */
+        l = (int64_t)expr0->u.i;
+        r = (int64_t)expr1->u.i;
+        switch ( type ) {
+        case OP_PLUS:
+            expr0->u.i = expr0->u.i + expr1->u.i;
+            break;
+        case OP_MINUS:
+            expr0->u.i = expr0->u.i - expr1->u.i;
+            break;
+        case OP_MUL:
+            expr0->u.i = expr0->u.i * expr1->u.i;
+            break;
+        case OP_DIV:
+            if ( 0 == r || (INT64_MIN == l && -1 == r) ) {
+                /* Leave it to the back end */
+                return -1;
+            }
+            expr0->u.i = (uint64_t)(l / r);
+            break;
+        default:
+            return -1;
+        }
+        return 0;
     }
 
-    /* Allocate new expression for an infix operator */
-    expr = malloc(sizeof(expr_t));
-    if ( NULL == expr ) {
-        vector_delete(args);
-        return NULL;
+    /* Symbol plus addend */
+    if ( OP_PLUS != type && OP_MINUS != type ) {
+        return -1;
+    }
+    if ( EXPR_INT == expr1->type ) {
+        if ( EXPR_VAR == expr0->type ) {
+            var = expr0->u.var;
+            expr0->type = EXPR_SYMADD;
+            expr0->u.symadd.var = var;
+            expr0->u.symadd.addend = 0;
+        } else if ( EXPR_SYMADD != expr0->type ) {
+            return -1;
+        }
+        if ( OP_PLUS == type ) {
+            expr0->u.symadd.addend
+                = (uint64_t)expr0->u.symadd.addend + expr1->u.i;
+        } else {
+            expr0->u.symadd.addend
+                = (uint64_t)expr0->u.symadd.addend - expr1->u.i;
+        }
+        return 0;
+    } else if ( EXPR_INT == expr0->type && OP_PLUS == type ) {
+        l = (int64_t)expr0->u.i;
+        if ( EXPR_VAR == expr1->type ) {
+            expr0->u.symadd.var = expr1->u.var;
+            expr0->u.symadd.addend = l;
+        } else if ( EXPR_SYMADD == expr1->type ) {
+            expr0->u.symadd.var = expr1->u.symadd.var;
+            expr0->u.symadd.addend = (uint64_t)expr1->u.symadd.addend + l;
+        } else {
+            return -1;
+        }
+        expr0->type = EXPR_SYMADD;
+        return 0;
     }
-    expr->type = EXPR_OP;
-    expr->u.op.type = type;
-    expr->u.op.fix_type = FIX_INFIX;
-    expr->u.op.args = args;
 
-    return expr;
+    return -1;
 }
 
 /*
- * Create new prefix operator
+ * Append an operation node to the expression (the root is expr0), and the
+ * nodes of expr1 before it if it is not NULL; expr0 and expr1 are consumed on
+ * success
  */
-expr_t *
-expr_prefix_operator(expr_operator_type_t type, expr_t *expr0)
+static expr_t *
+_expr_append_op(expr_operator_type_t type, expr_fix_type_t fix_type,
+                expr_t *expr0, expr_t *expr1)
 {
+    expr_t *nodes;
     expr_t *expr;
-    expr_vec_t *args;
+    size_t n0;
+    size_t n1;
 
-    /* The number of arguments is 1 for prefix operator */
-    args = vector_new(1);
-    if ( NULL == vector_push_back(args, expr0) ) {
-        vector_delete(args);
+    n0 = expr0->size;
+    n1 = (NULL != expr1) ? expr1->size : 0;
+    if ( n0 + n1 + 1 > UINT32_MAX ) {
         return NULL;
     }
 
-    /* Allocate new expression for a prefix operator */
-    expr = malloc(sizeof(expr_t));
-    if ( NULL == expr ) {
-        vector_delete(args);
+    /* Extend the node array of expr0 */
+    nodes = realloc(EXPR_FIRST(expr0), sizeof(expr_t) * (n0 + n1 + 1));
+    if ( NULL == nodes ) {
         return NULL;
     }
+    if ( NULL != expr1 ) {
+        (void)memcpy(nodes + n0, EXPR_FIRST(expr1), sizeof(expr_t) * n1);
+        free(EXPR_FIRST(expr1));
+    }
+
+    /* Set the operation node */
+    expr = nodes + n0 + n1;
     expr->type = EXPR_OP;
+    expr->size = n0 + n1 + 1;
     expr->u.op.type = type;
-    expr->u.op.fix_type = FIX_PREFIX;
-    expr->u.op.args = args;
+    expr->u.op.fix_type = fix_type;
+    if ( NULL != expr1 ) {
+        expr->u.op.args[0] = n1 + 1;
+        expr->u.op.args[1] = 1;
+    } else {
+        expr->u.op.args[0] = 1;
+        expr->u.op.args[1] = 0;
+    }
 
     return expr;
 }
 
+/*
+ * Create new infix operator
+ */
+expr_t *
+expr_infix_operator(expr_operator_type_t type, expr_t *expr0, expr_t *expr1)
+{
+    /* Constant folding */
+    if ( 0 == _expr_fold_infix(type, expr0, expr1) ) {
+        expr_free(expr1);
+        return expr0;
+    }
+
+    return _expr_append_op(type, FIX_INFIX, expr0, expr1);
+}
+
+/*
+ * Create new prefix operator
+ */
+expr_t *
+expr_prefix_operator(expr_operator_type_t type, expr_t *expr0)
+{
+    /* Constant folding */
+    if ( 0 == _expr_fold_prefix(type, expr0) ) {
+        return expr0;
+    }
+
+    return _expr_append_op(type, FIX_PREFIX, expr0, NULL);
+}
+
 /*
  * Variable (symbol or label) expression
  */
 expr_t *
-expr_var(char *var)
+expr_var(sym_id_t var)
 {
     expr_t *expr;
 
@@ -97,11 +210,8 @@ expr_var(char *var)
         return NULL;
     }
     expr->type = EXPR_VAR;
-    expr->u.var = strdup(var);
-    if ( NULL == expr->u.var ) {
-        free(expr);
-        return NULL;
-    }
+    expr->size = 1;
+    expr->u.var = var;
 
     return expr;
 }
@@ -120,48 +230,22 @@ expr_int(uint64_t val)
         return NULL;
     }
     expr->type = EXPR_INT;
+    expr->size = 1;
     expr->u.i = val;
 
     return expr;
 }
 
 /*
- * Free expression instance
+ * Free expression instance (the root node)
  */
 void
 expr_free(expr_t *expr)
 {
-    size_t i;
-
-    switch ( expr->type ) {
-    case EXPR_VAR:
-        free(expr->u.var);
-        break;
-    case EXPR_INT:
-        /* Do nothing else */
-        break;
-    case EXPR_OP:
-        switch ( expr->u.op.fix_type ) {
-        case FIX_PREFIX:
-        case FIX_INFIX:
-            for ( i = 0; i < vector_size(expr->u.op.args); i++ ) {
-                expr_free(vector_at(expr->u.op.args, i));
-            }
-            vector_delete(expr->u.op.args);
-            break;
-        default:
-            /* Must not reach here */
-            ;
-        }
-        break;
-    default:
-        ;
-    }
-    free(expr);
+    /* All the nodes are in the array */
+    free(EXPR_FIRST(expr));
 }
 
-
-
 /*
  * Local variables:
  * tab-width: 4
@@ -10,12 +10,10 @@
 #ifndef _LAS_EXPR_H
 #define _LAS_EXPR_H
 
-#include "vector.h"
 #include "token.h"
+#include "intern.h"
 #include <stdint.h>
 
-typedef struct vector expr_vec_t;
-
 /*
  * Types of operator
  */
@@ -47,6 +45,7 @@ typedef enum _expr_type {
     EXPR_VAR,
     EXPR_INT,
     EXPR_OP,
+    EXPR_SYMADD,                /* Symbol plus a constant addend */
 } expr_type_t;
 
 /*
@@ -55,28 +54,59 @@ typedef enum _expr_type {
 typedef struct _expr_op_t {
     expr_operator_type_t type;
     expr_fix_type_t fix_type;   /* Prefix or infix */
-    expr_vec_t *args;           /* Operands */
+    uint32_t args[2];           /* Operands (distance back to the node) */
 } expr_op_t;
 
 /*
- * Expression
+ * Symbol plus addend (folded from `sym + const', `const + sym' and
+ * `sym - const')
+ */
+typedef struct _expr_symadd {
+    sym_id_t var;
+    int64_t addend;
+} expr_symadd_t;
+
+/*
+ * Expression node
+ *
+ * An expression is a contiguous array of nodes in post-order; the root is the
+ * last node, and the subtree of a node occupies the `size' nodes ending at the
+ * node itself.  A pointer to any node thus refers to a (sub)expression, which
+ * is evaluated by a loop over the nodes without chasing pointers.
  */
 typedef struct expr {
     expr_type_t type;
+    uint32_t size;              /* # of nodes in the subtree */
     union {
-        char *var;
+        sym_id_t var;
         uint64_t i;
         expr_op_t op;
+        expr_symadd_t symadd;
     } u;
 } expr_t;
 
+/*
+ * The first node of the subtree rooted at the node
+ */
+#define EXPR_FIRST(e)   ((e) - (e)->size + 1)
+
+/*
+ * The n-th operand of the operation node
+ */
+#define EXPR_ARG(e, n)  ((e) - (e)->u.op.args[(n)])
+
+/*
+ * The number of operands of the operation node
+ */
+#define EXPR_ARITY(e)   (FIX_INFIX == (e)->u.op.fix_type ? 2 : 1)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
     expr_t * expr_infix_operator(expr_operator_type_t, expr_t *, expr_t *);
     expr_t * expr_prefix_operator(expr_operator_type_t, expr_t *);
-    expr_t * expr_var(char *);
+    expr_t * expr_var(sym_id_t);
     expr_t * expr_int(uint64_t);
     void expr_free(expr_t *);
 
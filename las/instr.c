@@ -7,118 +7,84 @@
 
 #include "las.h"
 #include <stdlib.h>
+#include <string.h>
 
 /*
- * Free a prefixed expression
+ * Create a new icode
  */
-void
-pexpr_free(pexpr_t *pexpr)
+icode_t *
+icode_new(void)
 {
-    expr_free(pexpr->expr);
-    free(pexpr);
-}
+    icode_t *icode;
 
-/*
- * Free an operand expression
- */
-void
-oexpr_free(oexpr_t *oexpr)
-{
-    if ( OEXPR_ADDR == oexpr->type ) {
-        pexpr_free(oexpr->u.pexpr);
-    } else {
-        expr_free(oexpr->u.expr);
+    icode = malloc(sizeof(icode_t));
+    if ( NULL == icode ) {
+        return NULL;
     }
-    free(oexpr);
-}
-
-/*
- * Free an operand
- */
-void
-operand_free(operand_t *op)
-{
-    if ( NULL != op->oexpr0 ) {
-        oexpr_free(op->oexpr0);
+    icode->stmts = stmt_vector_new();
+    if ( NULL == icode->stmts ) {
+        free(icode);
+        return NULL;
     }
-    if ( NULL != op->oexpr1 ) {
-        oexpr_free(op->oexpr1);
+    icode->arena = arena_new();
+    if ( NULL == icode->arena ) {
+        stmt_vector_delete(icode->stmts);
+        free(icode);
+        return NULL;
     }
-}
-
-/*
- * Delete the operands
- */
-void
-operands_delete(operand_vector_t *vec)
-{
-    size_t i;
+    icode->nfix = 0;
 
-    for ( i = 0; i < mvector_size(vec); i++ ) {
-        operand_free(mvector_at(vec, i));
-    }
-    mvector_delete(vec);
+    return icode;
 }
 
 /*
- * Delete the opcode vector
+ * Delete the icode with its statements and expressions
  */
 void
-opcode_vector_delete(opcode_vector_t *vec)
+icode_delete(icode_t *icode)
 {
-    size_t i;
-
-    for ( i = 0; i < mvector_size(vec); i++ ) {
-        free(mvector_at(vec, i));
-    }
-    mvector_delete(vec);
+    stmt_vector_delete(icode->stmts);
+    arena_delete(icode->arena);
+    free(icode);
 }
 
 /*
- * Create a new instruction
+ * Move the expression to the expression pool; returns the root node in the
+ * pool, or NULL on failure (the expression is freed in either case)
  */
-instr_t *
-instr_new(opcode_vector_t *opcode, operand_vector_t *operands)
+expr_t *
+icode_expr(icode_t *icode, expr_t *expr)
 {
-    instr_t *instr;
+    expr_t *pool;
+    size_t n;
 
-    instr = malloc(sizeof(instr_t));
-    if ( NULL == instr ) {
+    n = expr->size;
+    pool = arena_alloc(icode->arena, sizeof(expr_t) * n);
+    if ( NULL == pool ) {
+        expr_free(expr);
         return NULL;
     }
-    instr->opcode = opcode;
-    instr->operands = operands;
+    (void)memcpy(pool, EXPR_FIRST(expr), sizeof(expr_t) * n);
+    expr_free(expr);
 
-    return instr;
+    return pool + n - 1;
 }
 
 /*
- * Delete the instruction
+ * Get the bit of the *fix in the prefix and suffix masks of instructions
  */
-void
-instr_delete(instr_t *instr)
+int
+icode_fix_bit(const icode_t *icode, sym_id_t id)
 {
-    opcode_vector_delete(instr->opcode);
-    operands_delete(instr->operands);
-    free(instr);
-}
+    size_t i;
 
-/*
- * Free the statement
- */
-void
-stmt_free(stmt_t *stmt)
-{
-    switch ( stmt->type ) {
-    case STMT_INSTR:
-        instr_delete(stmt->u.instr);
-        break;
-    case STMT_LABEL:
-        free(stmt->u.label);
-        break;
-    case STMT_GLOBAL:
-        free(stmt->u.global);
+    for ( i = 0; i < icode->nfix; i++ ) {
+        if ( icode->fix[i] == id ) {
+            return i;
+        }
     }
+
+    return -1;
 }
 
 /*
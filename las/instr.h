@@ -14,17 +14,10 @@
 extern "C" {
 #endif
 
-    void pexpr_free(pexpr_t *);
-    void oexpr_free(oexpr_t *);
-
-    void operand_free(operand_t *);
-    void operands_delete(operand_vector_t *);
-
-    void opcode_vector_delete(opcode_vector_t *);
-
-    instr_t * instr_new(opcode_vector_t *, operand_vector_t *);
-    void instr_delete(instr_t *);
-    void stmt_free(stmt_t *);
+    icode_t * icode_new(void);
+    void icode_delete(icode_t *);
+    expr_t * icode_expr(icode_t *, expr_t *);
+    int icode_fix_bit(const icode_t *, sym_id_t);
 
 #ifdef __cplusplus
 }
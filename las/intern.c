@@ -0,0 +1,389 @@
+/*_
+ * Copyright 2013 Scyphus Solutions Co. Ltd.  All rights reserved.
+ *
+ * Authors:
+ *      Hirochika Asai  <asai@scyphus.co.jp>
+ */
+
+/* $Id$ */
+
+#include "intern.h"
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INTERN_DEFAULT_NSLOTS   1024
+
+/*
+ * Interned symbol
+ */
+struct intern_ent {
+    const char *s;
+    size_t len;
+    uint32_t hash;
+    /* Attribute given by the back end (e.g., register), zero by default */
+    int attr;
+};
+
+/*
+ * Interning table: the entries are indexed by the symbol ID, and the hash
+ * index is an open-addressing table (linear probing) of the symbol IDs
+ */
+struct intern_table {
+    /* Entries indexed by the symbol ID */
+    struct intern_ent *ents;
+    size_t size;
+    size_t max_size;
+    /* Hash index (SYM_ID_NONE for empty slots); the size is a power of 2 */
+    sym_id_t *slots;
+    size_t nslots;
+    /* Storage for the strings */
+    struct arena *arena;
+};
+
+/*
+ * The global interning table
+ */
+static struct intern_table _itbl;
+
+/*
+ * FNV-1a hash
+ */
+static __inline__ uint32_t
+_hash(const char *s, size_t len)
+{
+    uint32_t h;
+    size_t i;
+
+    h = 2166136261U;
+    for ( i = 0; i < len; i++ ) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619U;
+    }
+
+    return h;
+}
+
+/*
+ * Search the slot of the symbol in the hash index
+ */
+static __inline__ size_t
+_search_slot(const struct intern_table *tbl, const char *s, size_t len,
+             uint32_t h)
+{
+    size_t i;
+    sym_id_t id;
+    const struct intern_ent *ent;
+
+    i = h & (tbl->nslots - 1);
+    for ( ;; ) {
+        id = tbl->slots[i];
+        if ( SYM_ID_NONE == id ) {
+            /* Empty slot */
+            return i;
+        }
+        ent = &tbl->ents[id];
+        if ( ent->hash == h && ent->len == len
+             && 0 == memcmp(ent->s, s, len) ) {
+            /* Found */
+            return i;
+        }
+        i = (i + 1) & (tbl->nslots - 1);
+    }
+}
+
+/*
+ * Double the hash index (or allocate the initial one)
+ */
+static int
+_resize(struct intern_table *tbl)
+{
+    sym_id_t *slots;
+    size_t nslots;
+    size_t i;
+    size_t j;
+
+    if ( 0 == tbl->nslots ) {
+        nslots = INTERN_DEFAULT_NSLOTS;
+    } else {
+        if ( tbl->nslots > SIZE_MAX / 2 / sizeof(sym_id_t) ) {
+            return -1;
+        }
+        nslots = tbl->nslots * 2;
+    }
+    slots = malloc(sizeof(sym_id_t) * nslots);
+    if ( NULL == slots ) {
+        return -1;
+    }
+    (void)memset(slots, 0xff, sizeof(sym_id_t) * nslots);
+
+    /* Rehash */
+    for ( i = 0; i < tbl->size; i++ ) {
+        j = tbl->ents[i].hash & (nslots - 1);
+        while ( SYM_ID_NONE != slots[j] ) {
+            j = (j + 1) & (nslots - 1);
+        }
+        slots[j] = i;
+    }
+    free(tbl->slots);
+    tbl->slots = slots;
+    tbl->nslots = nslots;
+
+    return 0;
+}
+
+/*
+ * Intern a symbol of the hash h into the table and return its ID; the string
+ * is copied to the storage of the table unless the table has no storage
+ * (chunk-local tables refer to the source)
+ */
+static sym_id_t
+_intern(struct intern_table *tbl, const char *s, size_t len, uint32_t h)
+{
+    struct intern_ent *ents;
+    size_t max_size;
+    size_t i;
+    const char *str;
+
+    /* Keep the load factor of the hash index at most 1/2 */
+    if ( (tbl->size + 1) * 2 > tbl->nslots ) {
+        if ( _resize(tbl) < 0 ) {
+            return SYM_ID_NONE;
+        }
+    }
+
+    i = _search_slot(tbl, s, len, h);
+    if ( SYM_ID_NONE != tbl->slots[i] ) {
+        /* Already interned */
+        return tbl->slots[i];
+    }
+
+    /* New symbol */
+    if ( tbl->size >= SYM_ID_NONE ) {
+        return SYM_ID_NONE;
+    }
+    if ( tbl->size == tbl->max_size ) {
+        max_size = tbl->max_size ? tbl->max_size * 2 : INTERN_DEFAULT_NSLOTS;
+        if ( max_size > SIZE_MAX / sizeof(struct intern_ent) ) {
+            return SYM_ID_NONE;
+        }
+        ents = realloc(tbl->ents, sizeof(struct intern_ent) * max_size);
+        if ( NULL == ents ) {
+            return SYM_ID_NONE;
+        }
+        tbl->ents = ents;
+        tbl->max_size = max_size;
+    }
+    if ( NULL != tbl->arena ) {
+        str = arena_strndup(tbl->arena, s, len);
+        if ( NULL == str ) {
+            return SYM_ID_NONE;
+        }
+    } else {
+        str = s;
+    }
+    tbl->ents[tbl->size].s = str;
+    tbl->ents[tbl->size].len = len;
+    tbl->ents[tbl->size].hash = h;
+    tbl->ents[tbl->size].attr = 0;
+    tbl->slots[i] = tbl->size;
+
+    return tbl->size++;
+}
+
+/*
+ * Intern a symbol and return its ID
+ */
+sym_id_t
+intern_sym(const char *s, size_t len)
+{
+    struct intern_table *tbl;
+
+    tbl = &_itbl;
+    if ( NULL == tbl->arena ) {
+        tbl->arena = arena_new();
+        if ( NULL == tbl->arena ) {
+            return SYM_ID_NONE;
+        }
+    }
+
+    return _intern(tbl, s, len, _hash(s, len));
+}
+
+/*
+ * Create a chunk-local interning table, which lets threads intern symbols
+ * without touching the global table; the strings are not copied and must be
+ * valid until the table is merged
+ */
+struct intern_table *
+intern_table_new(void)
+{
+    struct intern_table *tbl;
+
+    tbl = calloc(1, sizeof(struct intern_table));
+    if ( NULL == tbl ) {
+        return NULL;
+    }
+
+    return tbl;
+}
+
+/*
+ * Delete a chunk-local interning table
+ */
+void
+intern_table_delete(struct intern_table *tbl)
+{
+    if ( NULL != tbl ) {
+        free(tbl->ents);
+        free(tbl->slots);
+        free(tbl);
+    }
+}
+
+/*
+ * Intern a symbol into the chunk-local table and return its local ID
+ */
+sym_id_t
+intern_table_sym(struct intern_table *tbl, const char *s, size_t len)
+{
+    return _intern(tbl, s, len, _hash(s, len));
+}
+
+/*
+ * Get the number of the symbols of the chunk-local table
+ */
+size_t
+intern_table_size(const struct intern_table *tbl)
+{
+    return tbl->size;
+}
+
+/*
+ * Intern the symbols of the chunk-local table into the global table in the
+ * order of their local IDs and store the global IDs to map indexed by the
+ * local IDs; merging the tables of the chunks in order assigns the same IDs
+ * as interning the symbols of the whole source in order
+ */
+int
+intern_table_merge(const struct intern_table *tbl, sym_id_t *map)
+{
+    const struct intern_ent *ent;
+    size_t i;
+
+    if ( NULL == _itbl.arena ) {
+        _itbl.arena = arena_new();
+        if ( NULL == _itbl.arena ) {
+            return -1;
+        }
+    }
+    for ( i = 0; i < tbl->size; i++ ) {
+        ent = &tbl->ents[i];
+        map[i] = _intern(&_itbl, ent->s, ent->len, ent->hash);
+        if ( SYM_ID_NONE == map[i] ) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Search the ID of a symbol without interning it
+ */
+sym_id_t
+intern_find(const char *s, size_t len)
+{
+    struct intern_table *tbl;
+
+    tbl = &_itbl;
+    if ( 0 == tbl->nslots ) {
+        return SYM_ID_NONE;
+    }
+
+    return tbl->slots[_search_slot(tbl, s, len, _hash(s, len))];
+}
+
+/*
+ * Get the (NUL-terminated) string of a symbol
+ */
+const char *
+intern_str(sym_id_t id)
+{
+    if ( id >= _itbl.size ) {
+        return NULL;
+    }
+
+    return _itbl.ents[id].s;
+}
+
+/*
+ * Get the length of a symbol
+ */
+size_t
+intern_len(sym_id_t id)
+{
+    if ( id >= _itbl.size ) {
+        return 0;
+    }
+
+    return _itbl.ents[id].len;
+}
+
+/*
+ * Get the attribute of a symbol
+ */
+int
+intern_attr(sym_id_t id)
+{
+    if ( id >= _itbl.size ) {
+        return 0;
+    }
+
+    return _itbl.ents[id].attr;
+}
+
+/*
+ * Set the attribute of a symbol; this lets a back end classify a symbol once
+ * for all the tokens referring to it
+ */
+int
+intern_set_attr(sym_id_t id, int attr)
+{
+    if ( id >= _itbl.size ) {
+        return -1;
+    }
+    _itbl.ents[id].attr = attr;
+
+    return 0;
+}
+
+/*
+ * Get the number of interned symbols
+ */
+size_t
+intern_count(void)
+{
+    return _itbl.size;
+}
+
+/*
+ * Release all the interned symbols
+ */
+void
+intern_release(void)
+{
+    free(_itbl.ents);
+    free(_itbl.slots);
+    arena_delete(_itbl.arena);
+    (void)memset(&_itbl, 0, sizeof(struct intern_table));
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,60 @@
+/*_
+ * Copyright 2013 Scyphus Solutions Co. Ltd.  All rights reserved.
+ *
+ * Authors:
+ *      Hirochika Asai  <asai@scyphus.co.jp>
+ */
+
+/* $Id$ */
+
+#ifndef _LAS_INTERN_H
+#define _LAS_INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Symbol ID; each distinct identifier is interned once and is referred to by
+ * its ID afterward, so that symbols are compared as integers
+ */
+typedef uint32_t sym_id_t;
+
+/*
+ * Interning table (the global one, or a chunk-local one)
+ */
+struct intern_table;
+
+#define SYM_ID_NONE     ((sym_id_t)-1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    sym_id_t intern_sym(const char *, size_t);
+    sym_id_t intern_find(const char *, size_t);
+    const char * intern_str(sym_id_t);
+    size_t intern_len(sym_id_t);
+    int intern_attr(sym_id_t);
+    int intern_set_attr(sym_id_t, int);
+    size_t intern_count(void);
+    void intern_release(void);
+    struct intern_table * intern_table_new(void);
+    void intern_table_delete(struct intern_table *);
+    sym_id_t intern_table_sym(struct intern_table *, const char *, size_t);
+    size_t intern_table_size(const struct intern_table *);
+    int intern_table_merge(const struct intern_table *, sym_id_t *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _LAS_INTERN_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -12,8 +12,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
-int arch_x86_64_assemble(const char *);
+int arch_x86_64_assemble(const char *, const las_opts_t *);
 
 /*
  * Print the usage
@@ -21,7 +22,14 @@ int arch_x86_64_assemble(const char *);
 void
 usage(const char *prog)
 {
-    fprintf(stderr, "Usage: %s <input file>\n", prog);
+    fprintf(stderr, "Usage: %s [-s] [-c <entries>] [-j <jobs>] <input file>\n",
+            prog);
+    fprintf(stderr, "\t-c <entries>: Maximum number of the entries of the "
+            "encoding cache,\n\t\tshared out among the worker threads "
+            "(0 to disable;\n\t\tdefault: %d; at most %d)\n",
+            LAS_ECACHE_SIZE_DEFAULT, LAS_ECACHE_SIZE_MAX);
+    fprintf(stderr, "\t-j <jobs>: Number of the worker threads (default: 1)\n");
+    fprintf(stderr, "\t-s: Print the statistics\n");
     exit(EXIT_FAILURE);
 }
 
@@ -29,17 +37,53 @@ usage(const char *prog)
  * Main routine
  */
 int
-main(int argc, const char *const argv[])
+main(int argc, char *const argv[])
 {
     const char *fname;
+    las_opts_t opts;
+    char *endptr;
+    long val;
+    int ch;
+
+    /* Parse the options */
+    opts.ecache_size = LAS_ECACHE_SIZE_DEFAULT;
+    opts.stats = 0;
+    opts.jobs = 1;
+    while ( -1 != (ch = getopt(argc, argv, "c:j:s")) ) {
+        switch ( ch ) {
+        case 'c':
+            val = strtol(optarg, &endptr, 10);
+            if ( '\0' == *optarg || '\0' != *endptr || val < 0
+                 || val > LAS_ECACHE_SIZE_MAX ) {
+                usage(argv[0]);
+            }
+            opts.ecache_size = val;
+            break;
+        case 'j':
+            val = strtol(optarg, &endptr, 10);
+            if ( '\0' == *optarg || '\0' != *endptr || val < 1 ) {
+                usage(argv[0]);
+            }
+            opts.jobs = val;
+            break;
+        case 's':
+            opts.stats = 1;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
 
     /* Get the input file */
-    if ( argc < 2 ) {
+    if ( optind >= argc ) {
         usage(argv[0]);
     }
-    fname = argv[1];
+    fname = argv[optind];
 
-    arch_x86_64_assemble(fname);
+    if ( arch_x86_64_assemble(fname, &opts) < 0 ) {
+        fprintf(stderr, "Failed to assemble %s\n", fname);
+        return EXIT_FAILURE;
+    }
 
 #if 0
     pcode_t *pcode;
@@ -11,8 +11,11 @@
 #include "token.h"
 #include "vector.h"
 #include "mvector.h"
+#include "tvector.h"
 #include "expr.h"
 #include "hashtable.h"
+#include "arena.h"
+#include "intern.h"
 #include <stdio.h>
 #include <stdint.h>
 #include <unistd.h>
@@ -45,6 +48,8 @@ typedef struct _string {
 typedef struct _scode {
     char *fname;
     string_t str;
+    /* Non-zero if str.s is a read-only mapping of the file */
+    int mapped;
 } scode_t;
 
 /*
@@ -54,12 +59,14 @@ typedef struct _token {
     token_type_t type;
     union {
         /* Symbol, identifier, or label */
-        char *sym;
+        const char *sym;
         /* Prefix/Suffix keyword */
-        char *fix;
+        const char *fix;
         /* Numerical value */
         char *num;
     } val;
+    /* Interned ID of the symbol or the *fix keyword */
+    sym_id_t id;
     /* Debugging information */
     scode_t *scode;
     struct {
@@ -85,6 +92,8 @@ typedef struct token_queue {
     token_queue_entry_t *head;
     token_queue_entry_t *tail;
     token_queue_entry_t *cur;
+    /* Arena that the entries are allocated from */
+    struct arena *arena;
 } token_queue_t;
 
 /*
@@ -92,6 +101,8 @@ typedef struct token_queue {
  */
 typedef struct tcode {
     token_queue_t *token_queue;
+    /* Arena for tokens, token queue entries and token strings */
+    struct arena *arena;
     /* Debugging information */
     scode_t *scode;
 } tcode_t;
@@ -106,13 +117,26 @@ struct code_tree_node {
     code_tree_node_t *children;
 };
 
+/*
+ * Maximum number of the registered *fixes; each *fix is a bit of the prefix
+ * and suffix masks of instructions
+ */
+#define PP_MAX_FIXES    32
+
 /*
  * Preprocessed code (output of the second process)
  */
 typedef struct pcode {
     token_queue_t *token_queue;
+    /* Arena taken over from the tcode; the parser may allocate from it */
+    struct arena *arena;
+    /* Source code the tokens refer to */
+    scode_t *scode;
     /* Code tree */
     code_tree_node_t *tree;
+    /* Interned IDs of the registered *fixes in the order of registration */
+    sym_id_t fix[PP_MAX_FIXES];
+    size_t nfix;
 } pcode_t;
 
 /*
@@ -120,7 +144,13 @@ typedef struct pcode {
  */
 typedef struct tokenizer {
     scode_t *scode;
+    /* Arena for tokens */
+    struct arena *arena;
     off_t cur;
+    /* End of the chunk to be tokenized */
+    off_t end;
+    /* Chunk-local interning table (NULL for the global one) */
+    struct intern_table *itbl;
     /* Debugging information */
     struct {
         size_t l;
@@ -131,13 +161,39 @@ typedef struct tokenizer {
 typedef struct mvector fix_vector_t;
 typedef struct _token_fix {
     char *kw;
+    size_t len;
+    sym_id_t id;
 } token_fix_t;
 
+/*
+ * An entry of the keyword table
+ */
+typedef struct _pp_keyword {
+    const char *kw;
+    size_t len;
+    token_type_t type;
+} pp_keyword_t;
+
+/*
+ * Keyword table: a perfect hash table of the keywords and the registered
+ * *fixes, rebuilt on every registration
+ */
+typedef struct _pp_keyword_table {
+    /* Slots (kw is NULL for empty slots); the size is a power of 2 */
+    pp_keyword_t *slots;
+    size_t nslots;
+    /* Seed of the hash function that has no collision */
+    uint32_t seed;
+} pp_keyword_table_t;
+
 /*
  * Preprocessor
  */
 typedef struct preprocessor {
     fix_vector_t *fix;
+    pp_keyword_table_t kwtbl;
+    /* Number of the tokenizer threads */
+    size_t jobs;
 } preprocessor_t;
 
 
@@ -152,11 +208,6 @@ typedef enum _size_prefix {
     SIZE_PREFIX_QWORD,
 } size_prefix_t;
 
-typedef struct _prefixed_expr {
-    size_prefix_t prefix;
-    expr_t *expr;
-} pexpr_t;
-
 /*
  * Operand type
  */
@@ -165,36 +216,39 @@ typedef enum operand_expr_type {
     OEXPR_EXPR,
 } oexpr_type_t;
 
-/*
- * Operand expression
- */
-typedef struct _operand_expr {
-    oexpr_type_t type;
-    union {
-        expr_t *expr;
-        pexpr_t *pexpr;
-    } u;
-} oexpr_t;
-
-
 /*
  * Operand
+ *
+ * expr0 is the operand expression, or the address in the brackets of which
+ * size prefix is aprefix if the type is OEXPR_ADDR, and expr1 is the
+ * expression following a colon (NULL if none).  Both are the root nodes of
+ * expressions in the expression pool of the icode.
  */
 typedef struct operand {
-    size_prefix_t prefix;
-    oexpr_t *oexpr0;
-    oexpr_t *oexpr1;
+    uint8_t type;               /* oexpr_type_t */
+    uint8_t prefix;             /* size_prefix_t */
+    uint8_t aprefix;            /* size_prefix_t in the brackets */
+    expr_t *expr0;
+    expr_t *expr1;
 } operand_t;
-typedef struct mvector operand_vector_t;
 
-typedef struct mvector opcode_vector_t;
+/*
+ * Maximum number of operands of an instruction
+ */
+#define INSTR_MAX_OPERANDS      4
 
 /*
  * Instruction
+ *
+ * The *fixes preceding and following the mnemonic are the bits of prefix and
+ * suffix, respectively, indexed by the order of registration (icode->fix).
  */
 typedef struct _instruction {
-    opcode_vector_t *opcode;
-    operand_vector_t *operands;
+    sym_id_t mnemonic;
+    uint32_t prefix;
+    uint32_t suffix;
+    uint32_t nopr;
+    operand_t opr[INSTR_MAX_OPERANDS];
 } instr_t;
 
 /*
@@ -206,16 +260,31 @@ typedef enum _stmt_type {
     STMT_GLOBAL,
 } stmt_type_t;
 
+/*
+ * Statement record; the records are stored in a contiguous array
+ */
 typedef struct _stmt {
     stmt_type_t type;
     union {
-        instr_t *instr;
-        char *label;
-        char *global;
+        instr_t instr;
+        sym_id_t label;
+        sym_id_t global;
     } u;
 } stmt_t;
 
-typedef struct mvector stmt_vector_t;
+TVECTOR_DECLARE(stmt_vector, stmt_t, 1)
+
+/*
+ * Intermediate code (output of the parser)
+ */
+typedef struct icode {
+    stmt_vector_t *stmts;
+    /* Expression pool that the operands refer to */
+    struct arena *arena;
+    /* Interned IDs of the *fixes indexed by the bits of the instructions */
+    sym_id_t fix[PP_MAX_FIXES];
+    size_t nfix;
+} icode_t;
 
 
 
@@ -244,6 +313,25 @@ typedef struct assembler {
     symbol_table_t *globals;
 } assembler_t;
 
+/*
+ * Default and upper limit of the maximum number of the entries of the
+ * encoding cache; the entries are indexed by 32-bit slots
+ */
+#define LAS_ECACHE_SIZE_DEFAULT 4096
+#define LAS_ECACHE_SIZE_MAX     0x7fffffff
+
+/*
+ * Command line options
+ */
+typedef struct _las_opts {
+    /* Maximum number of the entries of the encoding cache (0 to disable) */
+    size_t ecache_size;
+    /* Print the statistics to stderr if non-zero */
+    int stats;
+    /* Number of the worker threads */
+    size_t jobs;
+} las_opts_t;
+
 
 
 
@@ -253,7 +341,9 @@ extern "C" {
 #endif
 
     tcode_t * tokenize(preprocessor_t *, scode_t *);
+    void tcode_delete(tcode_t *);
     pcode_t * preprocess(preprocessor_t *, const char *);
+    void pcode_delete(pcode_t *);
 
     scode_t * scode_read(const char *);
     void scode_delete(scode_t *);
@@ -261,12 +351,12 @@ extern "C" {
     preprocessor_t * pp_new(void);
     void pp_delete(preprocessor_t *);
     int pp_register_fix(preprocessor_t *, const char *);
+    token_type_t pp_keyword_type(const preprocessor_t *, const char *, size_t);
 
     void token_queue_rewind(token_queue_t *);
     token_t * token_queue_cur(token_queue_t *);
     token_t * token_queue_next(token_queue_t *);
 
-    void pexpr_free(pexpr_t *);
 
     void assemble(pcode_t *);
 
@@ -36,7 +36,7 @@ parse_expr_atom(pcode_t *pcode)
     switch ( tok->type ) {
     case TOK_SYMBOL:
         /* Parse symbol expression */
-        expr = expr_var(tok->val.sym);
+        expr = expr_var(tok->id);
         /* Eat */
         (void)token_queue_next(pcode->token_queue);
         break;
@@ -98,384 +98,101 @@ parse_expr_atom(pcode_t *pcode)
     return expr;
 }
 
+#define PARSE_EXPR_MAX_PREFIXES 16
+
 /*
- * Parse expression primary
+ * Binary operators and their precedences (higher binds tighter; 0 for
+ * non-operator tokens)
  *
- * primary ::=
- *              atom
+ *      or_expr ::=     xor_expr ( "|" xor_expr )*
+ *      xor_expr ::=    and_expr ( "^" and_expr )*
+ *      and_expr ::=    shift_expr ( "&" shift_expr )*
+ *      shift_expr ::=  a_expr ( ("<<" | ">>") a_expr )*
+ *      a_expr ::=      m_expr ( ("+" | "-") m_expr )*
+ *      m_expr ::=      u_expr ( ("*" | "/") u_expr )*
  */
-expr_t *
-parse_expr_primary(pcode_t *pcode)
-{
-    return parse_expr_atom(pcode);
-}
+static const struct {
+    expr_operator_type_t op;
+    int prec;
+} _binops[] = {
+    [TOK_OP_BAR] = { OP_BAR, 1 },
+    [TOK_OP_XOR] = { OP_XOR, 2 },
+    [TOK_OP_AMP] = { OP_AMP, 3 },
+    [TOK_OP_LSHIFT] = { OP_LSHIFT, 4 },
+    [TOK_OP_RSHIFT] = { OP_RSHIFT, 4 },
+    [TOK_OP_PLUS] = { OP_PLUS, 5 },
+    [TOK_OP_MINUS] = { OP_MINUS, 5 },
+    [TOK_OP_MUL] = { OP_MUL, 6 },
+    [TOK_OP_DIV] = { OP_DIV, 6 },
+};
+#define BINOP_PREC(t)                                                   \
+    ((t) >= 0 && (size_t)(t) < sizeof(_binops) / sizeof(_binops[0])    \
+     ? _binops[(t)].prec : 0)
 
 /*
  * Parse expression u_expr
  *
  * u_expr ::=
  *              primary | "-" u_expr | "+" u_expr | "~" u_expr
- */
-expr_t *
-parse_expr_u_expr(pcode_t *pcode)
-{
-    token_t *tok;
-    expr_t *expr;
-    expr_t *expr0;
-
-    /* Check the next token */
-    tok = token_queue_cur(pcode->token_queue);
-    if ( NULL == tok ) {
-        /* End of token; i.e., syntax error */
-        return NULL;
-    }
-    switch ( tok->type ) {
-    case TOK_OP_MINUS:
-        /* Eat TOK_OP_MINUS */
-        (void)token_queue_next(pcode->token_queue);
-        expr0 = parse_expr_u_expr(pcode);
-        if ( NULL == expr0 ) {
-            /* Parse error */
-            return NULL;
-        }
-        expr = expr_prefix_operator(OP_MINUS, expr0);
-        if ( NULL == expr ) {
-            /* Error and free locally allocated memory */
-            expr_free(expr0);
-            return NULL;
-        }
-        break;
-    case TOK_OP_PLUS:
-        /* Eat TOK_OP_PLUS */
-        (void)token_queue_next(pcode->token_queue);
-        expr0 = parse_expr_u_expr(pcode);
-        if ( NULL == expr0 ) {
-            /* Parse error */
-            return NULL;
-        }
-        expr = expr_prefix_operator(OP_PLUS, expr0);
-        if ( NULL == expr ) {
-            /* Error and free locally allocated memory */
-            expr_free(expr0);
-            return NULL;
-        }
-        break;
-    case TOK_OP_TILDE:
-        /* Eat TOK_OP_PLUS */
-        (void)token_queue_next(pcode->token_queue);
-        expr0 = parse_expr_u_expr(pcode);
-        if ( NULL == expr0 ) {
-            /* Parse error */
-            return NULL;
-        }
-        expr = expr_prefix_operator(OP_TILDE, expr0);
-        if ( NULL == expr ) {
-            /* Error and free locally allocated memory */
-            expr_free(expr0);
-            return NULL;
-        }
-        break;
-    default:
-        /* Primary */
-        expr = parse_expr_primary(pcode);
-        if ( NULL == expr ) {
-            /* Error */
-            return NULL;
-        }
-    }
-
-    return expr;
-}
-
-/*
- * Parse expression m_expr
+ * primary ::=
+ *              atom
  *
- * m_expr ::=
- *              u_expr ( ("*" | "/") u_expr )*
+ * The prefix operators are stacked and applied to the atom from the
+ * innermost one.
  */
-expr_t *
-parse_expr_m_expr(pcode_t *pcode)
+static __inline__ expr_t *
+_parse_expr_u_expr(pcode_t *pcode)
 {
     token_t *tok;
     expr_t *expr;
     expr_t *expr0;
-    expr_t *expr1;
-
-    /* Parse the first `u' expression */
-    expr = parse_expr_u_expr(pcode);
-    if ( NULL == expr ) {
-        /* Error */
-        return NULL;
-    }
-
-    /* Check the next token */
-    tok = token_queue_cur(pcode->token_queue);
-    if ( NULL == tok ) {
-        /* End of token; i.e., syntax error */
-        expr_free(expr);
-        return NULL;
-    }
-    while ( TOK_OP_MUL == tok->type || TOK_OP_DIV == tok->type ) {
-        if ( TOK_OP_MUL == tok->type ) {
-            /* Eat TOK_OP_MUL */
-            (void)token_queue_next(pcode->token_queue);
-            expr0 = expr;
-            /* Parse the second `u' expression */
-            expr1 = parse_expr_u_expr(pcode);
-            if ( NULL == expr1 ) {
-                /* Error */
-                expr_free(expr0);
-                return NULL;
-            }
-            expr = expr_infix_operator(OP_MUL, expr0, expr1);
-            if ( NULL == expr ) {
-                /* Error */
-                expr_free(expr0);
-                expr_free(expr1);
-                return NULL;
-            }
-        } else if ( TOK_OP_DIV == tok->type ) {
-            /* Eat TOK_OP_DIV */
-            (void)token_queue_next(pcode->token_queue);
-            expr0 = expr;
-            /* Parse the second `u' expression */
-            expr1 = parse_expr_u_expr(pcode);
-            if ( NULL == expr1 ) {
-                /* Error */
-                expr_free(expr0);
-                return NULL;
-            }
-            expr = expr_infix_operator(OP_DIV, expr0, expr1);
-            if ( NULL == expr ) {
-                /* Error */
-                expr_free(expr0);
-                expr_free(expr1);
-                return NULL;
-            }
-        }
+    expr_operator_type_t ops[PARSE_EXPR_MAX_PREFIXES];
+    int n;
 
-        /* Get the current token */
+    n = 0;
+    for ( ;; ) {
+        /* Check the next token */
         tok = token_queue_cur(pcode->token_queue);
         if ( NULL == tok ) {
-            /* Error */
-            expr_free(expr);
+            /* End of token; i.e., syntax error */
             return NULL;
         }
-    }
-
-    return expr;
-}
-
-/*
- * Parse expression a_expr
- *
- * a_expr ::=
- *              m_expr ( ("+" | "-") m_expr )*
- */
-expr_t *
-parse_expr_a_expr(pcode_t *pcode)
-{
-    token_t *tok;
-    expr_t *expr;
-    expr_t *expr0;
-    expr_t *expr1;
-
-    /* Parse the first `m' expression */
-    expr = parse_expr_m_expr(pcode);
-    if ( NULL == expr ) {
-        /* Error */
-        return NULL;
-    }
-
-    /* Check the next token */
-    tok = token_queue_cur(pcode->token_queue);
-    if ( NULL == tok ) {
-        /* End of token; i.e., syntax error */
-        expr_free(expr);
-        return NULL;
-    }
-    while ( TOK_OP_PLUS == tok->type || TOK_OP_MINUS == tok->type ) {
-        if ( TOK_OP_PLUS == tok->type ) {
-            /* Eat TOK_OP_PLUS */
-            (void)token_queue_next(pcode->token_queue);
-            expr0 = expr;
-            /* Parse the second `m' expression */
-            expr1 = parse_expr_m_expr(pcode);
-            if ( NULL == expr1 ) {
-                /* Error */
-                expr_free(expr0);
-                return NULL;
-            }
-            expr = expr_infix_operator(OP_PLUS, expr0, expr1);
-            if ( NULL == expr ) {
-                /* Error */
-                expr_free(expr0);
-                expr_free(expr1);
-                return NULL;
-            }
-        } else if ( TOK_OP_MINUS == tok->type ) {
-            /* Eat TOK_OP_MINUS */
-            (void)token_queue_next(pcode->token_queue);
-            expr0 = expr;
-            /* Parse the second `m' expression */
-            expr1 = parse_expr_m_expr(pcode);
-            if ( NULL == expr1 ) {
-                /* Error */
-                expr_free(expr0);
-                return NULL;
-            }
-            expr = expr_infix_operator(OP_MINUS, expr0, expr1);
-            if ( NULL == expr ) {
-                /* Error */
-                expr_free(expr0);
-                expr_free(expr1);
-                return NULL;
-            }
+        if ( TOK_OP_MINUS == tok->type ) {
+            ops[n] = OP_MINUS;
+        } else if ( TOK_OP_PLUS == tok->type ) {
+            ops[n] = OP_PLUS;
+        } else if ( TOK_OP_TILDE == tok->type ) {
+            ops[n] = OP_TILDE;
+        } else {
+            break;
         }
-
-        /* Get the current token */
-        tok = token_queue_cur(pcode->token_queue);
-        if ( NULL == tok ) {
-            /* Error */
-            expr_free(expr);
-            return NULL;
+        /* Eat the prefix operator */
+        (void)token_queue_next(pcode->token_queue);
+        n++;
+        if ( n >= PARSE_EXPR_MAX_PREFIXES ) {
+            /* Too deep; parse the rest recursively */
+            break;
         }
     }
 
-    return expr;
-}
-
-/*
- * Parse expression shift_expr
- *
- * shift_expr ::=
- *              a_expr ( ("<<" | ">>") a_expr )*
- */
-expr_t *
-parse_expr_shift_expr(pcode_t *pcode)
-{
-    token_t *tok;
-    expr_t *expr;
-    expr_t *expr0;
-    expr_t *expr1;
-
-    /* Parse the first `a' expression */
-    expr = parse_expr_a_expr(pcode);
-    if ( NULL == expr ) {
-        /* Error */
-        return NULL;
-    }
-
-    /* Check the next token */
-    tok = token_queue_cur(pcode->token_queue);
-    if ( NULL == tok ) {
-        /* End of token; i.e., syntax error */
-        expr_free(expr);
-        return NULL;
-    }
-    while ( TOK_OP_LSHIFT == tok->type || TOK_OP_RSHIFT == tok->type ) {
-        if ( TOK_OP_LSHIFT == tok->type ) {
-            /* Eat TOK_OP_LSHIFT */
-            (void)token_queue_next(pcode->token_queue);
-            expr0 = expr;
-            /* Parse the second `a' expression */
-            expr1 = parse_expr_a_expr(pcode);
-            if ( NULL == expr1 ) {
-                /* Error */
-                expr_free(expr0);
-                return NULL;
-            }
-            expr = expr_infix_operator(OP_LSHIFT, expr0, expr1);
-            if ( NULL == expr ) {
-                /* Error */
-                expr_free(expr0);
-                expr_free(expr1);
-                return NULL;
-            }
-        } else if ( TOK_OP_RSHIFT == tok->type ) {
-            /* Eat TOK_OP_RSHIFT */
-            (void)token_queue_next(pcode->token_queue);
-            expr0 = expr;
-            /* Parse the second `a' expression */
-            expr1 = parse_expr_a_expr(pcode);
-            if ( NULL == expr1 ) {
-                /* Error */
-                expr_free(expr0);
-                return NULL;
-            }
-            expr = expr_infix_operator(OP_RSHIFT, expr0, expr1);
-            if ( NULL == expr ) {
-                /* Error */
-                expr_free(expr0);
-                expr_free(expr1);
-                return NULL;
-            }
-        }
-
-        /* Get the current token */
-        tok = token_queue_cur(pcode->token_queue);
-        if ( NULL == tok ) {
-            /* Error */
-            expr_free(expr);
-            return NULL;
-        }
+    /* Primary */
+    if ( n >= PARSE_EXPR_MAX_PREFIXES ) {
+        expr = _parse_expr_u_expr(pcode);
+    } else {
+        expr = parse_expr_atom(pcode);
     }
-
-    return expr;
-}
-
-/*
- * Parse expression and_expr
- *
- * and_expr ::=
- *              shift_expr ( "&" shift_expr )*
- */
-expr_t *
-parse_expr_and_expr(pcode_t *pcode)
-{
-    token_t *tok;
-    expr_t *expr;
-    expr_t *expr0;
-    expr_t *expr1;
-
-    /* Parse the first shift expression */
-    expr = parse_expr_shift_expr(pcode);
     if ( NULL == expr ) {
-        /* Error */
+        /* Parse error */
         return NULL;
     }
 
-    /* Check the next token */
-    tok = token_queue_cur(pcode->token_queue);
-    if ( NULL == tok ) {
-        /* End of token; i.e., syntax error */
-        expr_free(expr);
-        return NULL;
-    }
-    while ( TOK_OP_AMP == tok->type ) {
-        /* Eat TOK_OP_AMP */
-        (void)token_queue_next(pcode->token_queue);
+    /* Apply the prefix operators */
+    while ( n > 0 ) {
         expr0 = expr;
-        /* Parse the second shift expression */
-        expr1 = parse_expr_shift_expr(pcode);
-        if ( NULL == expr1 ) {
-            /* Error */
-            expr_free(expr0);
-            return NULL;
-        }
-        expr = expr_infix_operator(OP_AMP, expr0, expr1);
+        expr = expr_prefix_operator(ops[--n], expr0);
         if ( NULL == expr ) {
-            /* Error */
+            /* Error and free locally allocated memory */
             expr_free(expr0);
-            expr_free(expr1);
-            return NULL;
-        }
-
-        /* Get the current token */
-        tok = token_queue_cur(pcode->token_queue);
-        if ( NULL == tok ) {
-            /* Error */
-            expr_free(expr);
             return NULL;
         }
     }
@@ -484,118 +201,55 @@ parse_expr_and_expr(pcode_t *pcode)
 }
 
 /*
- * Parse expression xor_expr
- *
- * xor_expr ::=
- *              and_expr ( "^" and_expr )*
+ * Parse binary operators whose precedences are not less than minprec by
+ * precedence climbing; all the binary operators are left associative
  */
-expr_t *
-parse_expr_xor_expr(pcode_t *pcode)
+static expr_t *
+_parse_expr_binop(pcode_t *pcode, int minprec)
 {
     token_t *tok;
     expr_t *expr;
     expr_t *expr0;
     expr_t *expr1;
+    expr_operator_type_t op;
+    int prec;
 
-    /* Parse the first and expression */
-    expr = parse_expr_and_expr(pcode);
+    /* Parse the first `u' expression */
+    expr = _parse_expr_u_expr(pcode);
     if ( NULL == expr ) {
         /* Error */
         return NULL;
     }
 
-    /* Check the next token */
-    tok = token_queue_cur(pcode->token_queue);
-    if ( NULL == tok ) {
-        /* End of token; i.e., syntax error */
-        expr_free(expr);
-        return NULL;
-    }
-    while ( TOK_OP_XOR == tok->type ) {
-        /* Eat TOK_OP_XOR */
-        (void)token_queue_next(pcode->token_queue);
-        expr0 = expr;
-        /* Parse the second and expression */
-        expr1 = parse_expr_and_expr(pcode);
-        if ( NULL == expr1 ) {
-            /* Error */
-            expr_free(expr0);
-            return NULL;
-        }
-        expr = expr_infix_operator(OP_XOR, expr0, expr1);
-        if ( NULL == expr ) {
-            /* Error */
-            expr_free(expr0);
-            expr_free(expr1);
-            return NULL;
-        }
-
-        /* Get the current token */
+    for ( ;; ) {
+        /* Check the next token */
         tok = token_queue_cur(pcode->token_queue);
         if ( NULL == tok ) {
-            /* Error */
-            expr_free(expr);
-            return NULL;
+            /* End of token; i.e., end of the expression */
+            break;
         }
-    }
-
-    return expr;
-}
-
-/*
- * Parse expression or_expr
- *
- * or_expr ::=
- *              xor_expr ( "|" xor_expr )*
- */
-expr_t *
-parse_expr_or_expr(pcode_t *pcode)
-{
-    token_t *tok;
-    expr_t *expr;
-    expr_t *expr0;
-    expr_t *expr1;
-
-    /* Parse the first xor expression */
-    expr = parse_expr_xor_expr(pcode);
-    if ( NULL == expr ) {
-        /* Error */
-        return NULL;
-    }
-
-    /* Check the next token */
-    tok = token_queue_cur(pcode->token_queue);
-    if ( NULL == tok ) {
-        /* End of token; i.e., syntax error */
-        expr_free(expr);
-        return NULL;
-    }
-    while ( TOK_OP_BAR == tok->type ) {
-        /* Eat TOK_OP_BAR */
+        prec = BINOP_PREC(tok->type);
+        if ( 0 == prec || prec < minprec ) {
+            break;
+        }
+        op = _binops[tok->type].op;
+        /* Eat the operator */
         (void)token_queue_next(pcode->token_queue);
         expr0 = expr;
-        /* Parse the second xor expression */
-        expr1 = parse_expr_xor_expr(pcode);
+        /* Parse the right operand which binds tighter */
+        expr1 = _parse_expr_binop(pcode, prec + 1);
         if ( NULL == expr1 ) {
             /* Error */
             expr_free(expr0);
             return NULL;
         }
-        expr = expr_infix_operator(OP_BAR, expr0, expr1);
+        expr = expr_infix_operator(op, expr0, expr1);
         if ( NULL == expr ) {
             /* Error */
             expr_free(expr0);
             expr_free(expr1);
             return NULL;
         }
-
-        /* Get the current token */
-        tok = token_queue_cur(pcode->token_queue);
-        if ( NULL == tok ) {
-            /* Error */
-            expr_free(expr);
-            return NULL;
-        }
     }
 
     return expr;
@@ -610,77 +264,52 @@ parse_expr_or_expr(pcode_t *pcode)
 expr_t *
 parse_expr(pcode_t *pcode)
 {
-    return parse_expr_or_expr(pcode);
+    return _parse_expr_binop(pcode, 1);
 }
 
 /*
- * Parse expression
+ * Parse a size prefix
  *
  * size_prefix ::=
  *              ( "byte" | "word" | "dword" | "qword" )
- *
- * prefixed_expr ::=
- *              ( size_prefix expression | expression )
  */
-pexpr_t *
-parse_prefixed_expr(pcode_t *pcode)
+static size_prefix_t
+_parse_size_prefix(pcode_t *pcode)
 {
     token_t *tok;
-    pexpr_t *pexpr;
-    expr_t *expr;
     size_prefix_t prefix;
 
     /* Get the current token */
     tok = token_queue_cur(pcode->token_queue);
     if ( tok == NULL ) {
-        return NULL;
+        return SIZE_PREFIX_NONE;
     }
-    /* Parse the size prefix */
     if ( TOK_KW_BYTE == tok->type ) {
         prefix = SIZE_PREFIX_BYTE;
-        (void)token_queue_next(pcode->token_queue);
     } else if ( TOK_KW_WORD == tok->type ) {
         prefix = SIZE_PREFIX_WORD;
-        (void)token_queue_next(pcode->token_queue);
     } else if ( TOK_KW_DWORD == tok->type ) {
         prefix = SIZE_PREFIX_DWORD;
-        (void)token_queue_next(pcode->token_queue);
     } else if ( TOK_KW_QWORD == tok->type ) {
         prefix = SIZE_PREFIX_QWORD;
-        (void)token_queue_next(pcode->token_queue);
     } else {
-        prefix = SIZE_PREFIX_NONE;
-    }
-
-    /* Allocate a prefixed expression */
-    pexpr = malloc(sizeof(pexpr_t));
-    if ( NULL == pexpr ) {
-        return NULL;
+        return SIZE_PREFIX_NONE;
     }
-    /* Parse a following expression */
-    expr = parse_expr(pcode);
-    if ( NULL == expr ) {
-        free(pexpr);
-        return NULL;
-    }
-    /* Set */
-    pexpr->prefix = prefix;
-    pexpr->expr = expr;
+    (void)token_queue_next(pcode->token_queue);
 
-    return pexpr;
+    return prefix;
 }
 
 /*
- * Parse an expr
+ * Parse an expr into the expression pool
  *
  * operand_expr ::=
  *              expression
  */
-oexpr_t *
-parse_operand_expr(pcode_t *pcode)
+expr_t *
+parse_operand_expr(icode_t *icode, pcode_t *pcode)
 {
     expr_t *expr;
-    oexpr_t *oexpr;
 
     /* Parse the expression */
     expr = parse_expr(pcode);
@@ -688,253 +317,168 @@ parse_operand_expr(pcode_t *pcode)
         /* Parse error */
         return NULL;
     }
-    /* Allocate operand expression */
-    oexpr = malloc(sizeof(oexpr_t));
-    if ( NULL == oexpr ) {
-        expr_free(expr);
-        return NULL;
-    }
-    oexpr->type = OEXPR_EXPR;
-    oexpr->u.expr = expr;
 
-    return oexpr;
+    return icode_expr(icode, expr);
 }
 
 /*
  * Parse an addr or moffset
  *
  * operand_addr ::=
- *              "[" prefixed_expr "]"
+ *              "[" ( size_prefix expression | expression ) "]"
  */
-oexpr_t *
-parse_operand_addr(pcode_t *pcode)
+int
+parse_operand_addr(icode_t *icode, pcode_t *pcode, operand_t *op)
 {
     token_t *tok;
-    pexpr_t *pexpr;
-    oexpr_t *oexpr;
 
     /* Skip lbracket */
     (void)token_queue_next(pcode->token_queue);
 
-    /* Parse expression */
-    pexpr = parse_prefixed_expr(pcode);
-    if ( NULL == pexpr ) {
+    /* Parse the size prefix and the following expression */
+    op->aprefix = _parse_size_prefix(pcode);
+    op->expr0 = parse_operand_expr(icode, pcode);
+    if ( NULL == op->expr0 ) {
         /* Parse error */
-        return NULL;
+        return -1;
     }
 
     /* Get the current token */
     tok = token_queue_cur(pcode->token_queue);
     if ( tok == NULL || TOK_RBRACKET != tok->type ) {
-        return NULL;
+        return -1;
     }
     /* Skip the TOK_RBRACKET */
     (void)token_queue_next(pcode->token_queue);
 
-    /* Expression to addr */
-    oexpr = malloc(sizeof(oexpr_t));
-    if ( NULL == oexpr ) {
-        pexpr_free(pexpr);
-        return NULL;
-    }
-    oexpr->type = OEXPR_ADDR;
-    oexpr->u.pexpr = pexpr;
+    op->type = OEXPR_ADDR;
 
-    return oexpr;
+    return 0;
 }
 
 /*
  * Parse an operand
  *
  * operand ::=
- *              ( operand_expr | operand_addr )
+ *              size_prefix? ( operand_expr ( ":" operand_expr )?
+ *                             | operand_addr )
  */
-operand_t *
-parse_operand(pcode_t *pcode)
+int
+parse_operand(icode_t *icode, pcode_t *pcode, operand_t *op)
 {
-    oexpr_t *oexpr0;
-    oexpr_t *oexpr1;
     token_t *tok;
-    size_prefix_t prefix;
-    operand_t *op;
 
-    /* Get the current token */
-    tok = token_queue_cur(pcode->token_queue);
-    if ( tok == NULL ) {
-        return NULL;
-    }
     /* Parse the size prefix */
-    if ( TOK_KW_BYTE == tok->type ) {
-        prefix = SIZE_PREFIX_BYTE;
-        (void)token_queue_next(pcode->token_queue);
-    } else if ( TOK_KW_WORD == tok->type ) {
-        prefix = SIZE_PREFIX_WORD;
-        (void)token_queue_next(pcode->token_queue);
-    } else if ( TOK_KW_DWORD == tok->type ) {
-        prefix = SIZE_PREFIX_DWORD;
-        (void)token_queue_next(pcode->token_queue);
-    } else if ( TOK_KW_QWORD == tok->type ) {
-        prefix = SIZE_PREFIX_QWORD;
-        (void)token_queue_next(pcode->token_queue);
-    } else {
-        prefix = SIZE_PREFIX_NONE;
-    }
+    op->prefix = _parse_size_prefix(pcode);
+    op->aprefix = SIZE_PREFIX_NONE;
+    op->expr1 = NULL;
 
     /* Get the current token and check it */
     tok = token_queue_cur(pcode->token_queue);
+    if ( tok == NULL ) {
+        return -1;
+    }
     if ( TOK_BININT == tok->type || TOK_OCTINT == tok->type
          || TOK_DECINT == tok->type || TOK_HEXINT == tok->type
          || TOK_OP_PLUS == tok->type || TOK_OP_MINUS == tok->type
          || TOK_OP_TILDE == tok->type || TOK_SYMBOL == tok->type ) {
         /* Symbol, register, or immediate value */
-        oexpr0 = parse_operand_expr(pcode);
-        if ( NULL == oexpr0 ) {
-            return NULL;
+        op->type = OEXPR_EXPR;
+        op->expr0 = parse_operand_expr(icode, pcode);
+        if ( NULL == op->expr0 ) {
+            return -1;
         }
 
         /* Get the current token */
         tok = token_queue_cur(pcode->token_queue);
         if ( tok != NULL && TOK_COLON == tok->type ) {
             (void)token_queue_next(pcode->token_queue);
-            oexpr1 = parse_operand_expr(pcode);
-            if ( NULL == oexpr1 ) {
+            op->expr1 = parse_operand_expr(icode, pcode);
+            if ( NULL == op->expr1 ) {
                 /* Parse error */
-                oexpr_free(oexpr0);
-                return NULL;
+                return -1;
             }
-        } else {
-            oexpr1 = NULL;
         }
-
     } else if ( TOK_LBRACKET == tok->type ) {
         /* Address or moffset */
-        oexpr0 = parse_operand_addr(pcode);
-        if ( NULL == oexpr0 ) {
-            return NULL;
+        if ( 0 != parse_operand_addr(icode, pcode, op) ) {
+            return -1;
         }
     } else {
         /* Parse error */
-        return NULL;
-    }
-    op = malloc(sizeof(operand_t));
-    if ( NULL == op ) {
-        /* FIXME */
-        return NULL;
+        return -1;
     }
-    op->oexpr0 = oexpr0;
-    op->oexpr1 = oexpr1;
-    op->prefix = prefix;
 
-    return op;
+    return 0;
 }
 
 /*
  * Parse instruction
  *
  * instruction ::=
- *              opcode operand ( "," operand )*
+ *              fix* opcode fix* operand ( "," operand )*
  */
-stmt_t *
-parse_instr(pcode_t *pcode, token_t *tok0)
+int
+parse_instr(icode_t *icode, pcode_t *pcode, token_t *tok0, stmt_t *stmt)
 {
-    stmt_t *stmt;
-    instr_t *instr;
     token_t *tok;
-    char *opcodestr;
-    opcode_vector_t *opcode;
-    operand_t *op;
-    operand_vector_t *vec;
+    instr_t *instr;
+    int bit;
 
-    /* Allocate opcode and operand vectors  */
-    opcode = mvector_new();
-    if ( NULL == opcode ) {
-        return NULL;
-    }
-    vec = mvector_new();
-    if ( NULL == vec ) {
-        opcode_vector_delete(opcode);
-        return NULL;
-    }
+    stmt->type = STMT_INSTR;
+    instr = &stmt->u.instr;
+    instr->prefix = 0;
+    instr->suffix = 0;
+    instr->nopr = 0;
 
     tok = tok0;
     /* Prefix */
-    while ( TOK_FIX == tok->type ) {
-        /* Push the opcode prefixes */
-        opcodestr = strdup(tok->val.sym);
-        if ( NULL == opcodestr ) {
-            opcode_vector_delete(opcode);
-            operands_delete(vec);
-            return NULL;
-        }
-        if ( NULL == mvector_push_back(opcode, opcodestr) ) {
-            free(opcodestr);
-            opcode_vector_delete(opcode);
-            operands_delete(vec);
-            return NULL;
+    while ( NULL != tok && TOK_FIX == tok->type ) {
+        /* Set the bit of the opcode prefix */
+        bit = icode_fix_bit(icode, tok->id);
+        if ( bit < 0 ) {
+            return -1;
         }
+        instr->prefix |= (uint32_t)1 << bit;
         tok = token_queue_cur(pcode->token_queue);
         (void)token_queue_next(pcode->token_queue);
     }
 
     /* Operation */
-    if ( TOK_SYMBOL != tok->type ) {
+    if ( NULL == tok || TOK_SYMBOL != tok->type ) {
         /* Operation must be a symbol */
-        opcode_vector_delete(opcode);
-        operands_delete(vec);
-        return NULL;
-    }
-    /* Push the operation */
-    opcodestr = strdup(tok->val.sym);
-    if ( NULL == opcodestr ) {
-        opcode_vector_delete(opcode);
-        operands_delete(vec);
-        return NULL;
-    }
-    if ( NULL == mvector_push_back(opcode, opcodestr) ) {
-        free(opcodestr);
-        opcode_vector_delete(opcode);
-        operands_delete(vec);
-        return NULL;
+        return -1;
     }
+    instr->mnemonic = tok->id;
 
     /* Suffix */
     tok = token_queue_cur(pcode->token_queue);
-    while ( TOK_FIX == tok->type ) {
-        /* Push the opcode suffixes */
-        opcodestr = strdup(tok->val.sym);
-        if ( NULL == opcodestr ) {
-            opcode_vector_delete(opcode);
-            operands_delete(vec);
-            return NULL;
-        }
-        if ( NULL == mvector_push_back(opcode, opcodestr) ) {
-            free(opcodestr);
-            opcode_vector_delete(opcode);
-            operands_delete(vec);
-            return NULL;
+    while ( NULL != tok && TOK_FIX == tok->type ) {
+        /* Set the bit of the opcode suffix */
+        bit = icode_fix_bit(icode, tok->id);
+        if ( bit < 0 ) {
+            return -1;
         }
+        instr->suffix |= (uint32_t)1 << bit;
         tok = token_queue_next(pcode->token_queue);
     }
 
     /* Read until the end of line */
     tok = token_queue_cur(pcode->token_queue);
     while ( NULL != tok && TOK_EOL != tok->type ) {
-        op = parse_operand(pcode);
-        if ( NULL == op ) {
-            /* Free opcode and operands */
-            opcode_vector_delete(opcode);
-            operands_delete(vec);
-            return NULL;
+        if ( instr->nopr >= INSTR_MAX_OPERANDS ) {
+            /* Too many operands */
+            return -1;
         }
-        if ( NULL == mvector_push_back(vec, op) ) {
-            operand_free(op);
-            /* Free opcode and operands */
-            opcode_vector_delete(opcode);
-            operands_delete(vec);
-            return NULL;
+        if ( 0 != parse_operand(icode, pcode, &instr->opr[instr->nopr]) ) {
+            return -1;
         }
+        instr->nopr++;
         tok = token_queue_cur(pcode->token_queue);
-        if ( TOK_COMMA == tok->type ) {
+        if ( NULL == tok ) {
+            /* EOF (Valid syntax) */
+            break;
+        } else if ( TOK_COMMA == tok->type ) {
             /* Proceed to the next operand */
             (void)token_queue_next(pcode->token_queue);
         } else if ( TOK_EOL == tok->type ) {
@@ -942,33 +486,11 @@ parse_instr(pcode_t *pcode, token_t *tok0)
         } else {
             /* Syntax error */
             (void)token_queue_next(pcode->token_queue);
-            /* Free opcode and operands */
-            opcode_vector_delete(opcode);
-            operands_delete(vec);
-            return NULL;
+            return -1;
         }
     }
 
-    /* Instruction */
-    instr = instr_new(opcode, vec);
-    if ( NULL == instr ) {
-        opcode_vector_delete(opcode);
-        operands_delete(vec);
-        return NULL;
-    }
-
-    /* Allocate for the global statement structure */
-    stmt = malloc(sizeof(stmt_t));
-    if ( NULL == stmt ) {
-        /* Error on memory allocation */
-        instr_delete(instr);
-        return NULL;
-    }
-    /* Set attributes */
-    stmt->type = STMT_INSTR;
-    stmt->u.instr = instr;
-
-    return stmt;
+    return 0;
 }
 
 /*
@@ -977,30 +499,17 @@ parse_instr(pcode_t *pcode, token_t *tok0)
  * label ::=
  *              symbol ":"
  */
-stmt_t *
-parse_label(pcode_t *pcode, const token_t *tok)
+int
+parse_label(pcode_t *pcode, const token_t *tok, stmt_t *stmt)
 {
-    stmt_t *stmt;
-
-    /* Allocate for the global statement structure */
-    stmt = malloc(sizeof(stmt_t));
-    if ( NULL == stmt ) {
-        /* Error on memory allocation */
-        return NULL;
-    }
     /* Set attributes */
     stmt->type = STMT_LABEL;
-    stmt->u.label = strdup(tok->val.sym);
-    if ( NULL == stmt->u.label ) {
-        /* Can't allocate memory */
-        free(stmt);
-        return NULL;
-    }
+    stmt->u.label = tok->id;
 
     /* Skip this colon */
     (void)token_queue_next(pcode->token_queue);
 
-    return stmt;
+    return 0;
 }
 
 /*
@@ -1009,38 +518,26 @@ parse_label(pcode_t *pcode, const token_t *tok)
  * global ::=
  *              "global" symbol
  */
-stmt_t *
-parse_global(pcode_t *pcode)
+int
+parse_global(pcode_t *pcode, stmt_t *stmt)
 {
     token_t *tok;
-    stmt_t *stmt;
 
     /* Skip "global" and get the symbol string */
     tok = token_queue_next(pcode->token_queue);
-    if ( TOK_SYMBOL != tok->type ) {
+    if ( NULL == tok || TOK_SYMBOL != tok->type ) {
         /* Syntax error */
-        return NULL;
+        return -1;
     }
 
-    /* Allocate for the global statement structure */
-    stmt = malloc(sizeof(stmt_t));
-    if ( NULL == stmt ) {
-        /* Error on memory allocation */
-        return NULL;
-    }
     /* Set attributes */
     stmt->type = STMT_GLOBAL;
-    stmt->u.global = strdup(tok->val.sym);
-    if ( NULL == stmt->u.global ) {
-        /* Error on memory allocation */
-        free(stmt);
-        return NULL;
-    }
+    stmt->u.global = tok->id;
 
     /* Skip the current token */
     (void)token_queue_next(pcode->token_queue);
 
-    return stmt;
+    return 0;
 }
 
 /*
@@ -1049,19 +546,22 @@ parse_global(pcode_t *pcode)
  * input ::=
  *              ( EOL | instruction | label | global )* EOF
  */
-stmt_vector_t *
+icode_t *
 parse(pcode_t *pcode)
 {
     token_t *tok;
     token_t *tok0;
-    stmt_t *stmt;
-    stmt_vector_t *vec;
+    stmt_t stmt;
+    icode_t *icode;
+    int ret;
 
-    /* Create a new statement vector */
-    vec = mvector_new();
-    if ( NULL == vec ) {
+    /* Create a new icode */
+    icode = icode_new();
+    if ( NULL == icode ) {
         return NULL;
     }
+    (void)memcpy(icode->fix, pcode->fix, sizeof(sym_id_t) * pcode->nfix);
+    icode->nfix = pcode->nfix;
 
     token_queue_rewind(pcode->token_queue);
     while ( NULL != (tok = token_queue_cur(pcode->token_queue)) ) {
@@ -1069,58 +569,48 @@ parse(pcode_t *pcode)
         case TOK_INVAL:
             /* Invalid token */
             /* FIXME: Raise an error */
+            icode_delete(icode);
             return NULL;
-            break;
         case TOK_EOL:
             (void)token_queue_next(pcode->token_queue);
-            break;
+            continue;
         case TOK_KW_GLOBAL:
             /* glboal */
-            stmt = parse_global(pcode);
-            if ( NULL == mvector_push_back(vec, stmt) ) {
-                stmt_free(stmt);
-                return NULL;
-            }
+            ret = parse_global(pcode, &stmt);
             break;
         case TOK_FIX:
             /* PREFIX */
             (void)token_queue_next(pcode->token_queue);
-            stmt = parse_instr(pcode, tok);
-            if ( NULL == stmt ) {
-                /* Parse error */
-                return NULL;
-            }
-            if ( NULL == mvector_push_back(vec, stmt) ) {
-                stmt_free(stmt);
-                return NULL;
-            }
+            ret = parse_instr(icode, pcode, tok, &stmt);
             break;
         case TOK_SYMBOL:
             /* Store the current token */
             tok0 = tok;
             tok = token_queue_next(pcode->token_queue);
-            if ( TOK_COLON == tok->type ) {
+            if ( NULL != tok && TOK_COLON == tok->type ) {
                 /* Label token */
-                stmt = parse_label(pcode, tok0);
+                ret = parse_label(pcode, tok0, &stmt);
             } else {
-                stmt = parse_instr(pcode, tok0);
-            }
-            if ( NULL == stmt ) {
-                /* Parse error */
-                return NULL;
-            }
-            if ( NULL == mvector_push_back(vec, stmt) ) {
-                stmt_free(stmt);
-                return NULL;
+                ret = parse_instr(icode, pcode, tok0, &stmt);
             }
             break;
         default:
             /* Other token */
+            icode_delete(icode);
+            return NULL;
+        }
+        if ( 0 != ret ) {
+            /* Parse error */
+            icode_delete(icode);
+            return NULL;
+        }
+        if ( NULL == stmt_vector_push_back(icode->stmts, stmt) ) {
+            icode_delete(icode);
             return NULL;
         }
     }
 
-    return vec;
+    return icode;
 }
 
 /*
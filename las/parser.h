@@ -18,8 +18,8 @@ extern "C" {
 #endif
 
     expr_t * parse_expr(pcode_t *);
-    stmt_t * parse_instr(pcode_t *, token_t *);
-    stmt_vector_t * parse(pcode_t *);
+    int parse_instr(icode_t *, pcode_t *, token_t *, stmt_t *);
+    icode_t * parse(pcode_t *);
 
 #ifdef __cplusplus
 }
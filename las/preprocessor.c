@@ -13,6 +13,115 @@
 #include <string.h>
 #include <unistd.h>
 
+#define PP_KW_SEED_TRIALS       1024
+
+/*
+ * Built-in keywords
+ */
+static const pp_keyword_t _keywords[] = {
+    { "global", 6, TOK_KW_GLOBAL },
+    { "byte", 4, TOK_KW_BYTE },
+    { "word", 4, TOK_KW_WORD },
+    { "dword", 5, TOK_KW_DWORD },
+    { "qword", 5, TOK_KW_QWORD },
+};
+
+/*
+ * Hash function of the keyword table
+ */
+static __inline__ uint32_t
+_kw_hash(uint32_t seed, const char *s, size_t len)
+{
+    uint32_t h;
+    size_t i;
+
+    h = seed;
+    for ( i = 0; i < len; i++ ) {
+        h = (h ^ (unsigned char)s[i]) * 16777619U;
+    }
+
+    return h ^ (h >> 16);
+}
+
+/*
+ * Try to place all the keywords into the slots with the seed; returns 0 if
+ * there is no collision
+ */
+static int
+_kw_place(preprocessor_t *pp, pp_keyword_t *slots, size_t nslots,
+          uint32_t seed)
+{
+    size_t i;
+    size_t j;
+    token_fix_t *fix;
+
+    (void)memset(slots, 0, sizeof(pp_keyword_t) * nslots);
+
+    /* Built-in keywords */
+    for ( i = 0; i < sizeof(_keywords) / sizeof(_keywords[0]); i++ ) {
+        j = _kw_hash(seed, _keywords[i].kw, _keywords[i].len) & (nslots - 1);
+        if ( NULL != slots[j].kw ) {
+            /* Collision */
+            return -1;
+        }
+        slots[j] = _keywords[i];
+    }
+
+    /* Registered *fixes */
+    for ( i = 0; i < mvector_size(pp->fix); i++ ) {
+        fix = mvector_at(pp->fix, i);
+        j = _kw_hash(seed, fix->kw, fix->len) & (nslots - 1);
+        if ( NULL != slots[j].kw ) {
+            /* Collision */
+            return -1;
+        }
+        slots[j].kw = fix->kw;
+        slots[j].len = fix->len;
+        slots[j].type = TOK_FIX;
+    }
+
+    return 0;
+}
+
+/*
+ * Rebuild the keyword table from the built-in keywords and the registered
+ * *fixes by searching a collision-free seed
+ */
+static int
+_kw_rebuild(preprocessor_t *pp)
+{
+    pp_keyword_t *slots;
+    size_t n;
+    size_t nslots;
+    uint32_t seed;
+
+    n = sizeof(_keywords) / sizeof(_keywords[0]) + mvector_size(pp->fix);
+    nslots = 8;
+    while ( nslots < n * 2 ) {
+        nslots <<= 1;
+    }
+    for ( ;; ) {
+        slots = malloc(sizeof(pp_keyword_t) * nslots);
+        if ( NULL == slots ) {
+            return -1;
+        }
+        for ( seed = 2166136261U; seed < 2166136261U + PP_KW_SEED_TRIALS;
+              seed++ ) {
+            if ( 0 == _kw_place(pp, slots, nslots, seed) ) {
+                /* Found */
+                free(pp->kwtbl.slots);
+                pp->kwtbl.slots = slots;
+                pp->kwtbl.nslots = nslots;
+                pp->kwtbl.seed = seed;
+                return 0;
+            }
+        }
+        /* Retry with a larger table */
+        free(slots);
+        nslots <<= 1;
+    }
+}
+
 /*
  * Return a new preprocessor instance
  */
@@ -27,6 +136,19 @@ pp_new(void)
         return NULL;
     }
     pp->fix = mvector_new();
+    if ( NULL == pp->fix ) {
+        free(pp);
+        return NULL;
+    }
+    pp->kwtbl.slots = NULL;
+    pp->kwtbl.nslots = 0;
+    pp->kwtbl.seed = 0;
+    pp->jobs = 1;
+    if ( 0 != _kw_rebuild(pp) ) {
+        mvector_delete(pp->fix);
+        free(pp);
+        return NULL;
+    }
 
     return pp;
 }
@@ -37,7 +159,7 @@ pp_new(void)
 void
 pp_delete(preprocessor_t *pp)
 {
-    int i;
+    size_t i;
     token_fix_t *fix;
 
     for ( i = 0; i < mvector_size(pp->fix); i++ ) {
@@ -46,6 +168,7 @@ pp_delete(preprocessor_t *pp)
         free(fix);
     }
     mvector_delete(pp->fix);
+    free(pp->kwtbl.slots);
     free(pp);
 }
 
@@ -58,6 +181,8 @@ preprocess(preprocessor_t *pp, const char *fname)
     scode_t *scode;
     tcode_t *tcode;
     pcode_t *pcode;
+    token_fix_t *fix;
+    size_t i;
 
     /* Read source code from the input file */
     scode = scode_read(fname);
@@ -67,21 +192,44 @@ preprocess(preprocessor_t *pp, const char *fname)
 
     tcode = tokenize(pp, scode);
     if ( NULL == tcode ) {
-        /* FIXME: Free scode */
+        scode_delete(scode);
         return NULL;
     }
 
     pcode = malloc(sizeof(pcode_t));
     if ( NULL == pcode ) {
-        /* FIXME: Free scode and tcode */
+        tcode_delete(tcode);
+        scode_delete(scode);
         return NULL;
     }
+    /* Take over the token queue and its arena from the tcode */
     pcode->token_queue = tcode->token_queue;
+    pcode->arena = tcode->arena;
+    pcode->scode = scode;
     pcode->tree = NULL;
+    free(tcode);
+
+    /* Copy the IDs of the *fixes */
+    for ( i = 0; i < mvector_size(pp->fix); i++ ) {
+        fix = mvector_at(pp->fix, i);
+        pcode->fix[i] = fix->id;
+    }
+    pcode->nfix = i;
 
     return pcode;
 }
 
+/*
+ * Free the preprocessed code with its tokens and source code
+ */
+void
+pcode_delete(pcode_t *pcode)
+{
+    arena_delete(pcode->arena);
+    scode_delete(pcode->scode);
+    free(pcode);
+}
+
 /*
  * Register fix
  */
@@ -90,6 +238,22 @@ pp_register_fix(preprocessor_t *pp, const char *s)
 {
     token_fix_t *fix;
 
+    /* Check the duplicate */
+    switch ( pp_keyword_type(pp, s, strlen(s)) ) {
+    case TOK_SYMBOL:
+        break;
+    case TOK_FIX:
+        /* Already registered */
+        return 0;
+    default:
+        /* Reserved keyword */
+        return -1;
+    }
+    if ( mvector_size(pp->fix) >= PP_MAX_FIXES ) {
+        /* Too many *fixes */
+        return -1;
+    }
+
     fix = malloc(sizeof(token_fix_t));
     if ( NULL == fix ) {
         return -1;
@@ -99,6 +263,13 @@ pp_register_fix(preprocessor_t *pp, const char *s)
         free(fix);
         return -1;
     }
+    fix->len = strlen(s);
+    fix->id = intern_sym(s, fix->len);
+    if ( SYM_ID_NONE == fix->id ) {
+        free(fix->kw);
+        free(fix);
+        return -1;
+    }
 
     if ( NULL == mvector_push_back(pp->fix, fix) ) {
         free(fix->kw);
@@ -106,9 +277,35 @@ pp_register_fix(preprocessor_t *pp, const char *s)
         return -1;
     }
 
+    /* Rebuild the keyword table */
+    if ( 0 != _kw_rebuild(pp) ) {
+        (void)mvector_pop_back(pp->fix);
+        free(fix->kw);
+        free(fix);
+        return -1;
+    }
+
     return 0;
 }
 
+/*
+ * Classify a symbol: returns the token type of the keyword or the *fix, or
+ * TOK_SYMBOL if it is not registered
+ */
+token_type_t
+pp_keyword_type(const preprocessor_t *pp, const char *s, size_t len)
+{
+    const pp_keyword_t *ent;
+
+    ent = &pp->kwtbl.slots[_kw_hash(pp->kwtbl.seed, s, len)
+                           & (pp->kwtbl.nslots - 1)];
+    if ( ent->len == len && NULL != ent->kw && 0 == memcmp(ent->kw, s, len) ) {
+        return ent->type;
+    }
+
+    return TOK_SYMBOL;
+}
+
 /*
  * Local variables:
  * tab-width: 4
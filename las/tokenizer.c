@@ -10,35 +10,240 @@
 #include "las.h"
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAVE_X86_64_SIMD 1
+#endif
 
 #define SWAPZ(a, b) (((a) != (b)) && ((a) ^= (b), (b) = (a) ^ (b), (a) ^= (b)))
 #define EOS     -1
 #define EFATAL  1
-#define IS_DECINT_CHAR(c) (isdigit(c))
-#define IS_HEXINT_CHAR(c) (isxdigit(c))
 
-static __inline__ int
-IS_SYMBOL_CHAR(int c)
+/*
+ * Minimum number of the bytes of a chunk of the parallel tokenization
+ */
+#define TOKENIZER_MIN_CHUNK     (1 << 20)
+
+/*
+ * Character classes
+ */
+#define CC_SPACE        1       /* White space except for LF */
+#define CC_DEC          (1<<1)
+#define CC_BIN          (1<<2)
+#define CC_OCT          (1<<3)
+#define CC_HEX          (1<<4)
+#define CC_SYM          (1<<5)  /* [0-9A-Za-z_.] */
+
+#define SP      CC_SPACE
+#define D01     (CC_DEC | CC_BIN | CC_OCT | CC_HEX | CC_SYM)
+#define D27     (CC_DEC | CC_OCT | CC_HEX | CC_SYM)
+#define D89     (CC_DEC | CC_HEX | CC_SYM)
+#define HEX     (CC_HEX | CC_SYM)
+#define SYM     CC_SYM
+static const unsigned char _ctype[256] = {
+    0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , SP , 0  , SP , SP , SP , 0  , 0,
+    0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0,
+    SP , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , SYM, 0,
+    D01, D01, D27, D27, D27, D27, D27, D27, D89, D89, 0  , 0  , 0  , 0  , 0  , 0,
+    0  , HEX, HEX, HEX, HEX, HEX, HEX, SYM, SYM, SYM, SYM, SYM, SYM, SYM, SYM, SYM,
+    SYM, SYM, SYM, SYM, SYM, SYM, SYM, SYM, SYM, SYM, SYM, 0  , 0  , 0  , 0  , SYM,
+    0  , HEX, HEX, HEX, HEX, HEX, HEX, SYM, SYM, SYM, SYM, SYM, SYM, SYM, SYM, SYM,
+    SYM, SYM, SYM, SYM, SYM, SYM, SYM, SYM, SYM, SYM, SYM, 0  , 0  , 0  , 0  , 0,
+    /* 0x80-0xff: zero */
+};
+#undef SP
+#undef D01
+#undef D27
+#undef D89
+#undef HEX
+#undef SYM
+
+#define IS_CCLASS(c, cc)        (_ctype[(unsigned char)(c)] & (cc))
+#define IS_DECINT_CHAR(c)       IS_CCLASS((c), CC_DEC)
+#define IS_HEXINT_CHAR(c)       IS_CCLASS((c), CC_HEX)
+#define IS_BININT_CHAR(c)       IS_CCLASS((c), CC_BIN)
+#define IS_OCTINT_CHAR(c)       IS_CCLASS((c), CC_OCT)
+#define IS_SYMBOL_CHAR(c)       IS_CCLASS((c), CC_SYM)
+#define IS_SPACE_CHAR(c)        IS_CCLASS((c), CC_SPACE)
+
+/*
+ * Scanning functions for runs of characters; they return the pointer to the
+ * first character that does not belong to the run, or the end of the buffer
+ */
+typedef const unsigned char *
+(*_scan_f)(const unsigned char *, const unsigned char *);
+
+/*
+ * Skip white spaces (scalar)
+ */
+static const unsigned char *
+_scan_spaces_scalar(const unsigned char *p, const unsigned char *end)
 {
-    return (isalnum(c) || '_' == c || '.' == c) ? 1 : 0;
+    while ( p < end && IS_SPACE_CHAR(*p) ) {
+        p++;
+    }
+
+    return p;
 }
-static __inline__ int
-IS_BININT_CHAR(int c)
+
+/*
+ * Search LF (scalar; memchr of the C library is usually vectorized)
+ */
+static const unsigned char *
+_scan_line_scalar(const unsigned char *p, const unsigned char *end)
 {
-    return (c == '0' || c == '1') ? 1 : 0;
+    const unsigned char *lf;
+
+    lf = memchr(p, '\n', end - p);
+
+    return NULL != lf ? lf : end;
 }
-static __inline__ int
-IS_OCTINT_CHAR(int c)
+
+#if HAVE_X86_64_SIMD
+/*
+ * Skip white spaces (SSE2): a byte is a white space if it is ' ' or in
+ * [0x09, 0x0d] except for LF
+ */
+static const unsigned char *
+_scan_spaces_sse2(const unsigned char *p, const unsigned char *end)
 {
-    return (c >= '0' && c <= '7') ? 1 : 0;
+    __m128i x;
+    __m128i d;
+    __m128i m;
+    unsigned int mask;
+
+    /* Most of the runs are a few characters long */
+    if ( p < end && !IS_SPACE_CHAR(*p) ) {
+        return p;
+    }
+    while ( end - p >= 16 ) {
+        x = _mm_loadu_si128((const __m128i *)p);
+        d = _mm_sub_epi8(x, _mm_set1_epi8(0x09));
+        m = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(4)), d);
+        m = _mm_andnot_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\n')), m);
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(x, _mm_set1_epi8(' ')));
+        mask = ~(unsigned int)_mm_movemask_epi8(m) & 0xffff;
+        if ( mask ) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+
+    return _scan_spaces_scalar(p, end);
 }
-static __inline__ int
-IS_NONZERODIGIT(int c)
+
+/*
+ * Skip white spaces (AVX2)
+ */
+__attribute__((target("avx2")))
+static const unsigned char *
+_scan_spaces_avx2(const unsigned char *p, const unsigned char *end)
 {
-    return (c != '0' && isdigit(c)) ? 1 : 0;
+    __m256i x;
+    __m256i d;
+    __m256i m;
+    unsigned int mask;
+
+    /* Most of the runs are a few characters long */
+    if ( p < end && !IS_SPACE_CHAR(*p) ) {
+        return p;
+    }
+    while ( end - p >= 32 ) {
+        x = _mm256_loadu_si256((const __m256i *)p);
+        d = _mm256_sub_epi8(x, _mm256_set1_epi8(0x09));
+        m = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(4)), d);
+        m = _mm256_andnot_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n')),
+                                m);
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')));
+        mask = ~(unsigned int)_mm256_movemask_epi8(m);
+        if ( mask ) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+
+    return _scan_spaces_sse2(p, end);
+}
+
+/*
+ * Search LF (SSE2)
+ */
+static const unsigned char *
+_scan_line_sse2(const unsigned char *p, const unsigned char *end)
+{
+    unsigned int mask;
+
+    while ( end - p >= 16 ) {
+        mask = _mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p),
+                           _mm_set1_epi8('\n')));
+        if ( mask ) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+
+    return _scan_line_scalar(p, end);
+}
+
+/*
+ * Search LF (AVX2)
+ */
+__attribute__((target("avx2")))
+static const unsigned char *
+_scan_line_avx2(const unsigned char *p, const unsigned char *end)
+{
+    unsigned int mask;
+
+    while ( end - p >= 32 ) {
+        mask = _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)p),
+                              _mm256_set1_epi8('\n')));
+        if ( mask ) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+
+    return _scan_line_sse2(p, end);
 }
+#endif /* HAVE_X86_64_SIMD */
 
+/*
+ * Scanning functions selected at runtime
+ */
+static _scan_f _scan_spaces = NULL;
+static _scan_f _scan_line = NULL;
+
+/*
+ * Select the scanning functions for the running processor
+ */
+static void
+_scan_init(void)
+{
+    if ( NULL != _scan_spaces ) {
+        return;
+    }
+#if HAVE_X86_64_SIMD
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx2") ) {
+        _scan_line = _scan_line_avx2;
+        _scan_spaces = _scan_spaces_avx2;
+    } else {
+        _scan_line = _scan_line_sse2;
+        _scan_spaces = _scan_spaces_sse2;
+    }
+#else
+    _scan_line = _scan_line_scalar;
+    _scan_spaces = _scan_spaces_scalar;
+#endif
+}
 
 /*
  * Return the current character
@@ -46,33 +251,27 @@ IS_NONZERODIGIT(int c)
 static int
 _cur(tokenizer_t *tokenizer)
 {
-    if ( tokenizer->cur >= tokenizer->scode->str.len ) {
+    if ( tokenizer->cur >= tokenizer->end ) {
         /* End-of-string */
         return EOS;
     }
     return tokenizer->scode->str.s[tokenizer->cur];
 }
-static unsigned char *
-_curp(tokenizer_t *tokenizer)
-{
-    if ( tokenizer->cur >= tokenizer->scode->str.len ) {
-        /* End-of-string */
-        return NULL;
-    }
-    return &tokenizer->scode->str.s[tokenizer->cur];
-}
 
 /*
  * Proceed the pointer and return the next character
  */
-static int
+static __inline__ int
 _next(tokenizer_t *tokenizer)
 {
-    if ( tokenizer->cur >= tokenizer->scode->str.len ) {
+    const string_t *str;
+
+    str = &tokenizer->scode->str;
+    if ( tokenizer->cur >= tokenizer->end ) {
         /* End-of-string */
         return EOS;
     }
-    if ( '\n' == _cur(tokenizer) ) {
+    if ( '\n' == str->s[tokenizer->cur] ) {
          tokenizer->pos.l++;
          tokenizer->pos.c = 0;
     } else {
@@ -80,7 +279,21 @@ _next(tokenizer_t *tokenizer)
     }
 
     tokenizer->cur++;
-    return _cur(tokenizer);
+    if ( tokenizer->cur >= tokenizer->end ) {
+        /* End-of-string */
+        return EOS;
+    }
+    return str->s[tokenizer->cur];
+}
+
+/*
+ * Proceed the pointer by n characters that do not contain LF
+ */
+static __inline__ void
+_forward(tokenizer_t *tokenizer, size_t n)
+{
+    tokenizer->cur += n;
+    tokenizer->pos.c += n;
 }
 
 /*
@@ -89,22 +302,15 @@ _next(tokenizer_t *tokenizer)
 static int
 _skip_whitespaces(tokenizer_t *tokenizer)
 {
-    int c;
-    int cnt;
-
-    /* Reset the counter */
-    cnt = 0;
+    const unsigned char *sp;
+    const unsigned char *tp;
+    size_t cnt;
 
-    /* Process until the end of white-spaces */
-    c = _cur(tokenizer);
-    while ( c >= 0 ) {
-        /* Skip ``\t'', ``\n'', ``\v'', ``\f'', ``\r'' and `` ''  */
-        if ( !isspace(c) || '\n' == c ) {
-            /* Not a white space */
-            break;
-        }
-        c = _next(tokenizer);
-    }
+    /* Skip ``\t'', ``\v'', ``\f'', ``\r'' and `` '' (but not ``\n'') */
+    sp = tokenizer->scode->str.s + tokenizer->cur;
+    tp = _scan_spaces(sp, tokenizer->scode->str.s + tokenizer->end);
+    cnt = tp - sp;
+    _forward(tokenizer, cnt);
 
     /* Return the number of skipped chars */
     return cnt;
@@ -116,72 +322,120 @@ _skip_whitespaces(tokenizer_t *tokenizer)
 static int
 _skip_line_comment(tokenizer_t *tokenizer)
 {
-    int c;
-    int cnt;
+    const unsigned char *sp;
+    const unsigned char *tp;
+    size_t cnt;
 
-    /* Reset the counter */
-    cnt = 0;
+    /* Process until LF (or the end of the string) */
+    sp = tokenizer->scode->str.s + tokenizer->cur;
+    tp = _scan_line(sp, tokenizer->scode->str.s + tokenizer->end);
+    cnt = tp - sp;
+    _forward(tokenizer, cnt);
 
-    /* Process until the end of white-spaces */
-    c = _cur(tokenizer);
-    while ( c >= 0 ) {
-        if ( '\n' == c ) {
-            /* LF */
+    /* Return the number of skipped chars */
+    return cnt;
+}
+
+/*
+ * Read the whole content from a file descriptor into a heap buffer (used for
+ * pipes and other files that cannot be mapped)
+ */
+static int
+_scode_read_fd(int fd, string_t *str)
+{
+    unsigned char *buf;
+    unsigned char *nbuf;
+    size_t len;
+    size_t max;
+    ssize_t nr;
+
+    len = 0;
+    max = 4096;
+    buf = malloc(max);
+    if ( NULL == buf ) {
+        return -1;
+    }
+    for ( ;; ) {
+        if ( len == max ) {
+            /* Double the buffer */
+            if ( max > SIZE_MAX / 2 ) {
+                free(buf);
+                return -1;
+            }
+            nbuf = realloc(buf, max * 2);
+            if ( NULL == nbuf ) {
+                free(buf);
+                return -1;
+            }
+            buf = nbuf;
+            max *= 2;
+        }
+        nr = read(fd, buf + len, max - len);
+        if ( nr < 0 ) {
+            if ( EINTR == errno ) {
+                continue;
+            }
+            free(buf);
+            return -1;
+        } else if ( 0 == nr ) {
+            /* End-of-file */
             break;
         }
-        c = _next(tokenizer);
+        len += nr;
     }
 
-    /* Return the number of skipped chars */
-    return cnt;
+    str->s = buf;
+    str->len = len;
+
+    return 0;
 }
 
 /*
- * Read the content of a file from FILE pointer
+ * Read the content of a file.  A regular file is mapped into memory so that
+ * the tokenizer scans the page cache directly; others are read into a buffer.
  */
 scode_t *
 scode_read(const char *fname)
 {
     scode_t *scode;
-    FILE *fp;
-    char buf[4096];
-    off_t len;
-    off_t pos;
-    size_t nr;
+    int fd;
+    struct stat st;
+    void *addr;
 
     /* Open the file */
-    fp = fopen(fname, "r");
-
-    if ( 0 != fseeko(fp, 0, SEEK_END) ) {
-        goto error;
-    }
-    len = ftello(fp);
-    if ( len < 0 ) {
-        goto error;
+    fd = open(fname, O_RDONLY);
+    if ( fd < 0 ) {
+        return NULL;
     }
-    if ( 0 != fseeko(fp, 0, SEEK_SET) ) {
+    if ( 0 != fstat(fd, &st) ) {
         goto error;
     }
 
-    /* Allocate memory for the content of the input file */
+    /* Allocate memory for the source code */
     scode = malloc(sizeof(scode_t));
     if ( NULL == scode ) {
         goto error;
     }
-    scode->str.s = malloc(len);
-    if ( NULL == scode->str.s ) {
-        goto error1;
-    }
-    scode->str.len = len;
 
-    pos = 0;
-    for ( ;; ) {
-        nr = fread(buf, 1, sizeof(buf), fp);
-        if ( nr <= 0 ) {
-            break;
+    if ( S_ISREG(st.st_mode) && st.st_size > 0
+         && (uintmax_t)st.st_size <= SIZE_MAX ) {
+        /* Map the regular file */
+        addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if ( MAP_FAILED == addr ) {
+            goto error1;
         }
-        (void)memcpy(scode->str.s + pos, buf, nr);
-        pos += nr;
+#ifdef MADV_SEQUENTIAL
+        (void)madvise(addr, st.st_size, MADV_SEQUENTIAL);
+#endif
+        scode->str.s = addr;
+        scode->str.len = st.st_size;
+        scode->mapped = 1;
+    } else {
+        /* Read from the pipe or the other kind of file */
+        if ( 0 != _scode_read_fd(fd, &scode->str) ) {
+            goto error1;
+        }
+        scode->mapped = 0;
     }
 
     /* Copy the file name */
@@ -190,19 +444,24 @@ scode_read(const char *fname)
         goto error2;
     }
 
-    goto done;
+    /* The mapping remains valid after closing the descriptor */
+    (void)close(fd);
+
+    return scode;
 
 error2:
-    free(scode->str.s);
+    if ( scode->mapped ) {
+        (void)munmap(scode->str.s, scode->str.len);
+    } else {
+        free(scode->str.s);
+    }
 error1:
     free(scode);
 error:
     /* Close the file */
-    (void)fclose(fp);
-    scode = NULL;
+    (void)close(fd);
 
-done:
-    return scode;
+    return NULL;
 }
 
 /*
@@ -211,7 +470,12 @@ done:
 void
 scode_delete(scode_t *scode)
 {
-    free(scode->str.s);
+    if ( scode->mapped ) {
+        (void)munmap(scode->str.s, scode->str.len);
+    } else {
+        free(scode->str.s);
+    }
+    free(scode->fname);
     free(scode);
 }
 
@@ -220,17 +484,18 @@ scode_delete(scode_t *scode)
  * Create a new token queue
  */
 token_queue_t *
-token_queue_new(void)
+token_queue_new(struct arena *arena)
 {
     token_queue_t *tq;
 
-    tq = malloc(sizeof(token_queue_t));
+    tq = arena_alloc(arena, sizeof(token_queue_t));
     if ( NULL == tq ) {
         return NULL;
     }
     tq->head = NULL;
     tq->tail = NULL;
     tq->cur = NULL;
+    tq->arena = arena;
 
     return tq;
 }
@@ -245,7 +510,7 @@ token_queue_insert_tail(token_queue_t *tq, token_t *token)
     token_queue_entry_t *ent;
 
     /* allocate the entry */
-    ent = malloc(sizeof(token_queue_entry_t));
+    ent = arena_alloc(tq->arena, sizeof(token_queue_entry_t));
     if ( NULL == ent ) {
         return -1;
     }
@@ -312,7 +577,7 @@ token_new(tokenizer_t * tokenizer)
 {
     token_t *token;
 
-    token = malloc(sizeof(token_t));
+    token = arena_alloc(tokenizer->arena, sizeof(token_t));
     if ( NULL == token ) {
         return NULL;
     }
@@ -320,6 +585,7 @@ token_new(tokenizer_t * tokenizer)
     token->pos.l = tokenizer->pos.l;
     token->pos.c = tokenizer->pos.c;
     token->off = tokenizer->cur;
+    token->id = SYM_ID_NONE;
 
     return token;
 }
@@ -358,86 +624,77 @@ _append_typed_token(tokenizer_t *tokenizer, token_queue_t *tq,
 static int
 _scan_number(tokenizer_t *tokenizer, token_queue_t *tq)
 {
-    int c;
     int c0;
-    unsigned char *sp;
-    unsigned char *tp;
+    const unsigned char *sp;
+    const unsigned char *tp;
+    const unsigned char *end;
     char *val;
     int ret;
     int type;
     token_t *token;
 
     /* Store the current pointer */
-    sp = _curp(tokenizer);
+    sp = tokenizer->scode->str.s + tokenizer->cur;
+    end = tokenizer->scode->str.s + tokenizer->end;
 
-    /* Get the current and the next character */
-    c0 = _cur(tokenizer);
-    c = _next(tokenizer);
+    /* Get the current character and proceed to the next one */
+    tp = sp;
+    c0 = *tp++;
 
-    if ( '0' == c0 && IS_OCTINT_CHAR(c) ) {
+    if ( '0' == c0 && tp < end && IS_OCTINT_CHAR(*tp) ) {
         /* Octet */
         type = TOK_OCTINT;
-        while ( IS_OCTINT_CHAR(c) ) {
-            c = _next(tokenizer);
+        while ( tp < end && IS_OCTINT_CHAR(*tp) ) {
+            tp++;
         }
-    } else if ( '0' == c0 && 'b' == c ) {
+    } else if ( '0' == c0 && tp < end && 'b' == *tp ) {
         /* Binary */
         type = TOK_BININT;
-        c = _next(tokenizer);
-        if ( !IS_BININT_CHAR(c) ) {
+        tp++;
+        if ( tp >= end || !IS_BININT_CHAR(*tp) ) {
             /* Error: Invalid token */
             type = TOK_INVAL;
         } else {
-            while ( IS_BININT_CHAR(c) ) {
-                c = _next(tokenizer);
+            while ( tp < end && IS_BININT_CHAR(*tp) ) {
+                tp++;
             }
         }
-    } else if ( '0' == c0 && 'x' == c ) {
+    } else if ( '0' == c0 && tp < end && 'x' == *tp ) {
         /* Hex */
         type = TOK_HEXINT;
-        c = _next(tokenizer);
-        if ( !IS_HEXINT_CHAR(c) ) {
+        tp++;
+        if ( tp >= end || !IS_HEXINT_CHAR(*tp) ) {
             /* Error: Invalid token */
             type = TOK_INVAL;
         } else {
-            while ( IS_HEXINT_CHAR(c) ) {
-                c = _next(tokenizer);
+            while ( tp < end && IS_HEXINT_CHAR(*tp) ) {
+                tp++;
             }
         }
     } else {
         type = TOK_DECINT;
         /* Decimal */
-        while ( IS_DECINT_CHAR(c) ) {
-            c = _next(tokenizer);
+        while ( tp < end && IS_DECINT_CHAR(*tp) ) {
+            tp++;
         }
     }
 
-    /* Get the end of the number */
-    tp = _curp(tokenizer);
-
-    /* Check the length of the string */
-    if ( sp == tp ) {
-        /* Note: Must not reach here */
-        (void)_next(tokenizer);
-        type = TOK_INVAL;
-    }
+    /* Proceed to the end of the number */
+    _forward(tokenizer, tp - sp);
 
     if ( TOK_INVAL == type ) {
         /* Found it's an invalid token */
         ret = _append_typed_token(tokenizer, tq, TOK_INVAL);
     } else {
         /* Copy the value */
-        val = malloc(sizeof(char) * (tp - sp + 1));
+        val = arena_strndup(tokenizer->arena, (const char *)sp, tp - sp);
         if ( NULL == val ) {
             return -1;
         }
-        (void)memcpy(val, sp, tp - sp);
-        val[tp - sp] = '\0';
 
         /* Allocate a token */
         token = token_new(tokenizer);
         if ( NULL == token ) {
-            free(val);
             return -1;
         }
         token->type = type;
@@ -449,90 +706,63 @@ _scan_number(tokenizer_t *tokenizer, token_queue_t *tq)
     return ret;
 }
 
-static int
-_strmemcmp(const unsigned char *a0, const unsigned char *a1, const char *b)
-{
-    size_t len;
-
-    len = strlen(b);
-    if ( a1 - a0 == len && 0 == memcmp(a0, b, len) ) {
-        return 0;
-    } else {
-        return 1;
-    }
-}
-
 /*
  * Scan symbol
  */
 static int
 _scan_symbol(preprocessor_t *pp, tokenizer_t *tokenizer, token_queue_t *tq)
 {
-    int i;
-    int c;
-    unsigned char *sp;
-    unsigned char *tp;
-    char *val;
+    const unsigned char *sp;
+    const unsigned char *tp;
+    const unsigned char *end;
+    sym_id_t id;
     int ret;
     token_t *token;
-    token_fix_t *fix;
     token_type_t type;
 
     /* Store the current pointer */
-    sp = _curp(tokenizer);
+    sp = tokenizer->scode->str.s + tokenizer->cur;
+    end = tokenizer->scode->str.s + tokenizer->end;
 
-    /* Get the curret character */
-    c = _cur(tokenizer);
-    while ( IS_SYMBOL_CHAR(c) ) {
-        c = _next(tokenizer);
+    /* Search the end of the symbol */
+    tp = sp;
+    while ( tp < end && IS_SYMBOL_CHAR(*tp) ) {
+        tp++;
     }
-
-    /* Get the end of the symbol */
-    tp = _curp(tokenizer);
+    _forward(tokenizer, tp - sp);
 
     /* Check the length of the string */
     if ( sp == tp ) {
         /* Invalidate if the length is zero */
         (void)_next(tokenizer);
-        ret = _append_typed_token(tokenizer, tq, TOK_INVAL);
-    } else if ( 0 == _strmemcmp(sp, tp, "global") ) {
-        ret = _append_typed_token(tokenizer, tq, TOK_KW_GLOBAL);
-    } else if ( 0 == _strmemcmp(sp, tp, "byte") ) {
-        ret = _append_typed_token(tokenizer, tq, TOK_KW_BYTE);
-    } else if ( 0 == _strmemcmp(sp, tp, "word") ) {
-        ret = _append_typed_token(tokenizer, tq, TOK_KW_WORD);
-    } else if ( 0 == _strmemcmp(sp, tp, "dword") ) {
-        ret = _append_typed_token(tokenizer, tq, TOK_KW_DWORD);
-    } else if ( 0 == _strmemcmp(sp, tp, "qword") ) {
-        ret = _append_typed_token(tokenizer, tq, TOK_KW_QWORD);
+        return _append_typed_token(tokenizer, tq, TOK_INVAL);
+    }
+
+    /* Classify the symbol with the keyword table */
+    type = pp_keyword_type(pp, (const char *)sp, tp - sp);
+    if ( TOK_SYMBOL != type && TOK_FIX != type ) {
+        /* Keyword */
+        ret = _append_typed_token(tokenizer, tq, type);
     } else {
-        type = TOK_SYMBOL;
-        /* Search from the registered fix keywords */
-        for ( i = 0; i < mvector_size(pp->fix); i++ ) {
-            fix = mvector_at(pp->fix, i);
-            if ( tp - sp == strlen(fix->kw)
-                 && 0 == memcmp(sp, fix->kw, strlen(fix->kw)) ) {
-                type = TOK_FIX;
-                break;
-            }
+        /* Intern the symbol; a chunk-local ID is replaced with the global one
+           when the chunks are stitched */
+        if ( NULL != tokenizer->itbl ) {
+            id = intern_table_sym(tokenizer->itbl, (const char *)sp, tp - sp);
+        } else {
+            id = intern_sym((const char *)sp, tp - sp);
         }
-
-        /* Copy the value */
-        val = malloc(sizeof(char) * (tp - sp + 1));
-        if ( NULL == val ) {
+        if ( SYM_ID_NONE == id ) {
             return -1;
         }
-        (void)memcpy(val, sp, tp - sp);
-        val[tp - sp] = '\0';
 
         /* Allocate a token */
         token = token_new(tokenizer);
         if ( NULL == token ) {
-            free(val);
             return -1;
         }
         token->type = type;
-        token->val.sym = val;
+        token->val.sym = NULL != tokenizer->itbl ? NULL : intern_str(id);
+        token->id = id;
 
         ret = token_queue_insert_tail(tq, token);
     }
@@ -565,54 +795,55 @@ _next_token(preprocessor_t *pp, tokenizer_t *tokenizer, token_queue_t *tq)
         break;
     case '\n':
         ret = _append_typed_token(tokenizer, tq, TOK_EOL);
-        (void)_next(tokenizer);
+        (void)_next(tokenizer);  /* LF */
         break;
     case '#':
         ret = _append_typed_token(tokenizer, tq, TOK_SHARP);
-        (void)_next(tokenizer);
+        _forward(tokenizer, 1);
         break;
     case ',':
         ret = _append_typed_token(tokenizer, tq, TOK_COMMA);
-        (void)_next(tokenizer);
+        _forward(tokenizer, 1);
         break;
     case ':':
         ret = _append_typed_token(tokenizer, tq, TOK_COLON);
-        (void)_next(tokenizer);
+        _forward(tokenizer, 1);
         break;
     case ';':
         ret = _append_typed_token(tokenizer, tq, TOK_SEMICOLON);
-        (void)_next(tokenizer);
+        _forward(tokenizer, 1);
         break;
     case '[':
         ret = _append_typed_token(tokenizer, tq, TOK_LBRACKET);
-        (void)_next(tokenizer);
+        _forward(tokenizer, 1);
         break;
     case ']':
         ret = _append_typed_token(tokenizer, tq, TOK_RBRACKET);
-        (void)_next(tokenizer);
+        _forward(tokenizer, 1);
         break;
     case '(':
         ret = _append_typed_token(tokenizer, tq, TOK_LPAREN);
-        (void)_next(tokenizer);
+        _forward(tokenizer, 1);
         break;
     case ')':
         ret = _append_typed_token(tokenizer, tq, TOK_RPAREN);
-        (void)_next(tokenizer);
+        _forward(tokenizer, 1);
         break;
     case '+':
         ret = _append_typed_token(tokenizer, tq, TOK_OP_PLUS);
-        (void)_next(tokenizer);
+        _forward(tokenizer, 1);
         break;
     case '-':
         ret = _append_typed_token(tokenizer, tq, TOK_OP_MINUS);
-        (void)_next(tokenizer);
+        _forward(tokenizer, 1);
         break;
     case '*':
         ret = _append_typed_token(tokenizer, tq, TOK_OP_MUL);
-        (void)_next(tokenizer);
+        _forward(tokenizer, 1);
         break;
     case '/':
-        c = _next(tokenizer);
+        _forward(tokenizer, 1);
+        c = _cur(tokenizer);
         if ( '/' == c ) {
             /* Comment */
             _skip_line_comment(tokenizer);
@@ -622,23 +853,25 @@ _next_token(preprocessor_t *pp, tokenizer_t *tokenizer, token_queue_t *tq)
         break;
     case '~':
         ret = _append_typed_token(tokenizer, tq, TOK_OP_TILDE);
-        (void)_next(tokenizer);
+        _forward(tokenizer, 1);
         break;
     case '<':
-        c = _next(tokenizer);
+        _forward(tokenizer, 1);
+        c = _cur(tokenizer);
         if ( '<' == c ) {
             ret = _append_typed_token(tokenizer, tq, TOK_OP_LSHIFT);
-            (void)_next(tokenizer);
+            _forward(tokenizer, 1);
         } else {
             /* Invalid */
             ret = _append_typed_token(tokenizer, tq, TOK_INVAL);
         }
         break;
     case '>':
-        c = _next(tokenizer);
+        _forward(tokenizer, 1);
+        c = _cur(tokenizer);
         if ( '>' == c ) {
             ret = _append_typed_token(tokenizer, tq, TOK_OP_RSHIFT);
-            (void)_next(tokenizer);
+            _forward(tokenizer, 1);
         } else {
             /* Invalid */
             ret = _append_typed_token(tokenizer, tq, TOK_INVAL);
@@ -646,19 +879,19 @@ _next_token(preprocessor_t *pp, tokenizer_t *tokenizer, token_queue_t *tq)
         break;
     case '|':
         ret = _append_typed_token(tokenizer, tq, TOK_OP_BAR);
-        (void)_next(tokenizer);
+        _forward(tokenizer, 1);
         break;
     case '&':
         ret = _append_typed_token(tokenizer, tq, TOK_OP_AMP);
-        (void)_next(tokenizer);
+        _forward(tokenizer, 1);
         break;
     case '^':
         ret = _append_typed_token(tokenizer, tq, TOK_OP_XOR);
-        (void)_next(tokenizer);
+        _forward(tokenizer, 1);
         break;
     default:
         /* Other characters */
-        if ( isdigit(c) ) {
+        if ( IS_DECINT_CHAR(c) ) {
             /* Starting with digit; then scan number */
             ret = _scan_number(tokenizer, tq);
         } else {
@@ -671,6 +904,216 @@ _next_token(preprocessor_t *pp, tokenizer_t *tokenizer, token_queue_t *tq)
 }
 
 
+/*
+ * Chunk of the parallel tokenization: the lines of the chunk are tokenized
+ * into its own queue with its own arena and interning table, and then the
+ * chunk-local symbol IDs and the line numbers are rebased
+ */
+struct tokenize_chunk {
+    preprocessor_t *pp;
+    tokenizer_t tokenizer;
+    token_queue_t *tq;
+    /* Global IDs indexed by the chunk-local IDs */
+    sym_id_t *map;
+    /* Line number of the start of the chunk */
+    size_t line;
+    /* Return code of the tokenization */
+    int ret;
+};
+
+/*
+ * Tokenize a chunk
+ */
+static void *
+_tokenize_chunk(void *arg)
+{
+    struct tokenize_chunk *chunk;
+
+    chunk = (struct tokenize_chunk *)arg;
+    while ( _next_token(chunk->pp, &chunk->tokenizer, chunk->tq) >= 0 ) {
+        ;
+    }
+    if ( EOS != _cur(&chunk->tokenizer) ) {
+        /* Stopped before the end of the chunk; i.e., allocation error */
+        chunk->ret = -1;
+    }
+
+    return NULL;
+}
+
+/*
+ * Rebase the symbol IDs and the line numbers of the tokens of a chunk; the
+ * offsets are already those in the whole source
+ */
+static void *
+_tokenize_rebase(void *arg)
+{
+    struct tokenize_chunk *chunk;
+    token_queue_entry_t *ent;
+    token_t *token;
+
+    chunk = (struct tokenize_chunk *)arg;
+    for ( ent = chunk->tq->head; NULL != ent; ent = ent->next ) {
+        token = ent->token;
+        token->pos.l += chunk->line;
+        if ( SYM_ID_NONE != token->id ) {
+            token->id = chunk->map[token->id];
+            token->val.sym = intern_str(token->id);
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Run f on the chunks in parallel; a chunk of which thread fails to start is
+ * processed on this thread
+ */
+static void
+_tokenize_run(struct tokenize_chunk *chunks, size_t n, void *(*f)(void *))
+{
+    pthread_t *threads;
+    int *started;
+    size_t i;
+
+    threads = malloc(sizeof(pthread_t) * n);
+    started = calloc(n, sizeof(int));
+    for ( i = 0; i < n; i++ ) {
+        if ( NULL != threads && NULL != started ) {
+            started[i] = (0 == pthread_create(&threads[i], NULL, f,
+                                              &chunks[i]));
+        }
+        if ( NULL == started || !started[i] ) {
+            (void)f(&chunks[i]);
+        }
+    }
+    for ( i = 0; i < n && NULL != started; i++ ) {
+        if ( started[i] ) {
+            (void)pthread_join(threads[i], NULL);
+        }
+    }
+    free(threads);
+    free(started);
+}
+
+/*
+ * Tokenize the source split at newlines into n chunks in parallel and stitch
+ * the token queues in order; merging the interning tables of the chunks in
+ * order assigns the same symbol IDs as tokenizing serially
+ */
+static int
+_tokenize_parallel(preprocessor_t *pp, scode_t *scode, tcode_t *tcode,
+                   size_t n)
+{
+    struct tokenize_chunk *chunks;
+    struct tokenize_chunk *chunk;
+    token_queue_t *tq;
+    const unsigned char *lf;
+    off_t start;
+    off_t end;
+    size_t line;
+    size_t i;
+    int ret;
+
+    chunks = calloc(n, sizeof(struct tokenize_chunk));
+    if ( NULL == chunks ) {
+        return -1;
+    }
+
+    /* Split the source right after the newlines */
+    ret = 0;
+    start = 0;
+    for ( i = 0; i < n; i++ ) {
+        chunk = &chunks[i];
+        end = scode->str.len;
+        if ( i + 1 < n ) {
+            end = scode->str.len / n * (i + 1);
+            if ( end < start ) {
+                end = start;
+            }
+            lf = memchr(scode->str.s + end, '\n', scode->str.len - end);
+            if ( NULL != lf ) {
+                end = (size_t)(lf - scode->str.s) + 1;
+            } else {
+                end = scode->str.len;
+            }
+        }
+        chunk->pp = pp;
+        chunk->tokenizer.scode = scode;
+        chunk->tokenizer.arena = arena_new();
+        chunk->tokenizer.cur = start;
+        chunk->tokenizer.end = end;
+        chunk->tokenizer.itbl = intern_table_new();
+        chunk->tokenizer.pos.l = 0;
+        chunk->tokenizer.pos.c = 0;
+        if ( NULL == chunk->tokenizer.arena || NULL == chunk->tokenizer.itbl
+             || NULL == (chunk->tq = token_queue_new(chunk->tokenizer.arena)) ) {
+            ret = -1;
+        }
+        start = end;
+    }
+
+    if ( 0 == ret ) {
+        _tokenize_run(chunks, n, _tokenize_chunk);
+        for ( i = 0; i < n; i++ ) {
+            if ( 0 != chunks[i].ret ) {
+                ret = -1;
+            }
+        }
+    }
+
+    if ( 0 == ret ) {
+        /* Intern the symbols globally in the order of the chunks */
+        line = 0;
+        for ( i = 0; i < n && 0 == ret; i++ ) {
+            chunk = &chunks[i];
+            chunk->line = line;
+            line += chunk->tokenizer.pos.l;
+            chunk->map = malloc(sizeof(sym_id_t)
+                                * (intern_table_size(chunk->tokenizer.itbl)
+                                   + 1));
+            if ( NULL == chunk->map
+                 || 0 != intern_table_merge(chunk->tokenizer.itbl,
+                                            chunk->map) ) {
+                ret = -1;
+            }
+        }
+    }
+
+    if ( 0 == ret ) {
+        _tokenize_run(chunks, n, _tokenize_rebase);
+
+        /* Stitch the queues */
+        tq = tcode->token_queue;
+        for ( i = 0; i < n; i++ ) {
+            chunk = &chunks[i];
+            if ( NULL == chunk->tq->head ) {
+                continue;
+            }
+            if ( NULL == tq->head ) {
+                tq->head = chunk->tq->head;
+            } else {
+                tq->tail->next = chunk->tq->head;
+            }
+            tq->tail = chunk->tq->tail;
+        }
+        tq->cur = tq->head;
+    }
+
+    /* Move the tokens to the arena of the tcode */
+    for ( i = 0; i < n; i++ ) {
+        chunk = &chunks[i];
+        if ( NULL != chunk->tokenizer.arena ) {
+            arena_merge(tcode->arena, chunk->tokenizer.arena);
+        }
+        intern_table_delete(chunk->tokenizer.itbl);
+        free(chunk->map);
+    }
+    free(chunks);
+
+    return ret;
+}
+
 /*
  * Tokenize
  */
@@ -679,6 +1122,7 @@ tokenize(preprocessor_t *pp, scode_t *scode)
 {
     tcode_t *tcode;
     tokenizer_t tokenizer;
+    size_t n;
     int ret;
 
     /* Allocate tcode */
@@ -687,10 +1131,39 @@ tokenize(preprocessor_t *pp, scode_t *scode)
         return NULL;
     }
     tcode->scode = scode;
-    tcode->token_queue = token_queue_new();
+    tcode->arena = arena_new();
+    if ( NULL == tcode->arena ) {
+        free(tcode);
+        return NULL;
+    }
+    tcode->token_queue = token_queue_new(tcode->arena);
+    if ( NULL == tcode->token_queue ) {
+        arena_delete(tcode->arena);
+        free(tcode);
+        return NULL;
+    }
+
+    /* Select the scanning functions */
+    _scan_init();
+
+    /* Split a large source into the chunks of the threads */
+    n = scode->str.len / TOKENIZER_MIN_CHUNK;
+    if ( n > pp->jobs ) {
+        n = pp->jobs;
+    }
+    if ( n > 1 ) {
+        if ( 0 != _tokenize_parallel(pp, scode, tcode, n) ) {
+            tcode_delete(tcode);
+            return NULL;
+        }
+        return tcode;
+    }
 
     tokenizer.scode = scode;
+    tokenizer.arena = tcode->arena;
     tokenizer.cur = 0;
+    tokenizer.end = scode->str.len;
+    tokenizer.itbl = NULL;
     tokenizer.pos.l = 0;
     tokenizer.pos.c = 0;
 
@@ -700,11 +1173,26 @@ tokenize(preprocessor_t *pp, scode_t *scode)
             break;
         }
     }
+    if ( EOS != _cur(&tokenizer) ) {
+        /* Stopped before the end of the source; i.e., allocation error */
+        tcode_delete(tcode);
+        return NULL;
+    }
     /*printf("%lld [%zu:%zu]\n", tokenizer.cur, tokenizer.pos.l, tokenizer.pos.c);*/
 
     return tcode;
 }
 
+/*
+ * Free the tokenized code; all the tokens are released with the arena
+ */
+void
+tcode_delete(tcode_t *tcode)
+{
+    arena_delete(tcode->arena);
+    free(tcode);
+}
+
 
 /*
  * Local variables:
@@ -0,0 +1,145 @@
+/*_
+ * Copyright 2013 Scyphus Solutions Co. Ltd.  All rights reserved.
+ *
+ * Authors:
+ *      Hirochika Asai  <asai@scyphus.co.jp>
+ */
+
+/* $Id$ */
+
+#ifndef _TVECTOR_H
+#define _TVECTOR_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Typed vector
+ *
+ * TVECTOR_DECLARE(name, type, ninline) defines `struct name' (typedef'ed to
+ * name_t) holding elements of `type' and the following inline functions:
+ *
+ *      name_t * name_new(void);
+ *      void name_delete(name_t *);
+ *      void name_clear(name_t *);
+ *      size_t name_size(const name_t *);
+ *      type name_at(const name_t *, size_t);
+ *      type * name_ref(name_t *, size_t);
+ *      name_t * name_push_back(name_t *, type);
+ *
+ * The first `ninline' elements are stored in the structure itself so that
+ * short vectors (e.g., operands) do not allocate the element array, and the
+ * array then grows geometrically.  name_at() and name_ref() do not check the
+ * range, and the pointer returned by name_ref() is valid until the next
+ * push_back.  The structure must not be moved once created since `elems' may
+ * point to the inline storage.
+ */
+#define TVECTOR_DECLARE(name, type, ninline)                            \
+    typedef struct name {                                               \
+        type *elems;                                                    \
+        size_t size;                                                    \
+        size_t max_size;                                                \
+        type inl[ninline];                                              \
+    } name##_t;                                                         \
+                                                                        \
+    static __inline__ name##_t *                                        \
+    name##_new(void)                                                    \
+    {                                                                   \
+        name##_t *vec;                                                  \
+                                                                        \
+        vec = malloc(sizeof(name##_t));                                 \
+        if ( NULL == vec ) {                                            \
+            return NULL;                                                \
+        }                                                               \
+        vec->elems = vec->inl;                                          \
+        vec->size = 0;                                                  \
+        vec->max_size = (ninline);                                      \
+                                                                        \
+        return vec;                                                     \
+    }                                                                   \
+                                                                        \
+    static __inline__ void                                              \
+    name##_delete(name##_t *vec)                                        \
+    {                                                                   \
+        if ( NULL != vec ) {                                            \
+            if ( vec->elems != vec->inl ) {                             \
+                free(vec->elems);                                       \
+            }                                                           \
+            free(vec);                                                  \
+        }                                                               \
+    }                                                                   \
+                                                                        \
+    static __inline__ void                                              \
+    name##_clear(name##_t *vec)                                         \
+    {                                                                   \
+        vec->size = 0;                                                  \
+    }                                                                   \
+                                                                        \
+    static __inline__ size_t                                            \
+    name##_size(const name##_t *vec)                                    \
+    {                                                                   \
+        return vec->size;                                               \
+    }                                                                   \
+                                                                        \
+    static __inline__ type                                              \
+    name##_at(const name##_t *vec, size_t i)                            \
+    {                                                                   \
+        return vec->elems[i];                                           \
+    }                                                                   \
+                                                                        \
+    static __inline__ type *                                            \
+    name##_ref(name##_t *vec, size_t i)                                 \
+    {                                                                   \
+        return &vec->elems[i];                                          \
+    }                                                                   \
+                                                                        \
+    static __inline__ name##_t *                                        \
+    name##_grow(name##_t *vec)                                          \
+    {                                                                   \
+        type *elems;                                                    \
+        size_t max_sz;                                                  \
+                                                                        \
+        if ( vec->max_size > SIZE_MAX / 2 / sizeof(type) ) {            \
+            return NULL;                                                \
+        }                                                               \
+        max_sz = vec->max_size * 2;                                     \
+        if ( vec->elems == vec->inl ) {                                 \
+            elems = malloc(sizeof(type) * max_sz);                      \
+            if ( NULL == elems ) {                                      \
+                return NULL;                                            \
+            }                                                           \
+            (void)memcpy(elems, vec->inl, sizeof(type) * vec->size);    \
+        } else {                                                        \
+            elems = realloc(vec->elems, sizeof(type) * max_sz);         \
+            if ( NULL == elems ) {                                      \
+                return NULL;                                            \
+            }                                                           \
+        }                                                               \
+        vec->elems = elems;                                             \
+        vec->max_size = max_sz;                                         \
+                                                                        \
+        return vec;                                                     \
+    }                                                                   \
+                                                                        \
+    static __inline__ name##_t *                                        \
+    name##_push_back(name##_t *vec, type elem)                          \
+    {                                                                   \
+        if ( vec->size == vec->max_size && NULL == name##_grow(vec) ) { \
+            return NULL;                                                \
+        }                                                               \
+        vec->elems[vec->size++] = elem;                                 \
+                                                                        \
+        return vec;                                                     \
+    }
+
+#endif /* _TVECTOR_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,6 @@
+global	start
+
+start:
+	push	rax
+	jmp	start
+	ret
\ No newline at end of file
@@ -0,0 +1,65 @@
+global	start
+
+start:
+	jmp	fwd_short
+	jz	fwd_short
+	push	rax
+fwd_short:
+	jnz	start
+	jmp	fwd_near
+	je	fwd_near
+	call	fwd_near
+back_near:
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+fwd_near:
+	jmp	back_near
+	jnz	back_near
+	jz	fwd_short
+
+jmp_grown:
+	jmp	grown_end
+	jz	far_target
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	push	rax
+	push	rax
+	push	rax
+grown_end:
+	jnz	jmp_grown
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+	mov	rax,0x1122334455667788
+far_target:
+	ret